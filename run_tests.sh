@@ -2,7 +2,15 @@
 
 cd tests
 
-./run_tests.py $@
+# unc_tests runs the cases in one process, it is built by 'make check'
+if [ -x ../src/unc_tests ]; then
+	../src/unc_tests $@
+else
+	./run_tests.py $@
+fi
+ret=$?
 
-exit $?
+# The cases that need command line options
+./cmdline_tests.sh || ret=1
 
+exit $ret
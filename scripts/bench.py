@@ -0,0 +1,540 @@
+#! /usr/bin/env python
+#
+# Measures how fast uncrustify formats a fixed corpus.
+#
+# The corpus is every file in tests/input plus one big generated file for
+# each of C, C++, ObjC, Java and D. The generated files only depend on the
+# seed and the size, so two runs with the same options format the same text.
+# Each config is run over each set of files with --stats=json, and the best
+# of --repeat runs is kept. Run from the build folder:
+#
+#   $ python scripts/bench.py --exe src/uncrustify
+#   $ python scripts/bench.py --json new.json --baseline old.json
+#
+# Works with python 2.6+ and 3.x.
+#
+# @author  Ben Gardner
+# @license GPL v2+
+#
+import sys
+import os
+import time
+import json
+import hashlib
+import subprocess
+
+TOP = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+DEFAULT_CONFIGS = [ 'linux.cfg', 'ben.cfg', 'gnu-indent.cfg', 'objc.cfg' ]
+
+# the generated files, by extension
+SYNTH_LANGS = [ 'c', 'cpp', 'm', 'java', 'd' ]
+
+
+class Rand:
+	"""
+	A small LCG, so that the corpus doesn't change with the python version
+	"""
+	def __init__ (self, seed):
+		self.state = seed & 0xffffffff
+
+	def next (self, count):
+		self.state = (self.state * 1103515245 + 12345) & 0x7fffffff
+		return (self.state >> 8) % count
+
+	def pick (self, items):
+		return items[self.next(len(items))]
+
+	def chance (self, percent):
+		return self.next(100) < percent
+
+
+class Gen:
+	"""
+	Writes badly formatted code in a C family language.
+	The spacing, the brace placement and the indent are random, so that
+	every pass has something to do.
+	"""
+	def __init__ (self, lang, seed):
+		self.lang  = lang
+		self.rand  = Rand(seed)
+		self.out   = []
+		self.count = 0
+
+	def emit (self, level, text):
+		r = self.rand
+		if r.chance(15):
+			indent = ' ' * r.next(9)
+		elif r.chance(50):
+			indent = '\t' * level
+		else:
+			indent = '   ' * level
+		self.out.append(indent + text + ' ' * (r.chance(5) and 1 or 0))
+
+	def sp (self):
+		return self.rand.pick([ '', ' ', ' ', '  ' ])
+
+	def ident (self):
+		r = self.rand
+		return r.pick([ 'idx', 'count', 'len', 'value', 'tmp', 'res', 'pos', 'flags',
+		                'data', 'next', 'prev', 'total', 'width', 'height' ]) + \
+		       r.pick([ '', '', '1', '2', '_a', '_b' ])
+
+	def func_name (self):
+		r = self.rand
+		return r.pick([ 'get', 'set', 'find', 'update', 'parse', 'check', 'make', 'load' ]) + \
+		       r.pick([ '_item', '_entry', '_node', '_value', 'Item', 'Entry', 'Node', 'Value' ])
+
+	def type_name (self):
+		if self.lang == 'java':
+			return self.rand.pick([ 'int', 'long', 'boolean', 'String', 'Object', 'double' ])
+		if self.lang == 'd':
+			return self.rand.pick([ 'int', 'long', 'bool', 'string', 'auto', 'double' ])
+		return self.rand.pick([ 'int', 'long', 'unsigned int', 'char *', 'const char *', 'double', 'size_t' ])
+
+	def member (self):
+		if self.lang in [ 'c', 'cpp', 'm' ] and self.rand.chance(50):
+			return self.ident() + '->' + self.ident()
+		return self.ident() + '.' + self.ident()
+
+	def expr (self, depth = 0):
+		r = self.rand
+		k = r.next(depth < 3 and 9 or 3)
+		if k == 0:
+			return self.ident()
+		if k == 1:
+			return str(r.next(1000))
+		if k == 2:
+			return self.member()
+		if k == 3:
+			return self.call(depth + 1)
+		if k == 4:
+			return '(' + self.sp() + self.expr(depth + 1) + self.sp() + ')'
+		if k == 5:
+			return self.ident() + '[' + self.expr(depth + 1) + ']'
+		if k == 6:
+			return '"' + r.pick([ 'abc', 'hello %d', 'x = %s\\n', '' ]) + '"'
+		if k == 7 and self.lang == 'm':
+			return '[' + self.ident() + ' ' + self.func_name() + ':' + self.expr(depth + 1) + \
+			       r.pick([ '', ' with:' + self.expr(depth + 1) ]) + ']'
+		op = r.pick([ '+', '-', '*', '/', '%', '<<', '&', '|', '==', '!=', '<', '>=', '&&', '||' ])
+		return self.expr(depth + 1) + self.sp() + op + self.sp() + self.expr(depth + 1)
+
+	def call (self, depth):
+		r    = self.rand
+		args = [ self.expr(depth + 1) for i in range(r.next(4)) ]
+		return self.func_name() + self.sp() + '(' + (',' + self.sp()).join(args) + ')'
+
+	def open_brace (self, level, head):
+		if self.rand.chance(50):
+			self.emit(level, head + self.sp() + '{')
+		else:
+			self.emit(level, head)
+			self.emit(level, '{')
+
+	def block (self, level, count):
+		for i in range(count):
+			self.statement(level)
+
+	def statement (self, level):
+		r = self.rand
+		k = r.next(level < 4 and 12 or 6)
+		if k == 0:
+			self.emit(level, self.ident() + self.sp() + r.pick([ '=', '+=', '|=', '-=' ]) +
+			          self.sp() + self.expr() + ';')
+		elif k == 1:
+			self.emit(level, self.call(0) + ';')
+		elif k == 2:
+			self.emit(level, self.type_name() + ' ' + self.ident() + self.sp() + '=' + self.sp() +
+			          self.expr() + ';')
+		elif k == 3:
+			self.emit(level, '// ' + r.pick([ 'check the next one', 'TODO: fix this', 'done' ]))
+		elif k == 4:
+			self.emit(level, 'return' + r.pick([ ';', ' ' + self.expr() + ';' ]))
+		elif k == 5:
+			self.emit(level, '/* ' + r.pick([ 'a comment', 'see above', 'the long one is first' ]) + ' */')
+		elif k in [ 6, 7 ]:
+			self.open_brace(level, 'if' + self.sp() + '(' + self.expr() + ')')
+			self.block(level + 1, 1 + r.next(3))
+			self.emit(level, '}')
+			if r.chance(40):
+				self.open_brace(level, 'else')
+				self.block(level + 1, 1 + r.next(3))
+				self.emit(level, '}')
+		elif k == 8:
+			i = self.ident()
+			if self.lang == 'd' and r.chance(50):
+				head = 'foreach' + self.sp() + '(' + i + '; ' + self.ident() + ')'
+			else:
+				head = 'for' + self.sp() + '(' + i + self.sp() + '=' + self.sp() + '0;' + \
+				       self.sp() + i + self.sp() + '<' + self.sp() + self.expr(2) + ';' + \
+				       self.sp() + i + '++)'
+			self.open_brace(level, head)
+			self.block(level + 1, 1 + r.next(4))
+			self.emit(level, '}')
+		elif k == 9:
+			self.open_brace(level, 'while' + self.sp() + '(' + self.expr() + ')')
+			self.block(level + 1, 1 + r.next(3))
+			self.emit(level, '}')
+		elif k == 10:
+			self.open_brace(level, 'switch' + self.sp() + '(' + self.ident() + ')')
+			for c in range(1 + r.next(4)):
+				self.emit(level, 'case ' + str(c) + ':')
+				self.block(level + 1, 1 + r.next(2))
+				self.emit(level + 1, 'break;')
+			self.emit(level, 'default:')
+			self.emit(level + 1, 'break;')
+			self.emit(level, '}')
+		else:
+			self.emit(level, '{')
+			self.block(level + 1, 1 + r.next(3))
+			self.emit(level, '}')
+
+	def params (self):
+		return (',' + self.sp()).join([ self.type_name() + ' ' + self.ident()
+		                                for i in range(self.rand.next(4)) ])
+
+	def function (self, level, head):
+		self.open_brace(level, head)
+		self.block(level + 1, 3 + self.rand.next(8))
+		self.emit(level, '}')
+		self.out.append('')
+
+	def unit (self):
+		"""
+		Writes one top level item
+		"""
+		r = self.rand
+		self.count += 1
+		n = self.count
+		if self.lang == 'c':
+			if r.chance(20):
+				self.emit(0, '#define MAC_%d(x)' % n + self.sp() + '((x)' + self.sp() + '*' + self.sp() + '%d)' % n)
+			if r.chance(20):
+				self.emit(0, 'struct item_%d {' % n)
+				for i in range(1 + r.next(5)):
+					self.emit(1, self.type_name() + ' ' + self.ident() + '_%d;' % i)
+				self.emit(0, '};')
+			ifdef = r.chance(15)
+			if ifdef:
+				self.emit(0, '#ifdef HAVE_FEATURE_%d' % n)
+			self.function(0, r.pick([ 'static ', '' ]) + self.type_name() + ' ' + self.func_name() +
+			              '_%d(' % n + self.params() + ')')
+			if ifdef:
+				self.emit(0, '#endif')
+		elif self.lang == 'cpp':
+			self.emit(0, 'namespace ns%d {' % n)
+			if r.chance(30):
+				self.function(0, 'template <typename T>' + self.sp() + 'T ' + self.func_name() +
+				              '_%d(const T& ' % n + self.ident() + ')')
+			self.emit(0, 'class Item%d' % n + self.sp() + ':' + self.sp() + 'public Base {')
+			self.emit(0, 'public:')
+			self.emit(1, 'Item%d(int v) : ' % n + self.ident() + '(v) { }')
+			self.emit(1, 'virtual ~Item%d();' % n)
+			self.emit(1, 'int ' + self.func_name() + '(' + self.params() + ') const;')
+			self.emit(0, 'private:')
+			self.emit(1, 'std::vector<int>' + self.sp() + 'm_list;')
+			self.emit(1, 'int m_value;')
+			self.emit(0, '};')
+			self.function(0, 'int Item%d::' % n + self.func_name() + '(' + self.params() + ') const')
+			self.emit(0, '}')
+			self.out.append('')
+		elif self.lang == 'm':
+			self.emit(0, '@interface Item%d : NSObject {' % n)
+			self.emit(1, 'int ' + self.ident() + ';')
+			self.emit(1, 'NSString *' + self.ident() + ';')
+			self.emit(0, '}')
+			self.emit(0, '@property (nonatomic, retain) NSString *name;')
+			self.emit(0, '- (int)' + self.func_name() + ':(int)a with:(id)b;')
+			self.emit(0, '@end')
+			self.out.append('')
+			self.emit(0, '@implementation Item%d' % n)
+			self.function(0, '- (int)' + self.func_name() + ':(int)a with:(id)b')
+			self.function(0, '- (id)init')
+			self.emit(0, '@end')
+			self.out.append('')
+		elif self.lang == 'java':
+			self.emit(0, 'class Item%d' % n + r.pick([ '', ' extends Base', ' implements Runnable' ]) + ' {')
+			self.emit(1, 'private List<String>' + self.sp() + 'm_list = new ArrayList<String>();')
+			self.emit(1, 'private int m_value;')
+			if r.chance(50):
+				self.emit(1, '@Override')
+			self.function(1, 'public ' + self.type_name() + ' ' + self.func_name() + '(' + self.params() + ')')
+			self.function(1, 'static void ' + self.func_name() + '_%d()' % n)
+			self.emit(0, '}')
+			self.out.append('')
+		elif self.lang == 'd':
+			if r.chance(30):
+				self.function(0, 'T ' + self.func_name() + '_%d(T)(T a, T b)' % n)
+			self.emit(0, 'struct Item%d {' % n)
+			self.emit(1, 'int ' + self.ident() + ';')
+			self.function(1, self.type_name() + ' ' + self.func_name() + '(' + self.params() + ')')
+			self.emit(0, '}')
+			self.out.append('')
+
+	def header (self):
+		if self.lang == 'c':
+			return [ '#include <stdio.h>', '#include "items.h"', '' ]
+		if self.lang == 'cpp':
+			return [ '#include <vector>', '#include "items.h"', '' ]
+		if self.lang == 'm':
+			return [ '#import <Foundation/Foundation.h>', '' ]
+		if self.lang == 'java':
+			return [ 'package org.example.bench;', '', 'import java.util.*;', '' ]
+		if self.lang == 'd':
+			return [ 'module bench;', '', 'import std.stdio;', '' ]
+		return []
+
+	def generate (self, size):
+		self.out = self.header()
+		total = 0
+		while total < size:
+			start = len(self.out)
+			self.unit()
+			for line in self.out[start:]:
+				total += len(line) + 1
+		return '\n'.join(self.out) + '\n'
+
+
+def make_corpus (folder, size, seed):
+	"""
+	Writes the generated files, unless they are already there.
+	Returns the names, in order.
+	"""
+	if not os.path.isdir(folder):
+		os.makedirs(folder)
+	names = []
+	for idx in range(len(SYNTH_LANGS)):
+		lang = SYNTH_LANGS[idx]
+		name = os.path.join(folder, 'synth-%d-%d.%s' % (seed, size, lang))
+		if not os.path.exists(name):
+			text = Gen(lang, seed + idx).generate(size)
+			fh = open(name + '.tmp', 'w')
+			fh.write(text)
+			fh.close()
+			os.rename(name + '.tmp', name)
+		names.append(name)
+	return names
+
+
+def test_inputs ():
+	names = []
+	for root, dirs, files in os.walk(os.path.join(TOP, 'tests', 'input')):
+		dirs.sort()
+		for name in sorted(files):
+			names.append(os.path.join(root, name))
+	return names
+
+
+def files_md5 (names):
+	md5 = hashlib.md5()
+	for name in names:
+		fh = open(name, 'rb')
+		md5.update(fh.read())
+		fh.close()
+	return md5.hexdigest()
+
+
+def run_once (exe, cfg, list_file, out_dir, log_file):
+	"""
+	Formats the files in list_file.
+	Returns (wall seconds, the --stats report)
+	"""
+	cmd = [ exe, '-q', '-c', cfg, '--prefix', out_dir, '-F', list_file, '--stats=json' ]
+	null = open(os.devnull, 'w')
+	log  = open(log_file, 'w')
+	start = time.time()
+	subprocess.Popen(cmd, stdout = null, stderr = log).wait()
+	wall = time.time() - start
+	null.close()
+	log.close()
+
+	fh = open(log_file, 'r')
+	text = fh.read()
+	fh.close()
+	try:
+		report = json.loads(text)
+	except ValueError:
+		sys.stderr.write('%s: no --stats report:\n%s\n' % (' '.join(cmd), text))
+		sys.exit(1)
+	return wall, report
+
+
+def run_set (args, cfg, set_name, names):
+	list_file = os.path.join(args.work, set_name + '.list')
+	fh = open(list_file, 'w')
+	for name in names:
+		fh.write(name + '\n')
+	fh.close()
+
+	best = None
+	rss  = 0
+	for rep in range(args.repeat):
+		wall, report = run_once(args.exe, cfg, list_file, os.path.join(args.work, 'out'),
+		                        os.path.join(args.work, 'stats.json'))
+		total = report['total']
+		if (best == None) or (total['time_ns'] < best['total']['time_ns']):
+			best = { 'wall': wall, 'total': total }
+		rss = max(rss, total['max_rss_kb'])
+
+	total  = best['total']
+	fmt_s  = total['time_ns'] / 1e9
+	tokens = 0
+	passes = []
+	for ps in total['passes']:
+		passes.append({ 'pass': ps['pass'], 'time_ns': ps['time_ns'] })
+		if ps['pass'] == 'tokenize':
+			tokens = ps['chunks_after']
+	return {
+		'config':       os.path.basename(cfg),
+		'set':          set_name,
+		'files':        total['files'],
+		'bytes':        total['bytes_in'],
+		'tokens':       tokens,
+		'wall_s':       round(best['wall'], 4),
+		'format_s':     round(fmt_s, 4),
+		'mb_per_s':     round(fmt_s and (total['bytes_in'] / 1e6 / fmt_s) or 0, 3),
+		'tokens_per_s': int(fmt_s and (tokens / fmt_s) or 0),
+		'max_rss_kb':   rss,
+		'passes':       passes,
+	}
+
+
+def print_results (results):
+	out = sys.stdout
+	out.write('%-16s %-6s %6s %8s %10s %8s %8s %8s %10s %8s\n' %
+	          ('config', 'set', 'files', 'MB', 'tokens', 'wall s', 'fmt s', 'MB/s', 'tokens/s', 'RSS MB'))
+	for res in results:
+		out.write('%-16s %-6s %6d %8.2f %10d %8.3f %8.3f %8.2f %10d %8.1f\n' %
+		          (res['config'], res['set'], res['files'], res['bytes'] / 1e6, res['tokens'],
+		           res['wall_s'], res['format_s'], res['mb_per_s'], res['tokens_per_s'],
+		           res['max_rss_kb'] / 1024.0))
+
+	# percent of the format time by pass, both sets added up per config
+	configs = []
+	for res in results:
+		if res['config'] not in configs:
+			configs.append(res['config'])
+	totals = {}
+	names  = []
+	for res in results:
+		# keep the run order, a pass that is new goes after the one before it
+		pos = 0
+		for ps in res['passes']:
+			name = ps['pass']
+			key  = (res['config'], name)
+			totals[key] = totals.get(key, 0) + ps['time_ns']
+			if name in names:
+				pos = names.index(name) + 1
+			else:
+				names.insert(pos, name)
+				pos += 1
+	width = max([ len(name) for name in names ] + [ 24 ])
+	fmt_ns = {}
+	for res in results:
+		fmt_ns[res['config']] = fmt_ns.get(res['config'], 0) + res['format_s'] * 1e9
+
+	out.write('\n%-*s' % (width, 'pass (% of format time)'))
+	for cfg in configs:
+		out.write(' %15s' % cfg[:15])
+	out.write('\n')
+	for name in names:
+		out.write('%-*s' % (width, name))
+		for cfg in configs:
+			ns = totals.get((cfg, name), 0)
+			out.write(' %15.1f' % (fmt_ns[cfg] and (ns * 100.0 / fmt_ns[cfg]) or 0))
+		out.write('\n')
+
+
+def compare (results, baseline, threshold):
+	"""
+	Prints the MB/s change against an earlier --json file.
+	Returns the number of sets that got slower by more than threshold percent.
+	"""
+	fh = open(baseline, 'r')
+	old = json.load(fh)
+	fh.close()
+	if old.get('corpus_md5') != results['corpus_md5']:
+		sys.stdout.write('\nNote: the baseline used a different corpus\n')
+	prev = {}
+	for res in old['results']:
+		prev[(res['config'], res['set'])] = res
+	slower = 0
+	sys.stdout.write('\n%-16s %-6s %10s %10s %8s\n' % ('config', 'set', 'old MB/s', 'new MB/s', 'change'))
+	for res in results['results']:
+		key = (res['config'], res['set'])
+		if key not in prev or prev[key]['mb_per_s'] == 0:
+			continue
+		change = (res['mb_per_s'] / prev[key]['mb_per_s'] - 1) * 100
+		flag = ''
+		if change < -threshold:
+			flag = '  SLOWER'
+			slower += 1
+		sys.stdout.write('%-16s %-6s %10.2f %10.2f %+7.1f%%%s\n' %
+		                 (key[0], key[1], prev[key]['mb_per_s'], res['mb_per_s'], change, flag))
+	return slower
+
+
+def parse_args ():
+	import optparse
+	parser = optparse.OptionParser(usage = '%prog [options] [config ...]',
+	                               description = 'The configs default to ' +
+	                               ', '.join(DEFAULT_CONFIGS) + ' from etc/')
+	parser.add_option('--exe', default = 'src/uncrustify',
+	                  help = 'the uncrustify to run [%default]')
+	parser.add_option('--work', default = 'bench-work',
+	                  help = 'folder for the generated files and the output [%default]')
+	parser.add_option('--size', type = 'int', default = 2048,
+	                  help = 'KB per generated file [%default]')
+	parser.add_option('--seed', type = 'int', default = 1,
+	                  help = 'seed for the generated files [%default]')
+	parser.add_option('--repeat', type = 'int', default = 3,
+	                  help = 'runs of each set, the fastest is kept [%default]')
+	parser.add_option('--json', help = 'write the results to JSON')
+	parser.add_option('--baseline', help = 'compare with an earlier --json file')
+	parser.add_option('--threshold', type = 'float', default = 10.0,
+	                  help = 'with --baseline, fail if a set is this %% slower [%default]')
+	args, configs = parser.parse_args()
+	args.repeat = max(args.repeat, 1)
+	if len(configs) == 0:
+		configs = DEFAULT_CONFIGS
+	args.configs = []
+	for cfg in configs:
+		if not os.path.exists(cfg):
+			cfg = os.path.join(TOP, 'etc', cfg)
+		args.configs.append(cfg)
+	return args
+
+
+if __name__ == '__main__':
+	args = parse_args()
+	if not os.path.isfile(args.exe):
+		sys.stderr.write('%s: not found, use --exe\n' % args.exe)
+		sys.exit(1)
+
+	sets = [ ('tests', test_inputs()),
+	         ('synth', make_corpus(args.work, args.size * 1024, args.seed)) ]
+
+	results = {
+		'date':       time.strftime('%Y-%m-%dT%H:%M:%S'),
+		'exe':        os.path.abspath(args.exe),
+		'version':    subprocess.Popen([ args.exe, '--version' ],
+		                               stdout = subprocess.PIPE).communicate()[0].decode().strip(),
+		'repeat':     args.repeat,
+		'corpus_md5': files_md5(sets[0][1] + sets[1][1]),
+		'results':    [],
+	}
+	for cfg in args.configs:
+		for set_name, names in sets:
+			results['results'].append(run_set(args, cfg, set_name, names))
+
+	print_results(results['results'])
+
+	if args.json:
+		fh = open(args.json, 'w')
+		json.dump(results, fh, indent = 1, sort_keys = True)
+		fh.write('\n')
+		fh.close()
+
+	if args.baseline and (compare(results, args.baseline, args.threshold) > 0):
+		sys.exit(1)
@@ -0,0 +1,120 @@
+#! /usr/bin/env python
+#
+# Creates the perfect hash for the static keywords table.
+# Run from the top folder after changing keywords[] in src/keywords.cpp:
+#
+#   $ python scripts/keywords.py > src/keyword_hash.h
+#
+# The hash function must match kw_hash_str() in src/keywords.cpp.
+#
+# @author  Ben Gardner
+# @license GPL v2+
+#
+import sys
+
+# Number of slots, must be a power of 2
+KW_HASH_SIZE = 512
+
+# Number of displacement buckets, must be a power of 2
+KW_HASH_BUCKETS = 128
+
+def scan_file (filename):
+	"""
+	Returns the tags of keywords[], in table order
+	"""
+	fh = open(filename, 'r')
+	lines = fh.readlines()
+	fh.close()
+	in_table = False
+	tags = []
+	for line in lines:
+		line = line.strip()
+		if line.startswith('static const chunk_tag_t keywords[]'):
+			in_table = True
+		elif in_table:
+			if line.startswith('};'):
+				break
+			if line.startswith('{ "'):
+				tags.append(line[3:line.find('"', 3)])
+	return tags
+
+def kw_hash_str (word):
+	"""
+	FNV-1a over the bytes, seeded with the length
+	"""
+	h = 2166136261 ^ len(word)
+	for ch in word:
+		h ^= ord(ch)
+		h = (h * 16777619) & 0xffffffff
+	return h
+
+def kw_slot (h, disp):
+	return ((h >> 16) + disp) & (KW_HASH_SIZE - 1)
+
+def build_hash (words):
+	"""
+	Finds a displacement for each bucket so that no two words share a slot.
+	The biggest buckets are placed first.
+	"""
+	buckets = [ [] for i in range(KW_HASH_BUCKETS) ]
+	for word in words:
+		buckets[kw_hash_str(word) & (KW_HASH_BUCKETS - 1)].append(word)
+
+	disp  = [ 0 ] * KW_HASH_BUCKETS
+	slots = [ None ] * KW_HASH_SIZE
+	order = sorted(range(KW_HASH_BUCKETS), key=lambda b: -len(buckets[b]))
+	for b in order:
+		if len(buckets[b]) == 0:
+			break
+		for d in range(KW_HASH_SIZE):
+			used = [ kw_slot(kw_hash_str(w), d) for w in buckets[b] ]
+			if len(set(used)) == len(used) and all(slots[s] == None for s in used):
+				break
+		else:
+			sys.stderr.write("no displacement for bucket %d, increase KW_HASH_SIZE\n" % b)
+			sys.exit(1)
+		disp[b] = d
+		for idx in range(len(used)):
+			slots[used[idx]] = buckets[b][idx]
+	return disp, slots
+
+if __name__ == '__main__':
+	tags = scan_file('src/keywords.cpp')
+
+	# the first index and the number of entries for each word
+	runs = {}
+	words = []
+	for idx in range(len(tags)):
+		if tags[idx] in runs:
+			runs[tags[idx]][1] += 1
+		else:
+			runs[tags[idx]] = [ idx, 1 ]
+			words.append(tags[idx])
+
+	disp, slots = build_hash(words)
+
+	out = sys.stdout
+	out.write("/**\n")
+	out.write(" * @file keyword_hash.h\n")
+	out.write(" * Automatically generated by scripts/keywords.py\n")
+	out.write(" */\n")
+	out.write("#define KW_HASH_SIZE       %d\n" % KW_HASH_SIZE)
+	out.write("#define KW_HASH_BUCKETS    %d\n" % KW_HASH_BUCKETS)
+	out.write("#define KW_HASH_KEYWORDS   %d\n" % len(tags))
+	out.write("\n")
+	out.write("static const UINT16 kw_hash_disp[KW_HASH_BUCKETS] =\n")
+	out.write("{\n")
+	for idx in range(0, KW_HASH_BUCKETS, 8):
+		out.write("   " + " ".join([ "%3d," % d for d in disp[idx:idx + 8] ]) + "\n")
+	out.write("};\n")
+	out.write("\n")
+	out.write("static const kw_hash_entry_t kw_hash_table[KW_HASH_SIZE] =\n")
+	out.write("{\n")
+	for idx in range(KW_HASH_SIZE):
+		word = slots[idx]
+		if word == None:
+			out.write("   {   0,  0, 0 },   // %3d:\n" % idx)
+		else:
+			run = runs[word]
+			out.write("   { %3d, %2d, %d },   // %3d: %s\n" % (run[0], len(word), run[1], idx, word))
+	out.write("};\n")
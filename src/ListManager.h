@@ -6,6 +6,8 @@
  * @author  Ben Gardner
  * @license GPL v2+
  */
+#ifndef LIST_MANAGER_H_INCLUDED
+#define LIST_MANAGER_H_INCLUDED
 
 /**
  * A simple list manager for a double-linked list.
@@ -63,6 +65,17 @@ public:
    }
 
 
+   /**
+    * Forgets all the entries without touching them.
+    * For when the memory of the entries is released in one go.
+    */
+   void Clear()
+   {
+      first = NULL;
+      last  = NULL;
+   }
+
+
    void InitEntry(T *obj) const
    {
       if (obj != NULL)
@@ -201,3 +214,5 @@ public:
       first = obj;
    }
 };
+
+#endif   /* LIST_MANAGER_H_INCLUDED */
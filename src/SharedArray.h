@@ -0,0 +1,193 @@
+/**
+ * @file SharedArray.h
+ * Template class for an array that grows as it is used and that is shared
+ * by its copies until one of them changes it.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef SHARED_ARRAY_H_INCLUDED
+#define SHARED_ARRAY_H_INCLUDED
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * The first BLOCK_SIZE entries are kept in the array itself and are copied
+ * with it, as these are the ones that are used all the time and a copy
+ * changes them right away anyway.
+ * The rest are kept in blocks of BLOCK_SIZE. A copy of the array only takes
+ * a reference to these blocks, and a block that is shared is copied when it
+ * is about to be changed. So copies share all the blocks that none of them
+ * changed, and copying a big array is cheap.
+ *
+ * Class T must be plain data: new entries are all zeros and they are copied
+ * with memcpy(). Entries that were never set read as zeros.
+ *
+ * Getting an entry with the non-const operator[] counts as a change, as
+ * the entry may be changed through the reference.
+ */
+template<class T, int BLOCK_SIZE = 16> class SharedArray
+{
+private:
+   struct Block
+   {
+      int refs;            /* the arrays that use this block */
+      T   items[BLOCK_SIZE];
+   };
+
+   T     m_head[BLOCK_SIZE];
+   Block **m_blocks;       /* NULL for the blocks that weren't used yet */
+   int   m_count;          /* the number of entries in m_blocks */
+
+   void Share(const SharedArray& ref)
+   {
+      memcpy(m_head, ref.m_head, sizeof(m_head));
+      if (ref.m_count > 0)
+      {
+         m_blocks = (Block **)malloc(ref.m_count * sizeof(Block *));
+         if (m_blocks == NULL)
+         {
+            exit(1);
+         }
+         memcpy(m_blocks, ref.m_blocks, ref.m_count * sizeof(Block *));
+         m_count = ref.m_count;
+
+         for (int idx = 0; idx < m_count; idx++)
+         {
+            if (m_blocks[idx] != NULL)
+            {
+               m_blocks[idx]->refs++;
+            }
+         }
+      }
+   }
+
+
+   /**
+    * Gets block 'bidx' to change it, adding it or copying it if it is shared.
+    */
+   Block *Own(int bidx)
+   {
+      Block *blk;
+
+      if (bidx >= m_count)
+      {
+         int count = (m_count > 0) ? m_count : 4;
+
+         while (count <= bidx)
+         {
+            count *= 2;
+         }
+         Block **blocks = (Block **)realloc(m_blocks, count * sizeof(Block *));
+         if (blocks == NULL)
+         {
+            exit(1);
+         }
+         memset(&blocks[m_count], 0, (count - m_count) * sizeof(Block *));
+         m_blocks = blocks;
+         m_count  = count;
+      }
+
+      blk = m_blocks[bidx];
+      if ((blk == NULL) || (blk->refs > 1))
+      {
+         Block *copy = (Block *)malloc(sizeof(Block));
+         if (copy == NULL)
+         {
+            exit(1);
+         }
+         if (blk != NULL)
+         {
+            memcpy(copy->items, blk->items, sizeof(copy->items));
+            blk->refs--;
+         }
+         else
+         {
+            memset(copy->items, 0, sizeof(copy->items));
+         }
+         copy->refs     = 1;
+         m_blocks[bidx] = copy;
+         blk            = copy;
+      }
+      return(blk);
+   }
+
+
+public:
+   SharedArray() : m_blocks(NULL), m_count(0)
+   {
+      memset(m_head, 0, sizeof(m_head));
+   }
+
+
+   SharedArray(const SharedArray& ref) : m_blocks(NULL), m_count(0)
+   {
+      Share(ref);
+   }
+
+
+   ~SharedArray()
+   {
+      Clear();
+   }
+
+
+   SharedArray& operator=(const SharedArray& ref)
+   {
+      if (this != &ref)
+      {
+         Clear();
+         Share(ref);
+      }
+      return(*this);
+   }
+
+
+   /**
+    * Drops all the entries, so that they all read as zeros.
+    */
+   void Clear()
+   {
+      for (int idx = 0; idx < m_count; idx++)
+      {
+         if ((m_blocks[idx] != NULL) && (--m_blocks[idx]->refs == 0))
+         {
+            free(m_blocks[idx]);
+         }
+      }
+      free(m_blocks);
+      m_blocks = NULL;
+      m_count  = 0;
+      memset(m_head, 0, sizeof(m_head));
+   }
+
+
+   const T& operator[](int idx) const
+   {
+      static const T zero = T();
+
+      if ((unsigned)idx < (unsigned)BLOCK_SIZE)
+      {
+         return(m_head[idx]);
+      }
+      int bidx = idx / BLOCK_SIZE - 1;
+      if ((bidx >= m_count) || (m_blocks[bidx] == NULL))
+      {
+         return(zero);
+      }
+      return(m_blocks[bidx]->items[idx % BLOCK_SIZE]);
+   }
+
+
+   T& operator[](int idx)
+   {
+      if ((unsigned)idx < (unsigned)BLOCK_SIZE)
+      {
+         return(m_head[idx]);
+      }
+      return(Own(idx / BLOCK_SIZE - 1)->items[idx % BLOCK_SIZE]);
+   }
+};
+
+#endif   /* SHARED_ARRAY_H_INCLUDED */
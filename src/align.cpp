@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <vector>
 #include "unc_ctype.h"
 
 
@@ -121,13 +122,13 @@ static void align_stack(ChunkStack& cs, int col, bool align_single, log_sev_t se
 {
    chunk_t *pc;
 
-   if (cpd.settings[UO_align_on_tabstop].b)
+   if (cpd->settings[UO_align_on_tabstop].b)
    {
-      int rem = (col - 1) % cpd.settings[UO_output_tab_size].n;
+      int rem = (col - 1) % cpd->settings[UO_output_tab_size].n;
       if (rem != 0)
       {
          LOG_FMT(sev, "%s: col=%d rem=%d", __func__, col, rem);
-         col += cpd.settings[UO_output_tab_size].n - rem;
+         col += cpd->settings[UO_output_tab_size].n - rem;
       }
    }
 
@@ -136,7 +137,7 @@ static void align_stack(ChunkStack& cs, int col, bool align_single, log_sev_t se
       LOG_FMT(sev, "%s: max_col=%d\n", __func__, col);
       while ((pc = cs.Pop()) != NULL)
       {
-         if (cpd.settings[UO_align_right_cmt_at_col].n == 0)
+         if (cpd->settings[UO_align_right_cmt_at_col].n == 0)
          {
             indent_to_column(pc, col);
          }
@@ -226,32 +227,33 @@ void quick_align_again(void)
    LOG_FMT(LALAGAIN, "%s:\n", __func__);
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
-      if ((pc->align.next != NULL) && (pc->flags & PCF_ALIGN_START))
+      if ((pc->flags & PCF_ALIGN_START) && (pc->align != NULL) &&
+          (pc->align->next != NULL))
       {
          as.Start(100, 0);
-         as.m_right_align  = pc->align.right_align;
-         as.m_oc_str_align = pc->align.oc_str_align;
-         as.m_oc_msg_align = pc->align.oc_msg_align;
-         as.m_oc_msg_lines = pc->align.oc_msg_lines;
-         as.m_star_style   = (AlignStack::StarStyle)pc->align.star_style;
-         as.m_amp_style    = (AlignStack::StarStyle)pc->align.amp_style;
-         as.m_gap          = pc->align.gap;
+         as.m_right_align  = pc->align->right_align;
+         as.m_oc_str_align = pc->align->oc_str_align;
+         as.m_oc_msg_align = pc->align->oc_msg_align;
+         as.m_oc_msg_lines = pc->align->oc_msg_lines;
+         as.m_star_style   = (AlignStack::StarStyle)pc->align->star_style;
+         as.m_amp_style    = (AlignStack::StarStyle)pc->align->amp_style;
+         as.m_gap          = pc->align->gap;
 
          LOG_FMT(LALAGAIN, "   [%.*s:%d]", pc->len, pc->str, pc->orig_line);
          
-         as.Add(pc->align.start, 0, 
-                pc->align.oc_msg_line, 
-                pc->align.oc_msg_line_start, 
-                pc->align.oc_msg_line_end, 
-                pc->align.oc_ref_colon);
+         as.Add(pc->align->start, 0, 
+                pc->align->oc_msg_line, 
+                pc->align->oc_msg_line_start, 
+                pc->align->oc_msg_line_end, 
+                pc->align->oc_ref_colon);
          
-         for (tmp = pc->align.next; tmp != NULL; tmp = tmp->align.next)
+         for (tmp = pc->align->next; tmp != NULL; tmp = tmp->align->next)
          {
-            as.Add(tmp->align.start, 0, 
-                   tmp->align.oc_msg_line, 
-                   tmp->align.oc_msg_line_start, 
-                   tmp->align.oc_msg_line_end, 
-                   tmp->align.oc_ref_colon);
+            as.Add(tmp->align->start, 0, 
+                   tmp->align->oc_msg_line, 
+                   tmp->align->oc_msg_line_start, 
+                   tmp->align->oc_msg_line_end, 
+                   tmp->align->oc_ref_colon);
             
             LOG_FMT(LALAGAIN, " => [%.*s:%d]", tmp->len, tmp->str, tmp->orig_line);
          }
@@ -264,70 +266,70 @@ void quick_align_again(void)
 
 void align_all(void)
 {
-   if (cpd.settings[UO_align_typedef_span].n > 0)
+   if (cpd->settings[UO_align_typedef_span].n > 0)
    {
-      align_typedefs(cpd.settings[UO_align_typedef_span].n);
+      align_typedefs(cpd->settings[UO_align_typedef_span].n);
    }
 
-   if (cpd.settings[UO_align_left_shift].b)
+   if (cpd->settings[UO_align_left_shift].b)
    {
       align_left_shift();
    }
 
    /* Align variable definitions */
-   if ((cpd.settings[UO_align_var_def_span].n > 0) ||
-       (cpd.settings[UO_align_var_struct_span].n > 0))
+   if ((cpd->settings[UO_align_var_def_span].n > 0) ||
+       (cpd->settings[UO_align_var_struct_span].n > 0))
    {
-      align_var_def_brace(chunk_get_head(), cpd.settings[UO_align_var_def_span].n, NULL);
+      align_var_def_brace(chunk_get_head(), cpd->settings[UO_align_var_def_span].n, NULL);
    }
 
    /* Align assignments */
    align_assign(chunk_get_head(),
-                cpd.settings[UO_align_assign_span].n,
-                cpd.settings[UO_align_assign_thresh].n);
+                cpd->settings[UO_align_assign_span].n,
+                cpd->settings[UO_align_assign_thresh].n);
 
    /* Align structure initializers */
-   if (cpd.settings[UO_align_struct_init_span].n > 0)
+   if (cpd->settings[UO_align_struct_init_span].n > 0)
    {
       align_struct_initializers();
    }
 
    /* Align function prototypes */
-   if ((cpd.settings[UO_align_func_proto_span].n > 0) &&
-       !cpd.settings[UO_align_mix_var_proto].b)
+   if ((cpd->settings[UO_align_func_proto_span].n > 0) &&
+       !cpd->settings[UO_align_mix_var_proto].b)
    {
-      align_func_proto(cpd.settings[UO_align_func_proto_span].n);
+      align_func_proto(cpd->settings[UO_align_func_proto_span].n);
    }
 
    /* Align function prototypes */
-   if (cpd.settings[UO_align_oc_msg_spec_span].n > 0)
+   if (cpd->settings[UO_align_oc_msg_spec_span].n > 0)
    {
-      align_oc_msg_spec(cpd.settings[UO_align_oc_msg_spec_span].n);
+      align_oc_msg_spec(cpd->settings[UO_align_oc_msg_spec_span].n);
    }
    
    /* Align multi-line selectors/method signatures in method implementations */
-   if (cpd.settings[UO_align_oc_msg_decl_span].n > 0)
+   if (cpd->settings[UO_align_oc_msg_decl_span].n > 0)
    {
-      align_oc_msg_decl(cpd.settings[UO_align_oc_msg_decl_span].n);
+      align_oc_msg_decl(cpd->settings[UO_align_oc_msg_decl_span].n);
    }
 
    /* Align variable defs in function prototypes */
-   if (cpd.settings[UO_align_func_params].b)
+   if (cpd->settings[UO_align_func_params].b)
    {
       align_func_params();
    }
 
-   if (cpd.settings[UO_align_same_func_call_params].b)
+   if (cpd->settings[UO_align_same_func_call_params].b)
    {
       align_same_func_call_params();
    }
     
-   if (cpd.settings[UO_align_oc_msg_colon].b)
+   if (cpd->settings[UO_align_oc_msg_colon].b)
    {
       align_oc_msg_colon(1);
    }
    
-   if (cpd.settings[UO_align_oc_msg_string_literal].b)
+   if (cpd->settings[UO_align_oc_msg_string_literal].b)
    {
       align_oc_msg_string(1);
    }
@@ -348,7 +350,7 @@ static void align_oc_msg_spec(int span)
    LOG_FMT(LALIGN, "%s\n", __func__);
    as.Start(span, 0);
 
-   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
+   for (pc = chunk_first_of_type(CT_OC_MSG_SPEC); pc != NULL; pc = chunk_get_next(pc))
    {
       if (chunk_is_newline(pc))
       {
@@ -485,11 +487,11 @@ void align_right_comments(void)
          if (pc->parent_type == CT_COMMENT_END)
          {
             prev = chunk_get_prev(pc);
-            if (pc->column <= (prev->orig_col_end + cpd.settings[UO_align_right_cmt_gap].n))
+            if (pc->column <= (prev->orig_col_end + cpd->settings[UO_align_right_cmt_gap].n))
             {
                LOG_FMT(LALTC, "NOT changing END comment on line %d (%d <= %d + %d)\n",
                        pc->orig_line,
-                       pc->column, prev->orig_col_end, cpd.settings[UO_align_right_cmt_gap].n);
+                       pc->column, prev->orig_col_end, cpd->settings[UO_align_right_cmt_gap].n);
                skip = true;
             }
             if (!skip)
@@ -503,10 +505,10 @@ void align_right_comments(void)
          /* Change certain WHOLE comments into RIGHT-alignable comments */
          if (pc->parent_type == CT_COMMENT_WHOLE)
          {
-            int tmp_col = 1 + (pc->brace_level * cpd.settings[UO_indent_columns].n);
+            int tmp_col = 1 + (pc->brace_level * cpd->settings[UO_indent_columns].n);
 
             /* If the comment is further right than the brace level... */
-            if (pc->column > (tmp_col + cpd.settings[UO_align_right_cmt_gap].n))
+            if (pc->column > (tmp_col + cpd->settings[UO_align_right_cmt_gap].n))
             {
                LOG_FMT(LALTC, "Changing WHOLE comment on line %d into a RIGHT-comment\n",
                        pc->orig_line);
@@ -546,7 +548,7 @@ void align_struct_initializers(void)
       prev = chunk_get_prev_ncnl(pc);
       if ((prev != NULL) && (prev->type == CT_ASSIGN) &&
           ((pc->type == CT_BRACE_OPEN) ||
-           ((cpd.lang_flags & LANG_D) && (pc->type == CT_SQUARE_OPEN))))
+           ((cpd->lang_flags & LANG_D) && (pc->type == CT_SQUARE_OPEN))))
       {
          align_init_brace(pc);
       }
@@ -565,11 +567,11 @@ void align_preprocessor(void)
    AlignStack asf;   // function macros
    AlignStack *cur_as = &as;
 
-   as.Start(cpd.settings[UO_align_pp_define_span].n);
-   as.m_gap = cpd.settings[UO_align_pp_define_gap].n;
+   as.Start(cpd->settings[UO_align_pp_define_span].n);
+   as.m_gap = cpd->settings[UO_align_pp_define_gap].n;
 
-   asf.Start(cpd.settings[UO_align_pp_define_span].n);
-   asf.m_gap = cpd.settings[UO_align_pp_define_gap].n;
+   asf.Start(cpd->settings[UO_align_pp_define_span].n);
+   asf.m_gap = cpd->settings[UO_align_pp_define_gap].n;
 
    pc = chunk_get_head();
    while (pc != NULL)
@@ -702,13 +704,13 @@ chunk_t *align_assign(chunk_t *first, int span, int thresh)
 
          if (pc->parent_type == CT_ENUM)
          {
-            myspan   = cpd.settings[UO_align_enum_equ_span].n;
-            mythresh = cpd.settings[UO_align_enum_equ_thresh].n;
+            myspan   = cpd->settings[UO_align_enum_equ_span].n;
+            mythresh = cpd->settings[UO_align_enum_equ_thresh].n;
          }
          else
          {
-            myspan   = cpd.settings[UO_align_assign_span].n;
-            mythresh = cpd.settings[UO_align_assign_thresh].n;
+            myspan   = cpd->settings[UO_align_assign_span].n;
+            mythresh = cpd->settings[UO_align_assign_thresh].n;
          }
 
          pc = align_assign(chunk_get_next_ncnl(pc), myspan, mythresh);
@@ -800,8 +802,8 @@ static chunk_t *align_func_param(chunk_t *start)
 
    as.Start(2, 0);
 
-   as.m_star_style = (AlignStack::StarStyle)cpd.settings[UO_align_var_def_star_style].n;
-   as.m_amp_style  = (AlignStack::StarStyle)cpd.settings[UO_align_var_def_amp_style].n;
+   as.m_star_style = (AlignStack::StarStyle)cpd->settings[UO_align_var_def_star_style].n;
+   as.m_amp_style  = (AlignStack::StarStyle)cpd->settings[UO_align_var_def_amp_style].n;
 
    bool did_this_line = false;
    int  comma_count   = 0;
@@ -947,8 +949,8 @@ static void align_same_func_call_params()
          if ((pc->len == align_root->len) &&
              (memcmp(pc->str, align_root->str, pc->len) == 0))
          {
-            align_cur->align.next = pc;
-            align_cur             = pc;
+            chunk_align(align_cur)->next = pc;
+            align_cur = pc;
             align_len++;
             add_str = "  Add";
          }
@@ -986,7 +988,7 @@ static void align_same_func_call_params()
             if (idx > max_idx)
             {
                as[idx].Start(3);
-               if (!cpd.settings[UO_align_number_left].b)
+               if (!cpd->settings[UO_align_number_left].b)
                {
                   if ((chunks[idx]->type == CT_NUMBER_FP) ||
                       (chunks[idx]->type == CT_NUMBER) ||
@@ -1023,10 +1025,10 @@ static void align_func_proto(int span)
 
    LOG_FMT(LALIGN, "%s\n", __func__);
    as.Start(span, 0);
-   as.m_gap = cpd.settings[UO_align_func_proto_gap].n;
+   as.m_gap = cpd->settings[UO_align_func_proto_gap].n;
 
    as_br.Start(span, 0);
-   as_br.m_gap = cpd.settings[UO_align_single_line_brace_gap].n;
+   as_br.m_gap = cpd->settings[UO_align_single_line_brace_gap].n;
 
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
@@ -1038,10 +1040,10 @@ static void align_func_proto(int span)
       }
       else if ((pc->type == CT_FUNC_PROTO) ||
                ((pc->type == CT_FUNC_DEF) &&
-                cpd.settings[UO_align_single_line_func].b))
+                cpd->settings[UO_align_single_line_func].b))
       {
          if ((pc->parent_type == CT_OPERATOR) &&
-             cpd.settings[UO_align_on_operator].b)
+             cpd->settings[UO_align_on_operator].b)
          {
             as.Add(chunk_get_prev_ncnl(pc));
          }
@@ -1050,7 +1052,7 @@ static void align_func_proto(int span)
             as.Add(pc);
          }
          look_bro = (pc->type == CT_FUNC_DEF) &&
-                    cpd.settings[UO_align_single_line_brace].b;
+                    cpd->settings[UO_align_single_line_brace].b;
       }
       else if (look_bro &&
                (pc->type == CT_BRACE_OPEN) &&
@@ -1083,7 +1085,7 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
    AlignStack as_bc; /* bit-colon */
    AlignStack as_at; /* attribute */
    AlignStack as_br; /* one-liner brace open */
-   bool       fp_active   = cpd.settings[UO_align_mix_var_proto].b;
+   bool       fp_active   = cpd->settings[UO_align_mix_var_proto].b;
    bool       fp_look_bro = false;
 
 
@@ -1096,14 +1098,14 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
    if ((start->parent_type == CT_STRUCT) ||
        (start->parent_type == CT_UNION))
    {
-      myspan   = cpd.settings[UO_align_var_struct_span].n;
-      mythresh = cpd.settings[UO_align_var_struct_thresh].n;
-      mygap    = cpd.settings[UO_align_var_struct_gap].n;
+      myspan   = cpd->settings[UO_align_var_struct_span].n;
+      mythresh = cpd->settings[UO_align_var_struct_thresh].n;
+      mygap    = cpd->settings[UO_align_var_struct_gap].n;
    }
    else
    {
-      mythresh = cpd.settings[UO_align_var_def_thresh].n;
-      mygap    = cpd.settings[UO_align_var_def_gap].n;
+      mythresh = cpd->settings[UO_align_var_def_thresh].n;
+      mygap    = cpd->settings[UO_align_var_def_gap].n;
    }
 
    /* can't be any variable definitions in a "= {" block */
@@ -1120,7 +1122,7 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
    LOG_FMT(LAVDB, "%s: start=%.*s [%s] on line %d\n", __func__,
            start->len, start->str, get_token_name(start->type), start->orig_line);
 
-   if (!cpd.settings[UO_align_var_def_inline].b)
+   if (!cpd->settings[UO_align_var_def_inline].b)
    {
       align_mask |= PCF_VAR_INLINE;
    }
@@ -1128,18 +1130,18 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
    /* Set up the var/proto/def aligner */
    as.Start(myspan, mythresh);
    as.m_gap        = mygap;
-   as.m_star_style = (AlignStack::StarStyle)cpd.settings[UO_align_var_def_star_style].n;
-   as.m_amp_style  = (AlignStack::StarStyle)cpd.settings[UO_align_var_def_amp_style].n;
+   as.m_star_style = (AlignStack::StarStyle)cpd->settings[UO_align_var_def_star_style].n;
+   as.m_amp_style  = (AlignStack::StarStyle)cpd->settings[UO_align_var_def_amp_style].n;
 
    /* Set up the bit colon aligner */
    as_bc.Start(myspan, 0);
-   as_bc.m_gap = cpd.settings[UO_align_var_def_colon_gap].n;
+   as_bc.m_gap = cpd->settings[UO_align_var_def_colon_gap].n;
 
    as_at.Start(myspan, 0);
 
    /* Set up the brace open aligner */
    as_br.Start(myspan, mythresh);
-   as_br.m_gap = cpd.settings[UO_align_single_line_brace_gap].n;
+   as_br.m_gap = cpd->settings[UO_align_single_line_brace_gap].n;
 
    bool did_this_line = false;
    pc = chunk_get_next(start);
@@ -1162,14 +1164,14 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
       {
          if ((pc->type == CT_FUNC_PROTO) ||
              ((pc->type == CT_FUNC_DEF) &&
-              cpd.settings[UO_align_single_line_func].b))
+              cpd->settings[UO_align_single_line_func].b))
          {
             LOG_FMT(LAVDB, "    add=[%.*s] line=%d col=%d level=%d\n",
                     pc->len, pc->str, pc->orig_line, pc->column, pc->level);
 
             as.Add(pc);
             fp_look_bro = (pc->type == CT_FUNC_DEF) &&
-                          cpd.settings[UO_align_single_line_brace].b;
+                          cpd->settings[UO_align_single_line_brace].b;
          }
          else if (fp_look_bro &&
                   (pc->type == CT_BRACE_OPEN) &&
@@ -1243,7 +1245,7 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
 
             as.Add(pc);
 
-            if (cpd.settings[UO_align_var_def_colon].b)
+            if (cpd->settings[UO_align_var_def_colon].b)
             {
                next = chunk_get_next_nc(pc);
                if (next->type == CT_BIT_COLON)
@@ -1251,7 +1253,7 @@ static chunk_t *align_var_def_brace(chunk_t *start, int span, int *p_nl_count)
                   as_bc.Add(next);
                }
             }
-            if (cpd.settings[UO_align_var_def_attribute].b)
+            if (cpd->settings[UO_align_var_def_attribute].b)
             {
                next = pc;
                while ((next = chunk_get_next_nc(next)) != NULL)
@@ -1345,7 +1347,7 @@ static CmtAlignType get_comment_align_type(chunk_t *cmt)
    chunk_t      *prev;
    CmtAlignType cmt_type = CAT_REGULAR;
 
-   if (!cpd.settings[UO_align_right_cmt_mix].b &&
+   if (!cpd->settings[UO_align_right_cmt_mix].b &&
        ((prev = chunk_get_prev(cmt)) != NULL))
    {
       if ((prev->type == CT_PP_ENDIF) ||
@@ -1378,12 +1380,12 @@ chunk_t *align_trailing_comments(chunk_t *start)
    ChunkStack   cs;
    CmtAlignType cmt_type_start, cmt_type_cur;
    int          col;
-   int          intended_col = cpd.settings[UO_align_right_cmt_at_col].n;
+   int          intended_col = cpd->settings[UO_align_right_cmt_at_col].n;
 
    cmt_type_start = get_comment_align_type(pc);
 
    /* Find the max column */
-   while ((pc != NULL) && (nl_count < cpd.settings[UO_align_right_cmt_span].n))
+   while ((pc != NULL) && (nl_count < cpd->settings[UO_align_right_cmt_span].n))
    {
       if ((pc->flags & PCF_RIGHT_COMMENT) != 0)
       {
@@ -1391,7 +1393,7 @@ chunk_t *align_trailing_comments(chunk_t *start)
 
          if (cmt_type_cur == cmt_type_start)
          {
-            col = 1 + (pc->brace_level * cpd.settings[UO_indent_columns].n);
+            col = 1 + (pc->brace_level * cpd->settings[UO_indent_columns].n);
             LOG_FMT(LALADD, "%s: col=%d max_col=%d pc->col=%d pc->len=%d %s\n",
                     __func__, col, max_col, pc->column, pc->len, get_token_name(pc->type));
             if (pc->column < col)
@@ -1427,9 +1429,9 @@ chunk_t *align_trailing_comments(chunk_t *start)
  */
 void ib_shift_out(int idx, int num)
 {
-   while (idx < cpd.al_cnt)
+   while (idx < cpd->al_cnt)
    {
-      cpd.al[idx].col += num;
+      cpd->al[idx].col += num;
       idx++;
    }
 }
@@ -1454,9 +1456,9 @@ static chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
    if (start->type == CT_SQUARE_OPEN)
    {
       start->parent_type = CT_TSQUARE;
-      start            = chunk_get_next_type(start, CT_ASSIGN, start->level);
-      start            = chunk_get_next_ncnl(start);
-      cpd.al_c99_array = true;
+      start             = chunk_get_next_type(start, CT_ASSIGN, start->level);
+      start             = chunk_get_next_ncnl(start);
+      cpd->al_c99_array = true;
    }
    pc = start;
 
@@ -1487,22 +1489,22 @@ static chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
          /*TODO: need to handle missing structure defs? ie NULL vs { ... } ?? */
 
          /* Is this a new entry? */
-         if (idx >= cpd.al_cnt)
+         if (idx >= cpd->al_cnt)
          {
             LOG_FMT(LSIB, " - New   [%d] %.2d/%d - %10.10s\n", idx,
                     pc->column, token_width, get_token_name(pc->type));
 
-            cpd.al[cpd.al_cnt].type = pc->type;
-            cpd.al[cpd.al_cnt].col  = pc->column;
-            cpd.al[cpd.al_cnt].len  = token_width;
-            cpd.al_cnt++;
+            cpd->al[cpd->al_cnt].type = pc->type;
+            cpd->al[cpd->al_cnt].col  = pc->column;
+            cpd->al[cpd->al_cnt].len  = token_width;
+            cpd->al_cnt++;
             idx++;
             last_was_comment = false;
          }
          else
          {
             /* expect to match stuff */
-            if (cpd.al[idx].type == pc->type)
+            if (cpd->al[idx].type == pc->type)
             {
                LOG_FMT(LSIB, " - Match [%d] %.2d/%d - %10.10s", idx,
                        pc->column, token_width, get_token_name(pc->type));
@@ -1510,19 +1512,19 @@ static chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
                /* Shift out based on column */
                if (prev_match == NULL)
                {
-                  if (pc->column > cpd.al[idx].col)
+                  if (pc->column > cpd->al[idx].col)
                   {
                      LOG_FMT(LSIB, " [ pc->col(%d) > col(%d) ] ",
-                             pc->column, cpd.al[idx].col);
+                             pc->column, cpd->al[idx].col);
 
-                     ib_shift_out(idx, pc->column - cpd.al[idx].col);
-                     cpd.al[idx].col = pc->column;
+                     ib_shift_out(idx, pc->column - cpd->al[idx].col);
+                     cpd->al[idx].col = pc->column;
                   }
                }
                else if (idx > 0)
                {
                   int min_col_diff = pc->column - prev_match->column;
-                  int cur_col_diff = cpd.al[idx].col - cpd.al[idx - 1].col;
+                  int cur_col_diff = cpd->al[idx].col - cpd->al[idx - 1].col;
                   if (cur_col_diff < min_col_diff)
                   {
                      LOG_FMT(LSIB, " [ min_col_diff(%d) > cur_col_diff(%d) ] ",
@@ -1530,7 +1532,7 @@ static chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
                      ib_shift_out(idx, min_col_diff - cur_col_diff);
                   }
                }
-               LOG_FMT(LSIB, " - now col %d, len %d\n", cpd.al[idx].col, cpd.al[idx].len);
+               LOG_FMT(LSIB, " - now col %d, len %d\n", cpd->al[idx].col, cpd->al[idx].len);
                idx++;
             }
          }
@@ -1540,9 +1542,9 @@ static chunk_t *scan_ib_line(chunk_t *start, bool first_pass)
       pc = chunk_get_next_nc(pc);
    }
 
-   //if (last_was_comment && (cpd.al[cpd.al_cnt - 1].type == CT_COMMA))
+   //if (last_was_comment && (cpd->al[cpd->al_cnt - 1].type == CT_COMMA))
    //{
-   //   cpd.al_cnt--;
+   //   cpd->al_cnt--;
    //}
    return(pc);
 }
@@ -1554,11 +1556,11 @@ static void align_log_al(log_sev_t sev, int line)
 
    if (log_sev_on(sev))
    {
-      log_fmt(sev, "%s: line %d, %d)", __func__, line, cpd.al_cnt);
-      for (idx = 0; idx < cpd.al_cnt; idx++)
+      log_fmt(sev, "%s: line %d, %d)", __func__, line, cpd->al_cnt);
+      for (idx = 0; idx < cpd->al_cnt; idx++)
       {
-         log_fmt(sev, " %d/%d=%s", cpd.al[idx].col, cpd.al[idx].len,
-                 get_token_name(cpd.al[idx].type));
+         log_fmt(sev, " %d/%d=%s", cpd->al[idx].col, cpd->al[idx].len,
+                 get_token_name(cpd->al[idx].type));
       }
       log_fmt(sev, "\n");
    }
@@ -1605,8 +1607,8 @@ static void align_init_brace(chunk_t *start)
    chunk_t *prev;
    chunk_t *num_token = NULL;
 
-   cpd.al_cnt       = 0;
-   cpd.al_c99_array = false;
+   cpd->al_cnt       = 0;
+   cpd->al_c99_array = false;
 
    LOG_FMT(LALBR, "%s: line %d, col %d\n", __func__, start->orig_line, start->column);
 
@@ -1635,14 +1637,14 @@ static void align_init_brace(chunk_t *start)
    /* debug dump the current frame */
    align_log_al(LALBR, start->orig_line);
 
-   if (cpd.settings[UO_align_on_tabstop].b && (cpd.al_cnt >= 1) &&
-       (cpd.al[0].type == CT_ASSIGN))
+   if (cpd->settings[UO_align_on_tabstop].b && (cpd->al_cnt >= 1) &&
+       (cpd->al[0].type == CT_ASSIGN))
    {
-      int rem = (cpd.al[0].col - 1) % cpd.settings[UO_output_tab_size].n;
+      int rem = (cpd->al[0].col - 1) % cpd->settings[UO_output_tab_size].n;
       if (rem != 0)
       {
-         LOG_FMT(LALBR, "%s: col=%d rem=%d", __func__, cpd.al[0].col, rem);
-         cpd.al[0].col += cpd.settings[UO_output_tab_size].n - rem;
+         LOG_FMT(LALBR, "%s: col=%d rem=%d", __func__, cpd->al[0].col, rem);
+         cpd->al[0].col += cpd->settings[UO_output_tab_size].n - rem;
       }
    }
 
@@ -1663,13 +1665,13 @@ static void align_init_brace(chunk_t *start)
       }
 
       next = pc;
-      if (idx < cpd.al_cnt)
+      if (idx < cpd->al_cnt)
       {
          LOG_FMT(LALBR, " (%d) check %s vs %s -- ",
-                 idx, get_token_name(pc->type), get_token_name(cpd.al[idx].type));
-         if (pc->type == cpd.al[idx].type)
+                 idx, get_token_name(pc->type), get_token_name(cpd->al[idx].type));
+         if (pc->type == cpd->al[idx].type)
          {
-            if ((idx == 0) && cpd.al_c99_array)
+            if ((idx == 0) && cpd->al_c99_array)
             {
                prev = chunk_get_prev(pc);
                if (chunk_is_newline(prev))
@@ -1677,16 +1679,16 @@ static void align_init_brace(chunk_t *start)
                   pc->flags |= PCF_DONT_INDENT;
                }
             }
-            LOG_FMT(LALBR, " [%.*s] to col %d\n", pc->len, pc->str, cpd.al[idx].col);
+            LOG_FMT(LALBR, " [%.*s] to col %d\n", pc->len, pc->str, cpd->al[idx].col);
 
             if (num_token != NULL)
             {
                int col_diff = pc->column - num_token->column;
 
-               reindent_line(num_token, cpd.al[idx].col - col_diff);
+               reindent_line(num_token, cpd->al[idx].col - col_diff);
                //LOG_FMT(LSYS, "-= %d =- NUM indent [%.*s] col=%d diff=%d\n",
                //        num_token->orig_line,
-               //        num_token->len, num_token->str, cpd.al[idx - 1].col, col_diff);
+               //        num_token->len, num_token->str, cpd->al[idx - 1].col, col_diff);
 
                num_token->flags |= PCF_WAS_ALIGNED;
                num_token         = NULL;
@@ -1700,10 +1702,10 @@ static void align_init_brace(chunk_t *start)
                {
                   //LOG_FMT(LSYS, "-= %d =- indent [%.*s] col=%d len=%d\n",
                   //        next->orig_line,
-                  //        next->len, next->str, cpd.al[idx].col, cpd.al[idx].len);
+                  //        next->len, next->str, cpd->al[idx].col, cpd->al[idx].len);
 
-                  if ((idx < (cpd.al_cnt - 1)) &&
-                      cpd.settings[UO_align_number_left].b &&
+                  if ((idx < (cpd->al_cnt - 1)) &&
+                      cpd->settings[UO_align_number_left].b &&
                       ((next->type == CT_NUMBER_FP) ||
                        (next->type == CT_NUMBER) ||
                        (next->type == CT_POS) ||
@@ -1714,7 +1716,7 @@ static void align_init_brace(chunk_t *start)
                   }
                   else
                   {
-                     reindent_line(next, cpd.al[idx].col + cpd.al[idx].len);
+                     reindent_line(next, cpd->al[idx].col + cpd->al[idx].len);
                      next->flags |= PCF_WAS_ALIGNED;
                   }
                }
@@ -1722,12 +1724,12 @@ static void align_init_brace(chunk_t *start)
             else
             {
                /* first item on the line */
-               reindent_line(pc, cpd.al[idx].col);
+               reindent_line(pc, cpd->al[idx].col);
                pc->flags |= PCF_WAS_ALIGNED;
 
                /* see if we need to right-align a number */
-               if ((idx < (cpd.al_cnt - 1)) &&
-                   cpd.settings[UO_align_number_left].b)
+               if ((idx < (cpd->al_cnt - 1)) &&
+                   cpd->settings[UO_align_number_left].b)
                {
                   next = chunk_get_next(pc);
                   if ((next != NULL) && !chunk_is_newline(next) &&
@@ -1775,11 +1777,12 @@ static void align_typedefs(int span)
    AlignStack as;
 
    as.Start(span);
-   as.m_gap        = cpd.settings[UO_align_typedef_gap].n;
-   as.m_star_style = (AlignStack::StarStyle)cpd.settings[UO_align_typedef_star_style].n;
-   as.m_amp_style  = (AlignStack::StarStyle)cpd.settings[UO_align_typedef_amp_style].n;
+   as.m_gap        = cpd->settings[UO_align_typedef_gap].n;
+   as.m_star_style = (AlignStack::StarStyle)cpd->settings[UO_align_typedef_star_style].n;
+   as.m_amp_style  = (AlignStack::StarStyle)cpd->settings[UO_align_typedef_amp_style].n;
 
-   pc = chunk_get_head();
+   /* Nothing is aligned before the first typedef */
+   pc = chunk_first_of_type(CT_TYPEDEF);
    while (pc != NULL)
    {
       if (chunk_is_newline(pc))
@@ -1942,6 +1945,41 @@ bool oc_msg_whole_line_is_string_literal(chunk_t *pc, int level, bool skip)
    return result;
 }
 
+/**
+ * Gets the number of ObjC msg colons on the line of pc. It is counted once
+ * and kept in the line index, which is made if there is none.
+ *
+ * @return -1 if the line index can't be used
+ */
+static int oc_msg_colons_on_line(chunk_t *pc)
+{
+   line_t  *line;
+   chunk_t *tmp;
+
+   chunk_line_index();
+   if ((line = chunk_get_line(pc)) == NULL)
+   {
+      return(-1);
+   }
+   if (line->oc_colons < 0)
+   {
+      line->oc_colons = 0;
+      for (tmp = line->first; tmp != NULL; tmp = chunk_get_next(tmp))
+      {
+         if ((tmp->type == CT_OC_COLON) && (tmp->parent_type == CT_OC_MSG))
+         {
+            line->oc_colons++;
+         }
+         if (tmp == line->nl)
+         {
+            break;
+         }
+      }
+   }
+   return(line->oc_colons);
+}
+
+
 /**
  * Check if there are any CT_OC_COLONs from pc to end of line.
  *
@@ -1953,6 +1991,12 @@ bool oc_msg_line_has_colon(chunk_t *pc, int level)
    chunk_t * tmp = pc;
    bool result = false;
    
+   /* The search below starts after pc, on the next line if pc is a newline */
+   if (oc_msg_colons_on_line(chunk_is_newline(pc) ? chunk_get_next(pc, CNAV_PREPROC) : pc) == 0)
+   {
+      return(false);
+   }
+
    /* backtrack to previous newline */
    if (pc->type == CT_NEWLINE)
    {
@@ -2014,8 +2058,18 @@ bool next_line_has_oc_msg_colon(chunk_t *pc, int level)
       if (!tmp) 
          return false;
    }
+   else if ((level < 0) &&
+            (((tmp = chunk_get_next_nl(pc, CNAV_PREPROC)) == NULL) ||
+             (tmp->type == CT_NEWLINE)))
+   {
+      /* Without a level the msg send can't end first, so the line index
+       * finds the next line */
+      tmp = chunk_get_next(tmp, CNAV_PREPROC);
+   }
    else
    {      
+      tmp = pc;
+
       /* get to next line's start... */   
       while ((tmp = chunk_get_next_nc(tmp, CNAV_PREPROC)) != NULL)
       {
@@ -2043,17 +2097,28 @@ bool prev_line_has_oc_msg_colon(chunk_t *pc, int level)
    chunk_t * tmp = pc;
    
    /* need two newlines, first to get this line's start then to get to prev line's start... */   
-   while ((tmp = chunk_get_prev_nc(tmp, CNAV_PREPROC)) != NULL)
+   if ((level < 0) &&
+       (((tmp = chunk_get_prev_nl(pc, CNAV_PREPROC)) == NULL) ||
+        (tmp->type == CT_NEWLINE)))
+   {
+      /* Without a level the msg send can't start on this line, so the line
+       * index finds the newline */
+   }
+   else
    {
-      if (tmp->type == CT_NEWLINE)
+      tmp = pc;
+      while ((tmp = chunk_get_prev_nc(tmp, CNAV_PREPROC)) != NULL)
       {
+         if (tmp->type == CT_NEWLINE)
+         {
+               break;
+         }
+         else if ((tmp->type == CT_SQUARE_OPEN) && (tmp->level == level))
+         { 
+            /* ...but only if this is still the same msg send */
+            tmp = chunk_get_next_nc(tmp, CNAV_PREPROC);
             break;
-      }
-      else if ((tmp->type == CT_SQUARE_OPEN) && (tmp->level == level))
-      { 
-         /* ...but only if this is still the same msg send */
-         tmp = chunk_get_next_nc(tmp, CNAV_PREPROC);
-         break;
+         }
       }
    }
    
@@ -2063,6 +2128,52 @@ bool prev_line_has_oc_msg_colon(chunk_t *pc, int level)
    return oc_msg_line_has_colon(tmp, level);
 }
 
+/**
+ * Forgets what oc_msg_line_near_colon() worked out. To be called before
+ * a pass over the file or a msg send, as the answers are only good for one.
+ */
+void oc_msg_lines_reset(void)
+{
+   cpd->oc_seq++;
+}
+
+
+/**
+ * Check if the line before or the line after pc's has a CT_OC_COLON, which
+ * is what makes a line of a msg send take part in the colon alignment.
+ * The answer is the same for all the chunks of a line, so it is worked out
+ * once per line and kept in the line index until oc_msg_lines_reset().
+ *
+ * @param level         the level of the opening square bracket or -1 for
+ *                      all levels.
+ */
+bool oc_msg_line_near_colon(chunk_t *pc, int level)
+{
+   line_t *line = NULL;
+   bool   result;
+
+   /* A newline looks at the line after it, not at its own */
+   if (!chunk_is_newline(pc) && ((pc->flags & PCF_IN_PREPROC) == 0))
+   {
+      chunk_line_index();
+      line = chunk_get_line(pc);
+   }
+   if ((line != NULL) && (line->oc_seq == cpd->oc_seq))
+   {
+      return(line->oc_near);
+   }
+
+   result = (next_line_has_oc_msg_colon(pc, level) ||
+             prev_line_has_oc_msg_colon(pc, level));
+
+   if (line != NULL)
+   {
+      line->oc_seq  = cpd->oc_seq;
+      line->oc_near = result;
+   }
+   return(result);
+}
+
 /**
  * Check if how many CT_OC_COLONs there are on pc's current line.
  * This function backtracks to the beginning of the msg send if on the same line
@@ -2216,7 +2327,7 @@ static void add_oc_align_group(chunk_t *pc, AlignStack *st, int line_num, int st
  */
 static void align_oc_msg_colon(int span)
 {
-   chunk_t    *pc = chunk_get_head();
+   chunk_t    *pc = chunk_first_of_type(CT_SQUARE_OPEN);
    chunk_t    *tmp;
    chunk_t    *colon;            /* the colon to align other chunks to. note: colon really must be a
                                     colon while all other AlignStack entries following that are words 
@@ -2243,6 +2354,10 @@ static void align_oc_msg_colon(int span)
          continue;
       }
                
+      /* The line ends are looked for a lot from here on */
+      chunk_line_index();
+      oc_msg_lines_reset();
+
       cas.Start(span, 0);
       
       cas.m_oc_msg_align = true;
@@ -2264,7 +2379,7 @@ static void align_oc_msg_colon(int span)
       first_line     = true;
 
       bool has_multiple_colons = false;
-      bool align_on_first      = (cpd.settings[UO_align_oc_msg_on_first_colon].b);
+      bool align_on_first      = (cpd->settings[UO_align_oc_msg_on_first_colon].b);
       
       while (pc != NULL)
       {
@@ -2324,8 +2439,7 @@ static void align_oc_msg_colon(int span)
             }
          }
          else if (pc->type == CT_OC_COLON && 
-                  (next_line_has_oc_msg_colon(pc, level) ||
-                   prev_line_has_oc_msg_colon(pc, level)))
+                  oc_msg_line_near_colon(pc, level))
          {
 
             has_colon = true;
@@ -2485,6 +2599,73 @@ static void align_oc_msg_colon(int span)
 }
 
 
+/**
+ * A string that follows a colon in an ObjC msg send and the first newline
+ * after it on its level, see oc_msg_string_newlines().
+ */
+struct oc_str_nl_t
+{
+   chunk_t *str;
+   chunk_t *nl;
+};
+
+
+/**
+ * Finds the newline that align_oc_msg_string() looks for after each string
+ * that follows a colon: the first one on the level of the string, as
+ * chunk_get_next_type() with CNAV_PREPROC would find it. That can be far
+ * past the end of the msg send, so they are all found in one walk.
+ *
+ * @param found   Gets the strings in the order of the file
+ */
+static void oc_msg_string_newlines(std::vector<oc_str_nl_t>& found)
+{
+   /* The strings still looking, by level, outside of a preprocessor and in
+    * the current one */
+   std::vector<std::vector<int> > waiting[2];
+   chunk_t *pc;
+   chunk_t *prev;
+   int     pp;
+
+   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
+   {
+      pp = ((pc->flags & PCF_IN_PREPROC) != 0) ? 1 : 0;
+      if ((pp == 1) && ((pc->prev == NULL) || ((pc->prev->flags & PCF_IN_PREPROC) == 0)))
+      {
+         /* A walk from inside a preprocessor stops at its end */
+         waiting[1].clear();
+      }
+
+      if (pc->type == CT_NEWLINE)
+      {
+         if (pc->level < (int)waiting[pp].size())
+         {
+            std::vector<int>& lvl = waiting[pp][pc->level];
+            for (size_t idx = 0; idx < lvl.size(); idx++)
+            {
+               found[lvl[idx]].nl = pc;
+            }
+            lvl.clear();
+         }
+      }
+      else if ((pc->type == CT_STRING) &&
+               (pc->parent_type == CT_OC_MSG) &&
+               ((prev = chunk_get_prev(pc, CNAV_PREPROC)) != NULL) &&
+               (prev->type == CT_OC_COLON))
+      {
+         oc_str_nl_t str_nl = { pc, NULL };
+
+         if ((int)waiting[pp].size() <= pc->level)
+         {
+            waiting[pp].resize(pc->level + 1);
+         }
+         waiting[pp][pc->level].push_back(found.size());
+         found.push_back(str_nl);
+      }
+   }
+}
+
+
 /**
  * Works pretty much like align_oc_msg_colon() in that it gives 
  * the file the once-over by aligning ObjC string literals 
@@ -2524,7 +2705,7 @@ static void align_oc_msg_colon(int span)
  */
 static void align_oc_msg_string(int span)
 {
-   chunk_t    *pc = chunk_get_head();
+   chunk_t    *pc = chunk_first_of_type(CT_SQUARE_OPEN);
    chunk_t    *tmp;
    chunk_t    *cstr;
    
@@ -2536,6 +2717,11 @@ static void align_oc_msg_string(int span)
    int        line_start_col;    /* column of the start of a msg send line */
    int        line_end_col;      /* column of the end of a msg send line */
    int        last_skipped_lnum; /* line no of the last skipped line */
+
+   std::vector<oc_str_nl_t> str_nls;
+   bool   have_str_nls = false;
+   size_t str_idx      = 0;
+   size_t idx;
    
    while (pc != NULL)
    {
@@ -2545,6 +2731,14 @@ static void align_oc_msg_string(int span)
          continue;
       }
       
+      /* The line ends are looked for a lot from here on */
+      chunk_line_index();
+      if (!have_str_nls)
+      {
+         oc_msg_string_newlines(str_nls);
+         have_str_nls = true;
+      }
+
       sas.Start(span);      
       sas.m_oc_str_align = true;
       
@@ -2600,9 +2794,24 @@ static void align_oc_msg_string(int span)
                }
                
                tmp = cstr;
-               cstr = chunk_get_next_type(cstr, CT_NEWLINE, cstr->level, CNAV_PREPROC);
+               if (has_colon_string_pattern)
+               {
+                  /* The strings come up in order, so look on from the last one */
+                  for (idx = str_idx; (idx < str_nls.size()) && (str_nls[idx].str != cstr); idx++)
+                  {
+                  }
+                  if (idx < str_nls.size())
+                  {
+                     str_idx = idx;
+                     cstr    = str_nls[idx].nl;
+                  }
+                  else
+                  {
+                     cstr = chunk_get_next_type(cstr, CT_NEWLINE, cstr->level, CNAV_PREPROC);
+                  }
+               }
                
-               if ((cstr != NULL) && (oc_msg_whole_line_is_string_literal(cstr, -1, true)) && (has_colon_string_pattern))
+               if (has_colon_string_pattern && (cstr != NULL) && (oc_msg_whole_line_is_string_literal(cstr, -1, true)))
                {
                   last_str_line  = tmp->orig_line;
                   first_str_col  = tmp->column;
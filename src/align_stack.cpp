@@ -252,16 +252,18 @@ void AlignStack::Add(chunk_t *start, int seqnum, int oc_line, int oc_line_start,
       //         ref->len, ref->str, get_token_name(ref->type), ref->column,
       //         col_adj, endcol, m_star_style, m_amp_style, gap);
 
-      ali->align.col_adj           = col_adj;
-      ali->align.ref               = ref;
-      ali->align.start             = start;
-      ali->align.oc_msg_align      = m_oc_msg_align;
-      ali->align.oc_str_align      = m_oc_str_align;
-      ali->align.oc_msg_lines      = m_oc_msg_lines;
-      ali->align.oc_msg_line       = oc_line;
-      ali->align.oc_msg_line_start = oc_line_start;
-      ali->align.oc_msg_line_end   = oc_line_end;
-      ali->align.oc_ref_colon      = oc_ref_colon;
+      /* Only the chunks that get aligned carry alignment data */
+      chunk_align(ali);
+      ali->align->col_adj           = col_adj;
+      ali->align->ref               = ref;
+      ali->align->start             = start;
+      ali->align->oc_msg_align      = m_oc_msg_align;
+      ali->align->oc_str_align      = m_oc_str_align;
+      ali->align->oc_msg_lines      = m_oc_msg_lines;
+      ali->align->oc_msg_line       = oc_line;
+      ali->align->oc_msg_line_start = oc_line_start;
+      ali->align->oc_msg_line_end   = oc_line_end;
+      ali->align->oc_ref_colon      = oc_ref_colon;
       
       m_aligned.Push(ali, seqnum);
       m_last_added = 1;
@@ -271,7 +273,7 @@ void AlignStack::Add(chunk_t *start, int seqnum, int oc_line, int oc_line_start,
          LOG_FMT(LAS, "Add-[%.*s]: line %d, col %d, adj %d : ref = [%.*s] endcol = %d\n"
                  "m_oc_msg_align = %s, m_oc_str_align = %s, m_oc_msg_lines = %d\n"
                  "oc_msg_line = %d, oc_msg_line_start = %d, oc_msg_line_end = %d, oc_msg_ref_colon = %d\n",
-                 ali->len, ali->str, ali->orig_line, ali->column, ali->align.col_adj,
+                 ali->len, ali->str, ali->orig_line, ali->column, ali->align->col_adj,
                  ref->len, ref->str, endcol, 
                  (m_oc_msg_align ? "true" : "false"), (m_oc_str_align ? "true" : "false"), m_oc_msg_lines,
                  oc_line, oc_line_start, oc_line_end, oc_ref_colon);
@@ -279,7 +281,7 @@ void AlignStack::Add(chunk_t *start, int seqnum, int oc_line, int oc_line_start,
       else 
       {
          LOG_FMT(LAS, "Add-[%.*s]: line %d, col %d, adj %d : ref=[%.*s] endcol=%d\n",
-                 ali->len, ali->str, ali->orig_line, ali->column, ali->align.col_adj,
+                 ali->len, ali->str, ali->orig_line, ali->column, ali->align->col_adj,
                  ref->len, ref->str, endcol);
       }
 
@@ -390,9 +392,9 @@ void AlignStack::Flush()
       /* Set the column adjust and gap */
       int col_adj = 0;
       int gap     = 0;
-      if (pc != pc->align.ref)
+      if (pc != pc->align->ref)
       {
-         gap = pc->column - (pc->align.ref->column + pc->align.ref->len);
+         gap = pc->column - (pc->align->ref->column + pc->align->ref->len);
       }
       chunk_t *tmp = pc;
       if (chunk_is_str(tmp, "(", 1) && (tmp->parent_type == CT_TYPEDEF))
@@ -402,56 +404,56 @@ void AlignStack::Flush()
       if ((chunk_is_star(tmp) && (m_star_style == SS_DANGLE)) ||
           (chunk_is_addr(tmp) && (m_amp_style == SS_DANGLE)))
       {
-         col_adj = pc->align.start->column - pc->column;
-         gap     = pc->align.start->column - (pc->align.ref->column + pc->align.ref->len);
+         col_adj = pc->align->start->column - pc->column;
+         gap     = pc->align->start->column - (pc->align->ref->column + pc->align->ref->len);
       }
       if (m_right_align)
       {
          /* Adjust the width for signed numbers */
-         int start_len = pc->align.start->len;
-         if (pc->align.start->type == CT_NEG)
+         int start_len = pc->align->start->len;
+         if (pc->align->start->type == CT_NEG)
          {
-            tmp = chunk_get_next(pc->align.start);
+            tmp = chunk_get_next(pc->align->start);
             if ((tmp != NULL) && (tmp->type == CT_NUMBER))
             {
                start_len += tmp->len;
             }
          }
          col_adj += start_len;
-         pc->align.col_adj = col_adj;
+         pc->align->col_adj = col_adj;
       }
       
-      oc_line = pc->align.oc_msg_line;
+      oc_line = pc->align->oc_msg_line;
       
-      int oc_msg_start = pc->align.oc_msg_line_start;
-      int oc_msg_end   = pc->align.oc_msg_line_end;
+      int oc_msg_start = pc->align->oc_msg_line_start;
+      int oc_msg_end   = pc->align->oc_msg_line_end;
 
       if (m_oc_msg_align)
       {
-         pcs = pc->align.start;
+         pcs = pc->align->start;
          oc_msg_has_mult_colons = false;
          
          if (oc_line == 1) 
          {
             oc_msg_delta      = 0;
-            oc_msg_fix_pt     = pc->align.oc_ref_colon;
-            oc_ref_colon      = pc->align.oc_ref_colon;
+            oc_msg_fix_pt     = pc->align->oc_ref_colon;
+            oc_ref_colon      = pc->align->oc_ref_colon;
             oc_msg_ref_start  = oc_msg_start;
             oc_msg_ref_end    = oc_msg_end;
             
             col_adj           = oc_msg_delta;
-            pc->align.col_adj = col_adj;        
+            pc->align->col_adj = col_adj;        
          }
          else
          {
             /* the reference colon is the colon which should dictate 
                the amount of col_adj between the alignee and the fix point colon
                from the first line of the msg send */
-            oc_ref_colon = pcs->align.oc_ref_colon;
+            oc_ref_colon = (pcs->align != NULL) ? pcs->align->oc_ref_colon : 0;
             oc_msg_delta = (oc_msg_fix_pt - oc_ref_colon) + 1;
             
             col_adj = oc_msg_delta + (oc_msg_start - oc_msg_ref_start);
-            pc->align.col_adj = col_adj; 
+            pc->align->col_adj = col_adj; 
          }
       }
       else if (m_oc_str_align)
@@ -459,19 +461,19 @@ void AlignStack::Flush()
          if (idx == 0)
          {
             oc_msg_delta      = 0;
-            oc_msg_fix_pt     = pc->align.oc_ref_colon;
-            oc_ref_colon      = pc->align.oc_ref_colon;
+            oc_msg_fix_pt     = pc->align->oc_ref_colon;
+            oc_ref_colon      = pc->align->oc_ref_colon;
             oc_msg_ref_start  = oc_msg_start;
             oc_msg_ref_end    = oc_msg_end;
          }
          else 
          {
-            oc_ref_colon = pc->align.oc_ref_colon;
+            oc_ref_colon = pc->align->oc_ref_colon;
             oc_msg_delta = oc_msg_fix_pt;
          }
          
          col_adj = oc_msg_fix_pt;
-         pc->align.col_adj = col_adj; 
+         pc->align->col_adj = col_adj; 
       }
       
       /* See if this pushes out the max_col */
@@ -491,38 +493,38 @@ void AlignStack::Flush()
       ce = m_aligned.Get(idx);
       pc = ce->m_pc;
       
-      oc_line = pc->align.oc_msg_line;
+      oc_line = pc->align->oc_msg_line;
       
       if (idx == 0)
       {
          pc->flags |= PCF_ALIGN_START;
 
-         pc->align.right_align       = m_right_align;
-         pc->align.amp_style         = (int)m_amp_style;
-         pc->align.star_style        = (int)m_star_style;
-         pc->align.gap               = m_gap;
+         pc->align->right_align       = m_right_align;
+         pc->align->amp_style         = (int)m_amp_style;
+         pc->align->star_style        = (int)m_star_style;
+         pc->align->gap               = m_gap;
       }
       
-      pc->align.next = m_aligned.GetChunk(idx + 1);
+      pc->align->next = m_aligned.GetChunk(idx + 1);
 
       if (m_oc_msg_align)
       {
-         tmp_col = pc->align.col_adj;
-         pc->align.oc_msg_align  = m_oc_msg_align;
+         tmp_col = pc->align->col_adj;
+         pc->align->oc_msg_align  = m_oc_msg_align;
       }
       else if (m_oc_str_align)
       {
-         tmp_col = pc->align.col_adj;
-         pc->align.oc_str_align  = m_oc_str_align;
+         tmp_col = pc->align->col_adj;
+         pc->align->oc_str_align  = m_oc_str_align;
       }
       else
       {
          /* Indent the token, taking col_adj into account */
-         tmp_col = m_max_col - pc->align.col_adj;
+         tmp_col = m_max_col - pc->align->col_adj;
       }
       
       LOG_FMT(LAS, "%s: line %d: '%.*s' to col %d (adj=%d)\n", __func__,
-              pc->orig_line, pc->len, pc->str, tmp_col, pc->align.col_adj);
+              pc->orig_line, pc->len, pc->str, tmp_col, pc->align->col_adj);
    
       if (m_oc_msg_align)
       {
@@ -13,7 +13,7 @@
  *
  *  2. Create the output file.
  *
- *  3. Calculate the md5 over the output file.
+ *  3. Calculate the md5 over the output text.
  *     Create the .backup-md5 file.
  *
  * This will let you run uncrustify multiple times over the same file without
@@ -114,34 +114,15 @@ int backup_copy_file(const char *filename, const char *file_data, int file_len)
 
 /**
  * This should be called after the file was written to disk.
- * It will be read back and an md5 will be calculated over it.
+ * The md5 is calculated over the data that was written.
  */
-void backup_create_md5_file(const char *filename)
+void backup_create_md5_file(const char *filename, const char *file_data, int file_len)
 {
    UINT8 dig[16];
-   MD5   md5;
    FILE  *thefile;
-   UINT8 buf[4096];
-   INT32 len;
    char  newpath[1024];
 
-   md5.Init();
-
-   thefile = fopen(filename, "rb");
-   if (thefile == NULL)
-   {
-      LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
-              __func__, filename, strerror(errno), errno);
-      return;
-   }
-
-   while ((len = fread(buf, 1, sizeof(buf), thefile)) > 0)
-   {
-      md5.Update(buf, len);
-   }
-
-   fclose(thefile);
-   md5.Final(dig);
+   MD5::Calc(file_data, file_len, dig);
 
    snprintf(newpath, sizeof(newpath), "%s%s", filename, UNC_BACKUP_MD5_SUFFIX);
 
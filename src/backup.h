@@ -42,15 +42,17 @@ int backup_copy_file(const char *filename, const char *file_data, int file_len);
 
 
 /**
- * This calculates the MD5 over the file and writes the MD5 to
- * FILENAME+UNC_BACKUP_MD5_SUFFIX.*
+ * This calculates the MD5 over the output and writes the MD5 to
+ * FILENAME+UNC_BACKUP_MD5_SUFFIX.
  * This should be called after the file was written to disk.
  * We really don't care if it fails, as the MD5 just prevents us from backing
  * up a file that uncrustify created.
  *
  * @param filename   The file that was written (full path)
+ * @param file_data  The data that was written
+ * @param file_len   The length of file_data
  */
-void backup_create_md5_file(const char *filename);
+void backup_create_md5_file(const char *filename, const char *file_data, int file_len);
 
 
 #endif /* BACKUP_H_INCLUDED */
@@ -35,10 +35,12 @@ typedef char       CHAR;
 typedef int8_t     INT8;
 typedef int16_t    INT16;
 typedef int32_t    INT32;
+typedef int64_t    INT64;
 
 typedef uint8_t    UINT8;
 typedef uint16_t   UINT16;
 typedef uint32_t   UINT32;
+typedef uint64_t   UINT64;
 
 #endif   /* ifdef WIN32 */
 
@@ -52,6 +54,13 @@ typedef uint32_t   UINT32;
 
 #define static_inline    static inline
 
+/* storage that is private to each thread */
+#ifdef _MSC_VER
+#define THREAD_LOCAL    __declspec(thread)
+#else
+#define THREAD_LOCAL    __thread
+#endif
+
 /* and the ever-so-important array size macro */
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)    (sizeof(x) / sizeof((x)[0]))
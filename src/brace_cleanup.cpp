@@ -35,23 +35,23 @@ static bool handle_complex_close(struct parse_frame *frm, chunk_t *pc);
 static int preproc_start(struct parse_frame *frm, chunk_t *pc)
 {
    chunk_t *next;
-   int     pp_level = cpd.pp_level;
+   int     pp_level = cpd->pp_level;
 
    /* Get the type of preprocessor and handle it */
    next = chunk_get_next_ncnl(pc);
    if (next != NULL)
    {
-      cpd.in_preproc = next->type;
+      cpd->in_preproc = next->type;
 
       /**
        * If we are in a define, push the frame stack.
        */
-      if (cpd.in_preproc == CT_PP_DEFINE)
+      if (cpd->in_preproc == CT_PP_DEFINE)
       {
          pf_push(frm);
 
          /* a preproc body starts a new, blank frame */
-         memset(frm, 0, sizeof(*frm));
+         *frm             = parse_frame();
          frm->level       = 1;
          frm->brace_level = 1;
 
@@ -106,39 +106,38 @@ void brace_cleanup(void)
 {
    chunk_t            *pc;
    chunk_t            vs_chunk;
-   struct parse_frame frm;
+   struct parse_frame frm = parse_frame();
    int                pp_level;
 
-   memset(&frm, 0, sizeof(frm));
    memset(&vs_chunk, 0, sizeof(vs_chunk));
 
-   cpd.in_preproc = CT_NONE;
-   cpd.pp_level   = 0;
+   cpd->in_preproc = CT_NONE;
+   cpd->pp_level   = 0;
 
    pc = chunk_get_head();
    while (pc != NULL)
    {
       /* Check for leaving a #define body */
-      if ((cpd.in_preproc != CT_NONE) && ((pc->flags & PCF_IN_PREPROC) == 0))
+      if ((cpd->in_preproc != CT_NONE) && ((pc->flags & PCF_IN_PREPROC) == 0))
       {
-         if (cpd.in_preproc == CT_PP_DEFINE)
+         if (cpd->in_preproc == CT_PP_DEFINE)
          {
             /* out of the #define body, restore the frame */
             pf_pop(&frm);
          }
 
-         cpd.in_preproc = CT_NONE;
+         cpd->in_preproc = CT_NONE;
       }
 
       /* Check for a preprocessor start */
-      pp_level = cpd.pp_level;
+      pp_level = cpd->pp_level;
       if (pc->type == CT_PREPROC)
       {
          pp_level = preproc_start(&frm, pc);
       }
 
       /* Do before assigning stuff from the frame */
-      if ((cpd.lang_flags & LANG_PAWN) != 0)
+      if ((cpd->lang_flags & LANG_PAWN) != 0)
       {
          if ((frm.pse[frm.pse_tos].type == CT_VBRACE_OPEN) &&
              (pc->type == CT_NEWLINE))
@@ -158,10 +157,10 @@ void brace_cleanup(void)
        * Also need to pass in the initial '#' to close out any virtual braces.
        */
       if (!chunk_is_comment(pc) && !chunk_is_newline(pc) &&
-          ((cpd.in_preproc == CT_PP_DEFINE) ||
-           (cpd.in_preproc == CT_NONE)))
+          ((cpd->in_preproc == CT_PP_DEFINE) ||
+           (cpd->in_preproc == CT_NONE)))
       {
-         cpd.consumed = false;
+         cpd->consumed = false;
          parse_cleanup(&frm, pc);
          print_stack(LBCSAFTER, (pc->type == CT_VBRACE_CLOSE) ? "Virt-}" : pc->str, &frm, pc);
       }
@@ -204,21 +203,12 @@ static bool maybe_while_of_do(chunk_t *pc)
 static void push_fmr_pse(struct parse_frame *frm, chunk_t *pc,
                          brstage_e stage, const char *logtext)
 {
-   if (frm->pse_tos < ((int)ARRAY_SIZE(frm->pse) - 1))
-   {
-      frm->pse_tos++;
-      frm->pse[frm->pse_tos].type  = pc->type;
-      frm->pse[frm->pse_tos].stage = stage;
-      frm->pse[frm->pse_tos].pc    = pc;
+   frm->pse_tos++;
+   frm->pse[frm->pse_tos].type  = pc->type;
+   frm->pse[frm->pse_tos].stage = stage;
+   frm->pse[frm->pse_tos].pc    = pc;
 
-      print_stack(LBCSPUSH, logtext, frm, pc);
-   }
-   else
-   {
-      LOG_FMT(LWARN, "%s:%d Error: Frame stack overflow,  Unable to properly process this file.\n",
-              cpd.filename, cpd.line_number);
-      cpd.error_count++;
-   }
+   print_stack(LBCSPUSH, logtext, frm, pc);
 }
 
 
@@ -344,10 +334,10 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
    {
       if (chunk_is_semicolon(pc))
       {
-         cpd.consumed = true;
+         cpd->consumed = true;
          close_statement(frm, pc);
       }
-      else if ((cpd.lang_flags & LANG_PAWN) != 0)
+      else if ((cpd->lang_flags & LANG_PAWN) != 0)
       {
          if (pc->type == CT_BRACE_CLOSE)
          {
@@ -369,7 +359,7 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
           ((frm->pse[frm->pse_tos].type == CT_FPAREN_OPEN) ||
            (frm->pse[frm->pse_tos].type == CT_SPAREN_OPEN)))
       {
-         pc->type = (c_token_t)(frm->pse[frm->pse_tos].type + 1);
+         chunk_set_type(pc, (c_token_t)(frm->pse[frm->pse_tos].type + 1));
          if (pc->type == CT_SPAREN_CLOSE)
          {
             frm->sparen_count--;
@@ -384,16 +374,16 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
              (frm->pse[frm->pse_tos].type != CT_PP_DEFINE))
          {
             LOG_FMT(LWARN, "%s:%d Error: Unexpected '%.*s' for '%s', which was on line %d\n",
-                    cpd.filename, pc->orig_line, pc->len, pc->str,
+                    cpd->filename, pc->orig_line, pc->len, pc->str,
                     get_token_name(frm->pse[frm->pse_tos].pc->type),
                     frm->pse[frm->pse_tos].pc->orig_line);
             print_stack(LBCSPOP, "=Error  ", frm, pc);
-            cpd.error_count++;
+            cpd->error_count++;
          }
       }
       else
       {
-         cpd.consumed = true;
+         cpd->consumed = true;
 
          /* Copy the parent, update the paren/brace levels */
          pc->parent_type = frm->pse[frm->pse_tos].parent;
@@ -420,20 +410,20 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
    }
 
    /* In this state, we expect a semicolon, but we'll also hit the closing
-    * sparen, so we need to check cpd.consumed to see if the close sparen was
+    * sparen, so we need to check cpd->consumed to see if the close sparen was
     * aleady handled.
     */
    if (frm->pse[frm->pse_tos].stage == BS_WOD_SEMI)
    {
       chunk_t *tmp = pc;
 
-      if (cpd.consumed)
+      if (cpd->consumed)
       {
          /* If consumed, then we are on the close sparen.
           * PAWN: Check the next chunk for a semicolon. If it isn't, then
           * add a virtual semicolon, which will get handled on the next pass.
           */
-         if (cpd.lang_flags & LANG_PAWN)
+         if (cpd->lang_flags & LANG_PAWN)
          {
             tmp = chunk_get_next_ncnl(pc);
 
@@ -448,14 +438,14 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
          /* Complain if this ISN'T a semicolon, but close out WHILE_OF_DO anyway */
          if ((pc->type == CT_SEMICOLON) || (pc->type == CT_VSEMICOLON))
          {
-            cpd.consumed    = true;
+            cpd->consumed   = true;
             pc->parent_type = CT_WHILE_OF_DO;
          }
          else
          {
             LOG_FMT(LWARN, "%s:%d: Error: Expected a semicolon for WHILE_OF_DO, but got '%s'\n",
-                    cpd.filename, pc->orig_line, get_token_name(pc->type));
-            cpd.error_count++;
+                    cpd->filename, pc->orig_line, get_token_name(pc->type));
+            cpd->error_count++;
          }
          handle_complex_close(frm, pc);
       }
@@ -478,14 +468,14 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
             /* Set the parent for parens and change paren type */
             if (frm->pse[frm->pse_tos].stage != BS_NONE)
             {
-               pc->type = CT_SPAREN_OPEN;
-               parent   = frm->pse[frm->pse_tos].type;
+               chunk_set_type(pc, CT_SPAREN_OPEN);
+               parent = frm->pse[frm->pse_tos].type;
                frm->sparen_count++;
             }
             else if (prev->type == CT_FUNCTION)
             {
-               pc->type = CT_FPAREN_OPEN;
-               parent   = CT_FUNCTION;
+               chunk_set_type(pc, CT_FPAREN_OPEN);
+               parent = CT_FUNCTION;
             }
             else
             {
@@ -553,8 +543,8 @@ static void parse_cleanup(struct parse_frame *frm, chunk_t *pc)
 
       if ((pc->type == CT_WHILE) && maybe_while_of_do(pc))
       {
-         pc->type = CT_WHILE_OF_DO;
-         bs       = BS_WOD_PAREN;
+         chunk_set_type(pc, CT_WHILE_OF_DO);
+         bs = BS_WOD_PAREN;
       }
       push_fmr_pse(frm, pc, bs, "+ComplexParenBraced");
    }
@@ -668,11 +658,11 @@ static bool check_complex_statements(struct parse_frame *frm, chunk_t *pc)
    {
       if (pc->type == CT_IF)
       {
-         if (!cpd.settings[UO_indent_else_if].b ||
+         if (!cpd->settings[UO_indent_else_if].b ||
              !chunk_is_newline(chunk_get_prev_nc(pc)))
          {
             /* Replace CT_ELSE with CT_IF */
-            pc->type = CT_ELSEIF;
+            chunk_set_type(pc, CT_ELSEIF);
             frm->pse[frm->pse_tos].type  = CT_ELSEIF;
             frm->pse[frm->pse_tos].stage = BS_PAREN1;
             return(true);
@@ -709,17 +699,17 @@ static bool check_complex_statements(struct parse_frame *frm, chunk_t *pc)
    {
       if (pc->type == CT_WHILE)
       {
-         pc->type = CT_WHILE_OF_DO;
+         chunk_set_type(pc, CT_WHILE_OF_DO);
          frm->pse[frm->pse_tos].type  = CT_WHILE_OF_DO; //CT_WHILE;
          frm->pse[frm->pse_tos].stage = BS_WOD_PAREN;
          return(true);
       }
 
       LOG_FMT(LWARN, "%s:%d Error: Expected 'while', got '%.*s'\n",
-              cpd.filename, pc->orig_line, pc->len, pc->str);
+              cpd->filename, pc->orig_line, pc->len, pc->str);
       frm->pse_tos--;
       print_stack(LBCSPOP, "-Error  ", frm, pc);
-      cpd.error_count++;
+      cpd->error_count++;
    }
 
    /* Insert a CT_VBRACE_OPEN, if needed */
@@ -757,13 +747,13 @@ static bool check_complex_statements(struct parse_frame *frm, chunk_t *pc)
         (frm->pse[frm->pse_tos].stage == BS_WOD_PAREN)))
    {
       LOG_FMT(LWARN, "%s:%d Error: Expected '(', got '%.*s' for '%s'\n",
-              cpd.filename, pc->orig_line, pc->len, pc->str,
+              cpd->filename, pc->orig_line, pc->len, pc->str,
               get_token_name(frm->pse[frm->pse_tos].type));
 
       /* Throw out the complex statement */
       frm->pse_tos--;
       print_stack(LBCSPOP, "-Error  ", frm, pc);
-      cpd.error_count++;
+      cpd->error_count++;
    }
 
    return(false);
@@ -865,10 +855,10 @@ static bool handle_complex_close(struct parse_frame *frm, chunk_t *pc)
    {
       /* PROBLEM */
       LOG_FMT(LWARN, "%s:%d Error: TOS.type='%s' TOS.stage=%d\n",
-              cpd.filename, pc->orig_line,
+              cpd->filename, pc->orig_line,
               get_token_name(frm->pse[frm->pse_tos].type),
               frm->pse[frm->pse_tos].stage);
-      cpd.error_count++;
+      cpd->error_count++;
    }
    return(false);
 }
@@ -954,7 +944,7 @@ bool close_statement(struct parse_frame *frm, chunk_t *pc)
            get_token_name(frm->pse[frm->pse_tos].type),
            frm->pse[frm->pse_tos].stage);
 
-   if (cpd.consumed)
+   if (cpd->consumed)
    {
       frm->stmt_count = 0;
       frm->expr_count = 0;
@@ -968,7 +958,7 @@ bool close_statement(struct parse_frame *frm, chunk_t *pc)
    if (frm->pse[frm->pse_tos].type == CT_VBRACE_OPEN)
    {
       /* If the current token has already been consumed, then add after it */
-      if (cpd.consumed)
+      if (cpd->consumed)
       {
          insert_vbrace_close_after(pc, frm);
       }
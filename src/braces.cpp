@@ -30,24 +30,24 @@ static bool should_add_braces(chunk_t *vbopen);
 void do_braces(void)
 {
    /* covert vbraces if needed */
-   if (((cpd.settings[UO_mod_full_brace_if].a |
-         cpd.settings[UO_mod_full_brace_do].a |
-         cpd.settings[UO_mod_full_brace_for].a |
-         cpd.settings[UO_mod_full_brace_function].a |
-         cpd.settings[UO_mod_full_brace_while].a) & AV_ADD) != 0)
+   if (((cpd->settings[UO_mod_full_brace_if].a |
+         cpd->settings[UO_mod_full_brace_do].a |
+         cpd->settings[UO_mod_full_brace_for].a |
+         cpd->settings[UO_mod_full_brace_function].a |
+         cpd->settings[UO_mod_full_brace_while].a) & AV_ADD) != 0)
    {
       convert_vbrace_to_brace();
    }
 
-   if (((cpd.settings[UO_mod_full_brace_if].a |
-         cpd.settings[UO_mod_full_brace_do].a |
-         cpd.settings[UO_mod_full_brace_for].a |
-         cpd.settings[UO_mod_full_brace_while].a) & AV_REMOVE) != 0)
+   if (((cpd->settings[UO_mod_full_brace_if].a |
+         cpd->settings[UO_mod_full_brace_do].a |
+         cpd->settings[UO_mod_full_brace_for].a |
+         cpd->settings[UO_mod_full_brace_while].a) & AV_REMOVE) != 0)
    {
       examine_braces();
    }
 
-   if (cpd.settings[UO_mod_full_brace_if_chain].b)
+   if (cpd->settings[UO_mod_full_brace_if_chain].b)
    {
       mod_full_brace_if_chain();
    }
@@ -91,11 +91,11 @@ void do_braces(void)
       }
    }
 
-   if (cpd.settings[UO_mod_case_brace].a != AV_IGNORE)
+   if (cpd->settings[UO_mod_case_brace].a != AV_IGNORE)
    {
       mod_case_brace();
    }
-   if (cpd.settings[UO_mod_move_case_break].b)
+   if (cpd->settings[UO_mod_move_case_break].b)
    {
       move_case_break();
    }
@@ -120,13 +120,13 @@ static void examine_braces(void)
          if ((((pc->parent_type == CT_IF) ||
                (pc->parent_type == CT_ELSE) ||
                (pc->parent_type == CT_ELSEIF)) &&
-              ((cpd.settings[UO_mod_full_brace_if].a & AV_REMOVE) != 0)) ||
+              ((cpd->settings[UO_mod_full_brace_if].a & AV_REMOVE) != 0)) ||
              ((pc->parent_type == CT_DO) &&
-              ((cpd.settings[UO_mod_full_brace_do].a & AV_REMOVE) != 0)) ||
+              ((cpd->settings[UO_mod_full_brace_do].a & AV_REMOVE) != 0)) ||
              ((pc->parent_type == CT_FOR) &&
-              ((cpd.settings[UO_mod_full_brace_for].a & AV_REMOVE) != 0)) ||
+              ((cpd->settings[UO_mod_full_brace_for].a & AV_REMOVE) != 0)) ||
              ((pc->parent_type == CT_WHILE) &&
-              ((cpd.settings[UO_mod_full_brace_while].a & AV_REMOVE) != 0)))
+              ((cpd->settings[UO_mod_full_brace_while].a & AV_REMOVE) != 0)))
          {
             examine_brace(pc);
          }
@@ -146,7 +146,7 @@ static void examine_braces(void)
 static bool should_add_braces(chunk_t *vbopen)
 {
    chunk_t *pc;
-   int     nl_max   = cpd.settings[UO_mod_full_brace_nl].n;
+   int     nl_max   = cpd->settings[UO_mod_full_brace_nl].n;
    int     nl_count = 0;
 
    if (nl_max == 0)
@@ -186,7 +186,7 @@ static bool can_remove_braces(chunk_t *bopen)
    int     level      = bopen->level + 1;
    bool    hit_semi   = false;
    bool    was_fcn    = false;
-   int     nl_max     = cpd.settings[UO_mod_full_brace_nl].n;
+   int     nl_max     = cpd->settings[UO_mod_full_brace_nl].n;
    int     nl_count   = 0;
    int     if_count   = 0;
    int     br_count   = 0;
@@ -303,7 +303,7 @@ static void examine_brace(chunk_t *bopen)
    int     level      = bopen->level + 1;
    bool    hit_semi   = false;
    bool    was_fcn    = false;
-   int     nl_max     = cpd.settings[UO_mod_full_brace_nl].n;
+   int     nl_max     = cpd->settings[UO_mod_full_brace_nl].n;
    int     nl_count   = 0;
    int     if_count   = 0;
    int     br_count   = 0;
@@ -423,10 +423,11 @@ static void examine_brace(chunk_t *bopen)
                LOG_FMT(LBRDEL, " else-if removing braces on line %d and %d\n",
                        bopen->orig_line, pc->orig_line);
 
+               output_lines_tie(bopen, pc);
                chunk_del(bopen);
                chunk_del(pc);
                newline_del_between(prev, next);
-               if (cpd.settings[UO_nl_else_if].a & AV_ADD)
+               if (cpd->settings[UO_nl_else_if].a & AV_ADD)
                {
                   newline_add_between(prev, next);
                }
@@ -466,17 +467,17 @@ static void convert_brace(chunk_t *br)
    }
    else if (br->type == CT_BRACE_OPEN)
    {
-      br->type = CT_VBRACE_OPEN;
-      br->len  = 0;
-      br->str  = "";
-      tmp      = chunk_get_prev(br);
+      chunk_set_type(br, CT_VBRACE_OPEN);
+      br->len = 0;
+      br->str = "";
+      tmp     = chunk_get_prev(br);
    }
    else if (br->type == CT_BRACE_CLOSE)
    {
-      br->type = CT_VBRACE_CLOSE;
-      br->len  = 0;
-      br->str  = "";
-      tmp      = chunk_get_next(br);
+      chunk_set_type(br, CT_VBRACE_CLOSE);
+      br->len = 0;
+      br->str = "";
+      tmp     = chunk_get_next(br);
    }
    else
    {
@@ -511,9 +512,9 @@ static void convert_vbrace(chunk_t *vbr)
    }
    else if (vbr->type == CT_VBRACE_OPEN)
    {
-      vbr->type = CT_BRACE_OPEN;
-      vbr->len  = 1;
-      vbr->str  = "{";
+      chunk_set_type(vbr, CT_BRACE_OPEN);
+      vbr->len = 1;
+      vbr->str = "{";
 
       /* If the next chunk is a preprocessor, then move the open brace after the
        * preprocessor.
@@ -528,9 +529,9 @@ static void convert_vbrace(chunk_t *vbr)
    }
    else if (vbr->type == CT_VBRACE_CLOSE)
    {
-      vbr->type = CT_BRACE_CLOSE;
-      vbr->len  = 1;
-      vbr->str  = "}";
+      chunk_set_type(vbr, CT_BRACE_CLOSE);
+      vbr->len = 1;
+      vbr->str = "}";
 
       /* If the next chunk is a comment, followed by a newline, then
        * move the brace after the newline and add another newline after
@@ -570,19 +571,19 @@ static void convert_vbrace_to_brace(void)
       if ((((pc->parent_type == CT_IF) ||
             (pc->parent_type == CT_ELSE) ||
             (pc->parent_type == CT_ELSEIF)) &&
-           ((cpd.settings[UO_mod_full_brace_if].a & AV_ADD) != 0))
+           ((cpd->settings[UO_mod_full_brace_if].a & AV_ADD) != 0))
           ||
           ((pc->parent_type == CT_FOR) &&
-           ((cpd.settings[UO_mod_full_brace_for].a & AV_ADD) != 0))
+           ((cpd->settings[UO_mod_full_brace_for].a & AV_ADD) != 0))
           ||
           ((pc->parent_type == CT_DO) &&
-           ((cpd.settings[UO_mod_full_brace_do].a & AV_ADD) != 0))
+           ((cpd->settings[UO_mod_full_brace_do].a & AV_ADD) != 0))
           ||
           ((pc->parent_type == CT_WHILE) &&
-           ((cpd.settings[UO_mod_full_brace_while].a & AV_ADD) != 0))
+           ((cpd->settings[UO_mod_full_brace_while].a & AV_ADD) != 0))
           ||
           ((pc->parent_type == CT_FUNC_DEF) &&
-           ((cpd.settings[UO_mod_full_brace_function].a & AV_ADD) != 0)))
+           ((cpd->settings[UO_mod_full_brace_function].a & AV_ADD) != 0)))
       {
          /* Find the matching vbrace close */
          vbc = NULL;
@@ -724,20 +725,20 @@ void add_long_closebrace_comment(void)
 
                if (br_open->parent_type == CT_SWITCH)
                {
-                  nl_min = cpd.settings[UO_mod_add_long_switch_closebrace_comment].n;
+                  nl_min = cpd->settings[UO_mod_add_long_switch_closebrace_comment].n;
                   tag_pc = sw_pc;
                }
                else if ((br_open->parent_type == CT_FUNC_DEF) ||
                         (br_open->parent_type == CT_OC_MSG_DECL))
                {
-                  nl_min = cpd.settings[UO_mod_add_long_function_closebrace_comment].n;
+                  nl_min = cpd->settings[UO_mod_add_long_function_closebrace_comment].n;
                   tag_pc = fcn_pc;
                }
 
                if ((nl_min > 0) && (nl_count >= nl_min) && (tag_pc != NULL))
                {
                   /* determine the added comment style */
-                  c_token_t style = (cpd.lang_flags & (LANG_CPP | LANG_CS)) ?
+                  c_token_t style = (cpd->lang_flags & (LANG_CPP | LANG_CS)) ?
                                     CT_COMMENT_CPP : CT_COMMENT;
 
                   /* Add a comment after the close brace */
@@ -826,6 +827,7 @@ static chunk_t *mod_case_brace_remove(chunk_t *br_open)
       pc->level--;
    }
    next = chunk_get_prev(br_open, CNAV_PREPROC);
+   output_lines_tie(br_open, br_close);
    chunk_del(br_open);
    chunk_del(br_close);
    return(chunk_get_next(next, CNAV_PREPROC));
@@ -920,13 +922,13 @@ static void mod_case_brace(void)
          return;
       }
 
-      if ((cpd.settings[UO_mod_case_brace].a == AV_REMOVE) &&
+      if ((cpd->settings[UO_mod_case_brace].a == AV_REMOVE) &&
           (pc->type == CT_BRACE_OPEN) &&
           (pc->parent_type == CT_CASE))
       {
          pc = mod_case_brace_remove(pc);
       }
-      else if ((cpd.settings[UO_mod_case_brace].a & AV_ADD) &&
+      else if ((cpd->settings[UO_mod_case_brace].a & AV_ADD) &&
                (pc->type == CT_CASE_COLON) &&
                (next->type != CT_BRACE_OPEN) &&
                (next->type != CT_BRACE_CLOSE) &&
@@ -0,0 +1,161 @@
+/**
+ * @file cache.cpp
+ * The cache of already formatted inputs. See cache.h.
+ *
+ * The entry for a key is the empty file 'folder/k0k1/k2...k31', so that no
+ * one folder gets too big.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "cache.h"
+#include "uncrustify_types.h"
+#include "uncrustify_version.h"
+#include "prototypes.h"
+#include "md5.h"
+#include "logger.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+
+static std::string cache_folder;
+static UINT8       cache_cfg_digest[16];
+
+
+static void md5_add_str(MD5& md5, const char *str)
+{
+   /* include the NUL so that "ab","c" differs from "a","bc" */
+   md5.Update(str, strlen(str) + 1);
+}
+
+
+static void md5_add_file_mem(MD5& md5, const file_mem& fm)
+{
+   md5.Update(&fm.length, sizeof(fm.length));
+   if (fm.data != NULL)
+   {
+      md5.Update(fm.data, fm.length);
+   }
+}
+
+
+void cache_init(const char *folder)
+{
+   MD5                    md5;
+   const chunk_tag_t      *ct;
+   const define_tag_t     *dt;
+   const option_map_value *opt;
+   int                    idx;
+
+   md5.Init();
+   md5_add_str(md5, UNCRUSTIFY_VERSION);
+
+   for (idx = 0; idx < UO_option_count; idx++)
+   {
+      if ((opt = get_option_name(idx)) != NULL)
+      {
+         md5_add_str(md5, opt->name);
+         md5_add_str(md5, op_val_to_string(opt->type, cpd->settings[idx]).c_str());
+      }
+   }
+
+   idx = 0;
+   while ((ct = get_custom_keyword_idx(idx)) != NULL)
+   {
+      md5_add_str(md5, ct->tag);
+      md5.Update(&ct->type, sizeof(ct->type));
+      md5.Update(&ct->lang_flags, sizeof(ct->lang_flags));
+   }
+
+   idx = 0;
+   while ((dt = get_define_idx(idx)) != NULL)
+   {
+      md5_add_str(md5, dt->tag);
+      md5_add_str(md5, (dt->value != NULL) ? dt->value : "");
+   }
+
+   md5_add_file_mem(md5, cpd->file_hdr);
+   md5_add_file_mem(md5, cpd->file_ftr);
+   md5_add_file_mem(md5, cpd->func_hdr);
+   md5_add_file_mem(md5, cpd->class_hdr);
+
+   md5.Final(cache_cfg_digest);
+
+   if ((mkdir(folder, 0750) != 0) && (errno != EEXIST))
+   {
+      LOG_FMT(LWARN, "%s: Unable to create %s, not caching: %s (%d)\n",
+              __func__, folder, strerror(errno), errno);
+      return;
+   }
+   cache_folder = folder;
+}
+
+
+/**
+ * Builds the path of the entry for a key.
+ *
+ * @param sub_only  true to stop at the subfolder
+ */
+static std::string cache_path(const char *key, bool sub_only)
+{
+   std::string path = cache_folder;
+
+   path += PATH_SEP;
+   path.append(key, 2);
+   if (!sub_only)
+   {
+      path += PATH_SEP;
+      path += &key[2];
+   }
+   return(path);
+}
+
+
+bool cache_lookup(const char *data, int data_len, int lang_flags,
+                  char key[CACHE_KEY_SIZE])
+{
+   MD5         md5;
+   UINT8       dig[16];
+   struct stat my_stat;
+
+   key[0] = 0;
+   if (cache_folder.empty())
+   {
+      return(false);
+   }
+
+   md5.Init();
+   md5.Update(cache_cfg_digest, sizeof(cache_cfg_digest));
+   md5.Update(&lang_flags, sizeof(lang_flags));
+   md5.Update(data, data_len);
+   md5.Final(dig);
+
+   for (int idx = 0; idx < 16; idx++)
+   {
+      snprintf(&key[idx * 2], 3, "%02x", dig[idx]);
+   }
+
+   return(stat(cache_path(key, false).c_str(), &my_stat) == 0);
+}
+
+
+void cache_store(const char key[CACHE_KEY_SIZE])
+{
+   FILE *pfile;
+
+   if ((key[0] == 0) || cache_folder.empty())
+   {
+      return;
+   }
+
+   mkdir(cache_path(key, true).c_str(), 0750);
+   pfile = fopen(cache_path(key, false).c_str(), "wb");
+   if (pfile != NULL)
+   {
+      fclose(pfile);
+   }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file cache.h
+ * Remembers which inputs are already formatted, so that --replace can skip
+ * them without parsing.
+ *
+ * It works like this:
+ *
+ * 1. Call cache_init() once the config, types and defines are loaded
+ *
+ * 2. Call cache_lookup() on the file data. If it returns true, the file
+ *    doesn't need to be formatted.
+ *
+ * 3. If the output matches the input, call cache_store() with the key from
+ *    cache_lookup()
+ *
+ * The key is the MD5 over the uncrustify version, the config, the language
+ * and the file contents, so changing any of them is a miss. Only the inputs
+ * that came out unchanged are recorded, one empty file per key.
+ * The cache folder may be removed at any time.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef CACHE_H_INCLUDED
+#define CACHE_H_INCLUDED
+
+#define CACHE_KEY_SIZE    33
+
+
+/**
+ * Enables the cache and hashes the current config.
+ *
+ * @param folder  The cache folder, created if needed
+ */
+void cache_init(const char *folder);
+
+
+/**
+ * Checks whether the data is known to be formatted.
+ *
+ * @param data       The file contents
+ * @param data_len   The length of data
+ * @param lang_flags The LANG_xxx flags the file is formatted with
+ * @param key        Gets the key for cache_store(), empty if the cache is off
+ * @return           true if the data is already formatted
+ */
+bool cache_lookup(const char *data, int data_len, int lang_flags,
+                  char key[CACHE_KEY_SIZE]);
+
+
+/**
+ * Records that the input for key came out unchanged.
+ * Does nothing if key is empty.
+ */
+void cache_store(const char key[CACHE_KEY_SIZE]);
+
+
+#endif /* CACHE_H_INCLUDED */
@@ -8,23 +8,19 @@
 #include "chunk_list.h"
 #include <cstring>
 #include <cstdlib>
+#include <vector>
 
-#include "ListManager.h"
 #include "prototypes.h"
 
-typedef ListManager<chunk_t>   ChunkList;
-
-ChunkList g_cl;
-
 chunk_t *chunk_get_head(void)
 {
-   return(g_cl.GetHead());
+   return(cpd->chunks.GetHead());
 }
 
 
 chunk_t *chunk_get_tail(void)
 {
-   return(g_cl.GetTail());
+   return(cpd->chunks.GetTail());
 }
 
 
@@ -34,7 +30,7 @@ chunk_t *chunk_get_next(chunk_t *cur, chunk_nav_t nav)
    {
       return(NULL);
    }
-   chunk_t *pc = g_cl.GetNext(cur);
+   chunk_t *pc = cpd->chunks.GetNext(cur);
    if ((pc == NULL) || (nav == CNAV_ALL))
    {
       return(pc);
@@ -51,7 +47,7 @@ chunk_t *chunk_get_next(chunk_t *cur, chunk_nav_t nav)
    /* Not in a preproc, skip any proproc */
    while ((pc != NULL) && (pc->flags & PCF_IN_PREPROC))
    {
-      pc = g_cl.GetNext(pc);
+      pc = cpd->chunks.GetNext(pc);
    }
    return(pc);
 }
@@ -63,7 +59,7 @@ chunk_t *chunk_get_prev(chunk_t *cur, chunk_nav_t nav)
    {
       return(NULL);
    }
-   chunk_t *pc = g_cl.GetPrev(cur);
+   chunk_t *pc = cpd->chunks.GetPrev(cur);
    if ((pc == NULL) || (nav == CNAV_ALL))
    {
       return(pc);
@@ -80,26 +76,694 @@ chunk_t *chunk_get_prev(chunk_t *cur, chunk_nav_t nav)
    /* Not in a preproc, skip any proproc */
    while ((pc != NULL) && (pc->flags & PCF_IN_PREPROC))
    {
-      pc = g_cl.GetPrev(pc);
+      pc = cpd->chunks.GetPrev(pc);
    }
    return(pc);
 }
 
 
-chunk_t *chunk_dup(const chunk_t *pc_in)
+/* The opening types that chunk_t::match is kept for.
+ * The closing type is always the next one.
+ *
+ * Angles are left out: combine.cpp finds them by changing the type of '<'
+ * and '>' chunks, without a level change, which could make a link wrong.
+ */
+static const c_token_t match_types[] =
+{
+   CT_PAREN_OPEN,
+   CT_SPAREN_OPEN,
+   CT_FPAREN_OPEN,
+   CT_BRACE_OPEN,
+   CT_VBRACE_OPEN,
+   CT_SQUARE_OPEN,
+};
+
+
+/**
+ * Gets the index of an opening type in match_types[].
+ *
+ * @return the index or -1 if the type isn't there
+ */
+static int chunk_match_idx(c_token_t type)
+{
+   for (int idx = 0; idx < (int)ARRAY_SIZE(match_types); idx++)
+   {
+      if (match_types[idx] == type)
+      {
+         return(idx);
+      }
+   }
+   return(-1);
+}
+
+
+static bool chunk_is_match_open(c_token_t type)
+{
+   return(chunk_match_idx(type) >= 0);
+}
+
+
+/**
+ * Drops all the links by making their generation old.
+ * When the generation wraps around, old links could look valid again, so
+ * they are cleared.
+ */
+static void chunk_match_forget(void)
 {
    chunk_t *pc;
 
-   /* Allocate the entry */
-   pc = new chunk_t;
-   if (pc == NULL)
+   /* Nothing to drop, ie while tokenizing */
+   if (!cpd->match_used)
+   {
+      return;
+   }
+   cpd->match_used = false;
+
+   if (++cpd->match_gen == 0)
+   {
+      for (pc = chunk_get_head(); pc != NULL; pc = pc->next)
+      {
+         pc->match = NULL;
+      }
+   }
+}
+
+
+/**
+ * Called when a chunk is added, moved or deleted.
+ * If it is a paren/brace/etc, the links around it may be wrong, so all the
+ * links are dropped. They are not fixed up locally: which links a new or
+ * moved chunk breaks is only known after a walk like the search itself.
+ * The links are made again one at a time by the next searches, so after
+ * such a change the searches walk the list as without the links.
+ */
+static void chunk_match_changed(const chunk_t *pc)
+{
+   if (chunk_is_match_open(pc->type) ||
+       chunk_is_match_open((c_token_t)(pc->type - 1)))
+   {
+      chunk_match_forget();
+   }
+}
+
+
+static void chunk_match_link(chunk_t *pc1, chunk_t *pc2)
+{
+   pc1->match     = pc2;
+   pc1->match_gen = cpd->match_gen;
+   pc2->match     = pc1;
+   pc2->match_gen = cpd->match_gen;
+
+   cpd->match_used = true;
+}
+
+
+/**
+ * Gets the other half of the pair that cur is in, if that is known.
+ * The link is checked against the current type and level of both chunks.
+ *
+ * @param cur    The chunk to search from
+ * @param type   The type that is searched for
+ * @param level  The level that is searched for
+ * @param nav    The navigation used for the search
+ * @return       NULL if the search has to be done
+ */
+static chunk_t *chunk_match_get(chunk_t *cur, c_token_t type, int level,
+                                chunk_nav_t nav)
+{
+   chunk_t *pc = cur->match;
+
+   if ((pc == NULL) ||
+       (cur->match_gen != cpd->match_gen) ||
+       (pc->match_gen != cpd->match_gen) ||
+       (pc->match != cur) ||
+       (pc->type != type) ||
+       (pc->level != level) ||
+       (cur->level != level))
+   {
+      return(NULL);
+   }
+
+   /* CNAV_PREPROC may give a different answer if a preprocessor is involved */
+   if ((nav != CNAV_ALL) && ((cur->flags | pc->flags) & PCF_IN_PREPROC))
+   {
+      return(NULL);
+   }
+   return(pc);
+}
+
+
+/**
+ * Links the opening and closing halves of the parens, braces, etc.
+ * Called once the levels are known, so that most searches for the other
+ * half don't need to walk the list.
+ *
+ * A link is the same as what chunk_get_next_type() and chunk_get_prev_type()
+ * find with CNAV_ALL: the first closing chunk of the same level after the
+ * opening one and the last opening chunk before the closing one.
+ *
+ * The links are a memo of those searches, not an index that is kept up to
+ * date. Adding, moving or deleting a paren/brace/square drops all of them,
+ * see chunk_match_changed().
+ */
+void chunk_link_matches(void)
+{
+   /* The last opening chunk of each type at each level that isn't linked */
+   std::vector<chunk_t *> open;
+   chunk_t                *pc;
+   int                    idx;
+
+   for (pc = chunk_get_head(); pc != NULL; pc = pc->next)
+   {
+      bool is_open = true;
+
+      if ((idx = chunk_match_idx(pc->type)) < 0)
+      {
+         is_open = false;
+         if ((idx = chunk_match_idx((c_token_t)(pc->type - 1))) < 0)
+         {
+            continue;
+         }
+      }
+
+      idx += pc->level * ARRAY_SIZE(match_types);
+      if (idx >= (int)open.size())
+      {
+         open.resize(idx + ARRAY_SIZE(match_types), NULL);
+      }
+
+      if (is_open)
+      {
+         open[idx] = pc;
+      }
+      else if (open[idx] != NULL)
+      {
+         chunk_match_link(open[idx], pc);
+         open[idx] = NULL;
+      }
+   }
+}
+
+
+/**
+ * The chunks of each type are kept in a list on the side, made with one walk
+ * of the chunks when a type is first asked for. Adding, deleting, moving or
+ * changing a chunk only marks the list of its type as unknown; the list is
+ * made again when it is next wanted.
+ */
+static void chunk_type_changed(c_token_t type)
+{
+   cpd->type_known[type] = false;
+}
+
+
+/**
+ * Makes the list of a type, if it isn't known.
+ */
+static std::vector<chunk_t *>& chunk_type_list(c_token_t type)
+{
+   std::vector<chunk_t *>& list = cpd->type_list[type];
+   chunk_t                 *pc;
+
+   if (!cpd->type_known[type])
+   {
+      list.clear();
+      for (pc = chunk_get_head(); pc != NULL; pc = pc->next)
+      {
+         if (pc->type == type)
+         {
+            list.push_back(pc);
+         }
+      }
+      cpd->type_known[type] = true;
+      cpd->type_pos[type]   = 0;
+   }
+   return(list);
+}
+
+
+chunk_t *chunk_first_of_type(c_token_t type)
+{
+   std::vector<chunk_t *>& list = chunk_type_list(type);
+
+   cpd->type_pos[type] = 0;
+   return(list.empty() ? NULL : list[0]);
+}
+
+
+chunk_t *chunk_next_of_type(chunk_t *cur)
+{
+   int pos;
+   int count;
+
+   if (cur == NULL)
+   {
+      return(NULL);
+   }
+   std::vector<chunk_t *>& list = chunk_type_list(cur->type);
+
+   /* The callers step through the list, so cur is where the last call left off */
+   count = list.size();
+   pos   = cpd->type_pos[cur->type];
+   if ((pos >= count) || (list[pos] != cur))
+   {
+      for (pos = 0; (pos < count) && (list[pos] != cur); pos++)
+      {
+      }
+   }
+   pos++;
+   cpd->type_pos[cur->type] = (pos < count) ? pos : count;
+   return((pos < count) ? list[pos] : NULL);
+}
+
+
+/* A few hundred KB per slab: large files don't need many, small ones fit in one */
+#define CHUNK_SLAB_SIZE    2048
+
+struct chunk_slab
+{
+   struct chunk_slab *next;
+   chunk_t           chunks[CHUNK_SLAB_SIZE];
+};
+
+/* Only a small part of the chunks are ever aligned */
+#define ALIGN_SLAB_SIZE    256
+
+struct align_slab
+{
+   struct align_slab *next;
+   align_ptr_t       aligns[ALIGN_SLAB_SIZE];
+};
+
+/* A line is a dozen chunks or so */
+#define LINE_SLAB_SIZE    256
+
+struct line_slab
+{
+   struct line_slab *next;
+   line_t           lines[LINE_SLAB_SIZE];
+};
+
+
+/**
+ * Gets the memory for a chunk from the arena.
+ * Uses a deleted chunk if there is one, else the next one in the slab.
+ */
+static chunk_t *chunk_alloc(void)
+{
+   chunk_arena_t *ar = &cpd->arena;
+   chunk_t       *pc;
+
+   if (ar->free_list != NULL)
+   {
+      pc            = ar->free_list;
+      ar->free_list = pc->next;
+      return(pc);
+   }
+
+   if ((ar->slabs == NULL) || (ar->slab_used >= CHUNK_SLAB_SIZE))
+   {
+      struct chunk_slab *slab = (struct chunk_slab *)malloc(sizeof(*slab));
+      if (slab == NULL)
+      {
+         exit(1);
+      }
+      slab->next    = ar->slabs;
+      ar->slabs     = slab;
+      ar->slab_used = 0;
+   }
+   return(&ar->slabs->chunks[ar->slab_used++]);
+}
+
+
+/**
+ * Gets the alignment data for a chunk that doesn't have any yet.
+ * The alignment data lives as long as the chunks.
+ */
+static align_ptr_t *align_alloc(void)
+{
+   chunk_arena_t *ar = &cpd->arena;
+
+   if ((ar->align_slabs == NULL) || (ar->align_used >= ALIGN_SLAB_SIZE))
+   {
+      struct align_slab *slab = (struct align_slab *)malloc(sizeof(*slab));
+      if (slab == NULL)
+      {
+         exit(1);
+      }
+      slab->next      = ar->align_slabs;
+      ar->align_slabs = slab;
+      ar->align_used  = 0;
+   }
+   return(&ar->align_slabs->aligns[ar->align_used++]);
+}
+
+
+/**
+ * Gets a line for the line index, with nothing counted yet.
+ * Lines that go away aren't reused, they are released with the chunks.
+ */
+static line_t *line_alloc(chunk_t *first, chunk_t *nl)
+{
+   chunk_arena_t *ar = &cpd->arena;
+   line_t        *line;
+
+   if ((ar->line_slabs == NULL) || (ar->line_used >= LINE_SLAB_SIZE))
+   {
+      struct line_slab *slab = (struct line_slab *)malloc(sizeof(*slab));
+      if (slab == NULL)
+      {
+         exit(1);
+      }
+      slab->next     = ar->line_slabs;
+      ar->line_slabs = slab;
+      ar->line_used  = 0;
+   }
+   line            = &ar->line_slabs->lines[ar->line_used++];
+   line->first     = first;
+   line->nl        = nl;
+   line->oc_colons = -1;
+   line->oc_seq    = -1;
+   return(line);
+}
+
+
+/**
+ * Frees a list of slabs, except for the newest one if keep_one is set.
+ */
+template<class T>
+static void slabs_release(T **slabs, bool keep_one)
+{
+   T *slab = *slabs;
+   T *next;
+
+   if (keep_one && (slab != NULL))
+   {
+      next       = slab->next;
+      slab->next = NULL;
+      slab       = next;
+   }
+   else
+   {
+      *slabs = NULL;
+   }
+
+   while (slab != NULL)
+   {
+      next = slab->next;
+      free(slab);
+      slab = next;
+   }
+}
+
+
+/**
+ * Frees the slabs, except for the newest ones if keep_one is set.
+ * All the chunks, alignment data and lines are unused afterwards.
+ */
+static void chunk_arena_release(bool keep_one)
+{
+   chunk_arena_t *ar = &cpd->arena;
+
+   slabs_release(&ar->slabs, keep_one);
+   slabs_release(&ar->align_slabs, keep_one);
+   slabs_release(&ar->line_slabs, keep_one);
+   ar->slab_used  = 0;
+   ar->align_used = 0;
+   ar->line_used  = 0;
+   ar->free_list  = NULL;
+}
+
+
+/**
+ * Gets the alignment data of a chunk, adding it if the chunk has none.
+ * New alignment data is all zero.
+ */
+align_ptr_t *chunk_align(chunk_t *pc)
+{
+   if (pc->align == NULL)
+   {
+      pc->align = align_alloc();
+      memset(pc->align, 0, sizeof(*pc->align));
+   }
+   return(pc->align);
+}
+
+
+/**
+ * The line index: each chunk points to its line, and the line knows where
+ * it starts and ends. It is made on the first call to chunk_line_index() and
+ * kept up to date from then on. Adding or deleting a chunk only touches its
+ * line, adding or deleting a newline also the rest of the line or the next
+ * one.
+ */
+
+/**
+ * Gets the next chunk that is in the line index. The chunks that are being
+ * moved around are skipped.
+ */
+static chunk_t *chunk_line_next(chunk_t *pc)
+{
+   do
+   {
+      pc = pc->next;
+   } while ((pc != NULL) && (pc->line == NULL));
+   return(pc);
+}
+
+
+static chunk_t *chunk_line_prev(chunk_t *pc)
+{
+   do
+   {
+      pc = pc->prev;
+   } while ((pc != NULL) && (pc->line == NULL));
+   return(pc);
+}
+
+
+line_t *chunk_get_line(chunk_t *pc)
+{
+   return((pc != NULL) ? pc->line : NULL);
+}
+
+
+/**
+ * Whether 'nl', the first newline from cur found with the line index, is also
+ * what stepping with 'nav' would find. With CNAV_PREPROC the preprocessor
+ * chunks are skipped, or the walk stops at the end of a preprocessor.
+ */
+static bool chunk_line_nav_ok(chunk_t *cur, chunk_t *nl, chunk_nav_t nav)
+{
+   return((nav == CNAV_ALL) ||
+          (((cur->flags & PCF_IN_PREPROC) == 0) &&
+           ((nl == NULL) || ((nl->flags & PCF_IN_PREPROC) == 0))));
+}
+
+
+void chunk_line_index(void)
+{
+   chunk_t *pc;
+   line_t  *line = NULL;
+
+   if (cpd->line_index)
+   {
+      return;
+   }
+
+   for (pc = chunk_get_head(); pc != NULL; pc = pc->next)
+   {
+      if (line == NULL)
+      {
+         line = line_alloc(pc, NULL);
+      }
+      pc->line = line;
+      if (chunk_is_newline(pc))
+      {
+         line->nl = pc;
+         line     = NULL;
+      }
+   }
+   cpd->line_index = true;
+}
+
+
+/**
+ * Puts a chunk that was just added or moved into the line index.
+ */
+static void chunk_line_link(chunk_t *pc)
+{
+   chunk_t *prev;
+   chunk_t *next;
+   chunk_t *tmp;
+   line_t  *line;
+   line_t  *rest;
+
+   if (!cpd->line_index)
    {
-      exit(1);
+      return;
    }
+   prev = chunk_line_prev(pc);
+   next = chunk_line_next(pc);
+
+   if ((prev != NULL) && !chunk_is_newline(prev))
+   {
+      /* On the line of prev, a newline ends it there */
+      line = prev->line;
+      if (chunk_is_newline(pc) && (next != NULL))
+      {
+         rest = line_alloc(next, line->nl);
+         for (tmp = next; tmp != NULL; tmp = chunk_line_next(tmp))
+         {
+            tmp->line = rest;
+            if (tmp == rest->nl)
+            {
+               break;
+            }
+         }
+      }
+      if (chunk_is_newline(pc))
+      {
+         line->nl = pc;
+      }
+   }
+   else if (chunk_is_newline(pc) || (next == NULL))
+   {
+      line = line_alloc(pc, chunk_is_newline(pc) ? pc : NULL);
+   }
+   else
+   {
+      /* The new start of the line of next */
+      line        = next->line;
+      line->first = pc;
+   }
+   pc->line        = line;
+   line->oc_colons = -1;
+   line->oc_seq    = -1;
+}
+
+
+/**
+ * Takes a chunk that is about to be deleted or moved out of the line index.
+ */
+static void chunk_line_unlink(chunk_t *pc)
+{
+   line_t  *line = pc->line;
+   line_t  *rest;
+   chunk_t *next;
+   chunk_t *tmp;
+
+   if (line == NULL)
+   {
+      return;
+   }
+   next = chunk_line_next(pc);
+
+   if (!chunk_is_newline(pc))
+   {
+      if ((line->first == pc) && (next != NULL))
+      {
+         line->first = next;
+      }
+   }
+   else if (line->first != pc)
+   {
+      /* The line goes on with the next one */
+      if (next != NULL)
+      {
+         rest = next->line;
+         for (tmp = next; tmp != NULL; tmp = chunk_line_next(tmp))
+         {
+            tmp->line = line;
+            if (tmp == rest->nl)
+            {
+               break;
+            }
+         }
+         line->nl = rest->nl;
+      }
+      else
+      {
+         line->nl = NULL;
+      }
+   }
+   line->oc_colons = -1;
+   line->oc_seq    = -1;
+   pc->line        = NULL;
+}
+
+
+/**
+ * Puts a chunk that was just added or moved into the type and line indexes.
+ */
+static void chunk_index_add(chunk_t *pc)
+{
+   chunk_type_changed(pc->type);
+   chunk_line_link(pc);
+}
+
+
+/**
+ * Takes a chunk that is about to be deleted or moved out of the indexes.
+ */
+static void chunk_index_remove(chunk_t *pc)
+{
+   chunk_type_changed(pc->type);
+   chunk_line_unlink(pc);
+}
+
+
+void chunk_set_type(chunk_t *pc, c_token_t type)
+{
+   if (pc->type == type)
+   {
+      return;
+   }
+   if ((pc->prev == NULL) && (pc->next == NULL) && (chunk_get_head() != pc))
+   {
+      /* Not in the list, ie a dummy */
+      pc->type = type;
+      return;
+   }
+   chunk_type_changed(pc->type);
+   chunk_type_changed(type);
+   if (chunk_is_newline(pc) != ((type == CT_NEWLINE) || (type == CT_NL_CONT)))
+   {
+      /* It starts or stops ending its line */
+      chunk_line_unlink(pc);
+      pc->type = type;
+      chunk_line_link(pc);
+   }
+   else if (pc->line != NULL)
+   {
+      /* The ObjC counts of the line may change */
+      pc->line->oc_colons = -1;
+      pc->line->oc_seq    = -1;
+   }
+   pc->type = type;
+}
+
+
+chunk_t *chunk_dup(const chunk_t *pc_in)
+{
+   chunk_t *pc;
+
+   /* Allocate the entry */
+   pc = chunk_alloc();
 
    /* Copy all fields and then init the entry */
    *pc = *pc_in;
-   g_cl.InitEntry(pc);
+   cpd->chunks.InitEntry(pc);
+   pc->match = NULL;
+   pc->line  = NULL;
+   chunk_match_changed(pc);
+
+   /* The copy gets its own alignment data */
+   if (pc_in->align != NULL)
+   {
+      pc->align  = align_alloc();
+      *pc->align = *pc_in->align;
+   }
 
    return(pc);
 }
@@ -114,7 +778,9 @@ chunk_t *chunk_add(const chunk_t *pc_in)
 
    if ((pc = chunk_dup(pc_in)) != NULL)
    {
-      g_cl.AddTail(pc);
+      cpd->chunks.AddTail(pc);
+      chunk_index_add(pc);
+      cpd->chunks_added++;
    }
    return(pc);
 }
@@ -132,12 +798,14 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref)
    {
       if (ref != NULL)
       {
-         g_cl.AddAfter(pc, ref);
+         cpd->chunks.AddAfter(pc, ref);
       }
       else
       {
-         g_cl.AddHead(pc);
+         cpd->chunks.AddHead(pc);
       }
+      chunk_index_add(pc);
+      cpd->chunks_added++;
    }
    return(pc);
 }
@@ -155,12 +823,14 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
    {
       if (ref != NULL)
       {
-         g_cl.AddBefore(pc, ref);
+         cpd->chunks.AddBefore(pc, ref);
       }
       else
       {
-         g_cl.AddTail(pc);
+         cpd->chunks.AddTail(pc);
       }
+      chunk_index_add(pc);
+      cpd->chunks_added++;
    }
    return(pc);
 }
@@ -168,20 +838,69 @@ chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref)
 
 void chunk_del(chunk_t *pc)
 {
-   g_cl.Pop(pc);
+   chunk_match_changed(pc);
+   chunk_index_remove(pc);
+   cpd->chunks.Pop(pc);
+   cpd->chunks_deleted++;
    if ((pc->flags & PCF_OWN_STR) && (pc->str != NULL))
    {
       delete[] (char *)pc->str;
       pc->str = NULL;
    }
-   delete pc;
+   pc->next             = cpd->arena.free_list;
+   cpd->arena.free_list = pc;
+}
+
+
+/**
+ * Deletes all the chunks and the BOM at once.
+ * The first slab is kept for the next file.
+ */
+void chunk_del_all(void)
+{
+   chunk_t *pc;
+
+   for (pc = chunk_get_head(); pc != NULL; pc = pc->next)
+   {
+      if ((pc->flags & PCF_OWN_STR) && (pc->str != NULL))
+      {
+         delete[] (char *)pc->str;
+      }
+   }
+   cpd->chunks.Clear();
+   cpd->chunks_added   = 0;
+   cpd->chunks_deleted = 0;
+   memset(cpd->type_known, 0, sizeof(cpd->type_known));
+   cpd->line_index = false;
+
+   pc = cpd->bom;
+   if ((pc != NULL) && (pc->flags & PCF_OWN_STR) && (pc->str != NULL))
+   {
+      delete[] (char *)pc->str;
+   }
+   cpd->bom = NULL;
+
+   chunk_arena_release(true);
+}
+
+
+/**
+ * Frees all the memory of the arena, for when the context goes away.
+ * There must be no chunks left.
+ */
+void chunk_arena_free(void)
+{
+   chunk_arena_release(false);
 }
 
 
 void chunk_move_after(chunk_t *pc_in, chunk_t *ref)
 {
-   g_cl.Pop(pc_in);
-   g_cl.AddAfter(pc_in, ref);
+   chunk_match_changed(pc_in);
+   chunk_index_remove(pc_in);
+   cpd->chunks.Pop(pc_in);
+   cpd->chunks.AddAfter(pc_in, ref);
+   chunk_index_add(pc_in);
 
    /* HACK: Adjust the original column */
    pc_in->column       = ref->column + space_col_align(ref, pc_in);
@@ -197,6 +916,18 @@ chunk_t *chunk_get_next_nl(chunk_t *cur, chunk_nav_t nav)
 {
    chunk_t *pc = cur;
 
+   if (chunk_get_line(cur) != NULL)
+   {
+      /* The first newline after cur ends its line or the next one */
+      pc = chunk_is_newline(cur) ? cur->next : cur;
+      pc = (pc != NULL) ? pc->line->nl : NULL;
+      if (chunk_line_nav_ok(cur, pc, nav))
+      {
+         return(pc);
+      }
+      pc = cur;
+   }
+
    do
    {
       pc = chunk_get_next(pc, nav);
@@ -212,6 +943,17 @@ chunk_t *chunk_get_prev_nl(chunk_t *cur, chunk_nav_t nav)
 {
    chunk_t *pc = cur;
 
+   if (chunk_get_line(cur) != NULL)
+   {
+      /* The first newline before cur ends the line before it */
+      pc = cur->line->first->prev;
+      if (chunk_line_nav_ok(cur, pc, nav))
+      {
+         return(pc);
+      }
+      pc = cur;
+   }
+
    do
    {
       pc = chunk_get_prev(pc, nav);
@@ -401,6 +1143,9 @@ chunk_t *chunk_get_prev_nc(chunk_t *cur, chunk_nav_t nav)
 
 /**
  * Grabs the next chunk of the given type at the level.
+ * When looking for the closing half of a paren/brace/etc, the link from
+ * chunk_link_matches() is used if it is still valid. Otherwise the link is
+ * made on the way.
  *
  * @param cur     Starting chunk
  * @param type    The type to look for
@@ -410,7 +1155,22 @@ chunk_t *chunk_get_prev_nc(chunk_t *cur, chunk_nav_t nav)
 chunk_t *chunk_get_next_type(chunk_t *cur, c_token_t type,
                              int level, chunk_nav_t nav)
 {
-   chunk_t *pc = cur;
+   chunk_t *pc   = cur;
+   chunk_t *open = NULL;
+
+   if ((cur != NULL) && (cur->level == level) &&
+       chunk_is_match_open(cur->type) && (type == cur->type + 1))
+   {
+      if ((pc = chunk_match_get(cur, type, level, nav)) != NULL)
+      {
+         return(pc);
+      }
+      pc = cur;
+      if (nav == CNAV_ALL)
+      {
+         open = cur;
+      }
+   }
 
    do
    {
@@ -420,7 +1180,17 @@ chunk_t *chunk_get_next_type(chunk_t *cur, c_token_t type,
       {
          break;
       }
+      /* The match is for the last opening chunk before the closing one */
+      if ((open != NULL) && (pc->type == cur->type) && (pc->level == level))
+      {
+         open = pc;
+      }
    } while (pc != NULL);
+
+   if ((open != NULL) && (pc != NULL))
+   {
+      chunk_match_link(open, pc);
+   }
    return(pc);
 }
 
@@ -446,6 +1216,7 @@ chunk_t *chunk_get_next_str(chunk_t *cur, const char *str, int len, int level,
 
 /**
  * Grabs the prev chunk of the given type at the level.
+ * Uses and makes the same links as chunk_get_next_type().
  *
  * @param cur     Starting chunk
  * @param type    The type to look for
@@ -455,7 +1226,22 @@ chunk_t *chunk_get_next_str(chunk_t *cur, const char *str, int len, int level,
 chunk_t *chunk_get_prev_type(chunk_t *cur, c_token_t type,
                              int level, chunk_nav_t nav)
 {
-   chunk_t *pc = cur;
+   chunk_t *pc    = cur;
+   chunk_t *close = NULL;
+
+   if ((cur != NULL) && (cur->level == level) &&
+       chunk_is_match_open(type) && (cur->type == type + 1))
+   {
+      if ((pc = chunk_match_get(cur, type, level, nav)) != NULL)
+      {
+         return(pc);
+      }
+      pc = cur;
+      if (nav == CNAV_ALL)
+      {
+         close = cur;
+      }
+   }
 
    do
    {
@@ -465,7 +1251,17 @@ chunk_t *chunk_get_prev_type(chunk_t *cur, c_token_t type,
       {
          break;
       }
+      /* The match is for the first closing chunk after the opening one */
+      if ((close != NULL) && (pc->type == cur->type) && (pc->level == level))
+      {
+         close = pc;
+      }
    } while (pc != NULL);
+
+   if ((close != NULL) && (pc != NULL))
+   {
+      chunk_match_link(pc, close);
+   }
    return(pc);
 }
 
@@ -515,7 +1311,13 @@ bool chunk_is_newline_between(chunk_t *start, chunk_t *end)
  */
 void chunk_swap(chunk_t *pc1, chunk_t *pc2)
 {
-   g_cl.Swap(pc1, pc2);
+   chunk_match_changed(pc1);
+   chunk_match_changed(pc2);
+   chunk_index_remove(pc1);
+   chunk_index_remove(pc2);
+   cpd->chunks.Swap(pc1, pc2);
+   chunk_index_add(pc1);
+   chunk_index_add(pc2);
 }
 
 
@@ -531,6 +1333,11 @@ chunk_t *chunk_first_on_line(chunk_t *pc)
 {
    chunk_t *first = pc;
 
+   if (chunk_get_line(pc) != NULL)
+   {
+      return(pc->line->first);
+   }
+
    while (((pc = chunk_get_prev(pc)) != NULL) && !chunk_is_newline(pc))
    {
       first = pc;
@@ -551,6 +1358,8 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
    chunk_t *ref2;
    chunk_t *tmp;
 
+   std::vector<chunk_t *> moved;
+
    pc1 = chunk_first_on_line(pc1);
    pc2 = chunk_first_on_line(pc2);
 
@@ -559,6 +1368,9 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
       return;
    }
 
+   /* Whole lines move, so the links can't be trusted */
+   chunk_match_forget();
+
    /**
     * Example start:
     * ? - start1 - a1 - b1 - nl1 - ? - ref2 - start2 - a2 - b2 - nl2 - ?
@@ -570,8 +1382,10 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
    while ((pc2 != NULL) && !chunk_is_newline(pc2))
    {
       tmp = chunk_get_next(pc2);
-      g_cl.Pop(pc2);
-      g_cl.AddBefore(pc2, pc1);
+      chunk_index_remove(pc2);
+      moved.push_back(pc2);
+      cpd->chunks.Pop(pc2);
+      cpd->chunks.AddBefore(pc2, pc1);
       pc2 = tmp;
    }
 
@@ -585,19 +1399,27 @@ void chunk_swap_lines(chunk_t *pc1, chunk_t *pc2)
    while ((pc1 != NULL) && !chunk_is_newline(pc1))
    {
       tmp = chunk_get_next(pc1);
-      g_cl.Pop(pc1);
+      chunk_index_remove(pc1);
+      moved.push_back(pc1);
+      cpd->chunks.Pop(pc1);
       if (ref2 != NULL)
       {
-         g_cl.AddAfter(pc1, ref2);
+         cpd->chunks.AddAfter(pc1, ref2);
       }
       else
       {
-         g_cl.AddHead(pc1);
+         cpd->chunks.AddHead(pc1);
       }
       ref2 = pc1;
       pc1  = tmp;
    }
 
+   /* The indexes are fixed once everything is in place */
+   for (int idx = 0; idx < (int)moved.size(); idx++)
+   {
+      chunk_index_add(moved[idx]);
+   }
+
    /**
     * Should now be:
     * ? - start2 - a2 - b2 - nl1 - ? - ref2 - start1 - a1 - b1 - nl2 - ?
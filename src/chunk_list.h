@@ -35,8 +35,52 @@ chunk_t *chunk_add_after(const chunk_t *pc_in, chunk_t *ref);
 chunk_t *chunk_add_before(const chunk_t *pc_in, chunk_t *ref);
 
 void chunk_del(chunk_t *pc);
+void chunk_del_all(void);
+void chunk_arena_free(void);
+
+align_ptr_t *chunk_align(chunk_t *pc);
+
+void chunk_link_matches(void);
 void chunk_move_after(chunk_t *pc_in, chunk_t *ref);
 
+/**
+ * Changes the type of a chunk in the list.
+ * Always use this instead of setting chunk_t::type, so that the lists of the
+ * old and the new type are made again.
+ */
+void chunk_set_type(chunk_t *pc, c_token_t type);
+
+/**
+ * Gets the first chunk of a type, for the passes that only look at a few
+ * types. Each type has its own list on the side, in the same order as the
+ * chunks. It is made with one walk when it isn't known, ie the first time or
+ * after a chunk of the type was added, deleted, moved or changed.
+ *
+ * @return NULL if there is none
+ */
+chunk_t *chunk_first_of_type(c_token_t type);
+
+/**
+ * Gets the next chunk of the same type as cur.
+ * The type of cur must not be changed in between.
+ */
+chunk_t *chunk_next_of_type(chunk_t *cur);
+
+/**
+ * Makes the line index, for the passes that keep looking for the ends of
+ * lines. From then on it is kept up to date, chunk_first_on_line(),
+ * chunk_get_next_nl() and chunk_get_prev_nl() don't walk the line and
+ * chunk_get_line() works.
+ */
+void chunk_line_index(void);
+
+/**
+ * Gets the line of a chunk.
+ *
+ * @return NULL if there is no line index
+ */
+line_t *chunk_get_line(chunk_t *pc);
+
 chunk_t *chunk_get_head(void);
 chunk_t *chunk_get_tail(void);
 chunk_t *chunk_get_next(chunk_t *cur, chunk_nav_t nav = CNAV_ALL);
@@ -72,6 +116,8 @@ chunk_t *chunk_get_prev_nvb(chunk_t *cur, chunk_nav_t nav = CNAV_ALL);
 
 /**
  * Skips to the closing match for the current paren/brace/square.
+ * This is quick while the link from chunk_link_matches() is valid. After
+ * a paren/brace/square was added, moved or deleted, it walks the list.
  *
  * @param cur  The opening paren/brace/square
  * @return     NULL or the matching paren/brace/square
@@ -53,15 +53,15 @@ void make_type(chunk_t *pc)
    {
       if (pc->type == CT_WORD)
       {
-         pc->type = CT_TYPE;
+         chunk_set_type(pc, CT_TYPE);
       }
       else if (chunk_is_star(pc))
       {
-         pc->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
       }
       else if (chunk_is_addr(pc))
       {
-         pc->type = CT_BYREF;
+         chunk_set_type(pc, CT_BYREF);
       }
    }
 }
@@ -112,8 +112,8 @@ static chunk_t *flag_parens(chunk_t *po, UINT32 flags,
 
       if (opentype != CT_NONE)
       {
-         po->type          = opentype;
-         paren_close->type = (c_token_t)(opentype + 1);
+         chunk_set_type(po, opentype);
+         chunk_set_type(paren_close, (c_token_t)(opentype + 1));
       }
 
       if (parenttype != CT_NONE)
@@ -219,19 +219,19 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
       {
          if (tmp->type == CT_STAR)
          {
-            tmp->type = CT_DEREF;
+            chunk_set_type(tmp, CT_DEREF);
          }
          else if (tmp->type == CT_AMP)
          {
-            tmp->type = CT_ADDR;
+            chunk_set_type(tmp, CT_ADDR);
          }
          else if (tmp->type == CT_MINUS)
          {
-            tmp->type = CT_NEG;
+            chunk_set_type(tmp, CT_NEG);
          }
          else if (tmp->type == CT_PLUS)
          {
-            tmp->type = CT_POS;
+            chunk_set_type(tmp, CT_POS);
          }
       }
 
@@ -293,12 +293,12 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
       }
       else
       {
-         pc->type = CT_QUALIFIER;
+         chunk_set_type(pc, CT_QUALIFIER);
       }
    }
 
    /* Objective C stuff */
-   if (cpd.lang_flags & LANG_OC)
+   if (cpd->lang_flags & LANG_OC)
    {
       /* Check for message declarations */
       if (pc->flags & PCF_STMT_START)
@@ -325,7 +325,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
    }
 
    /* C# stuff */
-   if (cpd.lang_flags & LANG_CS)
+   if (cpd->lang_flags & LANG_CS)
    {
       /* '[assembly: xxx]' stuff */
       if ((pc->flags & PCF_EXPR_START) &&
@@ -366,11 +366,11 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
 
    /* A [] in C# and D only follows a type */
    if ((pc->type == CT_TSQUARE) &&
-       ((cpd.lang_flags & (LANG_D | LANG_CS | LANG_VALA)) != 0))
+       ((cpd->lang_flags & (LANG_D | LANG_CS | LANG_VALA)) != 0))
    {
       if ((prev != NULL) && (prev->type == CT_WORD))
       {
-         prev->type = CT_TYPE;
+         chunk_set_type(prev, CT_TYPE);
       }
       if ((next != NULL) && (next->type == CT_WORD))
       {
@@ -466,7 +466,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
    {
       if (pc->type == CT_WORD)
       {
-         pc->type = CT_FUNCTION;
+         chunk_set_type(pc, CT_FUNCTION);
       }
       else if (pc->type == CT_TYPE)
       {
@@ -486,7 +486,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
          if ((tmp != NULL) && (tmp->type == CT_PAREN_OPEN))
          {
             /* we have "TYPE(...)(" */
-            pc->type = CT_FUNCTION;
+            chunk_set_type(pc, CT_FUNCTION);
          }
          else
          {
@@ -497,12 +497,12 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
                if ((tmp != NULL) && (tmp->type == CT_PAREN_CLOSE))
                {
                   /* we have TYPE() */
-                  pc->type = CT_FUNCTION;
+                  chunk_set_type(pc, CT_FUNCTION);
                }
                else
                {
                   /* we have TYPE(...) */
-                  pc->type = CT_CPP_CAST;
+                  chunk_set_type(pc, CT_CPP_CAST);
                   set_paren_parent(next, CT_CPP_CAST);
                }
             }
@@ -513,11 +513,11 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
          flag_parens(next, 0, CT_FPAREN_OPEN, CT_ATTRIBUTE, false);
       }
    }
-   if ((cpd.lang_flags & LANG_PAWN) != 0)
+   if ((cpd->lang_flags & LANG_PAWN) != 0)
    {
       if ((pc->type == CT_FUNCTION) && (pc->brace_level > 0))
       {
-         pc->type = CT_FUNC_CALL;
+         chunk_set_type(pc, CT_FUNC_CALL);
       }
       if ((pc->type == CT_STATE) &&
           (next != NULL) &&
@@ -539,7 +539,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
        ((prev->type == CT_COMMA) ||
         (prev->type == CT_BRACE_OPEN)))
    {
-      pc->type          = CT_C99_MEMBER;
+      chunk_set_type(pc, CT_C99_MEMBER);
       next->parent_type = CT_C99_MEMBER;
    }
 
@@ -617,7 +617,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
        chunk_is_str(pc, ")", 1) &&
        chunk_is_str(next, "(", 1))
    {
-      if ((cpd.lang_flags & LANG_D) != 0)
+      if ((cpd->lang_flags & LANG_D) != 0)
       {
          flag_parens(next, 0, CT_FPAREN_OPEN, CT_FUNC_CALL, false);
       }
@@ -631,7 +631,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
         (pc->type == CT_STRUCT)) &&
        (pc->level == pc->brace_level))
    {
-      if ((pc->type != CT_STRUCT) || ((cpd.lang_flags & LANG_C) == 0))
+      if ((pc->type != CT_STRUCT) || ((cpd->lang_flags & LANG_C) == 0))
       {
          mark_class_ctor(pc);
       }
@@ -649,7 +649,7 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
 
    /*TODO: Check for stuff that can only occur at the start of an statement */
 
-   if ((cpd.lang_flags & LANG_D) == 0)
+   if ((cpd->lang_flags & LANG_D) == 0)
    {
       /**
        * Check a paren pair to see if it is a cast.
@@ -683,25 +683,25 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
       /* Change STAR, MINUS, and PLUS in the easy cases */
       if (pc->type == CT_STAR)
       {
-         pc->type = (prev->type == CT_ANGLE_CLOSE) ? CT_PTR_TYPE : CT_DEREF;
+         chunk_set_type(pc, (prev->type == CT_ANGLE_CLOSE) ? CT_PTR_TYPE : CT_DEREF);
       }
       if (pc->type == CT_MINUS)
       {
-         pc->type = CT_NEG;
+         chunk_set_type(pc, CT_NEG);
       }
       if (pc->type == CT_PLUS)
       {
-         pc->type = CT_POS;
+         chunk_set_type(pc, CT_POS);
       }
       if (pc->type == CT_INCDEC_AFTER)
       {
-         pc->type = CT_INCDEC_BEFORE;
+         chunk_set_type(pc, CT_INCDEC_BEFORE);
          //fprintf(stderr, "%s: %d> changed INCDEC_AFTER to INCDEC_BEFORE\n", __func__, pc->orig_line);
       }
       if (pc->type == CT_AMP)
       {
          //fprintf(stderr, "Changed AMP to ADDR on line %d\n", pc->orig_line);
-         pc->type = CT_ADDR;
+         chunk_set_type(pc, CT_ADDR);
       }
    }
 
@@ -753,37 +753,37 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
    {
       if (chunk_is_paren_close(next))
       {
-         pc->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
       }
-      else if ((cpd.lang_flags & LANG_OC) && (next->type == CT_STAR))
+      else if ((cpd->lang_flags & LANG_OC) && (next->type == CT_STAR))
       {
          /* Change pointer-to-pointer types in OC_MSG_DECLs
           * from ARITH <===> DEREF to PTR_TYPE <===> PTR_TYPE */
-         pc->type        = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
          pc->parent_type = prev->parent_type;
 
-         next->type        = CT_PTR_TYPE;
+         chunk_set_type(next, CT_PTR_TYPE);
          next->parent_type = pc->parent_type;
       }
       else if ((prev->type == CT_SIZEOF) || (prev->type == CT_DELETE))
       {
-         pc->type = CT_DEREF;
+         chunk_set_type(pc, CT_DEREF);
       }
       else if (((prev->type == CT_WORD) && chunk_ends_type(prev)) ||
                (prev->type == CT_DC_MEMBER))
       {
-         pc->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
       }
       else
       {
          /* most PCF_PUNCTUATOR chunks except a paren close would make this
           * a deref. A paren close may end a cast or may be part of a macro fcn.
           */
-         pc->type = ((prev->flags & PCF_PUNCTUATOR) &&
-                     (!chunk_is_paren_close(prev) ||
-                      (prev->parent_type == CT_MACRO_FUNC)) &&
-                     (prev->type != CT_SQUARE_CLOSE) &&
-                     (prev->type != CT_DC_MEMBER)) ? CT_DEREF : CT_ARITH;
+         chunk_set_type(pc, ((prev->flags & PCF_PUNCTUATOR) &&
+                             (!chunk_is_paren_close(prev) ||
+                              (prev->parent_type == CT_MACRO_FUNC)) &&
+                             (prev->type != CT_SQUARE_CLOSE) &&
+                             (prev->type != CT_DC_MEMBER)) ? CT_DEREF : CT_ARITH);
       }
    }
 
@@ -791,11 +791,11 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
    {
       if (prev->type == CT_DELETE)
       {
-         pc->type = CT_DEREF;
+         chunk_set_type(pc, CT_DEREF);
       }
       else
       {
-         pc->type = CT_ARITH;
+         chunk_set_type(pc, CT_ARITH);
          if (prev->type == CT_WORD)
          {
             tmp = chunk_get_prev_ncnl(prev);
@@ -804,8 +804,8 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
                  (tmp->type == CT_BRACE_OPEN) ||
                  (tmp->type == CT_QUALIFIER)))
             {
-               prev->type   = CT_TYPE;
-               pc->type     = CT_ADDR;
+               chunk_set_type(prev, CT_TYPE);
+               chunk_set_type(pc, CT_ADDR);
                next->flags |= PCF_VAR_1ST;
             }
          }
@@ -817,15 +817,15 @@ void do_symbol_check(chunk_t *prev, chunk_t *pc, chunk_t *next)
    {
       if ((prev->type == CT_POS) || (prev->type == CT_NEG))
       {
-         pc->type = (pc->type == CT_MINUS) ? CT_NEG : CT_POS;
+         chunk_set_type(pc, (pc->type == CT_MINUS) ? CT_NEG : CT_POS);
       }
       else if (prev->type == CT_OC_CLASS)
       {
-         pc->type = (pc->type == CT_MINUS) ? CT_NEG : CT_POS;
+         chunk_set_type(pc, (pc->type == CT_MINUS) ? CT_NEG : CT_POS);
       }
       else
       {
-         pc->type = CT_ARITH;
+         chunk_set_type(pc, CT_ARITH);
       }
    }
 }
@@ -1032,7 +1032,7 @@ static void mark_function_type(chunk_t *pc)
       return;
    }
 
-   pc->type        = CT_PAREN_CLOSE;
+   chunk_set_type(pc, CT_PAREN_CLOSE);
    pc->parent_type = CT_NONE;
 
    /* Step backwards to the previous open paren and mark everything a
@@ -1042,8 +1042,8 @@ static void mark_function_type(chunk_t *pc)
    {
       if (*tmp->str == '(')
       {
-         tmp->flags      |= PCF_VAR_1ST_DEF;
-         tmp->type        = CT_PAREN_OPEN;
+         tmp->flags |= PCF_VAR_1ST_DEF;
+         chunk_set_type(tmp, CT_PAREN_OPEN);
          tmp->parent_type = CT_NONE;
 
          tmp = chunk_get_prev_ncnl(tmp);
@@ -1055,7 +1055,7 @@ static void mark_function_type(chunk_t *pc)
                 (tmp->type == CT_FUNC_DEF) ||
                 (tmp->type == CT_FUNC_PROTO))
             {
-               tmp->type   = CT_TYPE;
+               chunk_set_type(tmp, CT_TYPE);
                tmp->flags &= ~PCF_VAR_1ST_DEF;
             }
          }
@@ -1068,17 +1068,33 @@ static void mark_function_type(chunk_t *pc)
 static void process_returns(void)
 {
    chunk_t *pc;
+   chunk_t *end;
+   chunk_t *next;
+   chunk_t *tmp;
 
-   pc = chunk_get_head();
+   pc = chunk_first_of_type(CT_RETURN);
    while (pc != NULL)
    {
-      if ((pc->type != CT_RETURN) || (pc->flags & PCF_IN_PREPROC))
+      if (pc->flags & PCF_IN_PREPROC)
       {
-         pc = chunk_get_next_type(pc, CT_RETURN, -1);
+         pc = chunk_next_of_type(pc);
          continue;
       }
 
-      pc = process_return(pc);
+      end  = process_return(pc);
+      next = chunk_next_of_type(pc);
+
+      /* Carry on after what process_return() looked at, skipping any
+       * return in there
+       */
+      for (tmp = chunk_get_next(pc); (tmp != end) && (tmp != NULL); tmp = chunk_get_next(tmp))
+      {
+         if (tmp == next)
+         {
+            next = chunk_next_of_type(next);
+         }
+      }
+      pc = next;
    }
 }
 
@@ -1104,9 +1120,9 @@ static chunk_t *process_return(chunk_t *pc)
       return(next);
    }
 
-   if (cpd.settings[UO_nl_return_expr].a != AV_IGNORE)
+   if (cpd->settings[UO_nl_return_expr].a != AV_IGNORE)
    {
-      newline_iarf(pc, cpd.settings[UO_nl_return_expr].a);
+      newline_iarf(pc, cpd->settings[UO_nl_return_expr].a);
    }
 
    if (next->type == CT_PAREN_OPEN)
@@ -1116,7 +1132,7 @@ static chunk_t *process_return(chunk_t *pc)
       semi = chunk_get_next_ncnl(cpar);
       if (chunk_is_semicolon(semi))
       {
-         if (cpd.settings[UO_mod_paren_on_return].a == AV_REMOVE)
+         if (cpd->settings[UO_mod_paren_on_return].a == AV_REMOVE)
          {
             LOG_FMT(LRETURN, "%s: removing parens on line %d\n",
                     __func__, pc->orig_line);
@@ -1128,6 +1144,7 @@ static chunk_t *process_return(chunk_t *pc)
             }
 
             /* delete the parens */
+            output_lines_tie(next, cpar);
             chunk_del(next);
             chunk_del(cpar);
 
@@ -1150,7 +1167,7 @@ static chunk_t *process_return(chunk_t *pc)
    }
 
    /* We don't have a fully paren'd return. Should we add some? */
-   if ((cpd.settings[UO_mod_paren_on_return].a & AV_ADD) == 0)
+   if ((cpd->settings[UO_mod_paren_on_return].a & AV_ADD) == 0)
    {
       return(next);
    }
@@ -1499,7 +1516,7 @@ static void fix_enum_struct_union(chunk_t *pc)
       next->parent_type = pc->type;
       next = chunk_get_next_ncnl(next);
 
-      if (((cpd.lang_flags & LANG_PAWN) != 0) &&
+      if (((cpd->lang_flags & LANG_PAWN) != 0) &&
           (next->type == CT_PAREN_OPEN))
       {
          next = set_paren_parent(next, CT_ENUM);
@@ -1530,7 +1547,7 @@ static void fix_enum_struct_union(chunk_t *pc)
       return;
    }
 
-   if ((cpd.lang_flags & LANG_D) && !chunk_is_semicolon(next))
+   if ((cpd->lang_flags & LANG_D) && !chunk_is_semicolon(next))
    {
       next = pawn_add_vsemi_after(chunk_get_prev_ncnl(next));
    }
@@ -1548,7 +1565,7 @@ static void fix_enum_struct_union(chunk_t *pc)
 
       if (next->type == CT_STAR)
       {
-         next->type = CT_PTR_TYPE;
+         chunk_set_type(next, CT_PTR_TYPE);
       }
 
       /* If we hit a comma in a function param, we are done */
@@ -1603,7 +1620,7 @@ static void fix_typedef(chunk_t *start)
          {
             break;
          }
-         if ((cpd.lang_flags & LANG_D) && (next->type == CT_ASSIGN))
+         if ((cpd->lang_flags & LANG_D) && (next->type == CT_ASSIGN))
          {
             next->parent_type = CT_TYPEDEF;
             break;
@@ -1637,11 +1654,11 @@ static void fix_typedef(chunk_t *start)
                     the_type->len, the_type->str, the_type->orig_line);
 
             /* If we are aligning on the open paren, grab that instead */
-            if (cpd.settings[UO_align_typedef_func].n == 1)
+            if (cpd->settings[UO_align_typedef_func].n == 1)
             {
                the_type = open_paren;
             }
-            if (cpd.settings[UO_align_typedef_func].n != 0)
+            if (cpd->settings[UO_align_typedef_func].n != 0)
             {
                the_type->flags |= PCF_ANCHOR;
             }
@@ -1739,7 +1756,7 @@ void combine_labels(void)
          if (cur->type == CT_GOTO)
          {
             /* handle "goto case x;" */
-            next->type = CT_QUALIFIER;
+            chunk_set_type(next, CT_QUALIFIER);
          }
          else
          {
@@ -1750,19 +1767,19 @@ void combine_labels(void)
       {
          if (cur->type == CT_DEFAULT)
          {
-            cur->type = CT_CASE;
-            hit_case  = true;
+            chunk_set_type(cur, CT_CASE);
+            hit_case = true;
          }
          if (question_count > 0)
          {
-            next->type = CT_COND_COLON;
+            chunk_set_type(next, CT_COND_COLON);
             question_count--;
          }
          else if (hit_case)
          {
-            hit_case   = false;
-            next->type = CT_CASE_COLON;
-            tmp        = chunk_get_next_ncnl(next);
+            hit_case = false;
+            chunk_set_type(next, CT_CASE_COLON);
+            tmp = chunk_get_next_ncnl(next);
             if ((tmp != NULL) && (tmp->type == CT_BRACE_OPEN))
             {
                tmp->parent_type = CT_CASE;
@@ -1777,7 +1794,7 @@ void combine_labels(void)
          {
             chunk_t *nextprev = chunk_get_prev_ncnl(next);
 
-            if ((cpd.lang_flags & LANG_PAWN) != 0)
+            if ((cpd->lang_flags & LANG_PAWN) != 0)
             {
                if ((cur->type == CT_WORD) ||
                    (cur->type == CT_BRACE_CLOSE))
@@ -1787,33 +1804,33 @@ void combine_labels(void)
                   tmp = chunk_get_next_nc(next);
                   if (chunk_is_newline(prev) && chunk_is_newline(tmp))
                   {
-                     new_type   = CT_LABEL;
-                     next->type = CT_LABEL_COLON;
+                     new_type = CT_LABEL;
+                     chunk_set_type(next, CT_LABEL_COLON);
                   }
                   else
                   {
-                     next->type = CT_TAG_COLON;
+                     chunk_set_type(next, CT_TAG_COLON);
                   }
                   if (cur->type == CT_WORD)
                   {
-                     cur->type = new_type;
+                     chunk_set_type(cur, new_type);
                   }
                }
             }
             else if (next->flags & PCF_IN_ARRAY_ASSIGN)
             {
-               next->type = CT_D_ARRAY_COLON;
+               chunk_set_type(next, CT_D_ARRAY_COLON);
             }
             else if (cur->type == CT_WORD)
             {
                if (chunk_is_newline(prev))
                {
-                  cur->type  = CT_LABEL;
-                  next->type = CT_LABEL_COLON;
+                  chunk_set_type(cur, CT_LABEL);
+                  chunk_set_type(next, CT_LABEL_COLON);
                }
                else
                {
-                  next->type = CT_BIT_COLON;
+                  chunk_set_type(next, CT_BIT_COLON);
 
                   tmp = chunk_get_next(next);
                   while ((tmp = chunk_get_next(tmp)) != NULL)
@@ -1824,7 +1841,7 @@ void combine_labels(void)
                      }
                      if (tmp->type == CT_COLON)
                      {
-                        tmp->type = CT_BIT_COLON;
+                        chunk_set_type(tmp, CT_BIT_COLON);
                      }
                   }
                }
@@ -1832,7 +1849,7 @@ void combine_labels(void)
             else if (nextprev->type == CT_FPAREN_CLOSE)
             {
                /* it's a class colon */
-               next->type = CT_CLASS_COLON;
+               chunk_set_type(next, CT_CLASS_COLON);
             }
             else if (next->level > next->brace_level)
             {
@@ -1865,11 +1882,11 @@ void combine_labels(void)
                else
                {
                   LOG_FMT(LWARN, "%s:%d unexpected colon in col %d n-parent=%s c-parent=%s l=%d bl=%d\n",
-                          cpd.filename, next->orig_line, next->orig_col,
+                          cpd->filename, next->orig_line, next->orig_col,
                           get_token_name(next->parent_type),
                           get_token_name(cur->parent_type),
                           next->level, next->brace_level);
-                  cpd.error_count++;
+                  cpd->error_count++;
                }
             }
          }
@@ -1896,7 +1913,7 @@ static void mark_variable_stack(ChunkStack& cs, log_sev_t sev)
       while ((word_type = cs.Pop()) != NULL)
       {
          LOG_FMT(LFCNP, " <%.*s>", word_type->len, word_type->str);
-         word_type->type   = CT_TYPE;
+         chunk_set_type(word_type, CT_TYPE);
          word_type->flags |= PCF_VAR_TYPE;
       }
 
@@ -1947,11 +1964,11 @@ static void fix_fcn_def_params(chunk_t *start)
       }
       if (chunk_is_star(pc))
       {
-         pc->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
       }
       else if (pc->type == CT_AMP)
       {
-         pc->type = CT_BYREF;
+         chunk_set_type(pc, CT_BYREF);
       }
       else if ((pc->type == CT_WORD) || (pc->type == CT_TYPE))
       {
@@ -2159,11 +2176,11 @@ static chunk_t *mark_variable_definition(chunk_t *start)
       }
       else if (chunk_is_star(pc))
       {
-         pc->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_PTR_TYPE);
       }
       else if (chunk_is_addr(pc))
       {
-         pc->type = CT_BYREF;
+         chunk_set_type(pc, CT_BYREF);
       }
       else if ((pc->type == CT_SQUARE_OPEN) || (pc->type == CT_ASSIGN))
       {
@@ -2315,9 +2332,9 @@ static void mark_function(chunk_t *pc)
       pc_op = chunk_get_prev_type(pc, CT_OPERATOR, pc->level);
       if ((pc_op != NULL) && (pc_op->flags & PCF_EXPR_START))
       {
-         pc->type = CT_FUNC_CALL;
+         chunk_set_type(pc, CT_FUNC_CALL);
       }
-      if (cpd.lang_flags & LANG_CPP)
+      if (cpd->lang_flags & LANG_CPP)
       {
          tmp = pc;
          while ((tmp = chunk_get_prev_ncnl(tmp)) != NULL)
@@ -2328,19 +2345,19 @@ static void mark_function(chunk_t *pc)
             }
             if (tmp->type == CT_TEMPLATE)
             {
-               pc->type = CT_FUNC_DEF;
+               chunk_set_type(pc, CT_FUNC_DEF);
                break;
             }
             if (tmp->type == CT_BRACE_OPEN)
             {
                if (tmp->parent_type == CT_FUNC_DEF)
                {
-                  pc->type = CT_FUNC_CALL;
+                  chunk_set_type(pc, CT_FUNC_CALL);
                }
                if ((tmp->parent_type == CT_CLASS) ||
                    (tmp->parent_type == CT_STRUCT))
                {
-                  pc->type = CT_FUNC_DEF;
+                  chunk_set_type(pc, CT_FUNC_DEF);
                }
                break;
             }
@@ -2362,7 +2379,7 @@ static void mark_function(chunk_t *pc)
 
    if (pc->flags & PCF_IN_CONST_ARGS)
    {
-      pc->type = CT_FUNC_CTOR_VAR;
+      chunk_set_type(pc, CT_FUNC_CTOR_VAR);
       LOG_FMT(LFCN, "  1) Marked [%.*s] as FUNC_CTOR_VAR on line %d col %d\n",
               pc->len, pc->str, pc->orig_line, pc->orig_col);
       next = skip_template_next(next);
@@ -2434,8 +2451,8 @@ static void mark_function(chunk_t *pc)
                     __func__, pc->orig_line, pc->orig_col, pc->len, pc->str);
          }
 
-         pc->type   = CT_TYPE;
-         tmp1->type = CT_PTR_TYPE;
+         chunk_set_type(pc, CT_TYPE);
+         chunk_set_type(tmp1, CT_PTR_TYPE);
          pc->flags &= ~PCF_VAR_1ST_DEF;
          if (tmp2 != NULL)
          {
@@ -2453,7 +2470,7 @@ static void mark_function(chunk_t *pc)
    /* Assume it is a function call if not already labeled */
    if (pc->type == CT_FUNCTION)
    {
-      pc->type = (pc->parent_type == CT_OPERATOR) ? CT_FUNC_DEF : CT_FUNC_CALL;
+      chunk_set_type(pc, (pc->parent_type == CT_OPERATOR) ? CT_FUNC_DEF : CT_FUNC_CALL);
    }
 
    /* Check for C++ function def */
@@ -2465,8 +2482,8 @@ static void mark_function(chunk_t *pc)
       if (prev->type == CT_INV)
       {
          /* TODO: do we care that this is the destructor? */
-         prev->type = CT_DESTRUCTOR;
-         pc->type   = CT_FUNC_CLASS;
+         chunk_set_type(prev, CT_DESTRUCTOR);
+         chunk_set_type(pc, CT_FUNC_CLASS);
 
          destr = prev;
          prev  = chunk_get_prev_ncnlnp(prev);
@@ -2486,10 +2503,10 @@ static void mark_function(chunk_t *pc)
          {
             if ((pc->len == prev->len) && (memcmp(pc->str, prev->str, pc->len) == 0))
             {
-               pc->type = CT_FUNC_CLASS;
+               chunk_set_type(pc, CT_FUNC_CLASS);
                if (destr != NULL)
                {
-                  destr->type = CT_DESTRUCTOR;
+                  chunk_set_type(destr, CT_DESTRUCTOR);
                }
                LOG_FMT(LFCN, "FOUND %sSTRUCTOR for %.*s[%s]\n",
                        (destr != NULL) ? "DE" : "CON",
@@ -2632,7 +2649,7 @@ static void mark_function(chunk_t *pc)
       }
       if (isa_def)
       {
-         pc->type = CT_FUNC_DEF;
+         chunk_set_type(pc, CT_FUNC_DEF);
          LOG_FMT(LFCN, "%s: '%.*s' is FCN_DEF:", __func__, pc->len, pc->str);
          if (prev == NULL)
          {
@@ -2675,7 +2692,7 @@ static void mark_function(chunk_t *pc)
       if (tmp->level < pc->level)
       {
          /* No semicolon - probably a function call? */
-         pc->type = CT_FUNC_CALL;
+         chunk_set_type(pc, CT_FUNC_CALL);
          break;
       }
       else if (tmp->level == pc->level)
@@ -2688,13 +2705,13 @@ static void mark_function(chunk_t *pc)
          else if (chunk_is_semicolon(tmp))
          {
             /* Set the parent for the semi for later */
-            semi     = tmp;
-            pc->type = CT_FUNC_PROTO;
+            semi = tmp;
+            chunk_set_type(pc, CT_FUNC_PROTO);
             break;
          }
          else if (pc->type == CT_COMMA)
          {
-            pc->type = CT_FUNC_CTOR_VAR;
+            chunk_set_type(pc, CT_FUNC_CTOR_VAR);
             LOG_FMT(LFCN, "  2) Marked [%.*s] as FUNC_CTOR_VAR on line %d col %d\n",
                     pc->len, pc->str, pc->orig_line, pc->orig_col);
             break;
@@ -2702,7 +2719,7 @@ static void mark_function(chunk_t *pc)
          else if (chunk_is_str(tmp, ":", 1))
          {
             /* mark constuctor colon (?) */
-            tmp->type = CT_CLASS_COLON;
+            chunk_set_type(tmp, CT_CLASS_COLON);
          }
       }
    }
@@ -2716,7 +2733,7 @@ static void mark_function(chunk_t *pc)
     * We search backwards and checking the parent of the containing open braces.
     * If the parent is a class or namespace, then it probably is a prototype.
     */
-   if ((cpd.lang_flags & LANG_CPP) &&
+   if ((cpd->lang_flags & LANG_CPP) &&
        (pc->type == CT_FUNC_PROTO) &&
        (pc->parent_type != CT_OPERATOR))
    {
@@ -2758,7 +2775,7 @@ static void mark_function(chunk_t *pc)
       }
       if (!is_param)
       {
-         pc->type = CT_FUNC_CTOR_VAR;
+         chunk_set_type(pc, CT_FUNC_CTOR_VAR);
          LOG_FMT(LFCN, "  3) Marked [%.*s] as FUNC_CTOR_VAR on line %d col %d\n",
                  pc->len, pc->str, pc->orig_line, pc->orig_col);
       }
@@ -2780,7 +2797,7 @@ static void mark_function(chunk_t *pc)
                    (p_op->parent_type != CT_STRUCT) &&
                    (p_op->parent_type != CT_NAMESPACE))
                {
-                  pc->type = CT_FUNC_CTOR_VAR;
+                  chunk_set_type(pc, CT_FUNC_CTOR_VAR);
                   LOG_FMT(LFCN, "  4) Marked [%.*s] as FUNC_CTOR_VAR on line %d col %d\n",
                           pc->len, pc->str, pc->orig_line, pc->orig_col);
                }
@@ -2870,7 +2887,7 @@ static void mark_cpp_constructor(chunk_t *pc)
    if (!chunk_is_str(paren_open, "(", 1))
    {
       LOG_FMT(LWARN, "%s:%d Expected '(', got: [%.*s]\n",
-              cpd.filename, paren_open->orig_line,
+              cpd->filename, paren_open->orig_line,
               paren_open->len, paren_open->str);
       return;
    }
@@ -2890,7 +2907,7 @@ static void mark_cpp_constructor(chunk_t *pc)
       tmp         = chunk_get_next_ncnl(tmp);
       if (chunk_is_str(tmp, ":", 1))
       {
-         tmp->type = CT_CLASS_COLON;
+         chunk_set_type(tmp, CT_CLASS_COLON);
       }
    }
    if ((tmp != NULL) && (tmp->type == CT_BRACE_OPEN))
@@ -2933,7 +2950,7 @@ static void mark_class_ctor(chunk_t *start)
 
       if (chunk_is_str(pc, ":", 1))
       {
-         pc->type = CT_CLASS_COLON;
+         chunk_set_type(pc, CT_CLASS_COLON);
          LOG_FMT(LFTOR, "%s: class colon on line %d\n",
                  __func__, pc->orig_line);
       }
@@ -2977,7 +2994,7 @@ static void mark_class_ctor(chunk_t *start)
           (pc->len == pclass->len) &&
           (memcmp(pc->str, pclass->str, pc->len) == 0))
       {
-         pc->type = CT_FUNC_CLASS;
+         chunk_set_type(pc, CT_FUNC_CLASS);
          LOG_FMT(LFTOR, "%d] Marked CTor/DTor %.*s\n", pc->orig_line, pc->len, pc->str);
          mark_cpp_constructor(pc);
       }
@@ -3003,12 +3020,12 @@ static void mark_namespace(chunk_t *pns)
       }
       if ((pc != NULL) && (pc->type == CT_BRACE_OPEN))
       {
-         if ((cpd.settings[UO_indent_namespace_limit].n > 0) &&
+         if ((cpd->settings[UO_indent_namespace_limit].n > 0) &&
              ((br_close = chunk_skip_to_match(pc)) != NULL))
          {
             int diff = br_close->orig_line - pc->orig_line;
 
-            if (diff > cpd.settings[UO_indent_namespace_limit].n)
+            if (diff > cpd->settings[UO_indent_namespace_limit].n)
             {
                pc->flags       |= PCF_LONG_BLOCK;
                br_close->flags |= PCF_LONG_BLOCK;
@@ -3244,7 +3261,7 @@ static void handle_template(chunk_t *pc)
       if ((tmp->type == CT_CLASS) ||
           (tmp->type == CT_STRUCT))
       {
-         tmp->type = CT_TYPE;
+         chunk_set_type(tmp, CT_TYPE);
       }
       else if ((tmp->type == CT_ANGLE_CLOSE) && (tmp->level == level))
       {
@@ -3296,7 +3313,7 @@ static void mark_template_func(chunk_t *pc, chunk_t *pc_next)
          {
             LOG_FMT(LTEMPFUNC, "%s: marking '%.*s' in line %d as a FUNC_CALL\n",
                     __func__, pc->len, pc->str, pc->orig_line);
-            pc->type = CT_FUNC_CALL;
+            chunk_set_type(pc, CT_FUNC_CALL);
             flag_parens(after, PCF_IN_FCN_CALL, CT_FPAREN_OPEN, CT_FUNC_CALL, false);
          }
          else
@@ -3311,14 +3328,14 @@ static void mark_template_func(chunk_t *pc, chunk_t *pc_next)
             LOG_FMT(LTEMPFUNC, "%s: marking '%.*s' in line %d as a FUNC_CALL\n",
                     __func__, pc->len, pc->str, pc->orig_line);
             // its a function!!!
-            pc->type = CT_FUNC_CALL;
+            chunk_set_type(pc, CT_FUNC_CALL);
             mark_function(pc);
          }
       }
       else if (after->type == CT_WORD)
       {
          // its a type!
-         pc->type      = CT_TYPE;
+         chunk_set_type(pc, CT_TYPE);
          pc->flags    |= PCF_VAR_TYPE;
          after->flags |= PCF_VAR_DEF;
       }
@@ -3340,7 +3357,7 @@ static void mark_exec_sql(chunk_t *pc)
       tmp->parent_type = pc->type;
       if (tmp->type == CT_WORD)
       {
-         tmp->type = CT_SQL_WORD;
+         chunk_set_type(tmp, CT_SQL_WORD);
       }
       if (tmp->type == CT_SEMICOLON)
       {
@@ -3459,7 +3476,7 @@ static void handle_oc_class(chunk_t *pc)
       }
       else if (tmp->type == CT_COLON)
       {
-         tmp->type        = CT_CLASS_COLON;
+         chunk_set_type(tmp, CT_CLASS_COLON);
          tmp->parent_type = CT_OC_CLASS;
       }
       else if (chunk_is_str(tmp, "-", 1) || chunk_is_str(tmp, "+", 1))
@@ -3503,7 +3520,7 @@ static void handle_oc_block(chunk_t *pc)
    {
       /* mark block declaration, e.g.: return_t (^name)(args) */
       prev->parent_type = pc->parent_type;
-      prev->type        = CT_PAREN_OPEN; /* reset FPAREN to PAREN */
+      chunk_set_type(prev, CT_PAREN_OPEN); /* reset FPAREN to PAREN */
 
       tmp = chunk_get_next(pc);
       if (tmp != NULL)
@@ -3511,7 +3528,7 @@ static void handle_oc_block(chunk_t *pc)
          if ((tmp->type != CT_PAREN_CLOSE) &&
              (tmp->type != CT_FPAREN_CLOSE))
          {
-            tmp->type        = CT_TYPE;
+            chunk_set_type(tmp, CT_TYPE);
             tmp->flags      |= PCF_STMT_START;
             tmp->parent_type = pc->parent_type;
 
@@ -3528,7 +3545,7 @@ static void handle_oc_block(chunk_t *pc)
                    ((tmp->next->type == CT_PAREN_OPEN) ||
                     (tmp->next->type == CT_FPAREN_OPEN)))
                {
-                  tmp->type = CT_PAREN_CLOSE;
+                  chunk_set_type(tmp, CT_PAREN_CLOSE);
                   tmp->next->parent_type = pc->parent_type;
                   break;
                }
@@ -3560,7 +3577,7 @@ static void handle_oc_block(chunk_t *pc)
          }
          else
          {
-            tmp->type        = CT_PAREN_CLOSE;
+            chunk_set_type(tmp, CT_PAREN_CLOSE);
             tmp->parent_type = CT_OC_BLOCK_TYPE;
          }
       }
@@ -3609,7 +3626,7 @@ static void handle_oc_block(chunk_t *pc)
             {
                pc->parent_type  = CT_OC_BLOCK_EXPR;
                tmp->parent_type = CT_OC_BLOCK_EXPR;
-               tmp->type        = CT_TYPE; /* the first word is definately a type */
+               chunk_set_type(tmp, CT_TYPE); /* the first word is definately a type */
 
                /* skip over return type until open paren */
                while ((tmp = chunk_get_next(tmp)) != NULL)
@@ -3708,7 +3725,7 @@ static void handle_oc_message_decl(chunk_t *pc)
    {
       return;
    }
-   pc->type        = CT_OC_SCOPE;
+   chunk_set_type(pc, CT_OC_SCOPE);
    pc->parent_type = pt;
 
    /* Mark everything */
@@ -3749,12 +3766,12 @@ static void handle_oc_message_decl(chunk_t *pc)
       {
          if (in_paren)
          {
-            tmp->type        = CT_TYPE;
+            chunk_set_type(tmp, CT_TYPE);
             tmp->parent_type = pt;
          }
          else if (paren_cnt == 1)
          {
-            tmp->type = pt;
+            chunk_set_type(tmp, pt);
          }
          else
          {
@@ -3763,7 +3780,7 @@ static void handle_oc_message_decl(chunk_t *pc)
       }
       else if (tmp->type == CT_COLON)
       {
-         tmp->type        = CT_OC_COLON;
+         chunk_set_type(tmp, CT_OC_COLON);
          tmp->parent_type = pt;
       }
    }
@@ -3817,7 +3834,7 @@ static void handle_oc_message_send(chunk_t *os)
       tmp->flags |= PCF_DONT_INDENT;
       if (tmp->type == CT_COLON)
       {
-         tmp->type = CT_OC_COLON;
+         chunk_set_type(tmp, CT_OC_COLON);
       }
    }
 }
@@ -3856,7 +3873,7 @@ static void handle_cs_square_stmt(chunk_t *os)
       tmp->parent_type = CT_CS_SQ_STMT;
       if (tmp->type == CT_COLON)
       {
-         tmp->type = CT_CS_SQ_COLON;
+         chunk_set_type(tmp, CT_CS_SQ_COLON);
       }
    }
 
@@ -3887,7 +3904,7 @@ static void handle_cs_property(chunk_t *bro)
       {
          if (!did_prop && ((pc->type == CT_WORD) || (pc->type == CT_THIS)))
          {
-            pc->type = CT_CS_PROPERTY;
+            chunk_set_type(pc, CT_CS_PROPERTY);
             did_prop = true;
          }
          else
@@ -3953,22 +3970,22 @@ static void handle_wrap(chunk_t *pc)
    char    *new_name;
 
    argval_t av = (pc->type == CT_FUNC_WRAP) ?
-                 cpd.settings[UO_sp_inside_fparen].a :
-                 cpd.settings[UO_sp_inside_paren_cast].a;
+                 cpd->settings[UO_sp_inside_fparen].a :
+                 cpd->settings[UO_sp_inside_paren_cast].a;
 
    if ((clp != NULL) &&
        (opp->type == CT_PAREN_OPEN) &&
        ((name->type == CT_WORD) || (name->type == CT_TYPE)) &&
        (clp->type == CT_PAREN_CLOSE))
    {
-      new_name = new char[pc->len + 2 + name->len + 2];
+      new_name = new char[pc->len + 3 + name->len + 2];
       if (new_name != NULL)
       {
          const char *fsp = (av & AV_ADD) ? " " : "";
 
          sprintf(new_name, "%.*s(%s%.*s%s)",
                  pc->len, pc->str, fsp, name->len, name->str, fsp);
-         pc->type   = (pc->type == CT_FUNC_WRAP) ? CT_FUNCTION : CT_TYPE;
+         chunk_set_type(pc, (pc->type == CT_FUNC_WRAP) ? CT_FUNCTION : CT_TYPE);
          pc->str    = new_name;
          pc->len    = strlen(new_name);
          pc->flags |= PCF_OWN_STR;
@@ -106,8 +106,8 @@ static bool d_parse_string(chunk_t *pc)
 
       if (pc->len > 1)
       {
-         pc->type    = CT_STRING;
-         cpd.column += pc->len;
+         pc->type     = CT_STRING;
+         cpd->column += pc->len;
          return(true);
       }
    }
@@ -15,13 +15,6 @@
 #include "chunk_list.h"
 #include "prototypes.h"
 
-typedef struct
-{
-   define_tag_t *p_tags;
-   int          total;            /* number of items at p_tags */
-   int          active;           /* number of valid entries */
-} define_list_t;
-static define_list_t dl;
 
 
 /**
@@ -48,11 +41,11 @@ static int def_compare(const void *p1, const void *p2)
 void add_define(const char *tag, const char *value)
 {
    /* Update existing entry */
-   if (dl.active > 0)
+   if (cpd->defines.active > 0)
    {
       define_tag_t *p_ret;
 
-      p_ret = (define_tag_t *)bsearch(&tag, dl.p_tags, dl.active,
+      p_ret = (define_tag_t *)bsearch(&tag, cpd->defines.p_tags, cpd->defines.active,
                                       sizeof(define_tag_t), def_compare);
       if (p_ret != NULL)
       {
@@ -62,38 +55,38 @@ void add_define(const char *tag, const char *value)
          }
          if ((value == NULL) || (*value == 0))
          {
-            dl.p_tags[dl.active].value = "";
+            cpd->defines.p_tags[cpd->defines.active].value = "";
          }
          else
          {
-            dl.p_tags[dl.active].value = strdup(value);
+            cpd->defines.p_tags[cpd->defines.active].value = strdup(value);
          }
          return;
       }
    }
 
    /* need to add it to the list: do we need to allocate more memory? */
-   if ((dl.total == dl.active) || (dl.p_tags == NULL))
+   if ((cpd->defines.total == cpd->defines.active) || (cpd->defines.p_tags == NULL))
    {
-      dl.total += 16;
-      dl.p_tags = (define_tag_t *)realloc(dl.p_tags, sizeof(define_tag_t) * dl.total);
+      cpd->defines.total += 16;
+      cpd->defines.p_tags = (define_tag_t *)realloc(cpd->defines.p_tags, sizeof(define_tag_t) * cpd->defines.total);
    }
-   if (dl.p_tags != NULL)
+   if (cpd->defines.p_tags != NULL)
    {
       /* add to the end of the list */
-      dl.p_tags[dl.active].tag = strdup(tag);
+      cpd->defines.p_tags[cpd->defines.active].tag = strdup(tag);
       if ((value == NULL) || (*value == 0))
       {
-         dl.p_tags[dl.active].value = "";
+         cpd->defines.p_tags[cpd->defines.active].value = "";
       }
       else
       {
-         dl.p_tags[dl.active].value = strdup(value);
+         cpd->defines.p_tags[cpd->defines.active].value = strdup(value);
       }
-      dl.active++;
+      cpd->defines.active++;
 
       /* Todo: add in sorted order instead of resorting the whole list? */
-      qsort(dl.p_tags, dl.active, sizeof(define_tag_t), def_compare);
+      qsort(cpd->defines.p_tags, cpd->defines.active, sizeof(define_tag_t), def_compare);
 
       LOG_FMT(LDEFVAL, "%s: added '%s' = '%s'\n",
               __func__, tag, value ? value : "NULL");
@@ -126,7 +119,7 @@ const define_tag_t *find_define(const char *word, int len)
    tag.tag = buf;
 
    /* check the dynamic word list first */
-   p_ret = (const define_tag_t *)bsearch(&tag, dl.p_tags, dl.active,
+   p_ret = (const define_tag_t *)bsearch(&tag, cpd->defines.p_tags, cpd->defines.active,
                                          sizeof(define_tag_t), def_compare);
    return(p_ret);
 }
@@ -152,7 +145,7 @@ int load_define_file(const char *filename)
    {
       LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
               __func__, filename, strerror(errno), errno);
-      cpd.error_count++;
+      cpd->error_count++;
       return(FAILURE);
    }
 
@@ -180,7 +173,7 @@ int load_define_file(const char *filename)
          {
             LOG_FMT(LWARN, "%s: line %d invalid (starts with '%s')\n",
                     filename, line_no, args[0]);
-            cpd.error_count++;
+            cpd->error_count++;
          }
       }
    }
@@ -194,19 +187,19 @@ void output_defines(FILE *pfile)
 {
    int idx;
 
-   if (dl.active > 0)
+   if (cpd->defines.active > 0)
    {
       fprintf(pfile, "-== User Defines ==-\n");
    }
-   for (idx = 0; idx < dl.active; idx++)
+   for (idx = 0; idx < cpd->defines.active; idx++)
    {
-      if (*dl.p_tags[idx].value != 0)
+      if (*cpd->defines.p_tags[idx].value != 0)
       {
-         fprintf(pfile, "%s = %s\n", dl.p_tags[idx].tag, dl.p_tags[idx].value);
+         fprintf(pfile, "%s = %s\n", cpd->defines.p_tags[idx].tag, cpd->defines.p_tags[idx].value);
       }
       else
       {
-         fprintf(pfile, "%s\n", dl.p_tags[idx].tag);
+         fprintf(pfile, "%s\n", cpd->defines.p_tags[idx].tag);
       }
    }
 }
@@ -216,9 +209,9 @@ const define_tag_t *get_define_idx(int& idx)
 {
    const define_tag_t *dt = NULL;
 
-   if ((idx >= 0) && (idx < dl.active))
+   if ((idx >= 0) && (idx < cpd->defines.active))
    {
-      dt = &dl.p_tags[idx];
+      dt = &cpd->defines.p_tags[idx];
    }
    idx++;
    return(dt);
@@ -227,23 +220,23 @@ const define_tag_t *get_define_idx(int& idx)
 
 void clear_defines(void)
 {
-   if (dl.p_tags != NULL)
+   if (cpd->defines.p_tags != NULL)
    {
-      for (int idx = 0; idx < dl.active; idx++)
+      for (int idx = 0; idx < cpd->defines.active; idx++)
       {
-         free((void *)dl.p_tags[idx].tag);
-         dl.p_tags[idx].tag = NULL;
-         if (dl.p_tags[idx].value != NULL)
+         free((void *)cpd->defines.p_tags[idx].tag);
+         cpd->defines.p_tags[idx].tag = NULL;
+         if (cpd->defines.p_tags[idx].value != NULL)
          {
-            free((void *)dl.p_tags[idx].value);
-            dl.p_tags[idx].value = NULL;
+            free((void *)cpd->defines.p_tags[idx].value);
+            cpd->defines.p_tags[idx].value = NULL;
          }
       }
-      free(dl.p_tags);
-      dl.p_tags = NULL;
+      free(cpd->defines.p_tags);
+      cpd->defines.p_tags = NULL;
    }
-   dl.total  = 0;
-   dl.active = 0;
+   cpd->defines.total  = 0;
+   cpd->defines.active = 0;
 }
 
 
@@ -374,11 +367,11 @@ void add_long_preprocessor_conditional_block_comment(void)
 
                if (br_close->type == CT_PP_ENDIF)
                {
-                  nl_min = cpd.settings[UO_mod_add_long_ifdef_endif_comment].n;
+                  nl_min = cpd->settings[UO_mod_add_long_ifdef_endif_comment].n;
                }
                else
                {
-                  nl_min = cpd.settings[UO_mod_add_long_ifdef_else_comment].n;
+                  nl_min = cpd->settings[UO_mod_add_long_ifdef_else_comment].n;
                }
 
                LOG_FMT(LPPIF, "#if / %s section candidate for augmenting when over NL threshold %d != 0 (nl_count=%d)\n",
@@ -388,7 +381,7 @@ void add_long_preprocessor_conditional_block_comment(void)
                if ((nl_min > 0) && (nl_count > nl_min)) /* nl_count is 1 too large at all times as #if line was counted too */
                {
                   /* determine the added comment style */
-                  c_token_t style = (cpd.lang_flags & (LANG_CPP | LANG_CS)) ?
+                  c_token_t style = (cpd->lang_flags & (LANG_CPP | LANG_CS)) ?
                                     CT_COMMENT_CPP : CT_COMMENT;
 
                   std::string str;
@@ -90,7 +90,7 @@ sp_votes::~sp_votes()
 }
 
 
-#define SP_VOTE_VAR(x)    sp_votes vote_ ## x(cpd.settings[UO_ ## x].a)
+#define SP_VOTE_VAR(x)    sp_votes vote_ ## x(cpd->settings[UO_ ## x].a)
 
 /**
  * Detect spacing options
@@ -0,0 +1,528 @@
+/**
+ * @file diff.cpp
+ * Line diffs between a file and its formatted text, for --diff.
+ * The lines are matched with the O(ND) algorithm from Eugene Myers' paper
+ * "An O(ND) Difference Algorithm and Its Variations", using the linear space
+ * version that splits at the middle snake.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "diff.h"
+#include "base_types.h"
+#include <cstring>
+#include <climits>
+#include <vector>
+
+/* Lines of context around each change in a unified diff */
+#define DIFF_CONTEXT    3
+
+struct diff_line
+{
+   const char *text;
+   int        len;     /* with the line end, if there is one */
+   UINT32     hash;
+};
+
+/**
+ * A run of lines in the old text that is replaced by a run of lines in the
+ * new text. Either run may be empty.
+ */
+struct diff_edit
+{
+   int old_first;
+   int old_count;
+   int new_first;
+   int new_count;
+};
+
+struct diff_ctx
+{
+   std::vector<diff_line> old_lines;
+   std::vector<diff_line> new_lines;
+   std::vector<char>      old_del;   /* the old line isn't in the new text */
+   std::vector<char>      new_ins;   /* the new line isn't in the old text */
+   std::vector<int>       fwd;       /* furthest x on each diagonal, forward */
+   std::vector<int>       bwd;       /* furthest x on each diagonal, backward */
+   int                    *fd;       /* fwd, indexed by the diagonal x - y */
+   int                    *bd;
+   int                    too_expensive;
+};
+
+
+static void diff_split(const char *text, int len, std::vector<diff_line>& lines)
+{
+   diff_line line;
+   int       start = 0;
+
+   for (int idx = 0; idx <= len; idx++)
+   {
+      if ((idx == len) ? (start < len) : (text[idx] == '\n'))
+      {
+         int end = (idx == len) ? len : idx + 1;
+
+         /* FNV-1a */
+         line.text = &text[start];
+         line.len  = end - start;
+         line.hash = 2166136261u;
+         for (int pos = start; pos < end; pos++)
+         {
+            line.hash = (line.hash ^ (unsigned char)text[pos]) * 16777619u;
+         }
+         lines.push_back(line);
+         start = end;
+      }
+   }
+}
+
+
+static bool diff_same(const diff_ctx& ctx, int old_idx, int new_idx)
+{
+   const diff_line& ol = ctx.old_lines[old_idx];
+   const diff_line& nl = ctx.new_lines[new_idx];
+
+   return((ol.hash == nl.hash) && (ol.len == nl.len) &&
+          (memcmp(ol.text, nl.text, ol.len) == 0));
+}
+
+
+/**
+ * Finds where the shortest edit script from old[xoff, xlim) to
+ * new[yoff, ylim) crosses its middle. Neither range is empty and the first
+ * and last lines differ.
+ * If that takes too long, the furthest point reached is used instead, which
+ * gives a valid diff that may not be the shortest.
+ */
+static void diff_split_point(diff_ctx& ctx, int xoff, int xlim, int yoff, int ylim,
+                             int& xmid, int& ymid)
+{
+   int  *fd  = ctx.fd;
+   int  *bd  = ctx.bd;
+   int  dmin = xoff - ylim;
+   int  dmax = xlim - yoff;
+   int  fmid = xoff - yoff;
+   int  bmid = xlim - ylim;
+   int  fmin = fmid, fmax = fmid;
+   int  bmin = bmid, bmax = bmid;
+   bool odd  = ((fmid - bmid) & 1) != 0;
+   int  cost;
+   int  d, x, y;
+
+   fd[fmid] = xoff;
+   bd[bmid] = xlim;
+
+   for (cost = 1; ; cost++)
+   {
+      /* Take one more step forward on each diagonal */
+      if (fmin > dmin)
+      {
+         fd[--fmin - 1] = -1;
+      }
+      else
+      {
+         fmin++;
+      }
+      if (fmax < dmax)
+      {
+         fd[++fmax + 1] = -1;
+      }
+      else
+      {
+         fmax--;
+      }
+      for (d = fmax; d >= fmin; d -= 2)
+      {
+         x = (fd[d - 1] >= fd[d + 1]) ? fd[d - 1] + 1 : fd[d + 1];
+         y = x - d;
+         while ((x < xlim) && (y < ylim) && diff_same(ctx, x, y))
+         {
+            x++;
+            y++;
+         }
+         fd[d] = x;
+         if (odd && (bmin <= d) && (d <= bmax) && (bd[d] <= x))
+         {
+            xmid = x;
+            ymid = y;
+            return;
+         }
+      }
+
+      /* And one more step back */
+      if (bmin > dmin)
+      {
+         bd[--bmin - 1] = INT_MAX;
+      }
+      else
+      {
+         bmin++;
+      }
+      if (bmax < dmax)
+      {
+         bd[++bmax + 1] = INT_MAX;
+      }
+      else
+      {
+         bmax--;
+      }
+      for (d = bmax; d >= bmin; d -= 2)
+      {
+         x = (bd[d - 1] < bd[d + 1]) ? bd[d - 1] : bd[d + 1] - 1;
+         y = x - d;
+         while ((x > xoff) && (y > yoff) && diff_same(ctx, x - 1, y - 1))
+         {
+            x--;
+            y--;
+         }
+         bd[d] = x;
+         if (!odd && (fmin <= d) && (d <= fmax) && (x <= fd[d]))
+         {
+            xmid = x;
+            ymid = y;
+            return;
+         }
+      }
+
+      if (cost < ctx.too_expensive)
+      {
+         continue;
+      }
+
+      /* Give up and split where one of the searches got furthest */
+      int fxy_best = -1, fx_best = xoff;
+      int bxy_best = INT_MAX, bx_best = xlim;
+
+      for (d = fmax; d >= fmin; d -= 2)
+      {
+         x = (fd[d] < xlim) ? fd[d] : xlim;
+         y = x - d;
+         if (y > ylim)
+         {
+            x = ylim + d;
+            y = ylim;
+         }
+         if (x + y > fxy_best)
+         {
+            fxy_best = x + y;
+            fx_best  = x;
+         }
+      }
+      for (d = bmax; d >= bmin; d -= 2)
+      {
+         x = (bd[d] > xoff) ? bd[d] : xoff;
+         y = x - d;
+         if (y < yoff)
+         {
+            x = yoff + d;
+            y = yoff;
+         }
+         if (x + y < bxy_best)
+         {
+            bxy_best = x + y;
+            bx_best  = x;
+         }
+      }
+      if ((xlim + ylim) - bxy_best < fxy_best - (xoff + yoff))
+      {
+         xmid = fx_best;
+         ymid = fxy_best - fx_best;
+      }
+      else
+      {
+         xmid = bx_best;
+         ymid = bxy_best - bx_best;
+      }
+      return;
+   }
+}
+
+
+/**
+ * Marks the lines of old[xoff, xlim) and new[yoff, ylim) that aren't
+ * matched up.
+ */
+static void diff_compare(diff_ctx& ctx, int xoff, int xlim, int yoff, int ylim)
+{
+   int xmid, ymid;
+
+   while (true)
+   {
+      /* Skip the lines that are the same at both ends */
+      while ((xoff < xlim) && (yoff < ylim) && diff_same(ctx, xoff, yoff))
+      {
+         xoff++;
+         yoff++;
+      }
+      while ((xoff < xlim) && (yoff < ylim) && diff_same(ctx, xlim - 1, ylim - 1))
+      {
+         xlim--;
+         ylim--;
+      }
+
+      if ((xoff == xlim) || (yoff == ylim))
+      {
+         break;
+      }
+
+      diff_split_point(ctx, xoff, xlim, yoff, ylim, xmid, ymid);
+      if (((xmid == xoff) && (ymid == yoff)) ||
+          ((xmid == xlim) && (ymid == ylim)))
+      {
+         /* No progress, so call the rest a change */
+         break;
+      }
+      diff_compare(ctx, xoff, xmid, yoff, ymid);
+      xoff = xmid;
+      yoff = ymid;
+   }
+
+   for ( ; xoff < xlim; xoff++)
+   {
+      ctx.old_del[xoff] = 1;
+   }
+   for ( ; yoff < ylim; yoff++)
+   {
+      ctx.new_ins[yoff] = 1;
+   }
+}
+
+
+/**
+ * Turns the marked lines into a list of edits.
+ */
+static void diff_edits(const diff_ctx& ctx, std::vector<diff_edit>& edits)
+{
+   int       old_count = (int)ctx.old_lines.size();
+   int       new_count = (int)ctx.new_lines.size();
+   int       old_idx   = 0;
+   int       new_idx   = 0;
+   diff_edit edit;
+
+   while ((old_idx < old_count) || (new_idx < new_count))
+   {
+      if ((old_idx < old_count) && (new_idx < new_count) &&
+          !ctx.old_del[old_idx] && !ctx.new_ins[new_idx])
+      {
+         old_idx++;
+         new_idx++;
+         continue;
+      }
+
+      edit.old_first = old_idx;
+      edit.new_first = new_idx;
+      while ((old_idx < old_count) && ctx.old_del[old_idx])
+      {
+         old_idx++;
+      }
+      while ((new_idx < new_count) && ctx.new_ins[new_idx])
+      {
+         new_idx++;
+      }
+      edit.old_count = old_idx - edit.old_first;
+      edit.new_count = new_idx - edit.new_first;
+      edits.push_back(edit);
+   }
+}
+
+
+static void print_line(FILE *pfile, char tag, const diff_line& line)
+{
+   fputc(tag, pfile);
+   fwrite(line.text, line.len, 1, pfile);
+   if (line.text[line.len - 1] != '\n')
+   {
+      fputs("\n\\ No newline at end of file\n", pfile);
+   }
+}
+
+
+/**
+ * Prints the start and length of a hunk. Like diff, an empty range gives
+ * the line before it and a length of 1 is left out.
+ */
+static void print_range(FILE *pfile, int first, int count)
+{
+   fprintf(pfile, "%d", (count == 0) ? first : first + 1);
+   if (count != 1)
+   {
+      fprintf(pfile, ",%d", count);
+   }
+}
+
+
+static void diff_unified(FILE *pfile, const char *filename, const diff_ctx& ctx,
+                         const std::vector<diff_edit>& edits)
+{
+   int old_total = (int)ctx.old_lines.size();
+   int first, last, idx;
+
+   fprintf(pfile, "--- %s\n+++ %s\n", filename, filename);
+
+   for (first = 0; first < (int)edits.size(); first = last + 1)
+   {
+      /* Changes that share their context go in one hunk */
+      last = first;
+      while ((last + 1 < (int)edits.size()) &&
+             (edits[last + 1].old_first - (edits[last].old_first + edits[last].old_count)
+              <= 2 * DIFF_CONTEXT))
+      {
+         last++;
+      }
+
+      const diff_edit& e_first = edits[first];
+      const diff_edit& e_last  = edits[last];
+      int              old_lo  = e_first.old_first - DIFF_CONTEXT;
+      int              old_hi  = e_last.old_first + e_last.old_count + DIFF_CONTEXT;
+
+      old_lo = (old_lo < 0) ? 0 : old_lo;
+      old_hi = (old_hi > old_total) ? old_total : old_hi;
+
+      int new_lo = e_first.new_first - (e_first.old_first - old_lo);
+      int new_hi = e_last.new_first + e_last.new_count +
+                   (old_hi - (e_last.old_first + e_last.old_count));
+
+      fputs("@@ -", pfile);
+      print_range(pfile, old_lo, old_hi - old_lo);
+      fputs(" +", pfile);
+      print_range(pfile, new_lo, new_hi - new_lo);
+      fputs(" @@\n", pfile);
+
+      int pos = old_lo;
+      for (int e_idx = first; e_idx <= last; e_idx++)
+      {
+         const diff_edit& edit = edits[e_idx];
+
+         for ( ; pos < edit.old_first; pos++)
+         {
+            print_line(pfile, ' ', ctx.old_lines[pos]);
+         }
+         for (idx = 0; idx < edit.old_count; idx++)
+         {
+            print_line(pfile, '-', ctx.old_lines[edit.old_first + idx]);
+         }
+         for (idx = 0; idx < edit.new_count; idx++)
+         {
+            print_line(pfile, '+', ctx.new_lines[edit.new_first + idx]);
+         }
+         pos = edit.old_first + edit.old_count;
+      }
+      for ( ; pos < old_hi; pos++)
+      {
+         print_line(pfile, ' ', ctx.old_lines[pos]);
+      }
+   }
+}
+
+
+static void json_text(FILE *pfile, const char *text, int len)
+{
+   fputc('"', pfile);
+   for (int idx = 0; idx < len; idx++)
+   {
+      unsigned char ch = (unsigned char)text[idx];
+
+      if ((ch == '"') || (ch == '\\'))
+      {
+         fprintf(pfile, "\\%c", ch);
+      }
+      else if (ch < 0x20)
+      {
+         fprintf(pfile, "\\u%04x", ch);
+      }
+      else
+      {
+         fputc(ch, pfile);
+      }
+   }
+   fputc('"', pfile);
+}
+
+
+/**
+ * Prints the edits as one line of JSON:
+ *   {"file": "a.c", "edits": [{"line": 3, "delete": 1, "insert": ["x;"]}]}
+ * 'line' is the first old line that is replaced, or the line that the new
+ * lines go before if 'delete' is 0. The lines are given without the '\n'.
+ */
+static void diff_json(FILE *pfile, const char *filename, const diff_ctx& ctx,
+                      const std::vector<diff_edit>& edits)
+{
+   fputs("{\"file\": ", pfile);
+   json_text(pfile, filename, strlen(filename));
+   fputs(", \"edits\": [", pfile);
+   for (int e_idx = 0; e_idx < (int)edits.size(); e_idx++)
+   {
+      const diff_edit& edit = edits[e_idx];
+
+      fprintf(pfile, "%s{\"line\": %d, \"delete\": %d, \"insert\": [",
+              (e_idx == 0) ? "" : ", ", edit.old_first + 1, edit.old_count);
+      for (int idx = 0; idx < edit.new_count; idx++)
+      {
+         const diff_line& line = ctx.new_lines[edit.new_first + idx];
+         int              len  = line.len;
+
+         if (line.text[len - 1] == '\n')
+         {
+            len--;
+         }
+         if (idx > 0)
+         {
+            fputs(", ", pfile);
+         }
+         json_text(pfile, line.text, len);
+      }
+      fputs("]}", pfile);
+   }
+   fputs("]}\n", pfile);
+}
+
+
+bool diff_report(FILE *pfile, diff_format_t format, const char *filename,
+                 const char *old_text, int old_len,
+                 const char *new_text, int new_len)
+{
+   if ((old_len == new_len) && (memcmp(old_text, new_text, old_len) == 0))
+   {
+      return(false);
+   }
+
+   diff_ctx               ctx;
+   std::vector<diff_edit> edits;
+
+   diff_split(old_text, old_len, ctx.old_lines);
+   diff_split(new_text, new_len, ctx.new_lines);
+
+   int old_count = (int)ctx.old_lines.size();
+   int new_count = (int)ctx.new_lines.size();
+
+   ctx.old_del.assign(old_count, 0);
+   ctx.new_ins.assign(new_count, 0);
+   ctx.fwd.resize(old_count + new_count + 3);
+   ctx.bwd.resize(old_count + new_count + 3);
+   ctx.fd = &ctx.fwd[new_count + 1];
+   ctx.bd = &ctx.bwd[new_count + 1];
+
+   /* Roughly the square root of the number of diagonals, like GNU diff */
+   ctx.too_expensive = 1;
+   for (int diags = old_count + new_count + 3; diags != 0; diags >>= 2)
+   {
+      ctx.too_expensive <<= 1;
+   }
+   if (ctx.too_expensive < 4096)
+   {
+      ctx.too_expensive = 4096;
+   }
+
+   diff_compare(ctx, 0, old_count, 0, new_count);
+   diff_edits(ctx, edits);
+
+   if (format == DIFF_JSON)
+   {
+      diff_json(pfile, filename, ctx, edits);
+   }
+   else
+   {
+      diff_unified(pfile, filename, ctx, edits);
+   }
+   return(true);
+}
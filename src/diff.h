@@ -0,0 +1,49 @@
+/**
+ * @file diff.h
+ * Line diffs between a file and its formatted text, for --diff.
+ *
+ * It works like this:
+ *
+ * 1. Format the file into memory
+ *
+ * 2. Call diff_report() with the original text and the formatted text
+ *
+ * Nothing is printed when the texts are the same, so a file that is already
+ * formatted gives no output at all.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef DIFF_H_INCLUDED
+#define DIFF_H_INCLUDED
+
+#include <cstdio>
+
+enum diff_format_t
+{
+   DIFF_NONE,      /* --diff is off */
+   DIFF_UNIFIED,   /* a unified diff, as made by 'diff -u' */
+   DIFF_JSON,      /* one JSON object with the edits for each file */
+};
+
+
+/**
+ * Prints the changes from old_text to new_text.
+ * The lines are compared with their line ends, so a change of the line ends
+ * shows up too.
+ *
+ * @param pfile     Where to print
+ * @param format    DIFF_UNIFIED or DIFF_JSON
+ * @param filename  The name of the file, for the headers
+ * @param old_text  The original text
+ * @param old_len   The length of old_text
+ * @param new_text  The formatted text
+ * @param new_len   The length of new_text
+ * @return          true if the texts differ
+ */
+bool diff_report(FILE *pfile, diff_format_t format, const char *filename,
+                 const char *old_text, int old_len,
+                 const char *new_text, int new_len);
+
+
+#endif /* DIFF_H_INCLUDED */
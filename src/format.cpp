@@ -0,0 +1,1025 @@
+/**
+ * @file format.cpp
+ * Runs the formatting passes over a file.
+ * Also has the formatting context and the helpers needed to set one up.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#define DEFINE_PCF_NAMES
+#define DEFINE_CHAR_TABLE
+
+#include "uncrustify_types.h"
+#include "char_table.h"
+#include "chunk_list.h"
+#include "prototypes.h"
+#include "token_names.h"
+#include "logger.h"
+#include "log_levels.h"
+#include "stats.h"
+#include "ChunkStack.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include "unc_ctype.h"
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_STRINGS_H
+#include <strings.h>  /* strcasecmp() */
+#endif
+
+/* Smaller files are read, which is quicker than mapping them */
+#define MAP_MIN_SIZE    (64 * 1024)
+
+/* The context used by the command line driver */
+static struct cp_data cpd_main;
+
+THREAD_LOCAL struct cp_data *cpd = &cpd_main;
+
+
+/**
+ * Replace the brain-dead and non-portable basename().
+ * Returns a pointer to the character after the last '/'.
+ * The returned value always points into path, unless path is NULL.
+ *
+ * Input            Returns
+ * NULL          => ""
+ * "/some/path/" => ""
+ * "/some/path"  => "path"
+ * "afile"       => "afile"
+ *
+ * @param path The path to look at
+ * @return     Pointer to the character after the last path seperator
+ */
+const char *path_basename(const char *path)
+{
+   if (path == NULL)
+   {
+      return("");
+   }
+
+   const char *last_path = path;
+   char       ch;
+
+   while ((ch = *path) != 0)
+   {
+      path++;
+      if (ch == PATH_SEP)
+      {
+         last_path = path;
+      }
+   }
+   return(last_path);
+}
+
+
+/**
+ * Returns the length of the directory part of the filename.
+ */
+int path_dirname_len(const char *filename)
+{
+   if (filename == NULL)
+   {
+      return(0);
+   }
+   return((int)(path_basename(filename) - filename));
+}
+
+
+/**
+ * Maps the regular file at fd into memory, if it is big enough to be worth
+ * it. The text is followed by a NUL, like a loaded file.
+ *
+ * @return false if the file should be read instead
+ */
+bool map_mem_file(int fd, file_mem& fm)
+{
+#ifndef WIN32
+   struct stat my_stat;
+   size_t      page = sysconf(_SC_PAGESIZE);
+   size_t      map_size;
+   char        *base;
+
+   /* only whole regular files can be mapped */
+   if ((fstat(fd, &my_stat) != 0) || !S_ISREG(my_stat.st_mode) ||
+       (my_stat.st_size < MAP_MIN_SIZE) || (my_stat.st_size >= INT_MAX) ||
+       (lseek(fd, 0, SEEK_CUR) != 0))
+   {
+      return(false);
+   }
+
+   /* Reserve zeroed memory for the file plus the NUL and map the file over
+    * the start of it. The NUL is then there even if the file ends on a page
+    * boundary.
+    */
+   map_size = (my_stat.st_size + page) & ~(page - 1);
+   base     = (char *)mmap(NULL, map_size, PROT_READ,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if (base == MAP_FAILED)
+   {
+      return(false);
+   }
+   if (mmap(base, my_stat.st_size, PROT_READ,
+            MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+   {
+      munmap(base, map_size);
+      return(false);
+   }
+#ifdef MADV_SEQUENTIAL
+   madvise(base, map_size, MADV_SEQUENTIAL);
+#endif
+
+   fm.data     = base;
+   fm.length   = my_stat.st_size;
+   fm.map_size = map_size;
+#ifdef HAVE_UTIME_H
+   fm.utb.modtime = my_stat.st_mtime;
+#endif
+   return(true);
+
+#else
+   return(false);
+#endif
+}
+
+
+/**
+ * Loads a file into memory.
+ * Big files are mapped instead of read.
+ */
+int load_mem_file(const char *filename, file_mem& fm)
+{
+   int         retval = -1;
+   struct stat my_stat;
+   FILE        *p_file;
+
+   fm.data     = NULL;
+   fm.length   = 0;
+   fm.map_size = 0;
+
+   /* Grab the stat info for the file */
+   if (stat(filename, &my_stat) < 0)
+   {
+      return(-1);
+   }
+
+#ifdef HAVE_UTIME_H
+   /* Save off mtime */
+   fm.utb.modtime = my_stat.st_mtime;
+#endif
+
+#ifndef WIN32
+   if (my_stat.st_size >= MAP_MIN_SIZE)
+   {
+      int  fd = open(filename, O_RDONLY);
+      bool mapped;
+
+      if (fd >= 0)
+      {
+         mapped = map_mem_file(fd, fm);
+         close(fd);
+         if (mapped)
+         {
+            return(0);
+         }
+      }
+   }
+#endif
+
+   /* Try to read in the file */
+   p_file = fopen(filename, "rb");
+   if (p_file == NULL)
+   {
+      return(-1);
+   }
+
+   fm.length = my_stat.st_size;
+   fm.data   = (char *)malloc(fm.length + 1);
+   if (fm.data == NULL)
+   {
+      LOG_FMT(LERR, "%s: fopen(%s) failed: out of memory\n", __func__, filename);
+      cpd->error_count++;
+   }
+   else if (fread(fm.data, fm.length, 1, p_file) != 1)
+   {
+      LOG_FMT(LERR, "%s: fread(%s) failed: %s (%d)\n",
+              __func__, filename, strerror(errno), errno);
+      cpd->error_count++;
+   }
+   else
+   {
+      fm.data[fm.length] = 0;
+      retval             = 0;
+   }
+   fclose(p_file);
+
+   if ((retval != 0) && (fm.data != NULL))
+   {
+      free(fm.data);
+      fm.data   = NULL;
+      fm.length = 0;
+   }
+   return(retval);
+}
+
+
+/**
+ * Try to load the file from the config folder first and then by name
+ */
+static int load_mem_file_config(const char *filename, file_mem& fm)
+{
+   int  retval;
+   char buf[1024];
+
+   snprintf(buf, sizeof(buf), "%.*s%s",
+            path_dirname_len(cpd->filename), cpd->filename, filename);
+
+   retval = load_mem_file(buf, fm);
+   if (retval < 0)
+   {
+      retval = load_mem_file(filename, fm);
+      if (retval < 0)
+      {
+         LOG_FMT(LERR, "Failed to load (%s) or (%s)\n", buf, filename);
+         cpd->error_count++;
+      }
+   }
+   return(retval);
+}
+
+
+int load_header_files()
+{
+   int retval = 0;
+
+   if ((cpd->settings[UO_cmt_insert_file_header].str != NULL) &&
+       (cpd->settings[UO_cmt_insert_file_header].str[0] != 0))
+   {
+      retval |= load_mem_file_config(cpd->settings[UO_cmt_insert_file_header].str,
+                                     cpd->file_hdr);
+   }
+   if ((cpd->settings[UO_cmt_insert_file_footer].str != NULL) &&
+       (cpd->settings[UO_cmt_insert_file_footer].str[0] != 0))
+   {
+      retval |= load_mem_file_config(cpd->settings[UO_cmt_insert_file_footer].str,
+                                     cpd->file_ftr);
+   }
+   if ((cpd->settings[UO_cmt_insert_func_header].str != NULL) &&
+       (cpd->settings[UO_cmt_insert_func_header].str[0] != 0))
+   {
+      retval |= load_mem_file_config(cpd->settings[UO_cmt_insert_func_header].str,
+                                     cpd->func_hdr);
+   }
+   if ((cpd->settings[UO_cmt_insert_class_header].str != NULL) &&
+       (cpd->settings[UO_cmt_insert_class_header].str[0] != 0))
+   {
+      retval |= load_mem_file_config(cpd->settings[UO_cmt_insert_class_header].str,
+                                     cpd->class_hdr);
+   }
+   return(retval);
+}
+
+
+static void add_file_header()
+{
+   if (!chunk_is_comment(chunk_get_head()))
+   {
+      /*TODO: detect the typical #ifndef FOO / #define FOO sequence */
+      tokenize(cpd->file_hdr.data, cpd->file_hdr.length, chunk_get_head());
+   }
+}
+
+
+static void add_file_footer()
+{
+   chunk_t *pc = chunk_get_tail();
+
+   /* Back up if the file ends with a newline */
+   if ((pc != NULL) && chunk_is_newline(pc))
+   {
+      pc = chunk_get_prev(pc);
+   }
+   if ((pc != NULL) &&
+       (!chunk_is_comment(pc) || !chunk_is_newline(chunk_get_prev(pc))))
+   {
+      pc = chunk_get_tail();
+      if (!chunk_is_newline(pc))
+      {
+         LOG_FMT(LSYS, "Adding a newline at the end of the file\n");
+         newline_add_after(pc);
+      }
+      tokenize(cpd->file_ftr.data, cpd->file_ftr.length, NULL);
+   }
+}
+
+
+static void add_func_header(c_token_t type, file_mem& fm)
+{
+   chunk_t *pc;
+   chunk_t *ref;
+   chunk_t *tmp;
+   bool    do_insert;
+
+   for (pc = chunk_first_of_type(type); pc != NULL; pc = chunk_next_of_type(pc))
+   {
+      if (chunk_is_preproc(pc))
+      {
+         continue;
+      }
+
+      do_insert = false;
+
+      /* On a function proto or def. Back up to a close brace or semicolon on
+       * the same level
+       */
+      ref = pc;
+      while ((ref = chunk_get_prev(ref)) != NULL)
+      {
+         /* Bail if we change level */
+         if (ref->level != pc->level)
+         {
+            do_insert = true;
+            break;
+         }
+
+         /* If we hit an angle close, back up to the angle open */
+         if (ref->type == CT_ANGLE_CLOSE)
+         {
+            ref = chunk_get_prev_type(ref, CT_ANGLE_OPEN, ref->level, CNAV_PREPROC);
+            continue;
+         }
+
+         /* Bail if we hit a preprocessor and cmt_insert_before_preproc is false */
+         if (ref->flags & PCF_IN_PREPROC)
+         {
+            tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
+            if ((tmp != NULL) && (tmp->parent_type == CT_PP_IF))
+            {
+               tmp = chunk_get_prev_nnl(tmp);
+               if (chunk_is_comment(tmp) &&
+                   !cpd->settings[UO_cmt_insert_before_preproc].b)
+               {
+                  break;
+               }
+            }
+         }
+
+         /* Ignore 'right' comments */
+         if (chunk_is_comment(ref) && chunk_is_newline(chunk_get_prev(ref)))
+         {
+            break;
+         }
+
+         if ((ref->level == pc->level) &&
+             ((ref->flags & PCF_IN_PREPROC) ||
+              (ref->type == CT_SEMICOLON) ||
+              (ref->type == CT_BRACE_CLOSE)))
+         {
+            do_insert = true;
+            break;
+         }
+      }
+      if (do_insert)
+      {
+         /* Insert between after and ref */
+         chunk_t *after = chunk_get_next_ncnl(ref);
+         tokenize(fm.data, fm.length, after);
+         for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
+         {
+            tmp->level = after->level;
+         }
+      }
+   }
+}
+
+
+void uncrustify_start(const char *data, int data_len)
+{
+   /* The settings may have changed since the last file */
+   space_table_check();
+
+   /**
+    * Parse the text into chunks
+    */
+   RUN_PASS(PASS_TOKENIZE, tokenize(data, data_len, NULL));
+
+   /* Add the file header */
+   if (cpd->file_hdr.data != NULL)
+   {
+      RUN_PASS(PASS_ADD_FILE_HEADER, add_file_header());
+   }
+
+   /* Add the file footer */
+   if (cpd->file_ftr.data != NULL)
+   {
+      RUN_PASS(PASS_ADD_FILE_FOOTER, add_file_footer());
+   }
+
+   /**
+    * Change certain token types based on simple sequence.
+    * Example: change '[' + ']' to '[]'
+    * Note that level info is not yet available, so it is OK to do all
+    * processing that doesn't need to know level info. (that's very little!)
+    */
+   RUN_PASS(PASS_TOKENIZE_CLEANUP, tokenize_cleanup());
+
+   /**
+    * Detect the brace and paren levels and insert virtual braces.
+    * This handles all that nasty preprocessor stuff
+    */
+   RUN_PASS(PASS_BRACE_CLEANUP, brace_cleanup());
+
+   /**
+    * At this point, the level information is available and accurate.
+    */
+   RUN_PASS(PASS_CHUNK_LINK_MATCHES, chunk_link_matches());
+
+   if ((cpd->lang_flags & LANG_PAWN) != 0)
+   {
+      RUN_PASS(PASS_PAWN_PRESCAN, pawn_prescan());
+   }
+
+   /**
+    * Re-type chunks, combine chunks
+    */
+   RUN_PASS(PASS_FIX_SYMBOLS, fix_symbols());
+
+   RUN_PASS(PASS_MARK_COMMENTS, mark_comments());
+
+   /**
+    * Look at all colons ':' and mark labels, :? sequences, etc.
+    */
+   RUN_PASS(PASS_COMBINE_LABELS, combine_labels());
+}
+
+
+/**
+ * Formats the data.
+ *
+ * @param render      whether to render the text into cpd->out
+ * @param parsed_file NULL or the file to dump the parsed data to
+ */
+static void uncrustify_run(const char *data, int data_len, bool render,
+                           const char *parsed_file)
+{
+   stats_file_begin(data_len);
+
+   uncrustify_start(data, data_len);
+
+   /**
+    * Done with detection. Do the rest only if the file will go somewhere.
+    * The detection code needs as few changes as possible.
+    */
+   if (render)
+   {
+      /**
+       * Add comments before function defs and classes
+       */
+      if (cpd->func_hdr.data != NULL)
+      {
+         RUN_PASS(PASS_ADD_FUNC_HEADER, add_func_header(CT_FUNC_DEF, cpd->func_hdr));
+      }
+      if (cpd->class_hdr.data != NULL)
+      {
+         RUN_PASS(PASS_ADD_FUNC_HEADER, add_func_header(CT_CLASS, cpd->class_hdr));
+      }
+
+      /**
+       * Change virtual braces into real braces...
+       */
+      RUN_PASS(PASS_DO_BRACES, do_braces());
+
+      /* Scrub extra semicolons */
+      if (cpd->settings[UO_mod_remove_extra_semicolon].b)
+      {
+         RUN_PASS(PASS_REMOVE_EXTRA_SEMICOLONS, remove_extra_semicolons());
+      }
+
+      /* Remove unnecessary returns */
+      if (cpd->settings[UO_mod_remove_empty_return].b)
+      {
+         RUN_PASS(PASS_REMOVE_EXTRA_RETURNS, remove_extra_returns());
+      }
+
+      /**
+       * Add parens
+       */
+      RUN_PASS(PASS_DO_PARENS, do_parens());
+
+      /**
+       * Insert line breaks as needed
+       */
+      RUN_PASS(PASS_DO_BLANK_LINES, do_blank_lines());
+      RUN_PASS(PASS_NEWLINES_CLEANUP_BRACES, newlines_cleanup_braces());
+      if (cpd->settings[UO_nl_after_multiline_comment].b)
+      {
+         RUN_PASS(PASS_NEWLINE_AFTER_MULTILINE_COMMENT, newline_after_multiline_comment());
+      }
+      /* Collected by newlines_insert_blank_lines() for the passes after it */
+      ChunkStack nl_later;
+      RUN_PASS(PASS_NEWLINES_INSERT_BLANK_LINES, newlines_insert_blank_lines(nl_later));
+      if (cpd->settings[UO_pos_bool].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_BOOL, cpd->settings[UO_pos_bool].tp));
+      }
+      if (cpd->settings[UO_pos_compare].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_COMPARE, cpd->settings[UO_pos_compare].tp));
+      }
+      if (cpd->settings[UO_pos_conditional].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_COND_COLON, cpd->settings[UO_pos_conditional].tp));
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_QUESTION, cpd->settings[UO_pos_conditional].tp));
+      }
+      if (cpd->settings[UO_pos_comma].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_COMMA, cpd->settings[UO_pos_comma].tp));
+      }
+      if (cpd->settings[UO_pos_assign].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_ASSIGN, cpd->settings[UO_pos_assign].tp));
+      }
+      if (cpd->settings[UO_pos_arith].tp != TP_IGNORE)
+      {
+         RUN_PASS(PASS_NEWLINES_CHUNK_POS, newlines_chunk_pos(nl_later, CT_ARITH, cpd->settings[UO_pos_arith].tp));
+      }
+      RUN_PASS(PASS_NEWLINES_CLASS_COLON_POS, newlines_class_colon_pos(nl_later));
+      if (cpd->settings[UO_nl_squeeze_ifdef].b)
+      {
+         RUN_PASS(PASS_NEWLINES_SQUEEZE_IFDEF, newlines_squeeze_ifdef(nl_later));
+      }
+      RUN_PASS(PASS_NEWLINES_EAT_START_END, newlines_eat_start_end());
+      RUN_PASS(PASS_NEWLINES_CLEANUP_DUP, newlines_cleanup_dup());
+
+      RUN_PASS(PASS_MARK_COMMENTS, mark_comments());
+
+      /**
+       * Add balanced spaces around nested params
+       */
+      if (cpd->settings[UO_sp_balance_nested_parens].b)
+      {
+         RUN_PASS(PASS_SPACE_TEXT_BALANCE_NESTED_PARENS, space_text_balance_nested_parens());
+      }
+
+      /* Scrub certain added semicolons */
+      if (((cpd->lang_flags & LANG_PAWN) != 0) &&
+          cpd->settings[UO_mod_pawn_semicolon].b)
+      {
+         RUN_PASS(PASS_PAWN_SCRUB_VSEMI, pawn_scrub_vsemi());
+      }
+
+      /* Sort imports/using/include */
+      if (cpd->settings[UO_mod_sort_import].b ||
+          cpd->settings[UO_mod_sort_include].b ||
+          cpd->settings[UO_mod_sort_using].b)
+      {
+         RUN_PASS(PASS_SORT_IMPORTS, sort_imports());
+      }
+
+      /**
+       * Fix same-line inter-chunk spacing
+       */
+      RUN_PASS(PASS_SPACE_TEXT, space_text());
+
+      /**
+       * Do any aligning of preprocessors
+       */
+      if (cpd->settings[UO_align_pp_define_span].n > 0)
+      {
+         RUN_PASS(PASS_ALIGN_PREPROCESSOR, align_preprocessor());
+      }
+
+      /**
+       * Indent the text
+       */
+      RUN_PASS(PASS_INDENT_PREPROC, indent_preproc());
+      RUN_PASS(PASS_INDENT_TEXT, indent_text());
+
+      /* Insert trailing comments after certain close braces */
+      if ((cpd->settings[UO_mod_add_long_switch_closebrace_comment].n > 0) ||
+          (cpd->settings[UO_mod_add_long_function_closebrace_comment].n > 0))
+      {
+         RUN_PASS(PASS_ADD_LONG_CLOSEBRACE_COMMENT, add_long_closebrace_comment());
+      }
+
+      /* Insert trailing comments after certain preprocessor conditional blocks */
+      if ((cpd->settings[UO_mod_add_long_ifdef_else_comment].n > 0) ||
+          (cpd->settings[UO_mod_add_long_ifdef_endif_comment].n > 0))
+      {
+         RUN_PASS(PASS_ADD_LONG_PREPROC_COMMENT, add_long_preprocessor_conditional_block_comment());
+      }
+
+      /**
+       * Aligning everything else and reindent
+       */
+      RUN_PASS(PASS_ALIGN_ALL, align_all());
+      RUN_PASS(PASS_INDENT_TEXT, indent_text());
+
+      if (cpd->settings[UO_code_width].n > 0)
+      {
+         int max_passes = 3;
+         int prev_changes;
+         do
+         {
+            prev_changes = cpd->changes;
+            RUN_PASS(PASS_DO_CODE_WIDTH, do_code_width());
+            if (prev_changes != cpd->changes)
+            {
+               RUN_PASS(PASS_ALIGN_ALL, align_all());
+               RUN_PASS(PASS_INDENT_TEXT, indent_text());
+            }
+         } while ((prev_changes != cpd->changes) && (--max_passes > 0));
+      }
+
+      /**
+       * And finally, align the backslash newline stuff
+       */
+      RUN_PASS(PASS_ALIGN_RIGHT_COMMENTS, align_right_comments());
+      if (cpd->settings[UO_align_nl_cont].b)
+      {
+         RUN_PASS(PASS_ALIGN_BACKSLASH_NEWLINE, align_backslash_newline());
+      }
+
+      /**
+       * Now render it all to the output buffer
+       */
+      RUN_PASS(PASS_OUTPUT_TEXT, output_text());
+
+      /* Put back the input around the lines that were asked for */
+      if (cpd->line_last > 0)
+      {
+         output_lines(data, data_len);
+      }
+   }
+
+   stats_file_end(render ? cpd->out.len : 0);
+
+   /* Special hook for dumping parsed data for debugging */
+   if (parsed_file != NULL)
+   {
+      FILE *p_file = fopen(parsed_file, "w");
+      if (p_file != NULL)
+      {
+         output_parsed(p_file);
+         fclose(p_file);
+      }
+      else
+      {
+         LOG_FMT(LERR, "%s: Failed to open '%s' for write: %s (%d)\n",
+                 __func__, parsed_file, strerror(errno), errno);
+      }
+   }
+
+   uncrustify_end();
+}
+
+
+void uncrustify_file(const char *data, int data_len, FILE *pfout,
+                     const char *parsed_file)
+{
+   uncrustify_run(data, data_len, pfout != NULL, parsed_file);
+
+   /* one write for the whole file */
+   if ((pfout != NULL) && (cpd->out.len > 0))
+   {
+      fwrite(cpd->out.data, cpd->out.len, 1, pfout);
+   }
+}
+
+
+/**
+ * Formats the data in memory.
+ * The text stays valid until the context formats the next file.
+ *
+ * @param out_len     Gets the length of the text
+ * @param parsed_file NULL or the file to dump the parsed data to
+ * @return            The text, not NUL terminated
+ */
+const char *uncrustify_file_mem(const char *data, int data_len, int& out_len,
+                                const char *parsed_file)
+{
+   uncrustify_run(data, data_len, true, parsed_file);
+   out_len = cpd->out.len;
+   return(cpd->out.data);
+}
+
+
+void uncrustify_end()
+{
+   /* Free all the memory */
+   chunk_del_all();
+   cpd->frames.clear();
+   output_lines_free();
+
+   /* Clean up some state variables */
+   cpd->unc_off     = false;
+   cpd->al_cnt      = 0;
+   cpd->did_newline = true;
+   cpd->pp_level    = 0;
+   cpd->changes     = 0;
+   cpd->in_preproc  = CT_NONE;
+   cpd->consumed    = false;
+   memset(cpd->le_counts, 0, sizeof(cpd->le_counts));
+   cpd->preproc_ncnl_count = 0;
+   cpd->pf_ref_no          = 0;
+   cpd->indent_ref         = 0;
+   cpd->last_char          = 0;
+}
+
+
+/**
+ * Makes ctx the context that this thread formats with.
+ *
+ * @param ctx  The context to use
+ * @return     The context that was in use before
+ */
+struct cp_data *context_select(struct cp_data *ctx)
+{
+   struct cp_data *prev = cpd;
+
+   cpd = ctx;
+   return(prev);
+}
+
+
+/**
+ * Creates a formatting context with the default settings.
+ * The current context is not changed.
+ * Load the config with the new context selected.
+ */
+struct cp_data *context_create(void)
+{
+   struct cp_data *ctx  = new cp_data();
+   struct cp_data *prev = context_select(ctx);
+
+   set_option_defaults();
+   context_select(prev);
+   return(ctx);
+}
+
+
+void free_file_mem(file_mem& fm)
+{
+   if (fm.data != NULL)
+   {
+#ifndef WIN32
+      if (fm.map_size != 0)
+      {
+         munmap(fm.data, fm.map_size);
+      }
+      else
+#endif
+      {
+         free(fm.data);
+      }
+      fm.data     = NULL;
+      fm.length   = 0;
+      fm.map_size = 0;
+   }
+}
+
+
+/**
+ * Frees a context made by context_create() and everything it owns.
+ * If it was the current context, there is no current context afterwards.
+ */
+void context_destroy(struct cp_data *ctx)
+{
+   struct cp_data *prev = context_select(ctx);
+
+   uncrustify_end();
+   chunk_arena_free();
+   free(cpd->out.data);
+   delete cpd->stats;
+   space_table_free();
+   output_lines_free();
+   clear_keyword_file();
+   clear_defines();
+   free_file_mem(cpd->file_hdr);
+   free_file_mem(cpd->file_ftr);
+   free_file_mem(cpd->func_hdr);
+   free_file_mem(cpd->class_hdr);
+
+   for (int idx = 0; idx < UO_option_count; idx++)
+   {
+      const option_map_value *opt = get_option_name(idx);
+      if ((opt != NULL) && (opt->type == AT_STRING) && (cpd->settings[idx].str != NULL))
+      {
+         free((void *)cpd->settings[idx].str);
+      }
+   }
+
+   context_select((prev != ctx) ? prev : NULL);
+   delete ctx;
+}
+
+
+const char *get_token_name(c_token_t token)
+{
+   if ((token >= 0) && (token < (int)ARRAY_SIZE(token_names)) &&
+       (token_names[token] != NULL))
+   {
+      return(token_names[token]);
+   }
+   return("???");
+}
+
+
+/**
+ * Grab the token id for the text.
+ * returns CT_NONE on failure t match
+ */
+c_token_t find_token_name(const char *text)
+{
+   int idx;
+
+   if ((text != NULL) && (*text != 0))
+   {
+      for (idx = 1; idx < (int)ARRAY_SIZE(token_names); idx++)
+      {
+         if (strcasecmp(text, token_names[idx]) == 0)
+         {
+            return((c_token_t)idx);
+         }
+      }
+   }
+   return(CT_NONE);
+}
+
+
+static bool ends_with(const char *filename, const char *tag)
+{
+   int len1 = strlen(filename);
+   int len2 = strlen(tag);
+
+   if ((len2 <= len1) && (strcmp(&filename[len1 - len2], tag) == 0))
+   {
+      return(true);
+   }
+   return(false);
+}
+
+
+struct file_lang
+{
+   const char *ext;
+   const char *tag;
+   int        lang;
+};
+
+struct file_lang languages[] =
+{
+   { ".c",    "C",    LANG_C             },
+   { ".cpp",  "CPP",  LANG_CPP           },
+   { ".d",    "D",    LANG_D             },
+   { ".cs",   "CS",   LANG_CS            },
+   { ".vala", "VALA", LANG_VALA          },
+   { ".java", "JAVA", LANG_JAVA          },
+   { ".pawn", "PAWN", LANG_PAWN          },
+   { ".p",    "",     LANG_PAWN          },
+   { ".sma",  "",     LANG_PAWN          },
+   { ".inl",  "",     LANG_PAWN          },
+   { ".h",    "",     LANG_CPP           },
+   { ".cxx",  "",     LANG_CPP           },
+   { ".hpp",  "",     LANG_CPP           },
+   { ".hxx",  "",     LANG_CPP           },
+   { ".cc",   "",     LANG_CPP           },
+   { ".di",   "",     LANG_D             },
+   { ".m",    "OC",   LANG_OC            },
+   { ".mm",   "OC+",  LANG_OC | LANG_CPP },
+   { ".sqc",  "",     LANG_C             }, // embedded SQL
+   { ".es",   "ECMA", LANG_ECMA          },
+};
+
+/**
+ * Set idx = 0 before the first call.
+ * Done when returns NULL
+ */
+const char *get_file_extension(int& idx)
+{
+   const char *val = NULL;
+
+   if (idx < (int)ARRAY_SIZE(languages))
+   {
+      val = languages[idx].ext;
+   }
+   idx++;
+   return(val);
+}
+
+
+/**
+ * Find the language for the file extension
+ * Default to C
+ *
+ * @param filename   The name of the file
+ * @return           LANG_xxx
+ */
+int language_from_filename(const char *filename)
+{
+   int i;
+
+   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   {
+      if (ends_with(filename, languages[i].ext))
+      {
+         return(languages[i].lang);
+      }
+   }
+   return(LANG_C);
+}
+
+
+/**
+ * Find the language for the file extension
+ *
+ * @param filename   The name of the file
+ * @return           LANG_xxx or 0 (no match)
+ */
+int language_from_tag(const char *tag)
+{
+   int i;
+
+   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   {
+      if (strcasecmp(tag, languages[i].tag) == 0)
+      {
+         return(languages[i].lang);
+      }
+   }
+   return(0);
+}
+
+
+/**
+ * Gets the tag text for a language
+ *
+ * @param lang    The LANG_xxx enum
+ * @return        A string
+ */
+const char *language_to_string(int lang)
+{
+   int i;
+
+   /* Check for an exact match first */
+   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   {
+      if (languages[i].lang == lang)
+      {
+         return(languages[i].tag);
+      }
+   }
+
+   /* Check for the first set language bit */
+   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   {
+      if ((languages[i].lang & lang) != 0)
+      {
+         return(languages[i].tag);
+      }
+   }
+   return("???");
+}
+
+
+void log_pcf_flags(log_sev_t sev, UINT32 flags)
+{
+   if (!log_sev_on(sev))
+   {
+      return;
+   }
+
+   log_fmt(sev, "[0x%X:", flags);
+
+   const char *tolog = NULL;
+   for (int i = 0; i < (int)ARRAY_SIZE(pcf_names); i++)
+   {
+      if ((flags & (1 << i)) != 0)
+      {
+         if (tolog != NULL)
+         {
+            log_str(sev, tolog, strlen(tolog));
+            log_str(sev, ",", 1);
+         }
+         tolog = pcf_names[i];
+      }
+   }
+
+   if (tolog != NULL)
+   {
+      log_str(sev, tolog, strlen(tolog));
+   }
+
+   log_str(sev, "]\n", 2);
+}
@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <vector>
 #include "unc_ctype.h"
 
 
@@ -168,7 +169,7 @@ void align_to_column(chunk_t *pc, int column, align_mode mode)
       if (chunk_is_comment(pc) && (pc->parent_type != CT_COMMENT_EMBED))
       {
          almod = (chunk_is_single_line_comment(pc) &&
-                  cpd.settings[UO_indent_relative_single_line_comments].b) ?
+                  cpd->settings[UO_indent_relative_single_line_comments].b) ?
                  ALMODE_KEEP_REL : ALMODE_KEEP_ABS;
       }
       
@@ -242,7 +243,7 @@ void reindent_line2(chunk_t *pc, int column, const char *fcn_name, int lineno)
 
       bool is_comment = chunk_is_comment(pc);
       bool keep       = is_comment && chunk_is_single_line_comment(pc) &&
-                        cpd.settings[UO_indent_relative_single_line_comments].b;
+                        cpd->settings[UO_indent_relative_single_line_comments].b;
 
       if (is_comment && (pc->parent_type != CT_COMMENT_EMBED) && !keep)
       {
@@ -276,27 +277,21 @@ void reindent_line2(chunk_t *pc, int column, const char *fcn_name, int lineno)
  */
 static void indent_pse_push(struct parse_frame& frm, chunk_t *pc)
 {
-   static int ref = 0;
-
-   /* check the stack depth */
-   if (frm.pse_tos < ((int)ARRAY_SIZE(frm.pse) - 1))
-   {
-      /* Bump up the index and initialize it */
-      frm.pse_tos++;
-      memset(&frm.pse[frm.pse_tos], 0, sizeof(frm.pse[frm.pse_tos]));
-
-      LOG_FMT(LINDPSE, "%4d] (pp=%d) OPEN  [%d,%s] level=%d\n",
-              pc->orig_line, cpd.pp_level, frm.pse_tos, get_token_name(pc->type), pc->level);
-
-      frm.pse[frm.pse_tos].pc         = pc;
-      frm.pse[frm.pse_tos].type       = pc->type;
-      frm.pse[frm.pse_tos].level      = pc->level;
-      frm.pse[frm.pse_tos].open_line  = pc->orig_line;
-      frm.pse[frm.pse_tos].ref        = ++ref;
-      frm.pse[frm.pse_tos].in_preproc = (pc->flags & PCF_IN_PREPROC) != 0;
-      frm.pse[frm.pse_tos].indent_tab = frm.pse[frm.pse_tos - 1].indent_tab;
-      frm.pse[frm.pse_tos].non_vardef = false;
-   }
+   /* Bump up the index and initialize it */
+   frm.pse_tos++;
+   memset(&frm.pse[frm.pse_tos], 0, sizeof(frm.pse[frm.pse_tos]));
+
+   LOG_FMT(LINDPSE, "%4d] (pp=%d) OPEN  [%d,%s] level=%d\n",
+           pc->orig_line, cpd->pp_level, frm.pse_tos, get_token_name(pc->type), pc->level);
+
+   frm.pse[frm.pse_tos].pc         = pc;
+   frm.pse[frm.pse_tos].type       = pc->type;
+   frm.pse[frm.pse_tos].level      = pc->level;
+   frm.pse[frm.pse_tos].open_line  = pc->orig_line;
+   frm.pse[frm.pse_tos].ref        = ++cpd->indent_ref;
+   frm.pse[frm.pse_tos].in_preproc = (pc->flags & PCF_IN_PREPROC) != 0;
+   frm.pse[frm.pse_tos].indent_tab = frm.pse[frm.pse_tos - 1].indent_tab;
+   frm.pse[frm.pse_tos].non_vardef = false;
 }
 
 
@@ -314,7 +309,7 @@ static void indent_pse_pop(struct parse_frame& frm, chunk_t *pc)
       if (pc != NULL)
       {
          LOG_FMT(LINDPSE, "%4d] (pp=%d) CLOSE [%d,%s] on %s, started on line %d, level=%d/%d\n",
-                 pc->orig_line, cpd.pp_level, frm.pse_tos,
+                 pc->orig_line, cpd->pp_level, frm.pse_tos,
                  get_token_name(frm.pse[frm.pse_tos].type),
                  get_token_name(pc->type),
                  frm.pse[frm.pse_tos].open_line,
@@ -383,9 +378,9 @@ void indent_text(void)
    bool               did_newline = true;
    int                idx;
    int                vardefcol   = 0;
-   int                indent_size = cpd.settings[UO_indent_columns].n;
+   int                indent_size = cpd->settings[UO_indent_columns].n;
    int                tmp;
-   struct parse_frame frm;
+   struct parse_frame frm        = parse_frame();
    bool               in_preproc = false, was_preproc = false;
    int                indent_column;
    int                parent_token_indent = 0;
@@ -394,7 +389,10 @@ void indent_text(void)
    int                sql_col      = 0;
    int                sql_orig_col = 0;
 
-   memset(&frm, 0, sizeof(frm));
+   /* The last OC block caret seen on each level, outside of a preprocessor
+    * and in the current one. This is what a walk back would find. */
+   std::vector<chunk_t *> carets;
+   std::vector<chunk_t *> pp_carets;
 
    /* dummy top-level entry */
    frm.pse[0].indent     = 1;
@@ -402,27 +400,42 @@ void indent_text(void)
    frm.pse[0].indent_tab = 1;
    frm.pse[0].type       = CT_EOF;
 
+   oc_msg_lines_reset();
+
    pc = chunk_get_head();
    while (pc != NULL)
    {
       /* Handle proprocessor transitions */
       was_preproc = in_preproc;
       in_preproc  = (pc->flags & PCF_IN_PREPROC) != 0;
-      
-      if ((pc->parent_type == CT_OC_MSG) && 
-          (cpd.settings[UO_indent_preserve_in_oc_msg_send].b)) 
+
+      if (in_preproc && ((pc->prev == NULL) || ((pc->prev->flags & PCF_IN_PREPROC) == 0)))
+      {
+         pp_carets.clear();
+      }
+      if (pc->type == CT_OC_BLOCK_CARET)
+      {
+         std::vector<chunk_t *>& lvl_carets = in_preproc ? pp_carets : carets;
+         if ((int)lvl_carets.size() <= pc->level)
+         {
+            lvl_carets.resize(pc->level + 1, NULL);
+         }
+         lvl_carets[pc->level] = pc;
+      }
+
+      if ((pc->parent_type == CT_OC_MSG) &&
+          (cpd->settings[UO_indent_preserve_in_oc_msg_send].b))
       {
          /* Quick fix for avoiding excessive indentation of already
             indented lines in ObjC msg sends unless this is a multiline 
             msg send suitable for colon alignment */
-         if (!(next_line_has_oc_msg_colon(pc, -1)) &&
-             !(prev_line_has_oc_msg_colon(pc, -1)))
+         if (!oc_msg_line_near_colon(pc, -1))
          {
             pc->flags |= PCF_DONT_INDENT;
          }
       }
 
-      if (cpd.settings[UO_indent_brace_parent].b)
+      if (cpd->settings[UO_indent_brace_parent].b)
       {
          parent_token_indent = token_indent(pc->parent_type);
       }
@@ -458,14 +471,14 @@ void indent_text(void)
          pf_check(&frm, pc);
 
          /* Indent the body of a #region here */
-         if (cpd.settings[UO_pp_region_indent_code].b &&
+         if (cpd->settings[UO_pp_region_indent_code].b &&
              (pc->parent_type == CT_PP_REGION))
          {
             next = chunk_get_next(pc);
             /* Hack to get the logs to look right */
-            next->type = CT_PP_REGION_INDENT;
+            chunk_set_type(next, CT_PP_REGION_INDENT);
             indent_pse_push(frm, next);
-            next->type = CT_PP_REGION;
+            chunk_set_type(next, CT_PP_REGION);
 
             /* Indent one level */
             frm.pse[frm.pse_tos].indent     = frm.pse[frm.pse_tos - 1].indent + indent_size;
@@ -475,15 +488,15 @@ void indent_text(void)
          }
 
          /* Indent the body of a #if here */
-         if (cpd.settings[UO_pp_if_indent_code].b &&
+         if (cpd->settings[UO_pp_if_indent_code].b &&
              ((pc->parent_type == CT_PP_IF) ||
               (pc->parent_type == CT_PP_ELSE)))
          {
             next = chunk_get_next(pc);
             /* Hack to get the logs to look right */
-            next->type = CT_PP_IF_INDENT;
+            chunk_set_type(next, CT_PP_IF_INDENT);
             indent_pse_push(frm, next);
-            next->type = CT_PP_IF;
+            chunk_set_type(next, CT_PP_IF);
 
             /* Indent one level */
             frm.pse[frm.pse_tos].indent     = frm.pse[frm.pse_tos - 1].indent + indent_size;
@@ -498,7 +511,7 @@ void indent_text(void)
 
          if (pc->parent_type == CT_PP_DEFINE)
          {
-            frm.pse[frm.pse_tos].indent_tmp = cpd.settings[UO_pp_define_at_level].b ?
+            frm.pse[frm.pse_tos].indent_tmp = cpd->settings[UO_pp_define_at_level].b ?
                                               frm.pse[frm.pse_tos - 1].indent_tmp : 1;
             frm.pse[frm.pse_tos].indent = frm.pse[frm.pse_tos].indent_tmp + indent_size;
          }
@@ -517,7 +530,7 @@ void indent_text(void)
             if ((pc->parent_type == CT_PP_REGION) ||
                 (pc->parent_type == CT_PP_ENDREGION))
             {
-               int val = cpd.settings[UO_pp_indent_region].n;
+               int val = cpd->settings[UO_pp_indent_region].n;
                if (val > 0)
                {
                   frm.pse[frm.pse_tos].indent = val;
@@ -531,7 +544,7 @@ void indent_text(void)
                      (pc->parent_type == CT_PP_ELSE) ||
                      (pc->parent_type == CT_PP_ENDIF))
             {
-               int val = cpd.settings[UO_pp_indent_if].n;
+               int val = cpd->settings[UO_pp_indent_if].n;
                if (val > 0)
                {
                   frm.pse[frm.pse_tos].indent = val;
@@ -546,7 +559,7 @@ void indent_text(void)
       }
 
       /* Check for close XML tags "</..." */
-      if (cpd.settings[UO_indent_xml_string].n > 0)
+      if (cpd->settings[UO_indent_xml_string].n > 0)
       {
          if (pc->type == CT_STRING)
          {
@@ -555,7 +568,7 @@ void indent_text(void)
                 (pc->str[1] == '<') &&
                 (pc->str[2] == '/'))
             {
-               xml_indent -= cpd.settings[UO_indent_xml_string].n;
+               xml_indent -= cpd->settings[UO_indent_xml_string].n;
             }
          }
          else
@@ -597,6 +610,11 @@ void indent_text(void)
                indent_pse_pop(frm, pc);
                frm.level--;
                pc = chunk_get_next(pc);
+               if (pc == NULL)
+               {
+                  /* the file ended with a virtual brace */
+                  break;
+               }
             }
 
             /* End any assign operations with a semicolon on the same level */
@@ -648,7 +666,7 @@ void indent_text(void)
             }
 
             /* a class scope is ended with another class scope or a close brace */
-            if (cpd.settings[UO_indent_access_spec_body].b &&
+            if (cpd->settings[UO_indent_access_spec_body].b &&
                 (frm.pse[frm.pse_tos].type == CT_PRIVATE) &&
                 ((pc->type == CT_BRACE_CLOSE) ||
                  (pc->type == CT_PRIVATE)))
@@ -684,6 +702,11 @@ void indent_text(void)
          }
       } while (old_pse_tos > frm.pse_tos);
 
+      if (pc == NULL)
+      {
+         break;
+      }
+
       /* Grab a copy of the current indent */
       indent_column_set(frm.pse[frm.pse_tos].indent_tmp);
 
@@ -716,8 +739,8 @@ void indent_text(void)
       bool brace_indent = false;
       if ((pc->type == CT_BRACE_CLOSE) || (pc->type == CT_BRACE_OPEN))
       {
-         brace_indent = (cpd.settings[UO_indent_braces].b &&
-                         (!cpd.settings[UO_indent_braces_no_func].b ||
+         brace_indent = (cpd->settings[UO_indent_braces].b &&
+                         (!cpd->settings[UO_indent_braces_no_func].b ||
                           (pc->parent_type != CT_FUNC_DEF)));
       }
       
@@ -760,7 +783,12 @@ void indent_text(void)
                than good. Other block expressions appear to do OK. */
             
             c_token_t pt = (c_token_t)-1;
-            chunk_t * oc = chunk_get_prev_type(pc, CT_OC_BLOCK_CARET, pc->level, CNAV_PREPROC);
+            chunk_t * oc = NULL;
+            std::vector<chunk_t *>& lvl_carets = in_preproc ? pp_carets : carets;
+            if (pc->level < (int)lvl_carets.size())
+            {
+               oc = lvl_carets[pc->level];
+            }
             if (oc != NULL) 
             {
                oc = chunk_get_prev(oc, CNAV_PREPROC);
@@ -808,8 +836,8 @@ void indent_text(void)
                }
                else
                {
-                  frm.pse[frm.pse_tos].indent += cpd.settings[UO_indent_brace].n;
-                  indent_column_set(indent_column + cpd.settings[UO_indent_brace].n);
+                  frm.pse[frm.pse_tos].indent += cpd->settings[UO_indent_brace].n;
+                  indent_column_set(indent_column + cpd->settings[UO_indent_brace].n);
                }
             }
             else if (pc->parent_type == CT_CASE)
@@ -820,35 +848,35 @@ void indent_text(void)
                 * indent_size that was added above and then add indent_case_brace.
                 */
                indent_column_set(frm.pse[frm.pse_tos - 1].indent - indent_size +
-                                 cpd.settings[UO_indent_case_brace].n);
+                                 cpd->settings[UO_indent_case_brace].n);
 
                /* Stuff inside the brace still needs to be indented */
                frm.pse[frm.pse_tos].indent     = indent_column + indent_size;
                frm.pse[frm.pse_tos].indent_tmp = frm.pse[frm.pse_tos].indent;
             }
-            else if ((pc->parent_type == CT_CLASS) && !cpd.settings[UO_indent_class].b)
+            else if ((pc->parent_type == CT_CLASS) && !cpd->settings[UO_indent_class].b)
             {
                frm.pse[frm.pse_tos].indent -= indent_size;
             }
             else if (pc->parent_type == CT_NAMESPACE)
             {
                if ((pc->flags & PCF_LONG_BLOCK) ||
-                   !cpd.settings[UO_indent_namespace].b)
+                   !cpd->settings[UO_indent_namespace].b)
                {
                   /* don't indent long blocks */
                   frm.pse[frm.pse_tos].indent -= indent_size;
                }
                else /* indenting 'short' namespace */
                {
-                  if (cpd.settings[UO_indent_namespace_level].n > 0)
+                  if (cpd->settings[UO_indent_namespace_level].n > 0)
                   {
                      frm.pse[frm.pse_tos].indent -= indent_size;
                      frm.pse[frm.pse_tos].indent +=
-                        cpd.settings[UO_indent_namespace_level].n;
+                        cpd->settings[UO_indent_namespace_level].n;
                   }
                }
             }
-            else if ((pc->parent_type == CT_EXTERN) && !cpd.settings[UO_indent_extern].b)
+            else if ((pc->parent_type == CT_EXTERN) && !cpd->settings[UO_indent_extern].b)
             {
                frm.pse[frm.pse_tos].indent -= indent_size;
             }
@@ -930,12 +958,12 @@ void indent_text(void)
       else if (pc->type == CT_CASE)
       {
          /* Start a case - indent UO_indent_switch_case from the switch level */
-         tmp = frm.pse[frm.pse_tos].indent + cpd.settings[UO_indent_switch_case].n;
+         tmp = frm.pse[frm.pse_tos].indent + cpd->settings[UO_indent_switch_case].n;
 
          indent_pse_push(frm, pc);
 
          frm.pse[frm.pse_tos].indent     = tmp;
-         frm.pse[frm.pse_tos].indent_tmp = tmp - indent_size + cpd.settings[UO_indent_case_shift].n;
+         frm.pse[frm.pse_tos].indent_tmp = tmp - indent_size + cpd->settings[UO_indent_case_shift].n;
          frm.pse[frm.pse_tos].indent_tab = tmp;
 
          /* Always set on case statements */
@@ -968,19 +996,19 @@ void indent_text(void)
       else if (pc->type == CT_LABEL)
       {
          /* Labels get sent to the left or backed up */
-         if (cpd.settings[UO_indent_label].n > 0)
+         if (cpd->settings[UO_indent_label].n > 0)
          {
-            indent_column_set(cpd.settings[UO_indent_label].n);
+            indent_column_set(cpd->settings[UO_indent_label].n);
          }
          else
          {
             indent_column_set(frm.pse[frm.pse_tos].indent +
-                              cpd.settings[UO_indent_label].n);
+                              cpd->settings[UO_indent_label].n);
          }
       }
       else if (pc->type == CT_PRIVATE)
       {
-         if (cpd.settings[UO_indent_access_spec_body].b)
+         if (cpd->settings[UO_indent_access_spec_body].b)
          {
             tmp = frm.pse[frm.pse_tos].indent + indent_size;
 
@@ -998,14 +1026,14 @@ void indent_text(void)
          else
          {
             /* Access spec labels get sent to the left or backed up */
-            if (cpd.settings[UO_indent_access_spec].n > 0)
+            if (cpd->settings[UO_indent_access_spec].n > 0)
             {
-               indent_column_set(cpd.settings[UO_indent_access_spec].n);
+               indent_column_set(cpd->settings[UO_indent_access_spec].n);
             }
             else
             {
                indent_column_set(frm.pse[frm.pse_tos].indent +
-                                 cpd.settings[UO_indent_access_spec].n);
+                                 cpd->settings[UO_indent_access_spec].n);
             }
          }
       }
@@ -1019,7 +1047,7 @@ void indent_text(void)
 
          indent_column_set(frm.pse[frm.pse_tos].indent_tmp);
 
-         if (cpd.settings[UO_indent_class_colon].b)
+         if (cpd->settings[UO_indent_class_colon].b)
          {
             prev = chunk_get_prev(pc);
             if (chunk_is_newline(prev))
@@ -1050,24 +1078,24 @@ void indent_text(void)
          frm.pse[frm.pse_tos].indent = pc->column + pc->len;
 
          if (((pc->type == CT_FPAREN_OPEN) || (pc->type == CT_ANGLE_OPEN)) &&
-             ((cpd.settings[UO_indent_func_call_param].b &&
+             ((cpd->settings[UO_indent_func_call_param].b &&
                ((pc->parent_type == CT_FUNC_CALL) ||
                 (pc->parent_type == CT_FUNC_CALL_USER)))
               ||
-              (cpd.settings[UO_indent_func_proto_param].b &&
+              (cpd->settings[UO_indent_func_proto_param].b &&
                ((pc->parent_type == CT_FUNC_PROTO) ||
                 (pc->parent_type == CT_FUNC_CLASS)))
               ||
-              (cpd.settings[UO_indent_func_class_param].b &&
+              (cpd->settings[UO_indent_func_class_param].b &&
                (pc->parent_type == CT_FUNC_CLASS))
               ||
-              (cpd.settings[UO_indent_template_param].b &&
+              (cpd->settings[UO_indent_template_param].b &&
                (pc->parent_type == CT_TEMPLATE))
               ||
-              (cpd.settings[UO_indent_func_ctor_var_param].b &&
+              (cpd->settings[UO_indent_func_ctor_var_param].b &&
                (pc->parent_type == CT_FUNC_CTOR_VAR))
               ||
-              (cpd.settings[UO_indent_func_def_param].b &&
+              (cpd->settings[UO_indent_func_def_param].b &&
                (pc->parent_type == CT_FUNC_DEF))))
          {
             /* Skip any continuation indents */
@@ -1086,16 +1114,16 @@ void indent_text(void)
                idx--;
             }
             frm.pse[frm.pse_tos].indent = frm.pse[idx].indent + indent_size;
-            if (cpd.settings[UO_indent_func_param_double].b)
+            if (cpd->settings[UO_indent_func_param_double].b)
             {
                frm.pse[frm.pse_tos].indent += indent_size;
             }
             frm.pse[frm.pse_tos].indent_tab = frm.pse[frm.pse_tos].indent;
          }
 
-         else if ((chunk_is_str(pc, "(", 1) && !cpd.settings[UO_indent_paren_nl].b) ||
-                  (chunk_is_str(pc, "<", 1) && !cpd.settings[UO_indent_paren_nl].b) || /* TODO: add indent_angle_nl? */
-                  (chunk_is_str(pc, "[", 1) && !cpd.settings[UO_indent_square_nl].b))
+         else if ((chunk_is_str(pc, "(", 1) && !cpd->settings[UO_indent_paren_nl].b) ||
+                  (chunk_is_str(pc, "<", 1) && !cpd->settings[UO_indent_paren_nl].b) || /* TODO: add indent_angle_nl? */
+                  (chunk_is_str(pc, "[", 1) && !cpd->settings[UO_indent_square_nl].b))
          {
             next = chunk_get_next_nc(pc);
             if (chunk_is_newline(next))
@@ -1148,7 +1176,7 @@ void indent_text(void)
          if (next != NULL)
          {
             indent_pse_push(frm, pc);
-            if (chunk_is_newline(next) || !cpd.settings[UO_indent_align_assign].b)
+            if (chunk_is_newline(next) || !cpd->settings[UO_indent_align_assign].b)
             {
                frm.pse[frm.pse_tos].indent = frm.pse[frm.pse_tos - 1].indent_tmp + indent_size;
                if (pc->type == CT_ASSIGN)
@@ -1188,10 +1216,10 @@ void indent_text(void)
          {
             indent_pse_push(frm, pc);
 
-            if ((cpd.settings[UO_indent_func_throw].n != 0) &&
+            if ((cpd->settings[UO_indent_func_throw].n != 0) &&
                 ((prev == NULL) || (prev->type == CT_NEWLINE)))
             {
-               frm.pse[frm.pse_tos].indent = cpd.settings[UO_indent_func_throw].n;
+               frm.pse[frm.pse_tos].indent = cpd->settings[UO_indent_func_throw].n;
             }
             else
             {
@@ -1204,10 +1232,10 @@ void indent_text(void)
          }
          else if (pc->parent_type == CT_FUNC_DEF)
          {
-            if ((cpd.settings[UO_indent_func_throw].n != 0) &&
+            if ((cpd->settings[UO_indent_func_throw].n != 0) &&
                 ((prev == NULL) || (prev->type == CT_NEWLINE)))
             {
-               indent_column_set(cpd.settings[UO_indent_func_throw].n);
+               indent_column_set(cpd->settings[UO_indent_func_throw].n);
                LOG_FMT(LINDENT, "%s: %d] throw => %d [%.*s]\n",
                        __func__, pc->orig_line, indent_column, pc->len, pc->str);
                reindent_line(pc, indent_column);
@@ -1242,7 +1270,7 @@ void indent_text(void)
             /* no change */
          }
          else if ((pc->parent_type == CT_SQL_EXEC) &&
-                  cpd.settings[UO_indent_preserve_sql].b)
+                  cpd->settings[UO_indent_preserve_sql].b)
          {
             reindent_line(pc, sql_col + (pc->orig_col - sql_orig_col));
             LOG_FMT(LINDENT, "Indent SQL: [%.*s] to %d (%d/%d)\n",
@@ -1255,7 +1283,7 @@ void indent_text(void)
                     ((prev->type == CT_MEMBER) ||
                      (prev->type == CT_DC_MEMBER)))))
          {
-            tmp = cpd.settings[UO_indent_member].n + indent_column;
+            tmp = cpd->settings[UO_indent_member].n + indent_column;
             LOG_FMT(LINDENT, "%s: %d] member => %d\n",
                     __func__, pc->orig_line, tmp);
             reindent_line(pc, tmp);
@@ -1270,8 +1298,9 @@ void indent_text(void)
                     __func__, pc->orig_line, vardefcol);
             reindent_line(pc, vardefcol);
          }
-         else if ((pc->type == CT_STRING) && (prev->type == CT_STRING) &&
-                  cpd.settings[UO_indent_align_string].b)
+         else if ((pc->type == CT_STRING) &&
+                  (prev != NULL) && (prev->type == CT_STRING) &&
+                  cpd->settings[UO_indent_align_string].b)
          {
             tmp = (xml_indent != 0) ? xml_indent : prev->column;
 
@@ -1303,16 +1332,16 @@ void indent_text(void)
                /* If the open paren was the first thing on the line or we are
                * doing mode 1, then put the close paren in the same column */
                if (chunk_is_newline(ck2) ||
-                   (cpd.settings[UO_indent_paren_close].n == 1))
+                   (cpd->settings[UO_indent_paren_close].n == 1))
                {
                   indent_column_set(ck1->column);
                }
                else
                {
-                  if (cpd.settings[UO_indent_paren_close].n != 2)
+                  if (cpd->settings[UO_indent_paren_close].n != 2)
                   {
                      indent_column_set(frm.pse[frm.pse_tos + 1].indent_tmp);
-                     if (cpd.settings[UO_indent_paren_close].n == 1)
+                     if (cpd->settings[UO_indent_paren_close].n == 1)
                      {
                         indent_column--;
                      }
@@ -1325,7 +1354,7 @@ void indent_text(void)
          }
          else if (pc->type == CT_COMMA)
          {
-            if (cpd.settings[UO_indent_comma_paren].b &&
+            if (cpd->settings[UO_indent_comma_paren].b &&
                 chunk_is_paren_open(frm.pse[frm.pse_tos].pc))
             {
                indent_column_set(frm.pse[frm.pse_tos].pc->column);
@@ -1334,7 +1363,7 @@ void indent_text(void)
                     __func__, pc->orig_line, indent_column, pc->len, pc->str);
             reindent_line(pc, indent_column);
          }
-         else if (cpd.settings[UO_indent_func_const].n &&
+         else if (cpd->settings[UO_indent_func_const].n &&
                   (pc->type == CT_QUALIFIER) &&
                   (strncasecmp(pc->str, "const", pc->len) == 0) &&
                   ((next == NULL) ||
@@ -1346,14 +1375,14 @@ void indent_text(void)
                    (next->type == CT_VBRACE_OPEN)))
          {
             // indent const - void GetFoo(void)\n const\n { return (m_Foo); }
-            indent_column_set(cpd.settings[UO_indent_func_const].n);
+            indent_column_set(cpd->settings[UO_indent_func_const].n);
             LOG_FMT(LINDENT, "%s: %d] const => %d [%.*s]\n",
                     __func__, pc->orig_line, indent_column, pc->len, pc->str);
             reindent_line(pc, indent_column);
          }
          else if (pc->type == CT_BOOL)
          {
-            if (cpd.settings[UO_indent_bool_paren].b &&
+            if (cpd->settings[UO_indent_bool_paren].b &&
                 chunk_is_paren_open(frm.pse[frm.pse_tos].pc))
             {
                indent_column_set(frm.pse[frm.pse_tos].pc->column);
@@ -1388,13 +1417,13 @@ void indent_text(void)
                 (frm.pse[frm.pse_tos].type == CT_BRACE_OPEN))
             {
                int tmp = indent_column;
-               if (cpd.settings[UO_indent_var_def_blk].n > 0)
+               if (cpd->settings[UO_indent_var_def_blk].n > 0)
                {
-                  tmp = cpd.settings[UO_indent_var_def_blk].n;
+                  tmp = cpd->settings[UO_indent_var_def_blk].n;
                }
                else
                {
-                  tmp += cpd.settings[UO_indent_var_def_blk].n;
+                  tmp += cpd->settings[UO_indent_var_def_blk].n;
                }
                reindent_line(pc, tmp);
                LOG_FMT(LINDENT, "%s: %d] var_type indent => %d [%.*s]\n",
@@ -1447,7 +1476,7 @@ void indent_text(void)
       }
 
       /* Check for open XML tags "</..." */
-      if (cpd.settings[UO_indent_xml_string].n > 0)
+      if (cpd->settings[UO_indent_xml_string].n > 0)
       {
          if (pc->type == CT_STRING)
          {
@@ -1460,7 +1489,7 @@ void indent_text(void)
                {
                   xml_indent = pc->column;
                }
-               xml_indent += cpd.settings[UO_indent_xml_string].n;
+               xml_indent += cpd->settings[UO_indent_xml_string].n;
             }
          }
       }
@@ -1481,9 +1510,9 @@ void indent_text(void)
    for (idx = 1; idx <= frm.pse_tos; idx++)
    {
       LOG_FMT(LWARN, "%s:%d Unmatched %s\n",
-              cpd.filename, frm.pse[idx].open_line,
+              cpd->filename, frm.pse[idx].open_line,
               get_token_name(frm.pse[idx].type));
-      cpd.error_count++;
+      cpd->error_count++;
    }
 
    quick_align_again();
@@ -1578,7 +1607,7 @@ static void indent_comment(chunk_t *pc, int col)
            pc->orig_line, pc->orig_col, pc->level);
 
    /* force column 1 comment to column 1 if not changing them */
-   if ((pc->orig_col == 1) && !cpd.settings[UO_indent_col1_comment].b &&
+   if ((pc->orig_col == 1) && !cpd->settings[UO_indent_col1_comment].b &&
        ((pc->flags & PCF_INSERTED) == 0))
    {
       LOG_FMT(LCMTIND, "rule 1 - keep in col 1\n");
@@ -1614,10 +1643,10 @@ static void indent_comment(chunk_t *pc, int col)
    }
 
    /* check if special single line comment rule applies */
-   if ((cpd.settings[UO_indent_sing_line_comments].n > 0) &&
+   if ((cpd->settings[UO_indent_sing_line_comments].n > 0) &&
        single_line_comment_indent_rule_applies(pc))
    {
-      reindent_line(pc, col + cpd.settings[UO_indent_sing_line_comments].n);
+      reindent_line(pc, col + cpd->settings[UO_indent_sing_line_comments].n);
       LOG_FMT(LCMTIND, "rule 4 - single line comment indent, now in %d\n", pc->column);
       return;
    }
@@ -1723,21 +1752,21 @@ void indent_preproc(void)
       }
 
       /* Adjust the indent of the '#' */
-      if ((cpd.settings[UO_pp_indent].a & AV_ADD) != 0)
+      if ((cpd->settings[UO_pp_indent].a & AV_ADD) != 0)
       {
-         reindent_line(pc, 1 + pp_level * cpd.settings[UO_pp_indent_count].n);
+         reindent_line(pc, 1 + pp_level * cpd->settings[UO_pp_indent_count].n);
       }
-      else if ((cpd.settings[UO_pp_indent].a & AV_REMOVE) != 0)
+      else if ((cpd->settings[UO_pp_indent].a & AV_REMOVE) != 0)
       {
          reindent_line(pc, 1);
       }
 
       /* Add spacing by adjusting the length */
-      if ((cpd.settings[UO_pp_space].a != AV_IGNORE) && (next != NULL))
+      if ((cpd->settings[UO_pp_space].a != AV_IGNORE) && (next != NULL))
       {
-         if ((cpd.settings[UO_pp_space].a & AV_ADD) != 0)
+         if ((cpd->settings[UO_pp_space].a & AV_ADD) != 0)
          {
-            int mult = cpd.settings[UO_pp_space_count].n;
+            int mult = cpd->settings[UO_pp_space_count].n;
 
             if (mult < 1)
             {
@@ -1745,19 +1774,19 @@ void indent_preproc(void)
             }
             reindent_line(next, pc->column + pc->len + (pp_level * mult));
          }
-         else if ((cpd.settings[UO_pp_space].a & AV_REMOVE) != 0)
+         else if ((cpd->settings[UO_pp_space].a & AV_REMOVE) != 0)
          {
             reindent_line(next, pc->column + pc->len);
          }
       }
 
       /* Mark as already handled if not region stuff or in column 1 */
-      if ((!cpd.settings[UO_pp_indent_at_level].b ||
+      if ((!cpd->settings[UO_pp_indent_at_level].b ||
            (pc->brace_level <= (pc->parent_type == CT_PP_DEFINE ? 1 : 0))) &&
           (pc->parent_type != CT_PP_REGION) &&
           (pc->parent_type != CT_PP_ENDREGION))
       {
-         if (!cpd.settings[UO_pp_define_at_level].b ||
+         if (!cpd->settings[UO_pp_define_at_level].b ||
              (pc->parent_type != CT_PP_DEFINE))
          {
             pc->flags |= PCF_DONT_INDENT;
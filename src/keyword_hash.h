@@ -0,0 +1,543 @@
+/**
+ * @file keyword_hash.h
+ * Automatically generated by scripts/keywords.py
+ */
+#define KW_HASH_SIZE       512
+#define KW_HASH_BUCKETS    128
+#define KW_HASH_KEYWORDS   222
+
+static const UINT16 kw_hash_disp[KW_HASH_BUCKETS] =
+{
+     0,   0,   0,   0,   1,   0,   0,   1,
+     0,   0,   0,   0,   0,   0,   0,   0,
+     0,   1,   2,   1,   0,   0,   2,   0,
+     0,   0,   0,   1,   1,   1,   2,   0,
+     0,   1,   2,   0,   0,   0,   0,   1,
+     0,   1,   1,   0,   0,   2,   0,   0,
+     1,   0,   0,   0,   7,   2,   0,   1,
+     1,   0,   1,   0,   0,   0,   0,   0,
+     0,   0,   1,   0,   0,   0,   0,   0,
+     2,   0,   0,   1,   0,   1,   2,   0,
+     3,   0,   0,   0,   0,   0,   0,   0,
+     0,   4,   0,   4,   0,   0,   0,   1,
+     1,   1,   0,   5,   0,   0,   2,   0,
+     2,   1,   3,   2,   2,   0,   1,   0,
+     2,   0,   0,   0,   3,   0,   2,   0,
+     1,   0,   0,   4,   0,   1,   0,   0,
+};
+
+static const kw_hash_entry_t kw_hash_table[KW_HASH_SIZE] =
+{
+   {   0,  0, 0 },   //   0:
+   {   0,  0, 0 },   //   1:
+   {   0,  0, 0 },   //   2:
+   {   0,  0, 0 },   //   3:
+   {   0,  0, 0 },   //   4:
+   {   0,  0, 0 },   //   5:
+   {   6,  8, 1 },   //   6: @private
+   {  23,  8, 1 },   //   7: abstract
+   {   0,  0, 0 },   //   8:
+   {   0,  0, 0 },   //   9:
+   {   0,  0, 0 },   //  10:
+   { 154,  4, 1 },   //  11: real
+   {   0,  0, 0 },   //  12:
+   {   0,  0, 0 },   //  13:
+   {   0,  0, 0 },   //  14:
+   {   0,  0, 0 },   //  15:
+   { 144,  5, 1 },   //  16: or_eq
+   {   0,  0, 0 },   //  17:
+   {   0,  0, 0 },   //  18:
+   {  48,  7, 1 },   //  19: cdouble
+   {  42,  5, 1 },   //  20: break
+   {   0,  0, 0 },   //  21:
+   { 132,  6, 1 },   //  22: module
+   {   0,  0, 0 },   //  23:
+   {   0,  0, 0 },   //  24:
+   {  82,  9, 1 },   //  25: endscript
+   {   0,  0, 0 },   //  26:
+   { 150,  7, 1 },   //  27: private
+   {   0,  0, 0 },   //  28:
+   {   0,  0, 0 },   //  29:
+   {   0,  0, 0 },   //  30:
+   {   0,  0, 0 },   //  31:
+   { 193,  7, 1 },   //  32: typedef
+   { 183, 12, 1 },   //  33: synchronized
+   { 201,  9, 1 },   //  34: unchecked
+   {  71,  2, 1 },   //  35: do
+   {   0,  0, 0 },   //  36:
+   {   0,  0, 0 },   //  37:
+   {   0,  0, 0 },   //  38:
+   {   0,  0, 0 },   //  39:
+   {   0,  0, 0 },   //  40:
+   {  30,  2, 1 },   //  41: as
+   {   0,  0, 0 },   //  42:
+   { 165,  7, 1 },   //  43: section
+   {  86,  4, 1 },   //  44: exit
+   { 197,  5, 1 },   //  45: ubyte
+   {   0,  0, 0 },   //  46:
+   {   0,  0, 0 },   //  47:
+   {   0,  0, 0 },   //  48:
+   {   0,  0, 0 },   //  49:
+   { 101,  6, 1 },   //  50: friend
+   {   0,  0, 0 },   //  51:
+   { 121,  9, 1 },   //  52: interface
+   {   0,  0, 0 },   //  53:
+   {   0,  0, 0 },   //  54:
+   {  12,  5, 1 },   //  55: _Bool
+   {   0,  0, 0 },   //  56:
+   { 203,  5, 1 },   //  57: union
+   {  14, 10, 1 },   //  58: _Imaginary
+   { 133,  7, 1 },   //  59: mutable
+   { 213,  8, 2 },   //  60: volatile
+   {  21, 10, 1 },   //  61: __typeof__
+   { 112,  8, 1 },   //  62: implicit
+   {  39,  4, 1 },   //  63: body
+   { 123,  9, 1 },   //  64: invariant
+   { 125,  2, 1 },   //  65: is
+   {   0,  0, 0 },   //  66:
+   { 184,  5, 1 },   //  67: tagof
+   {   0,  0, 0 },   //  68:
+   {   0,  0, 0 },   //  69:
+   {   0,  0, 0 },   //  70:
+   {   0,  0, 0 },   //  71:
+   {   0,  0, 0 },   //  72:
+   {   0,  0, 0 },   //  73:
+   {   0,  0, 0 },   //  74:
+   {   0,  0, 0 },   //  75:
+   {   0,  0, 0 },   //  76:
+   {   0,  0, 0 },   //  77:
+   {  92,  4, 1 },   //  78: file
+   { 198,  5, 1 },   //  79: ucent
+   {   0,  0, 0 },   //  80:
+   {   0,  0, 0 },   //  81:
+   {   0,  0, 0 },   //  82:
+   {   0,  0, 0 },   //  83:
+   {   0,  0, 0 },   //  84:
+   {  87,  8, 1 },   //  85: explicit
+   {   0,  0, 0 },   //  86:
+   { 190,  4, 1 },   //  87: true
+   {   0,  0, 0 },   //  88:
+   {   5, 10, 1 },   //  89: @interface
+   {   0,  0, 0 },   //  90:
+   {  10, 11, 1 },   //  91: @synthesize
+   {   0,  0, 0 },   //  92:
+   { 202,  5, 1 },   //  93: undef
+   {   0,  0, 0 },   //  94:
+   { 206,  8, 1 },   //  95: unsigned
+   {   0,  0, 0 },   //  96:
+   { 135,  6, 2 },   //  97: native
+   {  72,  6, 1 },   //  98: double
+   { 173, 10, 1 },   //  99: stackalloc
+   { 148,  6, 1 },   // 100: params
+   {  25,  5, 1 },   // 101: alias
+   { 218,  5, 1 },   // 102: while
+   {   0,  0, 0 },   // 103:
+   {   0,  0, 0 },   // 104:
+   {   0,  0, 0 },   // 105:
+   {   0,  0, 0 },   // 106:
+   { 162,  5, 1 },   // 107: sbyte
+   {  45,  4, 1 },   // 108: case
+   {  66,  7, 2 },   // 109: defined
+   {   0,  0, 0 },   // 110:
+   {   0,  0, 0 },   // 111:
+   { 199,  4, 1 },   // 112: uint
+   {   0,  0, 0 },   // 113:
+   {   0,  0, 0 },   // 114:
+   { 180,  6, 1 },   // 115: struct
+   {   0,  0, 0 },   // 116:
+   {   0,  0, 0 },   // 117:
+   {   0,  0, 0 },   // 118:
+   {   0,  0, 0 },   // 119:
+   {  20,  8, 1 },   // 120: __traits
+   {   0,  0, 0 },   // 121:
+   {   0,  0, 0 },   // 122:
+   {   0,  0, 0 },   // 123:
+   {   0,  0, 0 },   // 124:
+   {   0,  0, 0 },   // 125:
+   {   0,  0, 0 },   // 126:
+   {   0,  0, 0 },   // 127:
+   { 205,  6, 1 },   // 128: unsafe
+   { 169,  7, 1 },   // 129: signals
+   {  68,  8, 1 },   // 130: delegate
+   {  77,  6, 1 },   // 131: elseif
+   {  27,  7, 1 },   // 132: alignof
+   {  54,  5, 1 },   // 133: class
+   { 156,  6, 1 },   // 134: region
+   {   0,  0, 0 },   // 135:
+   {   0,  0, 0 },   // 136:
+   {   0,  0, 0 },   // 137:
+   { 160,  8, 1 },   // 138: restrict
+   {   0,  0, 0 },   // 139:
+   {   0,  0, 0 },   // 140:
+   {   0,  0, 0 },   // 141:
+   {   0,  0, 0 },   // 142:
+   {   0,  0, 0 },   // 143:
+   {  97,  3, 1 },   // 144: for
+   { 219,  4, 1 },   // 145: with
+   {  78,  4, 1 },   // 146: emit
+   { 108,  5, 1 },   // 147: ifdef
+   {   4, 15, 1 },   // 148: @implementation
+   { 145,  3, 1 },   // 149: out
+   {   0,  0, 0 },   // 150:
+   { 105,  7, 1 },   // 151: idouble
+   {   0,  0, 0 },   // 152:
+   { 141,  6, 1 },   // 153: object
+   { 208,  5, 1 },   // 154: using
+   { 221,  6, 1 },   // 155: xor_eq
+   { 195,  8, 1 },   // 156: typename
+   { 187,  5, 1 },   // 157: throw
+   {   0,  6, 1 },   // 158: @catch
+   {   3,  8, 1 },   // 159: @finally
+   {   0,  0, 0 },   // 160:
+   {   0,  0, 0 },   // 161:
+   {   0,  0, 0 },   // 162:
+   {   0,  0, 0 },   // 163:
+   {   0,  0, 0 },   // 164:
+   {   0,  0, 0 },   // 165:
+   {   0,  0, 0 },   // 166:
+   {   0,  0, 0 },   // 167:
+   {  96,  5, 1 },   // 168: float
+   {   0,  0, 0 },   // 169:
+   {   0,  0, 0 },   // 170:
+   {   0,  0, 0 },   // 171:
+   {   0,  0, 0 },   // 172:
+   {   0,  0, 0 },   // 173:
+   {   8,  9, 1 },   // 174: @protocol
+   { 137,  3, 1 },   // 175: new
+   {  24,  3, 1 },   // 176: add
+   {  62,  5, 1 },   // 177: debug
+   { 172,  5, 1 },   // 178: sleep
+   {   0,  0, 0 },   // 179:
+   { 209,  3, 1 },   // 180: var
+   { 191,  3, 1 },   // 181: try
+   {  19, 10, 1 },   // 182: __signed__
+   {   0,  0, 0 },   // 183:
+   {   0,  0, 0 },   // 184:
+   { 131,  5, 1 },   // 185: mixin
+   {   0,  0, 0 },   // 186:
+   { 142,  8, 1 },   // 187: operator
+   {  41,  7, 1 },   // 188: boolean
+   {  47,  5, 1 },   // 189: catch
+   {   0,  0, 0 },   // 190:
+   { 116,  7, 1 },   // 191: include
+   {   0,  0, 0 },   // 192:
+   { 182,  6, 1 },   // 193: switch
+   {   0,  0, 0 },   // 194:
+   {   0,  0, 0 },   // 195:
+   {   0,  0, 0 },   // 196:
+   {  79,  5, 1 },   // 197: endif
+   {  94,  7, 1 },   // 198: finally
+   {  75,  4, 2 },   // 199: else
+   {  28,  3, 1 },   // 200: and
+   { 159,  6, 1 },   // 201: remove
+   { 129,  4, 1 },   // 202: long
+   {  99, 15, 1 },   // 203: foreach_reverse
+   { 127,  4, 1 },   // 204: line
+   {   0,  0, 0 },   // 205:
+   { 181,  5, 1 },   // 206: super
+   {   0,  0, 0 },   // 207:
+   {   0,  0, 0 },   // 208:
+   {   0,  0, 0 },   // 209:
+   {   0,  0, 0 },   // 210:
+   {   0,  0, 0 },   // 211:
+   {   0,  0, 0 },   // 212:
+   {   0,  0, 0 },   // 213:
+   {   2,  4, 1 },   // 214: @end
+   { 128,  4, 1 },   // 215: lock
+   {  15, 13, 1 },   // 216: __attribute__
+   {   0,  0, 0 },   // 217:
+   {   0,  0, 0 },   // 218:
+   {  93,  5, 1 },   // 219: final
+   {   0,  0, 0 },   // 220:
+   {   0,  0, 0 },   // 221:
+   {   0,  0, 0 },   // 222:
+   {   0,  0, 0 },   // 223:
+   {   0,  0, 0 },   // 224:
+   {  16,  9, 1 },   // 225: __const__
+   {  80,  8, 1 },   // 226: endinput
+   {   0,  0, 0 },   // 227:
+   {   0,  0, 0 },   // 228:
+   {   0,  0, 0 },   // 229:
+   {   0,  0, 0 },   // 230:
+   {  29,  6, 1 },   // 231: and_eq
+   {   0,  0, 0 },   // 232:
+   {  13,  8, 1 },   // 233: _Complex
+   {   0,  0, 0 },   // 234:
+   {   0,  0, 0 },   // 235:
+   {   0,  0, 0 },   // 236:
+   {   0,  0, 0 },   // 237:
+   {  32,  6, 2 },   // 238: assert
+   {   0,  0, 0 },   // 239:
+   { 192, 10, 1 },   // 240: tryinclude
+   {   0,  0, 0 },   // 241:
+   {   0,  0, 0 },   // 242:
+   { 171,  6, 1 },   // 243: sizeof
+   {  98,  7, 1 },   // 244: foreach
+   { 152,  6, 1 },   // 245: public
+   {   0,  0, 0 },   // 246:
+   {   0,  0, 0 },   // 247:
+   {   0,  0, 0 },   // 248:
+   {  84,  5, 1 },   // 249: error
+   { 134,  9, 1 },   // 250: namespace
+   {   0,  0, 0 },   // 251:
+   {   0,  0, 0 },   // 252:
+   { 177,  5, 1 },   // 253: stock
+   { 215,  5, 1 },   // 254: wchar
+   {   0,  0, 0 },   // 255:
+   {   0,  0, 0 },   // 256:
+   {   0,  0, 0 },   // 257:
+   {   0,  0, 0 },   // 258:
+   {  11,  4, 1 },   // 259: @try
+   {  49,  4, 1 },   // 260: cent
+   {   0,  0, 0 },   // 261:
+   {   0,  0, 0 },   // 262:
+   {   0,  0, 0 },   // 263:
+   { 155,  3, 1 },   // 264: ref
+   {   0,  0, 0 },   // 265:
+   {   0,  0, 0 },   // 266:
+   { 212,  4, 1 },   // 267: void
+   {   0,  0, 0 },   // 268:
+   {   0,  0, 0 },   // 269:
+   {   0,  0, 0 },   // 270:
+   {   0,  0, 0 },   // 271:
+   {  89,  7, 1 },   // 272: extends
+   {  69,  6, 1 },   // 273: delete
+   { 139,  6, 1 },   // 274: not_eq
+   {  17, 10, 1 },   // 275: __inline__
+   { 211,  7, 1 },   // 276: virtual
+   {   0,  0, 0 },   // 277:
+   { 164,  6, 1 },   // 278: sealed
+   {  65,  6, 1 },   // 279: define
+   {   0,  0, 0 },   // 280:
+   { 186,  4, 1 },   // 281: this
+   {   0,  0, 0 },   // 282:
+   {   0,  0, 0 },   // 283:
+   {   0,  0, 0 },   // 284:
+   {   0,  0, 0 },   // 285:
+   {   0,  0, 0 },   // 286:
+   {  95,  5, 1 },   // 287: flags
+   {   0,  0, 0 },   // 288:
+   {   0,  0, 0 },   // 289:
+   {  91,  5, 1 },   // 290: false
+   { 157,  8, 1 },   // 291: register
+   {   0,  0, 0 },   // 292:
+   {   0,  0, 0 },   // 293:
+   {   0,  0, 0 },   // 294:
+   {   0,  0, 0 },   // 295:
+   {  38,  5, 1 },   // 296: bitor
+   {   0,  0, 0 },   // 297:
+   { 151,  9, 1 },   // 298: protected
+   {  53,  7, 1 },   // 299: checked
+   {   0,  0, 0 },   // 300:
+   {   0,  0, 0 },   // 301:
+   { 143,  2, 1 },   // 302: or
+   {   0,  0, 0 },   // 303:
+   { 122,  8, 1 },   // 304: internal
+   { 178,  8, 1 },   // 305: strictfp
+   {  36,  3, 1 },   // 306: bit
+   {  43,  4, 1 },   // 307: byte
+   {   0,  0, 0 },   // 308:
+   {   0,  0, 0 },   // 309:
+   {   0,  0, 0 },   // 310:
+   {   0,  0, 0 },   // 311:
+   {   0,  0, 0 },   // 312:
+   {   0,  0, 0 },   // 313:
+   {   0,  0, 0 },   // 314:
+   {   0,  0, 0 },   // 315:
+   { 115,  2, 1 },   // 316: in
+   { 106,  2, 2 },   // 317: if
+   { 200,  5, 1 },   // 318: ulong
+   {   9,  9, 1 },   // 319: @selector
+   { 140,  4, 1 },   // 320: null
+   {   0,  0, 0 },   // 321:
+   {   0,  0, 0 },   // 322:
+   { 220,  3, 1 },   // 323: xor
+   {   0,  0, 0 },   // 324:
+   {   0,  0, 0 },   // 325:
+   {   0,  0, 0 },   // 326:
+   {   0,  0, 0 },   // 327:
+   {   0,  0, 0 },   // 328:
+   {   0,  0, 0 },   // 329:
+   { 124,  5, 1 },   // 330: ireal
+   { 166,  3, 1 },   // 331: set
+   {  60,  5, 1 },   // 332: creal
+   {   0,  0, 0 },   // 333:
+   {   0,  0, 0 },   // 334:
+   {   0,  0, 0 },   // 335:
+   { 217,  4, 1 },   // 336: weak
+   {  40,  4, 1 },   // 337: bool
+   {   0,  0, 0 },   // 338:
+   {   0,  0, 0 },   // 339:
+   {   0,  0, 0 },   // 340:
+   {   0,  0, 0 },   // 341:
+   {   0,  0, 0 },   // 342:
+   {  81,  9, 1 },   // 343: endregion
+   {   0,  0, 0 },   // 344:
+   { 103,  3, 1 },   // 345: get
+   {   0,  0, 0 },   // 346:
+   { 104,  4, 1 },   // 347: goto
+   {   0,  0, 0 },   // 348:
+   {   0,  0, 0 },   // 349:
+   {   0,  0, 0 },   // 350:
+   {   0,  0, 0 },   // 351:
+   {  26,  5, 1 },   // 352: align
+   {  44,  8, 1 },   // 353: callback
+   { 207,  6, 1 },   // 354: ushort
+   {   0,  0, 0 },   // 355:
+   {   0,  0, 0 },   // 356:
+   {   0,  0, 0 },   // 357:
+   {   0,  0, 0 },   // 358:
+   { 153,  8, 1 },   // 359: readonly
+   {   0,  0, 0 },   // 360:
+   {   0,  0, 0 },   // 361:
+   { 113,  6, 2 },   // 362: import
+   {   0,  0, 0 },   // 363:
+   { 170,  6, 1 },   // 364: signed
+   { 147,  7, 1 },   // 365: package
+   {  46,  4, 1 },   // 366: cast
+   {   1,  8, 1 },   // 367: @dynamic
+   { 130,  5, 1 },   // 368: macro
+   {   0,  0, 0 },   // 369:
+   {   0,  0, 0 },   // 370:
+   { 117,  6, 1 },   // 371: inline
+   {   0,  0, 0 },   // 372:
+   {   0,  0, 0 },   // 373:
+   {   0,  0, 0 },   // 374:
+   { 168,  6, 1 },   // 375: signal
+   {   0,  0, 0 },   // 376:
+   {   0,  0, 0 },   // 377:
+   {   0,  0, 0 },   // 378:
+   {   0,  0, 0 },   // 379:
+   {  57, 10, 1 },   // 380: const_cast
+   {   0,  0, 0 },   // 381:
+   {   0,  0, 0 },   // 382:
+   { 118,  5, 1 },   // 383: inout
+   {   0,  0, 0 },   // 384:
+   { 100,  7, 1 },   // 385: forward
+   {   0,  0, 0 },   // 386:
+   {   0,  0, 0 },   // 387:
+   {   0,  0, 0 },   // 388:
+   { 185,  8, 1 },   // 389: template
+   {   0,  0, 0 },   // 390:
+   {   0,  0, 0 },   // 391:
+   {   0,  0, 0 },   // 392:
+   {   0,  0, 0 },   // 393:
+   {   0,  0, 0 },   // 394:
+   {   0,  0, 0 },   // 395:
+   {  18, 10, 1 },   // 396: __restrict
+   {   0,  0, 0 },   // 397:
+   {   0,  0, 0 },   // 398:
+   { 210,  7, 1 },   // 399: version
+   {   0,  0, 0 },   // 400:
+   { 158, 16, 1 },   // 401: reinterpret_cast
+   { 175,  6, 1 },   // 402: static
+   {  61,  5, 1 },   // 403: dchar
+   {  59,  8, 1 },   // 404: continue
+   {  35,  4, 1 },   // 405: base
+   { 119, 10, 1 },   // 406: instanceof
+   {   7,  9, 1 },   // 407: @property
+   {  51,  4, 2 },   // 408: char
+   { 111, 10, 1 },   // 409: implements
+   { 102,  8, 1 },   // 410: function
+   {   0,  0, 0 },   // 411:
+   {   0,  0, 0 },   // 412:
+   {   0,  0, 0 },   // 413:
+   { 138,  3, 1 },   // 414: not
+   { 189,  9, 1 },   // 415: transient
+   {   0,  0, 0 },   // 416:
+   {   0,  0, 0 },   // 417:
+   {   0,  0, 0 },   // 418:
+   {   0,  0, 0 },   // 419:
+   { 179,  6, 1 },   // 420: string
+   {   0,  0, 0 },   // 421:
+   {  34,  4, 1 },   // 422: auto
+   {   0,  0, 0 },   // 423:
+   { 174,  5, 1 },   // 424: state
+   {  22, 12, 1 },   // 425: __volatile__
+   { 149,  6, 1 },   // 426: pragma
+   {   0,  0, 0 },   // 427:
+   {   0,  0, 0 },   // 428:
+   {   0,  0, 0 },   // 429:
+   {   0,  0, 0 },   // 430:
+   {  74,  4, 1 },   // 431: elif
+   {   0,  0, 0 },   // 432:
+   {   0,  0, 0 },   // 433:
+   {   0,  0, 0 },   // 434:
+   {   0,  0, 0 },   // 435:
+   {   0,  0, 0 },   // 436:
+   {   0,  0, 0 },   // 437:
+   {  55,  5, 1 },   // 438: compl
+   {   0,  0, 0 },   // 439:
+   { 110,  6, 1 },   // 440: ifndef
+   {  58,  9, 1 },   // 441: construct
+   {  50,  6, 1 },   // 442: cfloat
+   { 188,  6, 1 },   // 443: throws
+   {   0,  0, 0 },   // 444:
+   {   0,  0, 0 },   // 445:
+   {   0,  0, 0 },   // 446:
+   {   0,  0, 0 },   // 447:
+   {   0,  0, 0 },   // 448:
+   {  90,  6, 1 },   // 449: extern
+   {   0,  0, 0 },   // 450:
+   { 194,  6, 1 },   // 451: typeid
+   {   0,  0, 0 },   // 452:
+   {   0,  0, 0 },   // 453:
+   {   0,  0, 0 },   // 454:
+   {   0,  0, 0 },   // 455:
+   {   0,  0, 0 },   // 456:
+   { 196,  6, 1 },   // 457: typeof
+   { 167,  5, 1 },   // 458: short
+   {   0,  0, 0 },   // 459:
+   {   0,  0, 0 },   // 460:
+   {   0,  0, 0 },   // 461:
+   {   0,  0, 0 },   // 462:
+   {   0,  0, 0 },   // 463:
+   {   0,  0, 0 },   // 464:
+   { 204,  8, 1 },   // 465: unittest
+   {   0,  0, 0 },   // 466:
+   {   0,  0, 0 },   // 467:
+   {   0,  0, 0 },   // 468:
+   {   0,  0, 0 },   // 469:
+   { 126,  4, 1 },   // 470: lazy
+   { 120,  3, 1 },   // 471: int
+   { 216,  7, 1 },   // 472: wchar_t
+   {  88,  6, 1 },   // 473: export
+   {   0,  0, 0 },   // 474:
+   {   0,  0, 0 },   // 475:
+   {   0,  0, 0 },   // 476:
+   {   0,  0, 0 },   // 477:
+   {   0,  0, 0 },   // 478:
+   { 161,  6, 1 },   // 479: return
+   {  64,  7, 1 },   // 480: default
+   {   0,  0, 0 },   // 481:
+   {  73, 12, 1 },   // 482: dynamic_cast
+   {   0,  0, 0 },   // 483:
+   {  31,  3, 1 },   // 484: asm
+   { 109,  6, 1 },   // 485: ifloat
+   {  83,  4, 1 },   // 486: enum
+   {   0,  0, 0 },   // 487:
+   {   0,  0, 0 },   // 488:
+   {   0,  0, 0 },   // 489:
+   {   0,  0, 0 },   // 490:
+   {   0,  0, 0 },   // 491:
+   {   0,  0, 0 },   // 492:
+   {  37,  6, 1 },   // 493: bitand
+   {   0,  0, 0 },   // 494:
+   {   0,  0, 0 },   // 495:
+   {   0,  0, 0 },   // 496:
+   {  63,  8, 1 },   // 497: debugger
+   { 176, 11, 1 },   // 498: static_cast
+   {  85,  5, 1 },   // 499: event
+   {   0,  0, 0 },   // 500:
+   {   0,  0, 0 },   // 501:
+   {   0,  0, 0 },   // 502:
+   { 163,  5, 1 },   // 503: scope
+   {   0,  0, 0 },   // 504:
+   {  56,  5, 1 },   // 505: const
+   {   0,  0, 0 },   // 506:
+   {  70, 10, 1 },   // 507: deprecated
+   {   0,  0, 0 },   // 508:
+   {   0,  0, 0 },   // 509:
+   {   0,  0, 0 },   // 510:
+   { 146,  8, 1 },   // 511: override
+};
@@ -13,16 +13,6 @@
 #include <cstdlib>
 #include "unc_ctype.h"
 
-typedef struct
-{
-   chunk_tag_t *p_tags;
-   int         total;            /* number of items at p_tags */
-   int         active;           /* number of valid entries */
-} dynamic_word_list_t;
-
-/* A dynamic list of keywords - add via add_keyword() */
-static dynamic_word_list_t wl;
-
 
 /**
  * interesting static keywords - keep sorted.
@@ -39,8 +29,8 @@ static const chunk_tag_t keywords[] =
    { "@private",         CT_PRIVATE,      LANG_OC | LANG_CPP | LANG_C                                                 },
    { "@property",        CT_OC_PROPERTY,  LANG_OC | LANG_CPP | LANG_C                                                 },
    { "@protocol",        CT_OC_INTF,      LANG_OC | LANG_CPP | LANG_C                                                 },
-   { "@synthesize",      CT_OC_DYNAMIC,   LANG_OC | LANG_CPP | LANG_C                                                 },
    { "@selector",        CT_OC_SEL,       LANG_OC | LANG_CPP | LANG_C                                                 },
+   { "@synthesize",      CT_OC_DYNAMIC,   LANG_OC | LANG_CPP | LANG_C                                                 },
    { "@try",             CT_TRY,          LANG_OC | LANG_CPP | LANG_C                                                 },
    { "_Bool",            CT_TYPE,         LANG_CPP                                                                    },
    { "_Complex",         CT_TYPE,         LANG_CPP                                                                    },
@@ -255,6 +245,56 @@ static const chunk_tag_t keywords[] =
 };
 
 
+/**
+ * A slot in the static keyword hash: the run of keywords[] entries that
+ * share a tag.
+ */
+struct kw_hash_entry_t
+{
+   UINT16 idx;    /* first entry in keywords[] */
+   UINT8  len;    /* length of the tag, 0 for an empty slot */
+   UINT8  count;  /* number of entries with this tag */
+};
+
+#include "keyword_hash.h"
+
+
+/**
+ * Hashes the text, keyed on the length and the bytes.
+ * Must match kw_hash_str() in scripts/keywords.py.
+ */
+static UINT32 kw_hash_str(const char *word, int len)
+{
+   UINT32 hash = 2166136261u ^ (UINT32)len;
+
+   for (int idx = 0; idx < len; idx++)
+   {
+      hash ^= (UINT8)word[idx];
+      hash *= 16777619u;
+   }
+   return(hash);
+}
+
+
+/**
+ * Finds the static hash slot for the text.
+ */
+static const kw_hash_entry_t *kw_static_find(const char *word, int len)
+{
+   UINT32                hash = kw_hash_str(word, len);
+   int                   slot;
+   const kw_hash_entry_t *ent;
+
+   slot = ((hash >> 16) + kw_hash_disp[hash & (KW_HASH_BUCKETS - 1)]) & (KW_HASH_SIZE - 1);
+   ent  = &kw_hash_table[slot];
+   if ((ent->len == len) && (memcmp(keywords[ent->idx].tag, word, len) == 0))
+   {
+      return(ent);
+   }
+   return(NULL);
+}
+
+
 /**
  * Compares two chunk_tag_t entries using strcmp on the strings
  *
@@ -272,8 +312,9 @@ static int kw_compare(const void *p1, const void *p2)
 
 bool keywords_are_sorted(void)
 {
-   int  idx;
-   bool retval = true;
+   int                   idx;
+   bool                  retval = true;
+   const kw_hash_entry_t *ent;
 
    for (idx = 1; idx < (int)ARRAY_SIZE(keywords); idx++)
    {
@@ -284,74 +325,154 @@ bool keywords_are_sorted(void)
          retval = false;
       }
    }
+
+   /* keyword_hash.h must be regenerated whenever keywords[] changes */
+   for (idx = 0; idx < (int)ARRAY_SIZE(keywords); idx++)
+   {
+      ent = kw_static_find(keywords[idx].tag, strlen(keywords[idx].tag));
+      if ((ARRAY_SIZE(keywords) != KW_HASH_KEYWORDS) || (ent == NULL) ||
+          (idx < ent->idx) || (idx >= ent->idx + ent->count))
+      {
+         LOG_FMT(LERR, "%s: keyword_hash.h is stale at idx %d, word '%s'\n",
+                 __func__, idx, keywords[idx].tag);
+         retval = false;
+         break;
+      }
+   }
    return(retval);
 }
 
 
 /**
- * Adds a keyword to the list of dynamic keywords
+ * Finds the slot for the text in the dynamic keyword hash.
  *
- * @param tag        The tag (string) must be zero terminated
- * @param type       The type, usually CT_TYPE
- * @param lang_flags Language flags, typically LANG_ALL
+ * @return the slot, which is -1 if it is empty
  */
-void add_keyword(const char *tag, c_token_t type, int lang_flags)
+static int *kw_dynamic_slot(const char *word, int len)
 {
-   /* Do we need to allocate more memory? */
-   if ((wl.total == wl.active) || (wl.p_tags == NULL))
+   dynamic_word_list_t& kw  = cpd->keywords;
+   UINT32               pos = kw_hash_str(word, len);
+   int                  *slot;
+   const char           *tag;
+
+   for ( ; ; pos++)
    {
-      wl.total += 16;
-      wl.p_tags = (chunk_tag_t *)realloc(wl.p_tags, sizeof(chunk_tag_t) * wl.total);
+      slot = &kw.hash[pos & (kw.hash_size - 1)];
+      if (*slot < 0)
+      {
+         return(slot);
+      }
+      tag = kw.p_tags[*slot].tag;
+      if ((strncmp(tag, word, len) == 0) && (tag[len] == 0))
+      {
+         return(slot);
+      }
+   }
+}
+
+
+/**
+ * Sets the size of the dynamic keyword hash and re-adds all the entries.
+ */
+static void kw_dynamic_rehash(int size)
+{
+   dynamic_word_list_t& kw = cpd->keywords;
+   int                  idx;
+
+   kw.hash_size = size;
+   kw.hash      = (int *)realloc(kw.hash, sizeof(int) * kw.hash_size);
+   for (idx = 0; idx < kw.hash_size; idx++)
+   {
+      kw.hash[idx] = -1;
    }
-   if (wl.p_tags != NULL)
+   for (idx = 0; idx < kw.active; idx++)
    {
-      wl.p_tags[wl.active].tag        = strdup(tag);
-      wl.p_tags[wl.active].type       = type;
-      wl.p_tags[wl.active].lang_flags = lang_flags;
-      wl.active++;
+      *kw_dynamic_slot(kw.p_tags[idx].tag, strlen(kw.p_tags[idx].tag)) = idx;
+   }
+}
 
-      /* Todo: add in sorted order instead of resorting the whole list? */
-      qsort(wl.p_tags, wl.active, sizeof(chunk_tag_t), kw_compare);
 
-      LOG_FMT(LDYNKW, "%s: added '%s'\n", __func__, tag);
+/**
+ * Sorts the dynamic keywords by tag, so that they are listed in order.
+ */
+static void kw_dynamic_sort(void)
+{
+   dynamic_word_list_t& kw = cpd->keywords;
+
+   if (!kw.sorted && (kw.active > 0))
+   {
+      qsort(kw.p_tags, kw.active, sizeof(chunk_tag_t), kw_compare);
+      kw_dynamic_rehash(kw.hash_size);
+      kw.sorted = true;
    }
 }
 
 
 /**
- * Backs up to the first string match in keywords.
+ * Adds a keyword to the list of dynamic keywords.
+ * Adding a tag again replaces the type and language flags.
+ *
+ * @param tag        The tag (string) must be zero terminated
+ * @param type       The type, usually CT_TYPE
+ * @param lang_flags Language flags, typically LANG_ALL
  */
-static const chunk_tag_t *kw_static_first(const chunk_tag_t *tag)
+void add_keyword(const char *tag, c_token_t type, int lang_flags)
 {
-   const chunk_tag_t *prev = tag - 1;
+   dynamic_word_list_t& kw = cpd->keywords;
+   int                  *slot;
+   chunk_tag_t          *ct;
 
-   while ((prev >= &keywords[0]) && (strcmp(prev->tag, tag->tag) == 0))
+   /* keep the hash at most half full */
+   if (kw.active * 2 >= kw.hash_size)
    {
-      tag = prev;
-      prev--;
+      kw_dynamic_rehash((kw.hash_size == 0) ? 64 : (kw.hash_size * 2));
+   }
+   slot = kw_dynamic_slot(tag, strlen(tag));
+   if (*slot >= 0)
+   {
+      kw.p_tags[*slot].type       = type;
+      kw.p_tags[*slot].lang_flags = lang_flags;
+      return;
+   }
+
+   /* Do we need to allocate more memory? */
+   if ((kw.total == kw.active) || (kw.p_tags == NULL))
+   {
+      kw.total += 16;
+      kw.p_tags = (chunk_tag_t *)realloc(kw.p_tags, sizeof(chunk_tag_t) * kw.total);
+   }
+   if (kw.p_tags != NULL)
+   {
+      ct             = &kw.p_tags[kw.active];
+      ct->tag        = strdup(tag);
+      ct->type       = type;
+      ct->lang_flags = lang_flags;
+      *slot          = kw.active;
+      kw.active++;
+      kw.sorted = false;
+
+      LOG_FMT(LDYNKW, "%s: added '%s'\n", __func__, tag);
    }
-   //fprintf(stderr, "first:%s -", tag->tag);
-   return(tag);
 }
 
 
-static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag)
+/**
+ * Picks the entry of the run in keywords[] that applies to the current
+ * language and preprocessor state.
+ */
+static const chunk_tag_t *kw_static_match(const kw_hash_entry_t *ent)
 {
-   bool              in_pp = ((cpd.in_preproc != CT_NONE) && (cpd.in_preproc != CT_PP_DEFINE));
+   bool              in_pp = ((cpd->in_preproc != CT_NONE) && (cpd->in_preproc != CT_PP_DEFINE));
    bool              pp_iter;
-   const chunk_tag_t *iter;
+   const chunk_tag_t *iter = &keywords[ent->idx];
+   const chunk_tag_t *end  = iter + ent->count;
 
-   for (iter = kw_static_first(tag);
-        iter < &keywords[ARRAY_SIZE(keywords)];
-        iter++)
+   for ( ; iter < end; iter++)
    {
-      //fprintf(stderr, " check:%s", iter->tag);
       pp_iter = (iter->lang_flags & FLAG_PP) != 0;
-      if ((strcmp(iter->tag, tag->tag) == 0) &&
-          ((cpd.lang_flags & iter->lang_flags) != 0) &&
+      if (((cpd->lang_flags & iter->lang_flags) != 0) &&
           (in_pp == pp_iter))
       {
-         //fprintf(stderr, " match:%s", iter->tag);
          return(iter);
       }
    }
@@ -368,42 +489,22 @@ static const chunk_tag_t *kw_static_match(const chunk_tag_t *tag)
  */
 const chunk_tag_t *find_keyword(const char *word, int len)
 {
-   chunk_tag_t       tag;
-   char              buf[128];
-   const chunk_tag_t *p_ret;
-
-   if (len > (int)(sizeof(buf) - 1))
-   {
-      LOG_FMT(LNOTE, "%s: keyword too long at %d char (%d max) : %.*s\n",
-              __func__, len, (int)sizeof(buf), len, word);
-      return(NULL);
-   }
-   memcpy(buf, word, len);
-   buf[len] = 0;
-
-   tag.tag = buf;
+   const kw_hash_entry_t *ent;
+   int                   *slot;
 
    /* check the dynamic word list first */
-   p_ret = NULL;
-   if (wl.p_tags)
+   if (cpd->keywords.active > 0)
    {
-      p_ret = (const chunk_tag_t *)bsearch(&tag, wl.p_tags, wl.active,
-                                           sizeof(chunk_tag_t), kw_compare);
-   }
-
-   if (p_ret == NULL)
-   {
-      /* check the static word list */
-      p_ret = (const chunk_tag_t *)bsearch(&tag, keywords, ARRAY_SIZE(keywords),
-                                           sizeof(keywords[0]), kw_compare);
-      if (p_ret != NULL)
+      slot = kw_dynamic_slot(word, len);
+      if (*slot >= 0)
       {
-         //fprintf(stderr, "%s: match %s -", __func__, p_ret->tag);
-         p_ret = kw_static_match(p_ret);
-         //fprintf(stderr, "\n");
+         return(&cpd->keywords.p_tags[*slot]);
       }
    }
-   return(p_ret);
+
+   /* check the static word list */
+   ent = kw_static_find(word, len);
+   return((ent != NULL) ? kw_static_match(ent) : NULL);
 }
 
 
@@ -427,7 +528,7 @@ int load_keyword_file(const char *filename)
    {
       LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
               __func__, filename, strerror(errno), errno);
-      cpd.error_count++;
+      cpd->error_count++;
       return(FAILURE);
    }
 
@@ -454,7 +555,7 @@ int load_keyword_file(const char *filename)
          {
             LOG_FMT(LWARN, "%s:%d Invalid line (starts with '%s')\n",
                     filename, line_no, args[0]);
-            cpd.error_count++;
+            cpd->error_count++;
          }
       }
    }
@@ -468,13 +569,14 @@ void output_types(FILE *pfile)
 {
    int idx;
 
-   if (wl.active > 0)
+   kw_dynamic_sort();
+   if (cpd->keywords.active > 0)
    {
       fprintf(pfile, "-== User Types ==-\n");
    }
-   for (idx = 0; idx < wl.active; idx++)
+   for (idx = 0; idx < cpd->keywords.active; idx++)
    {
-      fprintf(pfile, "%s\n", wl.p_tags[idx].tag);
+      fprintf(pfile, "%s\n", cpd->keywords.p_tags[idx].tag);
    }
 }
 
@@ -483,9 +585,13 @@ const chunk_tag_t *get_custom_keyword_idx(int& idx)
 {
    const chunk_tag_t *ct = NULL;
 
-   if ((idx >= 0) && (idx < wl.active))
+   if (idx == 0)
+   {
+      kw_dynamic_sort();
+   }
+   if ((idx >= 0) && (idx < cpd->keywords.active))
    {
-      ct = &wl.p_tags[idx];
+      ct = &cpd->keywords.p_tags[idx];
    }
    idx++;
    return(ct);
@@ -494,18 +600,21 @@ const chunk_tag_t *get_custom_keyword_idx(int& idx)
 
 void clear_keyword_file(void)
 {
-   if (wl.p_tags != NULL)
+   if (cpd->keywords.p_tags != NULL)
    {
-      for (int idx = 0; idx < wl.active; idx++)
+      for (int idx = 0; idx < cpd->keywords.active; idx++)
       {
-         free((void *)wl.p_tags[idx].tag);
-         wl.p_tags[idx].tag = NULL;
+         free((void *)cpd->keywords.p_tags[idx].tag);
+         cpd->keywords.p_tags[idx].tag = NULL;
       }
-      free(wl.p_tags);
-      wl.p_tags = NULL;
+      free(cpd->keywords.p_tags);
+      cpd->keywords.p_tags = NULL;
    }
-   wl.total  = 0;
-   wl.active = 0;
+   free(cpd->keywords.hash);
+   cpd->keywords.hash      = NULL;
+   cpd->keywords.hash_size = 0;
+   cpd->keywords.total     = 0;
+   cpd->keywords.active    = 0;
 }
 
 
@@ -34,7 +34,7 @@ chunk_t *pawn_add_vsemi_after(chunk_t *pc)
 
    chunk             = *pc;
    chunk.type        = CT_VSEMICOLON;
-   chunk.len         = cpd.settings[UO_mod_pawn_semicolon].b ? 1 : 0;
+   chunk.len         = cpd->settings[UO_mod_pawn_semicolon].b ? 1 : 0;
    chunk.str         = ";";
    chunk.column     += pc->len;
    chunk.parent_type = CT_NONE;
@@ -53,7 +53,7 @@ chunk_t *pawn_add_vsemi_after(chunk_t *pc)
  */
 void pawn_scrub_vsemi(void)
 {
-   if (!cpd.settings[UO_mod_pawn_semicolon].b)
+   if (!cpd->settings[UO_mod_pawn_semicolon].b)
    {
       return;
    }
@@ -274,7 +274,7 @@ void pawn_add_virtual_semicolons(void)
 
    /** Add Pawn virtual semicolons */
    prev = NULL;
-   if ((cpd.lang_flags & LANG_PAWN) != 0)
+   if ((cpd->lang_flags & LANG_PAWN) != 0)
    {
       pc = chunk_get_head();
       while ((pc = chunk_get_next(pc)) != NULL)
@@ -325,7 +325,7 @@ static chunk_t *pawn_mark_function0(chunk_t *start, chunk_t *fcn)
       {
          LOG_FMT(LPFUNC, "%s: %d] '%.*s' proto due to semicolon\n", __func__,
                  fcn->orig_line, fcn->len, fcn->str);
-         fcn->type = CT_FUNC_PROTO;
+         chunk_set_type(fcn, CT_FUNC_PROTO);
          return(last);
       }
    }
@@ -338,7 +338,7 @@ static chunk_t *pawn_mark_function0(chunk_t *start, chunk_t *fcn)
                  fcn->orig_line, fcn->len, fcn->str,
                  get_token_name(fcn->type),
                  get_token_name(start->type));
-         fcn->type = CT_FUNC_PROTO;
+         chunk_set_type(fcn, CT_FUNC_PROTO);
          return(chunk_get_next_nc(fcn));
       }
    }
@@ -355,7 +355,7 @@ static chunk_t *pawn_process_func_def(chunk_t *pc)
    chunk_t *last;
    chunk_t *next;
 
-   pc->type = CT_FUNC_DEF;
+   chunk_set_type(pc, CT_FUNC_DEF);
 
    /* If we don't have a brace open right after the close fparen, then
     * we need to add virtual braces around the function body.
@@ -375,7 +375,7 @@ static chunk_t *pawn_process_func_def(chunk_t *pc)
       LOG_FMT(LPFUNC, "%s: %d] '%.*s' has state angle open %s\n", __func__,
               pc->orig_line, pc->len, pc->str, get_token_name(last->type));
 
-      last->type        = CT_ANGLE_OPEN;
+      chunk_set_type(last, CT_ANGLE_OPEN);
       last->parent_type = CT_FUNC_DEF;
       while (((last = chunk_get_next(last)) != NULL) &&
              !chunk_is_str(last, ">", 1))
@@ -386,7 +386,7 @@ static chunk_t *pawn_process_func_def(chunk_t *pc)
       {
          LOG_FMT(LPFUNC, "%s: %d] '%.*s' has state angle close %s\n", __func__,
                  pc->orig_line, pc->len, pc->str, get_token_name(last->type));
-         last->type        = CT_ANGLE_CLOSE;
+         chunk_set_type(last, CT_ANGLE_CLOSE);
          last->parent_type = CT_FUNC_DEF;
       }
       last = chunk_get_next_ncnl(last);
@@ -0,0 +1,182 @@
+/**
+ * @file libuncrustify.cpp
+ * The C interface to the formatter. See libuncrustify.h.
+ *
+ * Each config is a formatting context. Selecting it makes it current for the
+ * calling thread only, so separate configs may be used in parallel.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "libuncrustify.h"
+#include "uncrustify_version.h"
+#include "uncrustify_types.h"
+#include "prototypes.h"
+#include "logger.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+struct uncrustify_config
+{
+   struct cp_data *ctx;
+};
+
+
+/**
+ * Builds the option map.
+ * The static in lib_init() makes sure this runs once, even if several
+ * threads load their first config at the same time.
+ */
+static bool lib_init_once(void)
+{
+   register_options();
+   return(true);
+}
+
+
+static void lib_init(void)
+{
+   static bool done = lib_init_once();
+
+   (void)done;
+}
+
+
+const char *uncrustify_version(void)
+{
+   return(UNCRUSTIFY_VERSION);
+}
+
+
+void uncrustify_set_log(FILE *log_file, const char *mask)
+{
+   log_mask_t lmask;
+
+   lib_init();
+   log_init(log_file);
+   if (mask != NULL)
+   {
+      logmask_from_string(mask, &lmask);
+      log_set_mask(&lmask);
+   }
+}
+
+
+uncrustify_config *uncrustify_config_load(const char *cfg_file)
+{
+   uncrustify_config *cfg;
+   struct cp_data    *prev;
+   int               retval = 0;
+
+   lib_init();
+
+   cfg = (uncrustify_config *)malloc(sizeof(*cfg));
+   if (cfg == NULL)
+   {
+      return(NULL);
+   }
+   cfg->ctx = context_create();
+
+   prev = context_select(cfg->ctx);
+   if (cfg_file != NULL)
+   {
+      cpd->filename = cfg_file;
+      retval        = load_option_file(cfg_file);
+      if (retval == 0)
+      {
+         /* This relies on cpd->filename being the config file name */
+         load_header_files();
+      }
+   }
+   context_select(prev);
+
+   if (retval < 0)
+   {
+      uncrustify_config_free(cfg);
+      return(NULL);
+   }
+   return(cfg);
+}
+
+
+int uncrustify_config_set(uncrustify_config *cfg, const char *name, const char *value)
+{
+   struct cp_data *prev = context_select(cfg->ctx);
+   int            id    = set_option_value(name, value);
+
+   context_select(prev);
+   return((id < 0) ? UNCRUSTIFY_ERR_CONFIG : UNCRUSTIFY_OK);
+}
+
+
+void uncrustify_config_free(uncrustify_config *cfg)
+{
+   if (cfg != NULL)
+   {
+      context_destroy(cfg->ctx);
+      free(cfg);
+   }
+}
+
+
+int uncrustify_format(uncrustify_config *cfg, const char *lang,
+                      const char *filename, const char *in, size_t in_len,
+                      char *out, size_t out_size, size_t *out_len)
+{
+   struct cp_data *prev;
+   int            lang_flags;
+   int            errors;
+   char           *data;
+   const char     *text;
+   int            len;
+
+   *out_len = 0;
+
+   if (lang != NULL)
+   {
+      lang_flags = language_from_tag(lang);
+      if (lang_flags == 0)
+      {
+         return(UNCRUSTIFY_ERR_LANG);
+      }
+   }
+   else
+   {
+      lang_flags = (filename != NULL) ? language_from_filename(filename) : LANG_C;
+   }
+
+   /* The tokenizer expects the text to be NUL terminated */
+   data = (char *)malloc(in_len + 1);
+   if (data == NULL)
+   {
+      return(UNCRUSTIFY_ERR_NOMEM);
+   }
+   memcpy(data, in, in_len);
+   data[in_len] = 0;
+
+   prev = context_select(cfg->ctx);
+
+   cpd->lang_flags = lang_flags;
+   cpd->filename   = (filename != NULL) ? filename : "text";
+   errors          = cpd->error_count;
+
+   text = uncrustify_file_mem(data, in_len, len);
+
+   errors   = cpd->error_count - errors;
+   *out_len = len;
+   if ((size_t)len <= out_size)
+   {
+      memcpy(out, text, len);
+   }
+   context_select(prev);
+   free(data);
+
+   if ((size_t)len > out_size)
+   {
+      return(UNCRUSTIFY_ERR_BUFFER);
+   }
+   return((errors != 0) ? UNCRUSTIFY_ERR_FORMAT : UNCRUSTIFY_OK);
+}
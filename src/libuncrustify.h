@@ -0,0 +1,102 @@
+/**
+ * @file libuncrustify.h
+ * C interface to the formatter, for programs that want to format text in
+ * memory without running uncrustify.
+ *
+ * A config holds everything loaded from one config file: the options, types
+ * and defines. Only one thread may use a config at a time. To format in
+ * parallel, load one config for each thread.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef LIBUNCRUSTIFY_H_INCLUDED
+#define LIBUNCRUSTIFY_H_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The return codes */
+#define UNCRUSTIFY_OK            0
+#define UNCRUSTIFY_ERR_CONFIG    -1  /* unknown option or bad value */
+#define UNCRUSTIFY_ERR_LANG      -2  /* unknown language tag */
+#define UNCRUSTIFY_ERR_NOMEM     -3  /* out of memory */
+#define UNCRUSTIFY_ERR_BUFFER    -4  /* output buffer too small */
+#define UNCRUSTIFY_ERR_FORMAT    -5  /* errors were logged while formatting */
+
+typedef struct uncrustify_config   uncrustify_config;
+
+
+/**
+ * Returns the version string, ie "0.54"
+ */
+const char *uncrustify_version(void);
+
+
+/**
+ * Sets where log output goes and which severities are shown.
+ * This applies to every config and every thread, so call it before
+ * formatting anything. Nothing is logged until this is called.
+ *
+ * @param log_file   The log stream, NULL for stderr
+ * @param mask       The severities, in the same format as '-L', ie "0-2"
+ */
+void uncrustify_set_log(FILE *log_file, const char *mask);
+
+
+/**
+ * Loads a config file.
+ *
+ * @param cfg_file   The config file, or NULL for the default settings
+ * @return           The config or NULL if the file couldn't be loaded
+ */
+uncrustify_config *uncrustify_config_load(const char *cfg_file);
+
+
+/**
+ * Changes one option in a loaded config, as if it were in the config file.
+ *
+ * @param cfg     The config
+ * @param name    The option name, ie "indent_columns"
+ * @param value   The option value, ie "3"
+ * @return        UNCRUSTIFY_OK or UNCRUSTIFY_ERR_CONFIG
+ */
+int uncrustify_config_set(uncrustify_config *cfg, const char *name, const char *value);
+
+
+/**
+ * Frees a config made by uncrustify_config_load().
+ */
+void uncrustify_config_free(uncrustify_config *cfg);
+
+
+/**
+ * Formats a block of text.
+ * If out is too small, UNCRUSTIFY_ERR_BUFFER is returned and *out_len is set
+ * to the size needed.
+ * UNCRUSTIFY_ERR_FORMAT means errors were logged, but the output is still
+ * filled in, same as what uncrustify would write.
+ *
+ * @param cfg        The config
+ * @param lang       The language tag, as used with '-l', or NULL
+ * @param filename   Used to pick the language if lang is NULL, may be NULL
+ * @param in         The text to format, need not be NUL terminated
+ * @param in_len     The length of in
+ * @param out        Where to put the formatted text, not NUL terminated
+ * @param out_size   The size of out
+ * @param out_len    Gets the length of the formatted text
+ * @return           UNCRUSTIFY_OK or one of the UNCRUSTIFY_ERR_xxx codes
+ */
+int uncrustify_format(uncrustify_config *cfg, const char *lang,
+                      const char *filename, const char *in, size_t in_len,
+                      char *out, size_t out_size, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif   /* LIBUNCRUSTIFY_H_INCLUDED */
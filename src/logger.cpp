@@ -20,15 +20,21 @@
 struct log_buf
 {
    FILE       *log_file;
-   log_sev_t  sev;
-   int        in_log;
-   char       buf[256];
-   int        buf_len;
    log_mask_t mask;
    bool       show_hdr;
 };
 static struct log_buf g_log;
 
+/** The log line being built - one per thread so that lines don't get mixed */
+struct log_line
+{
+   log_sev_t sev;
+   int       in_log;
+   char      buf[256];
+   int       buf_len;
+};
+static THREAD_LOCAL struct log_line g_line;
+
 
 /**
  * Initializes the log subsystem - call this first.
@@ -39,6 +45,7 @@ static struct log_buf g_log;
 void log_init(FILE *log_file)
 {
    memset(&g_log, 0, sizeof(g_log));
+   memset(&g_line, 0, sizeof(g_line));
 
    /* set the top 3 severities */
    log_set_sev(0, true);
@@ -121,16 +128,16 @@ static void log_flush(bool force_nl)
 {
    int dummy;  /* get the compiler to shut up */
 
-   if (g_log.buf_len > 0)
+   if (g_line.buf_len > 0)
    {
-      if (force_nl && (g_log.buf[g_log.buf_len - 1] != '\n'))
+      if (force_nl && (g_line.buf[g_line.buf_len - 1] != '\n'))
       {
-         g_log.buf[g_log.buf_len++] = '\n';
-         g_log.buf[g_log.buf_len]   = 0;
+         g_line.buf[g_line.buf_len++] = '\n';
+         g_line.buf[g_line.buf_len]   = 0;
       }
-      dummy = fwrite(g_log.buf, 1, g_log.buf_len, g_log.log_file);
+      dummy = fwrite(g_line.buf, 1, g_line.buf_len, g_log.log_file);
 
-      g_log.buf_len = 0;
+      g_line.buf_len = 0;
    }
 }
 
@@ -143,23 +150,23 @@ static void log_flush(bool force_nl)
  */
 static size_t log_start(log_sev_t sev)
 {
-   if (sev != g_log.sev)
+   if (sev != g_line.sev)
    {
-      if (g_log.buf_len > 0)
+      if (g_line.buf_len > 0)
       {
          log_flush(true);
       }
-      g_log.sev    = sev;
-      g_log.in_log = false;
+      g_line.sev    = sev;
+      g_line.in_log = false;
    }
 
    /* If not in a log, the buffer is empty. Add the header, if enabled. */
-   if (!g_log.in_log && g_log.show_hdr)
+   if (!g_line.in_log && g_log.show_hdr)
    {
-      g_log.buf_len = snprintf(g_log.buf, sizeof(g_log.buf), "<%d>", sev);
+      g_line.buf_len = snprintf(g_line.buf, sizeof(g_line.buf), "<%d>", sev);
    }
 
-   int cap = ((int)sizeof(g_log.buf) - 2) - g_log.buf_len;
+   int cap = ((int)sizeof(g_line.buf) - 2) - g_line.buf_len;
 
    return((cap > 0) ? (size_t)cap : 0);
 }
@@ -171,8 +178,8 @@ static size_t log_start(log_sev_t sev)
  */
 static void log_end(void)
 {
-   g_log.in_log = (g_log.buf[g_log.buf_len - 1] != '\n');
-   if (!g_log.in_log || (g_log.buf_len > (int)(sizeof(g_log.buf) / 2)))
+   g_line.in_log = (g_line.buf[g_line.buf_len - 1] != '\n');
+   if (!g_line.in_log || (g_line.buf_len > (int)(sizeof(g_line.buf) / 2)))
    {
       log_flush(false);
    }
@@ -200,9 +207,9 @@ void log_str(log_sev_t sev, const char *str, int len)
       {
          len = cap;
       }
-      memcpy(&g_log.buf[g_log.buf_len], str, len);
-      g_log.buf_len           += len;
-      g_log.buf[g_log.buf_len] = 0;
+      memcpy(&g_line.buf[g_line.buf_len], str, len);
+      g_line.buf_len            += len;
+      g_line.buf[g_line.buf_len] = 0;
    }
    log_end();
 }
@@ -234,7 +241,7 @@ void log_fmt(log_sev_t sev, const char *fmt, ...)
 
    /* Add on the variable log parameters to the log string */
    va_start(args, fmt);
-   len = vsnprintf(&g_log.buf[g_log.buf_len], cap, fmt, args);
+   len = vsnprintf(&g_line.buf[g_line.buf_len], cap, fmt, args);
    va_end(args);
 
    if (len > 0)
@@ -243,8 +250,8 @@ void log_fmt(log_sev_t sev, const char *fmt, ...)
       {
          len = cap;
       }
-      g_log.buf_len           += len;
-      g_log.buf[g_log.buf_len] = 0;
+      g_line.buf_len            += len;
+      g_line.buf[g_line.buf_len] = 0;
    }
 
    log_end();
@@ -302,7 +309,7 @@ void log_hex(log_sev_t sev, const void *vdata, int len)
  */
 void log_hex_blk(log_sev_t sev, const void *data, int len)
 {
-   static char buf[80] = "nnn | XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX | cccccccccccccccc\n";
+   char        buf[80] = "nnn | XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX XX | cccccccccccccccc\n";
    const UINT8 *dat    = (const UINT8 *)data;
    int         idx;
    int         count;
@@ -8,6 +8,7 @@
 #include "uncrustify_types.h"
 #include "chunk_list.h"
 #include "prototypes.h"
+#include "ChunkStack.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -27,7 +28,7 @@ static void newline_iarf_pair(chunk_t *before, chunk_t *after, argval_t av);
  */
 static bool can_increase_nl(chunk_t *nl)
 {
-   if (cpd.settings[UO_nl_squeeze_ifdef].b)
+   if (cpd->settings[UO_nl_squeeze_ifdef].b)
    {
       chunk_t *pc = chunk_get_next(nl);
 
@@ -335,7 +336,7 @@ static void newlines_if_for_while_switch(chunk_t *start, argval_t nl_opt)
 
    if ((nl_opt == AV_IGNORE) ||
        (((start->flags & PCF_IN_PREPROC) != 0) &&
-        !cpd.settings[UO_nl_define_macro].b))
+        !cpd->settings[UO_nl_define_macro].b))
    {
       return;
    }
@@ -349,7 +350,7 @@ static void newlines_if_for_while_switch(chunk_t *start, argval_t nl_opt)
       if ((brace_open != NULL) && (brace_open->type == CT_BRACE_OPEN) &&
           one_liner_nl_ok(brace_open))
       {
-         if (cpd.settings[UO_nl_multi_line_cond].b)
+         if (cpd->settings[UO_nl_multi_line_cond].b)
          {
             while ((pc = chunk_get_next(pc)) != close_paren)
             {
@@ -390,7 +391,7 @@ static void newlines_if_for_while_switch_pre_blank_lines(chunk_t *start, argval_
 
    if ((nl_opt == AV_IGNORE) ||
        (((start->flags & PCF_IN_PREPROC) != 0) &&
-        !cpd.settings[UO_nl_define_macro].b))
+        !cpd->settings[UO_nl_define_macro].b))
    {
       return;
    }
@@ -537,7 +538,7 @@ static void newlines_if_for_while_switch_post_blank_lines(chunk_t *start, argval
 
    if ((nl_opt == AV_IGNORE) ||
        (((start->flags & PCF_IN_PREPROC) != 0) &&
-        !cpd.settings[UO_nl_define_macro].b))
+        !cpd->settings[UO_nl_define_macro].b))
    {
       return;
    }
@@ -653,7 +654,7 @@ static void newlines_if_for_while_switch_post_blank_lines(chunk_t *start, argval
                //LOG_FMT(LSYS, "  -- pc2=%.*s [%s]\n", pc->len, pc->str, get_token_name(pc->type));
                if ((pc != NULL) && (pc->type == CT_PREPROC) &&
                    (pc->parent_type == CT_PP_ENDIF) &&
-                   cpd.settings[UO_nl_squeeze_ifdef].b)
+                   cpd->settings[UO_nl_squeeze_ifdef].b)
                {
                   LOG_FMT(LNEWLINE, "%s: cannot add newline after line %d due to nl_squeeze_ifdef\n",
                           __func__, prev->orig_line);
@@ -684,7 +685,7 @@ static void newlines_struct_enum_union(chunk_t *start, argval_t nl_opt, bool lea
 
    if ((nl_opt == AV_IGNORE) ||
        (((start->flags & PCF_IN_PREPROC) != 0) &&
-        !cpd.settings[UO_nl_define_macro].b))
+        !cpd->settings[UO_nl_define_macro].b))
    {
       return;
    }
@@ -738,7 +739,7 @@ static void newlines_cuddle_uncuddle(chunk_t *start, argval_t nl_opt)
    chunk_t *br_close;
 
    if (((start->flags & PCF_IN_PREPROC) != 0) &&
-       !cpd.settings[UO_nl_define_macro].b)
+       !cpd->settings[UO_nl_define_macro].b)
    {
       return;
    }
@@ -761,7 +762,7 @@ static void newlines_do_else(chunk_t *start, argval_t nl_opt)
 
    if ((nl_opt == AV_IGNORE) ||
        (((start->flags & PCF_IN_PREPROC) != 0) &&
-        !cpd.settings[UO_nl_define_macro].b))
+        !cpd->settings[UO_nl_define_macro].b))
    {
       return;
    }
@@ -823,7 +824,7 @@ static void newline_fnc_var_def(chunk_t *br_open, int nl_count)
       next = chunk_get_next_ncnl(prev);
       if ((next != NULL) && (next->type != CT_BRACE_CLOSE))
       {
-         newline_min_after(prev, 1 + cpd.settings[UO_nl_func_var_def_blk].n);
+         newline_min_after(prev, 1 + cpd->settings[UO_nl_func_var_def_blk].n);
       }
    }
 }
@@ -860,12 +861,12 @@ static void newlines_brace_pair(chunk_t *br_open)
    bool     nl_close_brace = false;
 
    if (((br_open->flags & PCF_IN_PREPROC) != 0) &&
-       !cpd.settings[UO_nl_define_macro].b)
+       !cpd->settings[UO_nl_define_macro].b)
    {
       return;
    }
 
-   if (cpd.settings[UO_nl_collapse_empty_body].b)
+   if (cpd->settings[UO_nl_collapse_empty_body].b)
    {
       next = chunk_get_next_nnl(br_open);
       if ((next != NULL) && (next->type == CT_BRACE_CLOSE))
@@ -904,12 +905,12 @@ static void newlines_brace_pair(chunk_t *br_open)
       {
          prev = chunk_get_prev_ncnl(br_open);
 
-         newline_iarf_pair(prev, br_open, cpd.settings[UO_nl_assign_brace].a);
+         newline_iarf_pair(prev, br_open, cpd->settings[UO_nl_assign_brace].a);
       }
    }
 
    /* Eat any extra newlines after the brace open */
-   if (cpd.settings[UO_eat_blanks_after_open_brace].b)
+   if (cpd->settings[UO_eat_blanks_after_open_brace].b)
    {
       if (chunk_is_newline(next))
       {
@@ -940,8 +941,8 @@ static void newlines_brace_pair(chunk_t *br_open)
       val = ((br_open->parent_type == CT_FUNC_DEF) ||
              (br_open->parent_type == CT_FUNC_CLASS) ||
              (br_open->parent_type == CT_OC_MSG_DECL)) ?
-            cpd.settings[UO_nl_fdef_brace].a :
-            cpd.settings[UO_nl_fcall_brace].a;
+            cpd->settings[UO_nl_fdef_brace].a :
+            cpd->settings[UO_nl_fcall_brace].a;
 
       if (val != AV_IGNORE)
       {
@@ -951,9 +952,9 @@ static void newlines_brace_pair(chunk_t *br_open)
          newline_iarf_pair(prev, br_open, val);
       }
 
-      if (cpd.settings[UO_nl_func_var_def_blk].n > 0)
+      if (cpd->settings[UO_nl_func_var_def_blk].n > 0)
       {
-         newline_fnc_var_def(br_open, cpd.settings[UO_nl_func_var_def_blk].n);
+         newline_fnc_var_def(br_open, cpd->settings[UO_nl_func_var_def_blk].n);
       }
    }
 
@@ -1146,12 +1147,12 @@ static void newline_func_def(chunk_t *start)
    chunk_t *prev = NULL;
    chunk_t *tmp;
 
-   if (cpd.settings[UO_nl_func_paren].a != AV_IGNORE)
+   if (cpd->settings[UO_nl_func_paren].a != AV_IGNORE)
    {
       prev = chunk_get_prev_ncnl(start);
       if (prev != NULL)
       {
-         newline_iarf(prev, cpd.settings[UO_nl_func_paren].a);
+         newline_iarf(prev, cpd->settings[UO_nl_func_paren].a);
       }
    }
 
@@ -1173,19 +1174,19 @@ static void newline_func_def(chunk_t *start)
       }
       if ((prev != NULL) && (prev->type == CT_DC_MEMBER))
       {
-         if (cpd.settings[UO_nl_func_scope_name].a != AV_IGNORE)
+         if (cpd->settings[UO_nl_func_scope_name].a != AV_IGNORE)
          {
-            newline_iarf(prev, cpd.settings[UO_nl_func_scope_name].a);
+            newline_iarf(prev, cpd->settings[UO_nl_func_scope_name].a);
          }
       }
 
       argval_t a = (tmp->parent_type == CT_FUNC_PROTO) ?
-                   cpd.settings[UO_nl_func_proto_type_name].a :
-                   cpd.settings[UO_nl_func_type_name].a;
+                   cpd->settings[UO_nl_func_proto_type_name].a :
+                   cpd->settings[UO_nl_func_type_name].a;
       if ((tmp->flags & PCF_IN_CLASS) &&
-          (cpd.settings[UO_nl_func_type_name_class].a != AV_IGNORE))
+          (cpd->settings[UO_nl_func_type_name_class].a != AV_IGNORE))
       {
-         a = cpd.settings[UO_nl_func_type_name_class].a;
+         a = cpd->settings[UO_nl_func_type_name_class].a;
       }
 
       if (a != AV_IGNORE)
@@ -1212,14 +1213,14 @@ static void newline_func_def(chunk_t *start)
    pc = chunk_get_next_ncnl(start);
    if (chunk_is_str(pc, ")", 1))
    {
-      if (cpd.settings[UO_nl_func_decl_empty].a != AV_IGNORE)
+      if (cpd->settings[UO_nl_func_decl_empty].a != AV_IGNORE)
       {
-         newline_iarf(start, cpd.settings[UO_nl_func_decl_empty].a);
+         newline_iarf(start, cpd->settings[UO_nl_func_decl_empty].a);
       }
       return;
    }
 
-   newline_iarf(start, cpd.settings[UO_nl_func_decl_start].a);
+   newline_iarf(start, cpd->settings[UO_nl_func_decl_start].a);
 
    /* Now scan for commas */
    for (pc = chunk_get_next_ncnl(start);
@@ -1234,7 +1235,7 @@ static void newline_func_def(chunk_t *start)
          {
             pc = tmp;
          }
-         newline_iarf(pc, cpd.settings[UO_nl_func_decl_args].a);
+         newline_iarf(pc, cpd->settings[UO_nl_func_decl_args].a);
       }
    }
 
@@ -1244,7 +1245,7 @@ static void newline_func_def(chunk_t *start)
       prev = chunk_get_prev_nnl(pc);
       if (prev->type != CT_FPAREN_OPEN)
       {
-         newline_iarf(prev, cpd.settings[UO_nl_func_decl_end].a);
+         newline_iarf(prev, cpd->settings[UO_nl_func_decl_end].a);
       }
    }
 }
@@ -1264,42 +1265,42 @@ static bool one_liner_nl_ok(chunk_t *pc)
        ((pc->type == CT_BRACE_OPEN) ||
         (pc->type == CT_BRACE_CLOSE)))
    {
-      if (cpd.settings[UO_nl_class_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_class_leave_one_liners].b &&
           (pc->flags & PCF_IN_CLASS))
       {
          LOG_FMT(LNL1LINE, "false (class)\n");
          return(false);
       }
 
-      if (cpd.settings[UO_nl_assign_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_assign_leave_one_liners].b &&
           (pc->parent_type == CT_ASSIGN))
       {
          LOG_FMT(LNL1LINE, "false (assign)\n");
          return(false);
       }
 
-      if (cpd.settings[UO_nl_enum_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_enum_leave_one_liners].b &&
           (pc->parent_type == CT_ENUM))
       {
          LOG_FMT(LNL1LINE, "false (enum)\n");
          return(false);
       }
 
-      if (cpd.settings[UO_nl_getset_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_getset_leave_one_liners].b &&
           (pc->parent_type == CT_GETSET))
       {
          LOG_FMT(LNL1LINE, "false (get/set)\n");
          return(false);
       }
 
-      if (cpd.settings[UO_nl_func_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_func_leave_one_liners].b &&
           (pc->parent_type == CT_FUNC_DEF))
       {
          LOG_FMT(LNL1LINE, "false (func def)\n");
          return(false);
       }
 
-      if (cpd.settings[UO_nl_if_leave_one_liners].b &&
+      if (cpd->settings[UO_nl_if_leave_one_liners].b &&
           ((pc->parent_type == CT_IF) ||
            (pc->parent_type == CT_ELSE)))
       {
@@ -1351,82 +1352,82 @@ void newlines_cleanup_braces(void)
    {
       if (pc->type == CT_IF)
       {
-         newlines_if_for_while_switch(pc, cpd.settings[UO_nl_if_brace].a);
+         newlines_if_for_while_switch(pc, cpd->settings[UO_nl_if_brace].a);
       }
       else if (pc->type == CT_ELSEIF)
       {
-         arg = cpd.settings[UO_nl_elseif_brace].a;
+         arg = cpd->settings[UO_nl_elseif_brace].a;
          newlines_if_for_while_switch(
-            pc, (arg != AV_IGNORE) ? arg : cpd.settings[UO_nl_if_brace].a);
+            pc, (arg != AV_IGNORE) ? arg : cpd->settings[UO_nl_if_brace].a);
       }
       else if (pc->type == CT_FOR)
       {
-         newlines_if_for_while_switch(pc, cpd.settings[UO_nl_for_brace].a);
+         newlines_if_for_while_switch(pc, cpd->settings[UO_nl_for_brace].a);
       }
       else if (pc->type == CT_CATCH)
       {
-         newlines_cuddle_uncuddle(pc, cpd.settings[UO_nl_brace_catch].a);
+         newlines_cuddle_uncuddle(pc, cpd->settings[UO_nl_brace_catch].a);
          next = chunk_get_next_ncnl(pc);
          if ((next != NULL) && (next->type == CT_BRACE_OPEN))
          {
-            newlines_do_else(pc, cpd.settings[UO_nl_catch_brace].a);
+            newlines_do_else(pc, cpd->settings[UO_nl_catch_brace].a);
          }
          else
          {
-            newlines_if_for_while_switch(pc, cpd.settings[UO_nl_catch_brace].a);
+            newlines_if_for_while_switch(pc, cpd->settings[UO_nl_catch_brace].a);
          }
       }
       else if (pc->type == CT_WHILE)
       {
-         newlines_if_for_while_switch(pc, cpd.settings[UO_nl_while_brace].a);
+         newlines_if_for_while_switch(pc, cpd->settings[UO_nl_while_brace].a);
       }
       else if (pc->type == CT_SWITCH)
       {
-         newlines_if_for_while_switch(pc, cpd.settings[UO_nl_switch_brace].a);
+         newlines_if_for_while_switch(pc, cpd->settings[UO_nl_switch_brace].a);
       }
       else if (pc->type == CT_DO)
       {
-         newlines_do_else(pc, cpd.settings[UO_nl_do_brace].a);
+         newlines_do_else(pc, cpd->settings[UO_nl_do_brace].a);
       }
       else if (pc->type == CT_ELSE)
       {
-         newlines_cuddle_uncuddle(pc, cpd.settings[UO_nl_brace_else].a);
+         newlines_cuddle_uncuddle(pc, cpd->settings[UO_nl_brace_else].a);
          next = chunk_get_next_ncnl(pc);
          if ((next != NULL) && (next->type == CT_ELSEIF))
          {
-            newline_iarf_pair(pc, next, cpd.settings[UO_nl_else_if].a);
+            newline_iarf_pair(pc, next, cpd->settings[UO_nl_else_if].a);
          }
-         newlines_do_else(pc, cpd.settings[UO_nl_else_brace].a);
+         newlines_do_else(pc, cpd->settings[UO_nl_else_brace].a);
       }
       else if (pc->type == CT_TRY)
       {
-         newlines_do_else(pc, cpd.settings[UO_nl_try_brace].a);
+         newlines_do_else(pc, cpd->settings[UO_nl_try_brace].a);
       }
       else if (pc->type == CT_GETSET)
       {
-         newlines_do_else(pc, cpd.settings[UO_nl_getset_brace].a);
+         newlines_do_else(pc, cpd->settings[UO_nl_getset_brace].a);
       }
       else if (pc->type == CT_FINALLY)
       {
-         newlines_cuddle_uncuddle(pc, cpd.settings[UO_nl_brace_finally].a);
-         newlines_do_else(pc, cpd.settings[UO_nl_finally_brace].a);
+         newlines_cuddle_uncuddle(pc, cpd->settings[UO_nl_brace_finally].a);
+         newlines_do_else(pc, cpd->settings[UO_nl_finally_brace].a);
       }
       else if (pc->type == CT_WHILE_OF_DO)
       {
-         newlines_cuddle_uncuddle(pc, cpd.settings[UO_nl_brace_while].a);
+         newlines_cuddle_uncuddle(pc, cpd->settings[UO_nl_brace_while].a);
       }
       else if (pc->type == CT_BRACE_OPEN)
       {
-         if (cpd.settings[UO_nl_brace_brace].a != AV_IGNORE)
+         if (cpd->settings[UO_nl_brace_brace].a != AV_IGNORE)
          {
             next = chunk_get_next_nc(pc, CNAV_PREPROC);
             if ((next != NULL) && (next->type == CT_BRACE_OPEN))
             {
-               newline_iarf_pair(pc, next, cpd.settings[UO_nl_brace_brace].a);
+               newline_iarf_pair(pc, next, cpd->settings[UO_nl_brace_brace].a);
             }
          }
 
-         if (cpd.settings[UO_nl_ds_struct_enum_cmt].b &&
+         if (cpd->settings[UO_nl_ds_struct_enum_cmt].b &&
              ((pc->parent_type == CT_ENUM) ||
               (pc->parent_type == CT_STRUCT) ||
               (pc->parent_type == CT_UNION)))
@@ -1437,7 +1438,7 @@ void newlines_cleanup_braces(void)
          if ((pc->parent_type == CT_CLASS) && (pc->level == pc->brace_level))
          {
             newlines_do_else(chunk_get_prev_nnl(pc),
-                             cpd.settings[UO_nl_class_brace].a);
+                             cpd->settings[UO_nl_class_brace].a);
          }
 
          next = chunk_get_next_nnl(pc);
@@ -1459,7 +1460,7 @@ void newlines_cleanup_braces(void)
 
             // Handle nl_after_brace_open
             if ((pc->level == pc->brace_level) &&
-                cpd.settings[UO_nl_after_brace_open].b)
+                cpd->settings[UO_nl_after_brace_open].b)
             {
                if (!one_liner_nl_ok(pc))
                {
@@ -1477,7 +1478,7 @@ void newlines_cleanup_braces(void)
                   {
                      if (chunk_is_comment(tmp))
                      {
-                        if (!cpd.settings[UO_nl_after_brace_open_cmt].b &&
+                        if (!cpd->settings[UO_nl_after_brace_open_cmt].b &&
                             (tmp->type != CT_COMMENT_MULTI))
                         {
                            break;
@@ -1495,16 +1496,16 @@ void newlines_cleanup_braces(void)
       }
       else if (pc->type == CT_BRACE_CLOSE)
       {
-         if (cpd.settings[UO_nl_brace_brace].a != AV_IGNORE)
+         if (cpd->settings[UO_nl_brace_brace].a != AV_IGNORE)
          {
             next = chunk_get_next_nc(pc, CNAV_PREPROC);
             if ((next != NULL) && (next->type == CT_BRACE_CLOSE))
             {
-               newline_iarf_pair(pc, next, cpd.settings[UO_nl_brace_brace].a);
+               newline_iarf_pair(pc, next, cpd->settings[UO_nl_brace_brace].a);
             }
          }
 
-         if (cpd.settings[UO_eat_blanks_before_close_brace].b)
+         if (cpd->settings[UO_eat_blanks_before_close_brace].b)
          {
             /* Limit the newlines before the close brace to 1 */
             prev = chunk_get_prev(pc);
@@ -1513,7 +1514,7 @@ void newlines_cleanup_braces(void)
                prev->nl_count = 1;
             }
          }
-         else if (cpd.settings[UO_nl_ds_struct_enum_close_brace].b &&
+         else if (cpd->settings[UO_nl_ds_struct_enum_close_brace].b &&
                   ((pc->parent_type == CT_ENUM) ||
                    (pc->parent_type == CT_STRUCT) ||
                    (pc->parent_type == CT_UNION)))
@@ -1534,7 +1535,7 @@ void newlines_cleanup_braces(void)
          }
 
          /* Force a newline after a function def */
-         if (cpd.settings[UO_nl_after_brace_close].b ||
+         if (cpd->settings[UO_nl_after_brace_close].b ||
              (pc->parent_type == CT_FUNC_DEF) ||
              (pc->parent_type == CT_OC_MSG_DECL))
          {
@@ -1552,7 +1553,7 @@ void newlines_cleanup_braces(void)
       }
       else if (pc->type == CT_VBRACE_OPEN)
       {
-         if (cpd.settings[UO_nl_after_vbrace_open].b)
+         if (cpd->settings[UO_nl_after_vbrace_open].b)
          {
             next = chunk_get_next(pc);
             if ((next->type != CT_VBRACE_CLOSE) &&
@@ -1564,42 +1565,42 @@ void newlines_cleanup_braces(void)
          }
 
          if (((pc->parent_type == CT_IF) &&
-              cpd.settings[UO_nl_create_if_one_liner].b) ||
+              cpd->settings[UO_nl_create_if_one_liner].b) ||
              ((pc->parent_type == CT_FOR) &&
-              cpd.settings[UO_nl_create_for_one_liner].b) ||
+              cpd->settings[UO_nl_create_for_one_liner].b) ||
              ((pc->parent_type == CT_WHILE) &&
-              cpd.settings[UO_nl_create_while_one_liner].b))
+              cpd->settings[UO_nl_create_while_one_liner].b))
          {
             nl_create_one_liner(pc);
          }
       }
       else if (pc->type == CT_STRUCT)
       {
-         newlines_struct_enum_union(pc, cpd.settings[UO_nl_struct_brace].a, true);
+         newlines_struct_enum_union(pc, cpd->settings[UO_nl_struct_brace].a, true);
       }
       else if (pc->type == CT_UNION)
       {
-         newlines_struct_enum_union(pc, cpd.settings[UO_nl_union_brace].a, true);
+         newlines_struct_enum_union(pc, cpd->settings[UO_nl_union_brace].a, true);
       }
       else if (pc->type == CT_ENUM)
       {
-         newlines_struct_enum_union(pc, cpd.settings[UO_nl_enum_brace].a, true);
+         newlines_struct_enum_union(pc, cpd->settings[UO_nl_enum_brace].a, true);
       }
       else if (pc->type == CT_CASE)
       {
          /* Note: 'default' also maps to CT_CASE */
-         if (cpd.settings[UO_nl_before_case].b)
+         if (cpd->settings[UO_nl_before_case].b)
          {
             newline_case(pc);
          }
       }
       else if (pc->type == CT_THROW)
       {
-         newline_iarf(chunk_get_prev_ncnl(pc), cpd.settings[UO_nl_before_throw].a);
+         newline_iarf(chunk_get_prev_ncnl(pc), cpd->settings[UO_nl_before_throw].a);
       }
       else if (pc->type == CT_CASE_COLON)
       {
-         if (cpd.settings[UO_nl_after_case].b)
+         if (cpd->settings[UO_nl_after_case].b)
          {
             newline_case_colon(pc);
          }
@@ -1618,7 +1619,7 @@ void newlines_cleanup_braces(void)
       }
       else if (pc->type == CT_RETURN)
       {
-         if (cpd.settings[UO_nl_after_return].b)
+         if (cpd->settings[UO_nl_after_return].b)
          {
             newline_return(pc);
          }
@@ -1626,7 +1627,7 @@ void newlines_cleanup_braces(void)
       else if (pc->type == CT_SEMICOLON)
       {
          if (((pc->flags & (PCF_IN_SPAREN | PCF_IN_PREPROC)) == 0) &&
-             cpd.settings[UO_nl_after_semicolon].b)
+             cpd->settings[UO_nl_after_semicolon].b)
          {
             next = chunk_get_next(pc);
             while ((next != NULL) && (next->type == CT_VBRACE_CLOSE))
@@ -1651,15 +1652,15 @@ void newlines_cleanup_braces(void)
               (pc->parent_type == CT_FUNC_CLASS) ||
               (pc->parent_type == CT_OPERATOR))
              &&
-             ((cpd.settings[UO_nl_func_decl_start].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_decl_args].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_decl_end].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_decl_empty].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_type_name].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_type_name_class].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_scope_name].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_proto_type_name].a != AV_IGNORE) ||
-              (cpd.settings[UO_nl_func_paren].a != AV_IGNORE)))
+             ((cpd->settings[UO_nl_func_decl_start].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_decl_args].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_decl_end].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_decl_empty].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_type_name].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_type_name_class].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_scope_name].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_proto_type_name].a != AV_IGNORE) ||
+              (cpd->settings[UO_nl_func_paren].a != AV_IGNORE)))
          {
             newline_func_def(pc);
          }
@@ -1675,14 +1676,14 @@ void newlines_cleanup_braces(void)
                tmp = chunk_get_prev_ncnl(chunk_get_prev_type(pc, CT_ANGLE_OPEN, pc->level));
                if ((tmp != NULL) && (tmp->type == CT_TEMPLATE))
                {
-                  newline_iarf(pc, cpd.settings[UO_nl_template_class].a);
+                  newline_iarf(pc, cpd->settings[UO_nl_template_class].a);
                }
             }
          }
       }
       else if (pc->type == CT_NAMESPACE)
       {
-         newlines_struct_enum_union(pc, cpd.settings[UO_nl_namespace_brace].a, false);
+         newlines_struct_enum_union(pc, cpd->settings[UO_nl_namespace_brace].a, false);
       }
       else if (pc->type == CT_SQUARE_OPEN)
       {
@@ -1690,11 +1691,11 @@ void newlines_cleanup_braces(void)
              ((pc->flags & PCF_ONE_LINER) == 0))
          {
             tmp = chunk_get_prev_ncnl(pc);
-            newline_iarf(tmp, cpd.settings[UO_nl_assign_square].a);
+            newline_iarf(tmp, cpd->settings[UO_nl_assign_square].a);
 
-            argval_t arg = cpd.settings[UO_nl_after_square_assign].a;
+            argval_t arg = cpd->settings[UO_nl_after_square_assign].a;
 
-            if (cpd.settings[UO_nl_assign_square].a & AV_ADD)
+            if (cpd->settings[UO_nl_assign_square].a & AV_ADD)
             {
                arg = AV_ADD;
             }
@@ -1716,7 +1717,7 @@ void newlines_cleanup_braces(void)
       else if (pc->type == CT_PRIVATE)
       {
          /** Make sure there is a newline before an access spec */
-         if (cpd.settings[UO_nl_before_access_spec].n > 0)
+         if (cpd->settings[UO_nl_before_access_spec].n > 0)
          {
             prev = chunk_get_prev(pc);
             if (!chunk_is_newline(prev))
@@ -1728,7 +1729,7 @@ void newlines_cleanup_braces(void)
       else if (pc->type == CT_PRIVATE_COLON)
       {
          /** Make sure there is a newline after an access spec */
-         if (cpd.settings[UO_nl_after_access_spec].n > 0)
+         if (cpd->settings[UO_nl_after_access_spec].n > 0)
          {
             next = chunk_get_next(pc);
             if (!chunk_is_newline(next))
@@ -1739,7 +1740,7 @@ void newlines_cleanup_braces(void)
       }
       else if (pc->type == CT_PP_DEFINE)
       {
-         if (cpd.settings[UO_nl_multi_line_define].b)
+         if (cpd->settings[UO_nl_multi_line_define].b)
          {
             nl_handle_define(pc);
          }
@@ -1810,37 +1811,67 @@ void newline_after_multiline_comment(void)
 
 /**
  * Handle insertion/removal of blank lines before if/for/while/do
+ * Also collects the chunks that newlines_chunk_pos(),
+ * newlines_class_colon_pos() and newlines_squeeze_ifdef() look at, so that
+ * those don't each need a walk of the whole list.
+ *
+ * @param later   Gets those chunks, in list order
  */
-void newlines_insert_blank_lines(void)
+void newlines_insert_blank_lines(ChunkStack& later)
 {
    chunk_t *pc;
 
+   later.Reset();
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next_ncnl(pc))
    {
+      switch (pc->type)
+      {
+      case CT_BOOL:
+      case CT_COMPARE:
+      case CT_COND_COLON:
+      case CT_QUESTION:
+      case CT_COMMA:
+      case CT_ASSIGN:
+      case CT_ARITH:
+      case CT_CLASS_COLON:
+         later.Push(pc);
+         break;
+
+      case CT_PREPROC:
+         if (pc->level > 0)
+         {
+            later.Push(pc);
+         }
+         break;
+
+      default:
+         break;
+      }
+
       if (pc->type == CT_IF)
       {
-         newlines_if_for_while_switch_pre_blank_lines(pc, cpd.settings[UO_nl_before_if].a);
-         newlines_if_for_while_switch_post_blank_lines(pc, cpd.settings[UO_nl_after_if].a);
+         newlines_if_for_while_switch_pre_blank_lines(pc, cpd->settings[UO_nl_before_if].a);
+         newlines_if_for_while_switch_post_blank_lines(pc, cpd->settings[UO_nl_after_if].a);
       }
       else if (pc->type == CT_FOR)
       {
-         newlines_if_for_while_switch_pre_blank_lines(pc, cpd.settings[UO_nl_before_for].a);
-         newlines_if_for_while_switch_post_blank_lines(pc, cpd.settings[UO_nl_after_for].a);
+         newlines_if_for_while_switch_pre_blank_lines(pc, cpd->settings[UO_nl_before_for].a);
+         newlines_if_for_while_switch_post_blank_lines(pc, cpd->settings[UO_nl_after_for].a);
       }
       else if (pc->type == CT_WHILE)
       {
-         newlines_if_for_while_switch_pre_blank_lines(pc, cpd.settings[UO_nl_before_while].a);
-         newlines_if_for_while_switch_post_blank_lines(pc, cpd.settings[UO_nl_after_while].a);
+         newlines_if_for_while_switch_pre_blank_lines(pc, cpd->settings[UO_nl_before_while].a);
+         newlines_if_for_while_switch_post_blank_lines(pc, cpd->settings[UO_nl_after_while].a);
       }
       else if (pc->type == CT_SWITCH)
       {
-         newlines_if_for_while_switch_pre_blank_lines(pc, cpd.settings[UO_nl_before_switch].a);
-         newlines_if_for_while_switch_post_blank_lines(pc, cpd.settings[UO_nl_after_switch].a);
+         newlines_if_for_while_switch_pre_blank_lines(pc, cpd->settings[UO_nl_before_switch].a);
+         newlines_if_for_while_switch_post_blank_lines(pc, cpd->settings[UO_nl_after_switch].a);
       }
       else if (pc->type == CT_DO)
       {
-         newlines_if_for_while_switch_pre_blank_lines(pc, cpd.settings[UO_nl_before_do].a);
-         newlines_if_for_while_switch_post_blank_lines(pc, cpd.settings[UO_nl_after_do].a);
+         newlines_if_for_while_switch_pre_blank_lines(pc, cpd->settings[UO_nl_before_do].a);
+         newlines_if_for_while_switch_post_blank_lines(pc, cpd->settings[UO_nl_after_do].a);
       }
       else
       {
@@ -1850,7 +1881,10 @@ void newlines_insert_blank_lines(void)
 }
 
 
-void newlines_squeeze_ifdef(void)
+/**
+ * @param later   The chunks collected by newlines_insert_blank_lines()
+ */
+void newlines_squeeze_ifdef(const ChunkStack& later)
 {
    chunk_t *pc;
    chunk_t *ppr;
@@ -1859,8 +1893,9 @@ void newlines_squeeze_ifdef(void)
    chunk_t *tmp1;
    chunk_t *tmp2;
 
-   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next_ncnl(pc))
+   for (int idx = 0; idx < later.Len(); idx++)
    {
+      pc = later.GetChunk(idx);
       if ((pc->type == CT_PREPROC) && (pc->level > 0))
       {
          ppr = chunk_get_next(pc);
@@ -1914,66 +1949,66 @@ void newlines_eat_start_end(void)
    chunk_t *pc;
 
    /* Process newlines at the start of the file */
-   if (((cpd.settings[UO_nl_start_of_file].a & AV_REMOVE) != 0) ||
-       (((cpd.settings[UO_nl_start_of_file].a & AV_ADD) != 0) &&
-        (cpd.settings[UO_nl_start_of_file_min].n > 0)))
+   if (((cpd->settings[UO_nl_start_of_file].a & AV_REMOVE) != 0) ||
+       (((cpd->settings[UO_nl_start_of_file].a & AV_ADD) != 0) &&
+        (cpd->settings[UO_nl_start_of_file_min].n > 0)))
    {
       pc = chunk_get_head();
       if (pc != NULL)
       {
          if (pc->type == CT_NEWLINE)
          {
-            if (cpd.settings[UO_nl_start_of_file].a == AV_REMOVE)
+            if (cpd->settings[UO_nl_start_of_file].a == AV_REMOVE)
             {
                chunk_del(pc);
             }
-            else if ((cpd.settings[UO_nl_start_of_file].a == AV_FORCE) ||
-                     (pc->nl_count < cpd.settings[UO_nl_start_of_file_min].n))
+            else if ((cpd->settings[UO_nl_start_of_file].a == AV_FORCE) ||
+                     (pc->nl_count < cpd->settings[UO_nl_start_of_file_min].n))
             {
-               pc->nl_count = cpd.settings[UO_nl_start_of_file_min].n;
+               pc->nl_count = cpd->settings[UO_nl_start_of_file_min].n;
             }
          }
-         else if (((cpd.settings[UO_nl_start_of_file].a & AV_ADD) != 0) &&
-                  (cpd.settings[UO_nl_start_of_file_min].n > 0))
+         else if (((cpd->settings[UO_nl_start_of_file].a & AV_ADD) != 0) &&
+                  (cpd->settings[UO_nl_start_of_file_min].n > 0))
          {
             chunk_t chunk;
             memset(&chunk, 0, sizeof(chunk));
             chunk.orig_line = pc->orig_line;
             chunk.type      = CT_NEWLINE;
-            chunk.nl_count  = cpd.settings[UO_nl_start_of_file_min].n;
+            chunk.nl_count  = cpd->settings[UO_nl_start_of_file_min].n;
             chunk_add_before(&chunk, pc);
          }
       }
    }
 
    /* Process newlines at the end of the file */
-   if (((cpd.settings[UO_nl_end_of_file].a & AV_REMOVE) != 0) ||
-       (((cpd.settings[UO_nl_end_of_file].a & AV_ADD) != 0) &&
-        (cpd.settings[UO_nl_end_of_file_min].n > 0)))
+   if (((cpd->settings[UO_nl_end_of_file].a & AV_REMOVE) != 0) ||
+       (((cpd->settings[UO_nl_end_of_file].a & AV_ADD) != 0) &&
+        (cpd->settings[UO_nl_end_of_file_min].n > 0)))
    {
       pc = chunk_get_tail();
       if (pc != NULL)
       {
          if (pc->type == CT_NEWLINE)
          {
-            if (cpd.settings[UO_nl_end_of_file].a == AV_REMOVE)
+            if (cpd->settings[UO_nl_end_of_file].a == AV_REMOVE)
             {
                chunk_del(pc);
             }
-            else if ((cpd.settings[UO_nl_end_of_file].a == AV_FORCE) ||
-                     (pc->nl_count < cpd.settings[UO_nl_end_of_file_min].n))
+            else if ((cpd->settings[UO_nl_end_of_file].a == AV_FORCE) ||
+                     (pc->nl_count < cpd->settings[UO_nl_end_of_file_min].n))
             {
-               pc->nl_count = cpd.settings[UO_nl_end_of_file_min].n;
+               pc->nl_count = cpd->settings[UO_nl_end_of_file_min].n;
             }
          }
-         else if (((cpd.settings[UO_nl_end_of_file].a & AV_ADD) != 0) &&
-                  (cpd.settings[UO_nl_end_of_file_min].n > 0))
+         else if (((cpd->settings[UO_nl_end_of_file].a & AV_ADD) != 0) &&
+                  (cpd->settings[UO_nl_end_of_file_min].n > 0))
          {
             chunk_t chunk;
             memset(&chunk, 0, sizeof(chunk));
             chunk.orig_line = pc->orig_line;
             chunk.type      = CT_NEWLINE;
-            chunk.nl_count  = cpd.settings[UO_nl_end_of_file_min].n;
+            chunk.nl_count  = cpd->settings[UO_nl_end_of_file_min].n;
             chunk_add(&chunk);
          }
       }
@@ -1986,8 +2021,13 @@ void newlines_eat_start_end(void)
  * Will not move tokens that are on their own line or have other than
  * exactly 1 newline before (UO_pos_comma == TRAIL) or after (UO_pos_comma == LEAD).
  * We can't remove a newline if it is right before a preprocessor.
+ *
+ * A move only takes a chunk across newlines and comments, so the chunks in
+ * 'later' stay in list order and each type can be done from there.
+ *
+ * @param later   The chunks collected by newlines_insert_blank_lines()
  */
-void newlines_chunk_pos(c_token_t chunk_type, tokenpos_e mode)
+void newlines_chunk_pos(const ChunkStack& later, c_token_t chunk_type, tokenpos_e mode)
 {
    chunk_t *pc;
    chunk_t *next;
@@ -1998,8 +2038,9 @@ void newlines_chunk_pos(c_token_t chunk_type, tokenpos_e mode)
       return;
    }
 
-   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next_ncnl(pc))
+   for (int idx = 0; idx < later.Len(); idx++)
    {
+      pc = later.GetChunk(idx);
       if (pc->type == chunk_type)
       {
          prev = chunk_get_prev_nc(pc);
@@ -2050,20 +2091,32 @@ void newlines_chunk_pos(c_token_t chunk_type, tokenpos_e mode)
 /**
  * Searches for CT_CLASS_COLON and moves them, if needed.
  * Also breaks up the args
+ *
+ * @param later   The chunks collected by newlines_insert_blank_lines()
  */
-void newlines_class_colon_pos(void)
+void newlines_class_colon_pos(const ChunkStack& later)
 {
    chunk_t    *pc;
    chunk_t    *next;
    chunk_t    *prev;
-   tokenpos_e mode    = cpd.settings[UO_pos_class_colon].tp;
+   tokenpos_e mode    = cpd->settings[UO_pos_class_colon].tp;
    chunk_t    *ccolon = NULL;
+   int        idx     = 0;
 
-   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next_ncnl(pc))
+   for (pc = NULL; ; pc = chunk_get_next_ncnl(pc))
    {
-      if ((ccolon == NULL) && (pc->type != CT_CLASS_COLON))
+      if ((ccolon == NULL) || (pc == NULL) || (pc->type == CT_CLASS_COLON))
       {
-         continue;
+         /* Skip to the next class colon */
+         while ((idx < later.Len()) && (later.GetChunk(idx)->type != CT_CLASS_COLON))
+         {
+            idx++;
+         }
+         if (idx >= later.Len())
+         {
+            break;
+         }
+         pc = later.GetChunk(idx++);
       }
 
       if (pc->type == CT_CLASS_COLON)
@@ -2073,14 +2126,14 @@ void newlines_class_colon_pos(void)
          next   = chunk_get_next_nc(pc);
 
          if (!chunk_is_newline(prev) && !chunk_is_newline(next) &&
-             ((cpd.settings[UO_nl_class_colon].a & AV_ADD) != 0))
+             ((cpd->settings[UO_nl_class_colon].a & AV_ADD) != 0))
          {
             newline_add_after(pc);
             prev = chunk_get_prev_nc(pc);
             next = chunk_get_next_nc(pc);
          }
 
-         if (cpd.settings[UO_nl_class_colon].a == AV_REMOVE)
+         if (cpd->settings[UO_nl_class_colon].a == AV_REMOVE)
          {
             if (chunk_is_newline(prev) &&
                 chunk_safe_to_del_nl(prev))
@@ -2123,13 +2176,13 @@ void newlines_class_colon_pos(void)
 
          if ((pc->type == CT_COMMA) && (pc->level == ccolon->level))
          {
-            if ((cpd.settings[UO_nl_class_init_args].a & AV_ADD) != 0)
+            if ((cpd->settings[UO_nl_class_init_args].a & AV_ADD) != 0)
             {
-               if (cpd.settings[UO_pos_class_comma].tp == TP_TRAIL)
+               if (cpd->settings[UO_pos_class_comma].tp == TP_TRAIL)
                {
                   newline_add_after(pc);
                }
-               else if (cpd.settings[UO_pos_class_comma].tp == TP_LEAD)
+               else if (cpd->settings[UO_pos_class_comma].tp == TP_LEAD)
                {
                   newline_add_before(pc);
                   next = chunk_get_next_nc(pc);
@@ -2139,7 +2192,7 @@ void newlines_class_colon_pos(void)
                   }
                }
             }
-            else if (cpd.settings[UO_nl_class_init_args].a == AV_REMOVE)
+            else if (cpd->settings[UO_nl_class_init_args].a == AV_REMOVE)
             {
                next = chunk_get_next(pc);
                if (chunk_is_newline(next) && chunk_safe_to_del_nl(next))
@@ -2182,14 +2235,14 @@ void do_blank_lines(void)
       pcmt = chunk_get_prev(pc);
 
       /* Limit consecutive newlines */
-      if ((cpd.settings[UO_nl_max].n > 0) &&
-          (pc->nl_count > (cpd.settings[UO_nl_max].n)))
+      if ((cpd->settings[UO_nl_max].n > 0) &&
+          (pc->nl_count > (cpd->settings[UO_nl_max].n)))
       {
-         pc->nl_count = cpd.settings[UO_nl_max].n;
+         pc->nl_count = cpd->settings[UO_nl_max].n;
       }
 
       /** Control blanks before multi-line comments */
-      if ((cpd.settings[UO_nl_before_block_comment].n > pc->nl_count) &&
+      if ((cpd->settings[UO_nl_before_block_comment].n > pc->nl_count) &&
           (next != NULL) &&
           (next->type == CT_COMMENT_MULTI))
       {
@@ -2199,12 +2252,12 @@ void do_blank_lines(void)
               (prev->type != CT_VBRACE_OPEN)))
          {
             LOG_FMT(LCMTNL, "%s: NL-MLCommentC: line %d\n", __func__, next->orig_line);
-            pc->nl_count = cpd.settings[UO_nl_before_block_comment].n;
+            pc->nl_count = cpd->settings[UO_nl_before_block_comment].n;
          }
       }
 
       /** Control blanks before single line C comments */
-      if ((cpd.settings[UO_nl_before_c_comment].n > pc->nl_count) &&
+      if ((cpd->settings[UO_nl_before_c_comment].n > pc->nl_count) &&
           (next != NULL) &&
           (next->type == CT_COMMENT))
       {
@@ -2215,12 +2268,12 @@ void do_blank_lines(void)
               (pcmt->type != CT_COMMENT)))
          {
             LOG_FMT(LCMTNL, "%s: NL-CommentC: line %d\n", __func__, next->orig_line);
-            pc->nl_count = cpd.settings[UO_nl_before_c_comment].n;
+            pc->nl_count = cpd->settings[UO_nl_before_c_comment].n;
          }
       }
 
       /** Control blanks before CPP comments */
-      if ((cpd.settings[UO_nl_before_cpp_comment].n > pc->nl_count) &&
+      if ((cpd->settings[UO_nl_before_cpp_comment].n > pc->nl_count) &&
           (next != NULL) &&
           (next->type == CT_COMMENT_CPP))
       {
@@ -2231,13 +2284,13 @@ void do_blank_lines(void)
               (pcmt->type != CT_COMMENT_CPP)))
          {
             LOG_FMT(LCMTNL, "%s: NL-CommentCPP: line %d\n", __func__, next->orig_line);
-            pc->nl_count = cpd.settings[UO_nl_before_cpp_comment].n;
+            pc->nl_count = cpd->settings[UO_nl_before_cpp_comment].n;
          }
       }
 
       /** Control blanks before an access spec */
-      if ((cpd.settings[UO_nl_before_access_spec].n > 0) &&
-          (cpd.settings[UO_nl_before_access_spec].n != pc->nl_count) &&
+      if ((cpd->settings[UO_nl_before_access_spec].n > 0) &&
+          (cpd->settings[UO_nl_before_access_spec].n != pc->nl_count) &&
           (next != NULL) &&
           (next->type == CT_PRIVATE))
       {
@@ -2247,18 +2300,18 @@ void do_blank_lines(void)
               (prev->type != CT_VBRACE_OPEN)))
          {
             LOG_FMT(LCMTNL, "%s: NL-BeforePrivate: line %d\n", __func__, next->orig_line);
-            pc->nl_count = cpd.settings[UO_nl_before_access_spec].n;
+            pc->nl_count = cpd->settings[UO_nl_before_access_spec].n;
          }
       }
 
       /** Control blanks after an access spec */
-      if ((cpd.settings[UO_nl_after_access_spec].n > 0) &&
-          (cpd.settings[UO_nl_after_access_spec].n != pc->nl_count) &&
+      if ((cpd->settings[UO_nl_after_access_spec].n > 0) &&
+          (cpd->settings[UO_nl_after_access_spec].n != pc->nl_count) &&
           (prev != NULL) &&
           (prev->type == CT_PRIVATE_COLON))
       {
          LOG_FMT(LCMTNL, "%s: NL-AfterPrivate: line %d\n", __func__, prev->orig_line);
-         pc->nl_count = cpd.settings[UO_nl_after_access_spec].n;
+         pc->nl_count = cpd->settings[UO_nl_after_access_spec].n;
       }
 
       /* Add blanks after function bodies */
@@ -2270,17 +2323,17 @@ void do_blank_lines(void)
       {
          if (prev->flags & PCF_ONE_LINER)
          {
-            if (cpd.settings[UO_nl_after_func_body_one_liner].n > pc->nl_count)
+            if (cpd->settings[UO_nl_after_func_body_one_liner].n > pc->nl_count)
             {
-               pc->nl_count = cpd.settings[UO_nl_after_func_body_one_liner].n;
+               pc->nl_count = cpd->settings[UO_nl_after_func_body_one_liner].n;
             }
          }
          else
          {
-            if ((cpd.settings[UO_nl_after_func_body].n > 0) &&
-                (cpd.settings[UO_nl_after_func_body].n != pc->nl_count))
+            if ((cpd->settings[UO_nl_after_func_body].n > 0) &&
+                (cpd->settings[UO_nl_after_func_body].n != pc->nl_count))
             {
-               pc->nl_count = cpd.settings[UO_nl_after_func_body].n;
+               pc->nl_count = cpd->settings[UO_nl_after_func_body].n;
             }
          }
       }
@@ -2290,35 +2343,35 @@ void do_blank_lines(void)
           (prev->type == CT_SEMICOLON) &&
           (prev->parent_type == CT_FUNC_PROTO))
       {
-         if (cpd.settings[UO_nl_after_func_proto].n > pc->nl_count)
+         if (cpd->settings[UO_nl_after_func_proto].n > pc->nl_count)
          {
-            pc->nl_count = cpd.settings[UO_nl_after_func_proto].n;
+            pc->nl_count = cpd->settings[UO_nl_after_func_proto].n;
          }
-         if ((cpd.settings[UO_nl_after_func_proto_group].n > pc->nl_count) &&
+         if ((cpd->settings[UO_nl_after_func_proto_group].n > pc->nl_count) &&
              (next != NULL) &&
              (next->parent_type != CT_FUNC_PROTO) &&
              can_increase_nl(pc))
          {
-            pc->nl_count = cpd.settings[UO_nl_after_func_proto_group].n;
+            pc->nl_count = cpd->settings[UO_nl_after_func_proto_group].n;
          }
       }
 
       /* Change blanks between a function comment and body */
-      if ((cpd.settings[UO_nl_comment_func_def].n != 0) &&
+      if ((cpd->settings[UO_nl_comment_func_def].n != 0) &&
           (pcmt->type == CT_COMMENT_MULTI) &&
           (pcmt->parent_type == CT_COMMENT_WHOLE) &&
           (next != NULL) && (next->parent_type == CT_FUNC_DEF))
       {
-         if (cpd.settings[UO_nl_comment_func_def].n != pc->nl_count)
+         if (cpd->settings[UO_nl_comment_func_def].n != pc->nl_count)
          {
             LOG_FMT(LCMTNL, "%s: nl_comment_func_def affected line %d\n", __func__, pc->orig_line);
-            pc->nl_count = cpd.settings[UO_nl_comment_func_def].n;
+            pc->nl_count = cpd->settings[UO_nl_comment_func_def].n;
          }
       }
 
       /* Change blanks after a try-catch-finally block */
-      if ((cpd.settings[UO_nl_after_try_catch_finally].n != 0) &&
-          (cpd.settings[UO_nl_after_try_catch_finally].n != pc->nl_count) &&
+      if ((cpd->settings[UO_nl_after_try_catch_finally].n != 0) &&
+          (cpd->settings[UO_nl_after_try_catch_finally].n != pc->nl_count) &&
           (prev != NULL) && (next != NULL))
       {
          if ((prev->type == CT_BRACE_CLOSE) &&
@@ -2329,14 +2382,14 @@ void do_blank_lines(void)
                 (next->type != CT_CATCH) &&
                 (next->type != CT_FINALLY))
             {
-               pc->nl_count = cpd.settings[UO_nl_after_try_catch_finally].n;
+               pc->nl_count = cpd->settings[UO_nl_after_try_catch_finally].n;
             }
          }
       }
 
       /* Change blanks after a try-catch-finally block */
-      if ((cpd.settings[UO_nl_between_get_set].n != 0) &&
-          (cpd.settings[UO_nl_between_get_set].n != pc->nl_count) &&
+      if ((cpd->settings[UO_nl_between_get_set].n != 0) &&
+          (cpd->settings[UO_nl_between_get_set].n != pc->nl_count) &&
           (prev != NULL) && (next != NULL))
       {
          if ((prev->parent_type == CT_GETSET) &&
@@ -2344,25 +2397,25 @@ void do_blank_lines(void)
              ((prev->type == CT_BRACE_CLOSE) ||
               (prev->type == CT_SEMICOLON)))
          {
-            pc->nl_count = cpd.settings[UO_nl_between_get_set].n;
+            pc->nl_count = cpd->settings[UO_nl_between_get_set].n;
          }
       }
 
       /* Change blanks after a try-catch-finally block */
-      if ((cpd.settings[UO_nl_around_cs_property].n != 0) &&
-          (cpd.settings[UO_nl_around_cs_property].n != pc->nl_count) &&
+      if ((cpd->settings[UO_nl_around_cs_property].n != 0) &&
+          (cpd->settings[UO_nl_around_cs_property].n != pc->nl_count) &&
           (prev != NULL) && (next != NULL))
       {
          if ((prev->type == CT_BRACE_CLOSE) &&
              (prev->parent_type == CT_CS_PROPERTY) &&
              (next->type != CT_BRACE_CLOSE))
          {
-            pc->nl_count = cpd.settings[UO_nl_around_cs_property].n;
+            pc->nl_count = cpd->settings[UO_nl_around_cs_property].n;
          }
          else if ((next->parent_type == CT_CS_PROPERTY) &&
                   (next->flags & PCF_STMT_START))
          {
-            pc->nl_count = cpd.settings[UO_nl_around_cs_property].n;
+            pc->nl_count = cpd->settings[UO_nl_around_cs_property].n;
          }
       }
    }
@@ -22,6 +22,7 @@
 static std::map<std::string, option_map_value>      option_name_map;
 static std::map<uncrustify_groups, group_map_value> group_map;
 static uncrustify_groups current_group;
+static int               max_option_name_len;
 
 
 static void unc_add_option(const char         *name,
@@ -100,9 +101,9 @@ void unc_add_option(const char *name, uncrustify_options id, argtype_e type,
    option_name_map[name] = value;
 
    int name_len = strlen(name);
-   if (name_len > cpd.max_option_name_len)
+   if (name_len > max_option_name_len)
    {
-      cpd.max_option_name_len = name_len;
+      max_option_name_len = name_len;
    }
 }
 
@@ -1079,8 +1080,8 @@ static void convert_value(const option_map_value *entry, const char *val, op_val
       if (strcasecmp(val, "AUTO") != 0)
       {
          LOG_FMT(LWARN, "%s:%d Expected AUTO, LF, CRLF, or CR for %s, got %s\n",
-                 cpd.filename, cpd.line_number, entry->name, val);
-         cpd.error_count++;
+                 cpd->filename, cpd->line_number, entry->name, val);
+         cpd->error_count++;
       }
       dest->le = LE_AUTO;
       return;
@@ -1103,8 +1104,8 @@ static void convert_value(const option_map_value *entry, const char *val, op_val
       if (strcasecmp(val, "IGNORE") != 0)
       {
          LOG_FMT(LWARN, "%s:%d Expected IGNORE, LEAD/START, or TRAIL/END for %s, got %s\n",
-                 cpd.filename, cpd.line_number, entry->name, val);
-         cpd.error_count++;
+                 cpd->filename, cpd->line_number, entry->name, val);
+         cpd->error_count++;
       }
       dest->tp = TP_IGNORE;
       return;
@@ -1130,13 +1131,13 @@ static void convert_value(const option_map_value *entry, const char *val, op_val
 
          if (((tmp = unc_find_option(val)) != NULL) && (tmp->type == entry->type))
          {
-            dest->n = cpd.settings[tmp->id].n * mult;
+            dest->n = cpd->settings[tmp->id].n * mult;
             return;
          }
       }
       LOG_FMT(LWARN, "%s:%d Expected a number for %s, got %s\n",
-              cpd.filename, cpd.line_number, entry->name, val);
-      cpd.error_count++;
+              cpd->filename, cpd->line_number, entry->name, val);
+      cpd->error_count++;
       dest->n = 0;
       return;
    }
@@ -1168,12 +1169,12 @@ static void convert_value(const option_map_value *entry, const char *val, op_val
 
       if (((tmp = unc_find_option(val)) != NULL) && (tmp->type == entry->type))
       {
-         dest->b = cpd.settings[tmp->id].b ? btrue : !btrue;
+         dest->b = cpd->settings[tmp->id].b ? btrue : !btrue;
          return;
       }
       LOG_FMT(LWARN, "%s:%d Expected 'True' or 'False' for %s, got %s\n",
-              cpd.filename, cpd.line_number, entry->name, val);
-      cpd.error_count++;
+              cpd->filename, cpd->line_number, entry->name, val);
+      cpd->error_count++;
       dest->b = false;
       return;
    }
@@ -1208,12 +1209,12 @@ static void convert_value(const option_map_value *entry, const char *val, op_val
    }
    if (((tmp = unc_find_option(val)) != NULL) && (tmp->type == entry->type))
    {
-      dest->a = cpd.settings[tmp->id].a;
+      dest->a = cpd->settings[tmp->id].a;
       return;
    }
    LOG_FMT(LWARN, "%s:%d Expected 'Add', 'Remove', 'Force', or 'Ignore' for %s, got %s\n",
-           cpd.filename, cpd.line_number, entry->name, val);
-   cpd.error_count++;
+           cpd->filename, cpd->line_number, entry->name, val);
+   cpd->error_count++;
    dest->a = AV_IGNORE;
 }
 
@@ -1224,7 +1225,7 @@ int set_option_value(const char *name, const char *value)
 
    if ((entry = unc_find_option(name)) != NULL)
    {
-      convert_value(entry, value, &cpd.settings[entry->id]);
+      convert_value(entry, value, &cpd->settings[entry->id]);
       return(entry->id);
    }
    return(-1);
@@ -1241,21 +1242,21 @@ int load_option_file(const char *filename)
    int  argc;
    int  idx;
 
-   cpd.line_number = 0;
+   cpd->line_number = 0;
 
    pfile = fopen(filename, "r");
    if (pfile == NULL)
    {
       LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
               __func__, filename, strerror(errno), errno);
-      cpd.error_count++;
+      cpd->error_count++;
       return(-1);
    }
 
    /* Read in the file line by line */
    while (fgets(buffer, sizeof(buffer), pfile) != NULL)
    {
-      cpd.line_number++;
+      cpd->line_number++;
 
       /* Chop off trailing comments */
       if ((ptr = strchr(buffer, '#')) != NULL)
@@ -1283,8 +1284,8 @@ int load_option_file(const char *filename)
          if (argc > 0)
          {
             LOG_FMT(LWARN, "%s:%d Wrong number of arguments: %s...\n",
-                    filename, cpd.line_number, buffer);
-            cpd.error_count++;
+                    filename, cpd->line_number, buffer);
+            cpd->error_count++;
          }
          continue;
       }
@@ -1318,14 +1319,14 @@ int load_option_file(const char *filename)
          if (argc < 3)
          {
             LOG_FMT(LWARN, "%s:%d 'set' requires at least three arguments\n",
-                    filename, cpd.line_number);
+                    filename, cpd->line_number);
          }
          else
          {
             c_token_t id = find_token_name(args[1]);
             if (id != CT_NONE)
             {
-               LOG_FMT(LNOTE, "%s:%d set '%s':", filename, cpd.line_number, args[1]);
+               LOG_FMT(LNOTE, "%s:%d set '%s':", filename, cpd->line_number, args[1]);
                for (idx = 2; idx < argc; idx++)
                {
                   LOG_FMT(LNOTE, " '%s'", args[idx]);
@@ -1335,7 +1336,7 @@ int load_option_file(const char *filename)
             }
             else
             {
-               LOG_FMT(LWARN, "%s:%d unknown type '%s':", filename, cpd.line_number, args[1]);
+               LOG_FMT(LWARN, "%s:%d unknown type '%s':", filename, cpd->line_number, args[1]);
             }
          }
       }
@@ -1345,8 +1346,8 @@ int load_option_file(const char *filename)
          if ((id = set_option_value(args[0], args[1])) < 0)
          {
             LOG_FMT(LWARN, "%s:%d Unknown symbol '%s'\n",
-                    filename, cpd.line_number, args[0]);
-            cpd.error_count++;
+                    filename, cpd->line_number, args[0]);
+            cpd->error_count++;
          }
       }
    }
@@ -1400,13 +1401,13 @@ int save_option_file(FILE *pfile, bool withDoc)
             }
          }
          first      = false;
-         val_string = op_val_to_string(option->type, cpd.settings[option->id]);
+         val_string = op_val_to_string(option->type, cpd->settings[option->id]);
          val_str    = val_string.c_str();
          val_len    = strlen(val_str);
          name_len   = strlen(option->name);
 
          fprintf(pfile, "%s %*.s= ",
-                 option->name, cpd.max_option_name_len - name_len, " ");
+                 option->name, max_option_name_len - name_len, " ");
          if (option->type == AT_STRING)
          {
             fprintf(pfile, "\"%s\"", val_str);
@@ -1477,29 +1478,29 @@ int save_option_file(FILE *pfile, bool withDoc)
       if (ct->type == CT_TYPE)
       {
          fprintf(pfile, "type %*.s%s\n",
-                 cpd.max_option_name_len - 4, " ", ct->tag);
+                 max_option_name_len - 4, " ", ct->tag);
       }
       else if (ct->type == CT_MACRO_OPEN)
       {
          fprintf(pfile, "macro-open %*.s%s\n",
-                 cpd.max_option_name_len - 11, " ", ct->tag);
+                 max_option_name_len - 11, " ", ct->tag);
       }
       else if (ct->type == CT_MACRO_CLOSE)
       {
          fprintf(pfile, "macro-close %*.s%s\n",
-                 cpd.max_option_name_len - 12, " ", ct->tag);
+                 max_option_name_len - 12, " ", ct->tag);
       }
       else if (ct->type == CT_MACRO_ELSE)
       {
          fprintf(pfile, "macro-else %*.s%s\n",
-                 cpd.max_option_name_len - 11, " ", ct->tag);
+                 max_option_name_len - 11, " ", ct->tag);
       }
       else
       {
          const char *tn = get_token_name(ct->type);
 
          fprintf(pfile, "set %s %*.s%s\n", tn,
-                 int(cpd.max_option_name_len - (4 + strlen(tn))), " ", ct->tag);
+                 int(max_option_name_len - (4 + strlen(tn))), " ", ct->tag);
       }
    }
 
@@ -1509,7 +1510,7 @@ int save_option_file(FILE *pfile, bool withDoc)
    while ((dt = get_define_idx(idx)) != NULL)
    {
       fprintf(pfile, "define %*.s%s \"%s\"\n",
-              cpd.max_option_name_len - 6, " ", dt->tag, dt->value);
+              max_option_name_len - 6, " ", dt->tag, dt->value);
    }
 
    fclose(pfile);
@@ -1590,35 +1591,35 @@ void print_options(FILE *pfile, bool verbose)
  */
 void set_option_defaults(void)
 {
-   cpd.settings[UO_newlines].le            = LE_AUTO;
-   cpd.settings[UO_input_tab_size].n       = 8;
-   cpd.settings[UO_output_tab_size].n      = 8;
-   cpd.settings[UO_indent_columns].n       = 8;
-   cpd.settings[UO_indent_with_tabs].n     = 1;
-   cpd.settings[UO_indent_label].n         = 1;
-   cpd.settings[UO_indent_access_spec].n   = 1;
-   cpd.settings[UO_sp_before_comma].a      = AV_REMOVE;
-   cpd.settings[UO_string_escape_char].n   = '\\';
-   cpd.settings[UO_sp_not].a               = AV_REMOVE;
-   cpd.settings[UO_sp_inv].a               = AV_REMOVE;
-   cpd.settings[UO_sp_addr].a              = AV_REMOVE;
-   cpd.settings[UO_sp_deref].a             = AV_REMOVE;
-   cpd.settings[UO_sp_member].a            = AV_REMOVE;
-   cpd.settings[UO_sp_sign].a              = AV_REMOVE;
-   cpd.settings[UO_sp_incdec].a            = AV_REMOVE;
-   cpd.settings[UO_sp_after_type].a        = AV_FORCE;
-   cpd.settings[UO_sp_before_nl_cont].a    = AV_ADD;
-   cpd.settings[UO_sp_before_case_colon].a = AV_REMOVE;
-   cpd.settings[UO_sp_before_semi].a       = AV_REMOVE;
-   cpd.settings[UO_sp_after_semi].a        = AV_ADD;
-   cpd.settings[UO_sp_after_semi_for].a    = AV_FORCE;
-   cpd.settings[UO_cmt_indent_multi].b     = true;
-   cpd.settings[UO_cmt_multi_check_last].b = true;
-   cpd.settings[UO_pp_indent_count].n      = 1;
-   cpd.settings[UO_align_left_shift].b     = true;
-   cpd.settings[UO_indent_align_assign].b  = true;
-   cpd.settings[UO_sp_pp_concat].a         = AV_ADD;
-   cpd.settings[UO_sp_pp_stringify].a      = AV_ADD;
+   cpd->settings[UO_newlines].le            = LE_AUTO;
+   cpd->settings[UO_input_tab_size].n       = 8;
+   cpd->settings[UO_output_tab_size].n      = 8;
+   cpd->settings[UO_indent_columns].n       = 8;
+   cpd->settings[UO_indent_with_tabs].n     = 1;
+   cpd->settings[UO_indent_label].n         = 1;
+   cpd->settings[UO_indent_access_spec].n   = 1;
+   cpd->settings[UO_sp_before_comma].a      = AV_REMOVE;
+   cpd->settings[UO_string_escape_char].n   = '\\';
+   cpd->settings[UO_sp_not].a               = AV_REMOVE;
+   cpd->settings[UO_sp_inv].a               = AV_REMOVE;
+   cpd->settings[UO_sp_addr].a              = AV_REMOVE;
+   cpd->settings[UO_sp_deref].a             = AV_REMOVE;
+   cpd->settings[UO_sp_member].a            = AV_REMOVE;
+   cpd->settings[UO_sp_sign].a              = AV_REMOVE;
+   cpd->settings[UO_sp_incdec].a            = AV_REMOVE;
+   cpd->settings[UO_sp_after_type].a        = AV_FORCE;
+   cpd->settings[UO_sp_before_nl_cont].a    = AV_ADD;
+   cpd->settings[UO_sp_before_case_colon].a = AV_REMOVE;
+   cpd->settings[UO_sp_before_semi].a       = AV_REMOVE;
+   cpd->settings[UO_sp_after_semi].a        = AV_ADD;
+   cpd->settings[UO_sp_after_semi_for].a    = AV_FORCE;
+   cpd->settings[UO_cmt_indent_multi].b     = true;
+   cpd->settings[UO_cmt_multi_check_last].b = true;
+   cpd->settings[UO_pp_indent_count].n      = 1;
+   cpd->settings[UO_align_left_shift].b     = true;
+   cpd->settings[UO_indent_align_assign].b  = true;
+   cpd->settings[UO_sp_pp_concat].a         = AV_ADD;
+   cpd->settings[UO_sp_pp_stringify].a      = AV_ADD;
 }
 
 
@@ -11,6 +11,10 @@
 #include "unc_ctype.h"
 #include <cstring>
 #include <cstdlib>
+#include <cassert>
+#include <climits>
+#include <string>
+#include <vector>
 
 static void output_comment_multi(chunk_t *pc);
 static void output_comment_multi_simple(chunk_t *pc);
@@ -32,41 +36,112 @@ static chunk_t *output_comment_cpp(chunk_t *pc);
 static void add_comment_text(const char *text, int len,
                              cmt_reflow& cmt, bool esc_close);
 
+/**
+ * For --lines: the input lines that a chunk came from and the output lines
+ * that it went to
+ */
+struct line_span_t
+{
+   int in_first;
+   int in_last;
+   int out_first;
+   int out_last;
+};
+
+/**
+ * For --lines: an opening brace or vbrace and the output line it went to
+ */
+struct line_brace_t
+{
+   chunk_t *pc;
+   int     out_line;
+};
+
+struct line_map_t
+{
+   std::vector<line_span_t>  spans;
+   std::vector<line_span_t>  ties;      /* deleted pairs, only the in_ lines */
+   std::vector<line_brace_t> braces;    /* the open braces, innermost last */
+   int                       out_lines; /* newlines in the output before 'scan' */
+   int                       scan;      /* how much of the output was counted */
+};
+
+/**
+ * Makes room for len more bytes in the output buffer.
+ *
+ * @return where the bytes go
+ */
+static char *out_reserve(int len)
+{
+   output_buf_t& out = cpd->out;
+
+   if (out.len + len > out.size)
+   {
+      out.size = (out.size < 65536) ? 65536 : out.size;
+      while (out.len + len > out.size)
+      {
+         out.size *= 2;
+      }
+      out.data = (char *)realloc(out.data, out.size);
+      assert(out.data != NULL);
+   }
+   return(&out.data[out.len]);
+}
+
+
+/**
+ * Appends bytes to the output buffer, without looking at them.
+ */
+static void out_write(const char *text, int len)
+{
+   memcpy(out_reserve(len), text, len);
+   cpd->out.len += len;
+}
+
+
+/**
+ * Appends count copies of ch to the output buffer.
+ */
+static void out_fill(char ch, int count)
+{
+   memset(out_reserve(count), ch, count);
+   cpd->out.len += count;
+}
+
+
 /**
  * All output text is sent here, one char at a time.
  */
 static void add_char(char ch)
 {
-   static char last_char = 0;
-
    /* If we did a '\r' and it isn't followed by a '\n', then output a newline */
-   if ((last_char == '\r') && (ch != '\n'))
+   if ((cpd->last_char == '\r') && (ch != '\n'))
    {
-      fputs(cpd.newline, cpd.fout);
-      cpd.column      = 1;
-      cpd.did_newline = 1;
+      out_write(cpd->newline, strlen(cpd->newline));
+      cpd->column      = 1;
+      cpd->did_newline = 1;
    }
 
    /* convert a newline into the LF/CRLF/CR sequence */
    if (ch == '\n')
    {
-      fputs(cpd.newline, cpd.fout);
-      cpd.column      = 1;
-      cpd.did_newline = 1;
+      out_write(cpd->newline, strlen(cpd->newline));
+      cpd->column      = 1;
+      cpd->did_newline = 1;
    }
    else if (ch == '\r')
    {
       /* do not output '\r' */
-      cpd.column      = 1;
-      cpd.did_newline = 1;
+      cpd->column      = 1;
+      cpd->did_newline = 1;
    }
    else
    {
       /* Explicitly disallow a tab after a space */
-      if ((ch == '\t') && (last_char == ' '))
+      if ((ch == '\t') && (cpd->last_char == ' '))
       {
-         int endcol = next_tab_column(cpd.column);
-         while (cpd.column < endcol)
+         int endcol = next_tab_column(cpd->column);
+         while (cpd->column < endcol)
          {
             add_char(' ');
          }
@@ -74,39 +149,107 @@ static void add_char(char ch)
       }
       else
       {
-         fputc(ch, cpd.fout);
+         out_fill(ch, 1);
          if (ch == '\t')
          {
-            cpd.column = next_tab_column(cpd.column);
+            cpd->column = next_tab_column(cpd->column);
          }
          else
          {
-            cpd.column++;
+            cpd->column++;
          }
       }
    }
-   last_char = ch;
+   cpd->last_char = ch;
+}
+
+
+/**
+ * Sends text to the output. The runs that need no translation are copied
+ * as a whole, the rest goes through add_char().
+ */
+static void add_text_len(const char *text, int len)
+{
+   int run;
+
+   while (len > 0)
+   {
+      run = 0;
+      if (cpd->last_char != '\r')
+      {
+         while ((run < len) && (text[run] != '\n') &&
+                (text[run] != '\r') && (text[run] != '\t'))
+         {
+            run++;
+         }
+      }
+      if (run > 0)
+      {
+         out_write(text, run);
+         cpd->column   += run;
+         cpd->last_char = text[run - 1];
+         text          += run;
+         len           -= run;
+      }
+      else
+      {
+         add_char(*text);
+         text++;
+         len--;
+      }
+   }
 }
 
 
 static void add_text(const char *text)
 {
-   char ch;
+   add_text_len(text, strlen(text));
+}
 
-   while ((ch = *text) != 0)
+
+/**
+ * Sends spaces to the output until it gets to column.
+ */
+static void add_spaces(int column)
+{
+   if ((cpd->column < column) && (cpd->last_char == '\r'))
    {
-      text++;
-      add_char(ch);
+      add_char(' ');
+   }
+   if (cpd->column < column)
+   {
+      out_fill(' ', column - cpd->column);
+      cpd->column    = column;
+      cpd->last_char = ' ';
    }
 }
 
 
-static void add_text_len(const char *text, int len)
+/**
+ * Sends tabs to the output until the next one would go past column.
+ */
+static void add_tabs(int column)
 {
-   while (len-- > 0)
+   int count = 0;
+   int col   = cpd->column;
+   int nc;
+
+   while ((nc = next_tab_column(col)) <= column)
    {
-      add_char(*text);
-      text++;
+      col = nc;
+      count++;
+   }
+   if ((count > 0) && ((cpd->last_char == ' ') || (cpd->last_char == '\r')))
+   {
+      /* add_char() turns the first tab into spaces */
+      add_char('\t');
+      add_tabs(column);
+   }
+   else if (count > 0)
+   {
+      out_fill('\t', count);
+      cpd->column    = col;
+      cpd->last_char = '\t';
    }
 }
 
@@ -132,34 +275,26 @@ static bool next_word_exceeds_limit(const char *text)
       text++;
       length++;
    }
-   return((cpd.column + length - 1) > cpd.settings[UO_cmt_width].n);
+   return((cpd->column + length - 1) > cpd->settings[UO_cmt_width].n);
 }
 
 
 /**
  * Advance to a specific column
- * cpd.column is the current column
+ * cpd->column is the current column
  *
  * @param column  The column to advance to
  */
 static void output_to_column(int column, bool allow_tabs)
 {
-   int nc;
-
-   cpd.did_newline = 0;
+   cpd->did_newline = 0;
    if (allow_tabs)
    {
       /* tab out as far as possible and then use spaces */
-      while ((nc = next_tab_column(cpd.column)) <= column)
-      {
-         add_text("\t");
-      }
+      add_tabs(column);
    }
    /* space out the final bit */
-   while (cpd.column < column)
-   {
-      add_text(" ");
-   }
+   add_spaces(column);
 }
 
 
@@ -171,26 +306,20 @@ static void output_to_column(int column, bool allow_tabs)
  */
 static void output_indent(int column, int brace_col)
 {
-   cpd.did_newline = 0;
-   if ((cpd.column == 1) && (cpd.settings[UO_indent_with_tabs].n != 0))
+   cpd->did_newline = 0;
+   if ((cpd->column == 1) && (cpd->settings[UO_indent_with_tabs].n != 0))
    {
-      if (cpd.settings[UO_indent_with_tabs].n == 2)
+      if (cpd->settings[UO_indent_with_tabs].n == 2)
       {
          brace_col = column;
       }
 
       /* tab out as far as possible and then use spaces */
-      while (next_tab_column(cpd.column) <= brace_col)
-      {
-         add_text("\t");
-      }
+      add_tabs(brace_col);
    }
 
    /* space out the rest */
-   while (cpd.column < column)
-   {
-      add_text(" ");
-   }
+   add_spaces(column);
 }
 
 
@@ -250,13 +379,13 @@ void output_options(FILE *pfile)
          {
             fprintf(pfile, "%3d) %32s = \"%s\"\n",
                     ptr->id, ptr->name,
-                    op_val_to_string(ptr->type, cpd.settings[ptr->id]).c_str());
+                    op_val_to_string(ptr->type, cpd->settings[ptr->id]).c_str());
          }
          else
          {
             fprintf(pfile, "%3d) %32s = %s\n",
                     ptr->id, ptr->name,
-                    op_val_to_string(ptr->type, cpd.settings[ptr->id]).c_str());
+                    op_val_to_string(ptr->type, cpd->settings[ptr->id]).c_str());
          }
       }
    }
@@ -269,41 +398,195 @@ void output_options(FILE *pfile)
  */
 void dump_text()
 {
-   output_text(stdout);
+   output_text();
+   fwrite(cpd->out.data, cpd->out.len, 1, stdout);
 }
 #endif
 
+
+/**
+ * Gets the character that ends an output line.
+ */
+static char out_newline_char(void)
+{
+   return(cpd->newline[strlen(cpd->newline) - 1]);
+}
+
+
 /**
- * This renders the chunk list to a file.
+ * Counts the input lines that a chunk covers past its first.
  */
-void output_text(FILE *pfile)
+static int chunk_extra_lines(chunk_t *pc)
+{
+   int count = 0;
+
+   for (int idx = 0; idx < pc->len; idx++)
+   {
+      if ((pc->str[idx] == '\n') ||
+          ((pc->str[idx] == '\r') &&
+           ((idx + 1 >= pc->len) || (pc->str[idx + 1] != '\n'))))
+      {
+         count++;
+      }
+   }
+   return(count);
+}
+
+
+/**
+ * Gets the output line that the text at 'pos' is on.
+ * The positions must be asked for in order.
+ */
+static int line_map_out_line(int pos)
+{
+   line_map_t *map  = cpd->line_map;
+   const char *data = cpd->out.data;
+   char       nl_ch = out_newline_char();
+
+   for ( ; map->scan < pos; map->scan++)
+   {
+      map->out_lines += (data[map->scan] == nl_ch);
+   }
+   return(map->out_lines + 1);
+}
+
+
+/**
+ * Notes where the chunks 'first' to 'last' came from and where their text,
+ * which starts at 'start_len' in the output, went.
+ */
+static void line_map_add(chunk_t *first, chunk_t *last, int start_len)
+{
+   int         end = cpd->out.len;
+   line_span_t span;
+
+   if ((end == start_len) || (first->orig_line == 0))
+   {
+      return;
+   }
+
+   span.out_first = line_map_out_line(start_len);
+
+   /* a newline at the end belongs to the last line of the text */
+   span.out_last = line_map_out_line(end - 1);
+
+   span.in_first = first->orig_line;
+   span.in_last  = last->orig_line + chunk_extra_lines(last);
+   if (span.in_last < span.in_first)
+   {
+      span.in_last = span.in_first;
+   }
+   cpd->line_map->spans.push_back(span);
+}
+
+
+/**
+ * A brace that was removed is still in the list as a vbrace, and an added
+ * one was a vbrace. Those have no column in the input.
+ */
+static bool line_map_brace_changed(chunk_t *pc)
+{
+   return((pc->orig_col > 0) != (pc->len > 0));
+}
+
+
+/**
+ * Notes the lines of a brace pair that had a brace added or removed, so
+ * that --lines doesn't put out one half of the pair without the other.
+ * Called for each chunk, after its text went to the output.
+ */
+static void line_map_brace(chunk_t *pc)
+{
+   line_map_t   *map = cpd->line_map;
+   line_brace_t br;
+   line_span_t  span;
+
+   if (chunk_is_opening_brace(pc))
+   {
+      br.pc       = pc;
+      br.out_line = line_map_out_line(cpd->out.len);
+      map->braces.push_back(br);
+   }
+   else if (chunk_is_closing_brace(pc))
+   {
+      /* Drop the unclosed braces, ie from an #if branch */
+      while (!map->braces.empty() && (map->braces.back().pc->level > pc->level))
+      {
+         map->braces.pop_back();
+      }
+      if (map->braces.empty() || (map->braces.back().pc->level != pc->level))
+      {
+         return;
+      }
+      br = map->braces.back();
+      map->braces.pop_back();
+
+      if ((br.pc->orig_line > 0) && (pc->orig_line > 0) &&
+          (line_map_brace_changed(br.pc) || line_map_brace_changed(pc)))
+      {
+         span.in_first  = br.pc->orig_line;
+         span.in_last   = pc->orig_line;
+         span.out_first = br.out_line;
+         span.out_last  = line_map_out_line(cpd->out.len);
+         if (span.in_last < span.in_first)
+         {
+            span.in_last = span.in_first;
+         }
+         map->spans.push_back(span);
+      }
+   }
+}
+
+
+/**
+ * This renders the chunk list to cpd->out.
+ */
+void output_text(void)
 {
    chunk_t *pc;
    chunk_t *prev;
    int     cnt;
    int     lvlcol;
    bool    allow_tabs;
+   chunk_t *first;
+   int     start_len;
 
-   cpd.fout = pfile;
+   cpd->out.len = 0;
+   out_reserve(0);
 
-   cpd.did_newline = 1;
-   cpd.column      = 1;
+   cpd->did_newline = 1;
+   cpd->column      = 1;
 
-   if (cpd.bom != NULL)
+   if (cpd->line_last > 0)
    {
-      add_text_len(cpd.bom->str, cpd.bom->len);
+      if (cpd->line_map == NULL)
+      {
+         cpd->line_map = new line_map_t;
+      }
+      cpd->line_map->spans.clear();
+      cpd->line_map->braces.clear();
+      cpd->line_map->out_lines = 0;
+      cpd->line_map->scan      = 0;
+   }
+
+   if (cpd->bom != NULL)
+   {
+      add_text_len(cpd->bom->str, cpd->bom->len);
    }
 
    for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next(pc))
    {
+      first     = pc;
+      start_len = cpd->out.len;
+
       if (pc->type == CT_NEWLINE)
       {
          for (cnt = 0; cnt < pc->nl_count; cnt++)
          {
             add_char('\n');
          }
-         cpd.did_newline = 1;
-         cpd.column      = 1;
+         cpd->did_newline = 1;
+         cpd->column      = 1;
          LOG_FMT(LOUTIND, " xx\n");
       }
       else if (pc->type == CT_NL_CONT)
@@ -311,9 +594,9 @@ void output_text(FILE *pfile)
          /* FIXME: this really shouldn't be done here! */
          if ((pc->flags & PCF_WAS_ALIGNED) == 0)
          {
-            if (cpd.settings[UO_sp_before_nl_cont].a & AV_REMOVE)
+            if (cpd->settings[UO_sp_before_nl_cont].a & AV_REMOVE)
             {
-               pc->column = cpd.column + (cpd.settings[UO_sp_before_nl_cont].a == AV_FORCE);
+               pc->column = cpd->column + (cpd->settings[UO_sp_before_nl_cont].a == AV_FORCE);
             }
             else
             {
@@ -322,25 +605,25 @@ void output_text(FILE *pfile)
                if ((prev != NULL) && (prev->nl_count == 0))
                {
                   int orig_sp = (pc->orig_col - prev->orig_col_end);
-                  pc->column = cpd.column + orig_sp;
-                  if ((cpd.settings[UO_sp_before_nl_cont].a != AV_IGNORE) &&
-                      (pc->column < (cpd.column + 1)))
+                  pc->column = cpd->column + orig_sp;
+                  if ((cpd->settings[UO_sp_before_nl_cont].a != AV_IGNORE) &&
+                      (pc->column < (cpd->column + 1)))
                   {
-                     pc->column = cpd.column + 1;
+                     pc->column = cpd->column + 1;
                   }
                }
             }
          }
-         output_to_column(pc->column, (cpd.settings[UO_indent_with_tabs].n == 2));
+         output_to_column(pc->column, (cpd->settings[UO_indent_with_tabs].n == 2));
          add_char('\\');
          add_char('\n');
-         cpd.did_newline = 1;
-         cpd.column      = 1;
+         cpd->did_newline = 1;
+         cpd->column      = 1;
          LOG_FMT(LOUTIND, " \\xx\n");
       }
       else if (pc->type == CT_COMMENT_MULTI)
       {
-         if (cpd.settings[UO_cmt_indent_multi].b)
+         if (cpd->settings[UO_cmt_indent_multi].b)
          {
             output_comment_multi(pc);
          }
@@ -370,9 +653,9 @@ void output_text(FILE *pfile)
       else
       {
          /* indent to the 'level' first */
-         if (cpd.did_newline)
+         if (cpd->did_newline)
          {
-            if (cpd.settings[UO_indent_with_tabs].n == 1)
+            if (cpd->settings[UO_indent_with_tabs].n == 1)
             {
                /* FIXME: it would be better to properly set column_indent in
                 * indent_text(), but this hack for '}' and ':' seems to work. */
@@ -396,11 +679,11 @@ void output_text(FILE *pfile)
                   output_to_column(lvlcol, true);
                }
             }
-            allow_tabs = (cpd.settings[UO_indent_with_tabs].n == 2) ||
+            allow_tabs = (cpd->settings[UO_indent_with_tabs].n == 2) ||
                          (chunk_is_comment(pc) &&
-                          (cpd.settings[UO_indent_with_tabs].n != 0));
+                          (cpd->settings[UO_indent_with_tabs].n != 0));
 
-            LOG_FMT(LOUTIND, "  %d> col %d/%d - ", pc->orig_line, pc->column, cpd.column);
+            LOG_FMT(LOUTIND, "  %d> col %d/%d - ", pc->orig_line, pc->column, cpd->column);
          }
          else
          {
@@ -410,22 +693,22 @@ void output_text(FILE *pfile)
              * This has to be done here because comments are not formatted
              * until the output phase.
              */
-            if (pc->column < cpd.column)
+            if (pc->column < cpd->column)
             {
-               reindent_line(pc, cpd.column);
+               reindent_line(pc, cpd->column);
             }
 
             /* not the first item on a line */
-            if (cpd.settings[UO_align_keep_tabs].b)
+            if (cpd->settings[UO_align_keep_tabs].b)
             {
                allow_tabs = pc->after_tab;
             }
             else
             {
                prev       = chunk_get_prev(pc);
-               allow_tabs = (cpd.settings[UO_align_with_tabs].b &&
+               allow_tabs = (cpd->settings[UO_align_with_tabs].b &&
                              ((pc->flags & PCF_WAS_ALIGNED) != 0) &&
-                             (((pc->column - 1) % cpd.settings[UO_output_tab_size].n) == 0) &&
+                             (((pc->column - 1) % cpd->settings[UO_output_tab_size].n) == 0) &&
                              ((prev->column + prev->len + 1) != pc->column));
             }
             LOG_FMT(LOUTIND, " %d -", pc->column);
@@ -433,12 +716,204 @@ void output_text(FILE *pfile)
 
          output_to_column(pc->column, allow_tabs);
          add_text_len(pc->str, pc->len);
-         cpd.did_newline = chunk_is_newline(pc);
+         cpd->did_newline = chunk_is_newline(pc);
+      }
+
+      if ((cpd->line_last > 0) && (first->type != CT_NEWLINE))
+      {
+         line_map_add(first, pc, start_len);
+         line_map_brace(pc);
       }
    }
 }
 
 
+/**
+ * Finds where a line starts in the text, ending lines the same way as the
+ * tokenizer. Gives 'len' if the text doesn't have that many lines.
+ */
+static int line_offset(const char *text, int len, int line)
+{
+   int idx = 0;
+
+   while ((line > 1) && (idx < len))
+   {
+      if ((text[idx] == '\n') ||
+          ((text[idx] == '\r') && ((idx + 1 >= len) || (text[idx + 1] != '\n'))))
+      {
+         line--;
+      }
+      idx++;
+   }
+   return(idx);
+}
+
+
+/**
+ * For --lines: notes the input lines of a brace or paren pair that is
+ * deleted, so that both lines are formatted or neither is.
+ * Called before the chunks are deleted.
+ */
+void output_lines_tie(chunk_t *open, chunk_t *close)
+{
+   line_span_t span;
+
+   if ((cpd->line_last <= 0) || (open->orig_line == 0) || (close->orig_line == 0))
+   {
+      return;
+   }
+   if (cpd->line_map == NULL)
+   {
+      cpd->line_map = new line_map_t;
+   }
+   span.in_first  = open->orig_line;
+   span.in_last   = close->orig_line;
+   span.out_first = 0;
+   span.out_last  = 0;
+   cpd->line_map->ties.push_back(span);
+}
+
+
+/**
+ * Puts the input back around the lines that --lines asked for.
+ * The whole file was formatted, so that the levels and types are right, but
+ * only the chunks on those lines keep their new text.
+ *
+ * The lines are widened until no chunk comes from or goes to both the
+ * lines and the rest of the file, so that a chunk that moved to another
+ * line isn't lost or output twice. They are also widened over both halves
+ * of a brace pair that had a brace added or removed.
+ * With --lines-patch, only the new text goes out, after a "first:last" line
+ * that says which input lines it replaces.
+ */
+void output_lines(const char *data, int data_len)
+{
+   line_map_t  *map      = cpd->line_map;
+   int         in_first  = INT_MAX;
+   int         in_last   = 0;
+   int         out_first = 1;
+   int         out_last  = 0;
+   int         in_start, in_end, out_start, out_end;
+   bool        grew;
+   std::string text;
+   size_t      idx;
+
+   for (idx = 0; (map != NULL) && (idx < map->spans.size()); idx++)
+   {
+      const line_span_t& span = map->spans[idx];
+
+      if ((span.in_last >= cpd->line_first) && (span.in_first <= cpd->line_last))
+      {
+         in_first = (span.in_first < in_first) ? span.in_first : in_first;
+         in_last  = (span.in_last > in_last) ? span.in_last : in_last;
+      }
+   }
+
+   if (in_last == 0)
+   {
+      /* The lines are blank, nothing to replace */
+      in_first = cpd->line_first;
+      in_last  = in_first - 1;
+   }
+   else
+   {
+      do
+      {
+         grew      = false;
+         out_first = INT_MAX;
+         out_last  = 0;
+         for (idx = 0; idx < map->spans.size(); idx++)
+         {
+            const line_span_t& span = map->spans[idx];
+
+            if ((span.in_last >= in_first) && (span.in_first <= in_last))
+            {
+               out_first = (span.out_first < out_first) ? span.out_first : out_first;
+               out_last  = (span.out_last > out_last) ? span.out_last : out_last;
+            }
+         }
+         for (idx = 0; idx < map->spans.size(); idx++)
+         {
+            const line_span_t& span = map->spans[idx];
+
+            if ((span.out_last >= out_first) && (span.out_first <= out_last))
+            {
+               if (span.in_first < in_first)
+               {
+                  in_first = span.in_first;
+                  grew     = true;
+               }
+               if (span.in_last > in_last)
+               {
+                  in_last = span.in_last;
+                  grew    = true;
+               }
+            }
+         }
+         for (idx = 0; idx < map->ties.size(); idx++)
+         {
+            const line_span_t& tie = map->ties[idx];
+
+            if (((tie.in_first >= in_first) && (tie.in_first <= in_last)) ||
+                ((tie.in_last >= in_first) && (tie.in_last <= in_last)))
+            {
+               if (tie.in_first < in_first)
+               {
+                  in_first = tie.in_first;
+                  grew     = true;
+               }
+               if (tie.in_last > in_last)
+               {
+                  in_last = tie.in_last;
+                  grew    = true;
+               }
+            }
+         }
+      } while (grew);
+   }
+
+   LOG_FMT(LOUTIND, "%s: input lines %d-%d => output lines %d-%d\n",
+           __func__, in_first, in_last, out_first, out_last);
+
+   in_start  = line_offset(data, data_len, in_first);
+   in_end    = line_offset(data, data_len, in_last + 1);
+   out_start = line_offset(cpd->out.data, cpd->out.len, out_first);
+   out_end   = line_offset(cpd->out.data, cpd->out.len, out_last + 1);
+
+   if (cpd->line_patch)
+   {
+      char buf[32];
+
+      snprintf(buf, sizeof(buf), "%d:%d\n", in_first, in_last);
+      text += buf;
+   }
+   else
+   {
+      text.append(data, in_start);
+   }
+   text.append(cpd->out.data + out_start, out_end - out_start);
+   if ((out_end > out_start) && (in_end < data_len) &&
+       (cpd->out.data[out_end - 1] != out_newline_char()))
+   {
+      text += cpd->newline;
+   }
+   if (!cpd->line_patch)
+   {
+      text.append(data + in_end, data_len - in_end);
+   }
+
+   cpd->out.len = 0;
+   out_write(text.data(), (int)text.size());
+}
+
+
+void output_lines_free(void)
+{
+   delete cpd->line_map;
+   cpd->line_map = NULL;
+}
+
+
 /**
  * Given a multi-line comment block that starts in column X, figure out how
  * much subsequent lines should be indented.
@@ -470,12 +945,12 @@ static int calculate_comment_body_indent(const char *str, int len, int start_col
    int last_len  = 0;
    int width     = 0;
 
-   if (!cpd.settings[UO_cmt_indent_multi].b)
+   if (!cpd->settings[UO_cmt_indent_multi].b)
    {
       return(0);
    }
 
-   if (cpd.settings[UO_cmt_multi_check_last].b)
+   if (cpd->settings[UO_cmt_multi_check_last].b)
    {
       /* find the last line length */
       for (idx = len - 1; idx > 0; idx--)
@@ -684,7 +1159,7 @@ static int add_comment_kw(const char *text, int len, cmt_reflow& cmt)
 {
    if ((len >= 11) && (memcmp(text, "$(filename)", 11) == 0))
    {
-      add_text(path_basename(cpd.filename));
+      add_text(path_basename(cpd->filename));
       return(11);
    }
    if ((len >= 8) && (memcmp(text, "$(class)", 8) == 0))
@@ -779,8 +1254,8 @@ static void add_comment_text(const char *text, int len,
       }
       else if (cmt.reflow &&
                (text[idx] == ' ') &&
-               (cpd.settings[UO_cmt_width].n > 0) &&
-               ((cpd.column > cpd.settings[UO_cmt_width].n) ||
+               (cpd->settings[UO_cmt_width].n > 0) &&
+               ((cpd->column > cpd->settings[UO_cmt_width].n) ||
                 next_word_exceeds_limit(text + idx)))
       {
          in_word = false;
@@ -821,7 +1296,7 @@ static void output_cmt_start(cmt_reflow& cmt, chunk_t *pc)
    if ((pc->parent_type == CT_COMMENT_START) ||
        (pc->parent_type == CT_COMMENT_WHOLE))
    {
-      if (!cpd.settings[UO_indent_col1_comment].b &&
+      if (!cpd->settings[UO_indent_col1_comment].b &&
           (pc->orig_col == 1))
       {
          cmt.column    = 1;
@@ -893,14 +1368,14 @@ static chunk_t *output_comment_c(chunk_t *first)
 {
    cmt_reflow cmt;
 
-   cmt.reflow = (cpd.settings[UO_cmt_reflow_mode].n != 1);
+   cmt.reflow = (cpd->settings[UO_cmt_reflow_mode].n != 1);
 
    output_cmt_start(cmt, first);
 
-   cmt.cont_text = cpd.settings[UO_cmt_star_cont].b ? " *" : "  ";
+   cmt.cont_text = cpd->settings[UO_cmt_star_cont].b ? " *" : "  ";
 
    /* See if we can combine this comment with the next comment */
-   if (!cpd.settings[UO_cmt_c_group].b ||
+   if (!cpd->settings[UO_cmt_c_group].b ||
        !can_combine_comment(first, cmt))
    {
       /* Just add the single comment */
@@ -909,7 +1384,7 @@ static chunk_t *output_comment_c(chunk_t *first)
    }
 
    add_text_len("/*", 2);
-   if (cpd.settings[UO_cmt_c_nl_start].b)
+   if (cpd->settings[UO_cmt_c_nl_start].b)
    {
       add_comment_text("\n", 1, cmt, false);
    }
@@ -921,7 +1396,7 @@ static chunk_t *output_comment_c(chunk_t *first)
       pc = chunk_get_next(chunk_get_next(pc));
    }
    add_comment_text(pc->str + 2, pc->len - 4, cmt, false);
-   if (cpd.settings[UO_cmt_c_nl_end].b)
+   if (cpd->settings[UO_cmt_c_nl_end].b)
    {
       cmt.cont_text = " ";
       add_comment_text("\n", 1, cmt, false);
@@ -941,16 +1416,16 @@ static chunk_t *output_comment_cpp(chunk_t *first)
 {
    cmt_reflow cmt;
 
-   cmt.reflow = (cpd.settings[UO_cmt_reflow_mode].n != 1);
+   cmt.reflow = (cpd->settings[UO_cmt_reflow_mode].n != 1);
 
    output_cmt_start(cmt, first);
 
    /* CPP comments can't be grouped unless they are converted to C comments */
-   if (!cpd.settings[UO_cmt_cpp_to_c].b)
+   if (!cpd->settings[UO_cmt_cpp_to_c].b)
    {
-      cmt.cont_text = (cpd.settings[UO_sp_cmt_cpp_start].a & AV_REMOVE) ? "//" : "// ";
+      cmt.cont_text = (cpd->settings[UO_sp_cmt_cpp_start].a & AV_REMOVE) ? "//" : "// ";
 
-      if (cpd.settings[UO_sp_cmt_cpp_start].a == AV_IGNORE)
+      if (cpd->settings[UO_sp_cmt_cpp_start].a == AV_IGNORE)
       {
          add_comment_text(first->str, first->len, cmt, false);
       }
@@ -961,7 +1436,7 @@ static chunk_t *output_comment_cpp(chunk_t *first)
          const char *tmp = first->str + 2;
          int        len  = first->len - 2;
 
-         if (cpd.settings[UO_sp_cmt_cpp_start].a & AV_REMOVE)
+         if (cpd->settings[UO_sp_cmt_cpp_start].a & AV_REMOVE)
          {
             while ((len > 0) && unc_isspace(*tmp))
             {
@@ -971,7 +1446,7 @@ static chunk_t *output_comment_cpp(chunk_t *first)
          }
          if (len > 0)
          {
-            if (cpd.settings[UO_sp_cmt_cpp_start].a & AV_ADD)
+            if (cpd->settings[UO_sp_cmt_cpp_start].a & AV_ADD)
             {
                if (!unc_isspace(*tmp))
                {
@@ -986,10 +1461,10 @@ static chunk_t *output_comment_cpp(chunk_t *first)
    }
 
    /* We are going to convert the CPP comments to C comments */
-   cmt.cont_text = cpd.settings[UO_cmt_star_cont].b ? " * " : "   ";
+   cmt.cont_text = cpd->settings[UO_cmt_star_cont].b ? " * " : "   ";
 
    /* See if we can combine this comment with the next comment */
-   if (!cpd.settings[UO_cmt_cpp_group].b ||
+   if (!cpd->settings[UO_cmt_cpp_group].b ||
        !can_combine_comment(first, cmt))
    {
       /* nothing to group: just output a single line */
@@ -1004,7 +1479,7 @@ static chunk_t *output_comment_cpp(chunk_t *first)
    }
 
    add_text_len("/*", 2);
-   if (cpd.settings[UO_cmt_cpp_nl_start].b)
+   if (cpd->settings[UO_cmt_cpp_nl_start].b)
    {
       add_comment_text("\n", 1, cmt, false);
    }
@@ -1024,7 +1499,7 @@ static chunk_t *output_comment_cpp(chunk_t *first)
    }
    offs = unc_isspace(pc->str[2]) ? 1 : 0;
    add_comment_text(pc->str + 2 + offs, pc->len - (2 + offs), cmt, true);
-   if (cpd.settings[UO_cmt_cpp_nl_end].b)
+   if (cpd->settings[UO_cmt_cpp_nl_end].b)
    {
       cmt.cont_text = "";
       add_comment_text("\n", 1, cmt, false);
@@ -1057,11 +1532,11 @@ static void output_comment_multi(chunk_t *pc)
 
    cmt_reflow cmt;
 
-   cmt.reflow = (cpd.settings[UO_cmt_reflow_mode].n != 1);
+   cmt.reflow = (cpd->settings[UO_cmt_reflow_mode].n != 1);
 
    output_cmt_start(cmt, pc);
-   cmt.cont_text = !cpd.settings[UO_cmt_indent_multi].b ? "" :
-                   cpd.settings[UO_cmt_star_cont].b ? " * " : "   ";
+   cmt.cont_text = !cpd->settings[UO_cmt_indent_multi].b ? "" :
+                   cpd->settings[UO_cmt_star_cont].b ? " * " : "   ";
 
    prev = chunk_get_prev(pc);
    if ((prev != NULL) && (prev->type != CT_NEWLINE))
@@ -1113,7 +1588,7 @@ static void output_comment_multi(chunk_t *pc)
          }
          else if (ch == '\t')
          {
-            ccol = calc_next_tab_column(ccol, cpd.settings[UO_input_tab_size].n);
+            ccol = calc_next_tab_column(ccol, cpd->settings[UO_input_tab_size].n);
             continue;
          }
          else
@@ -1125,7 +1600,7 @@ static void output_comment_multi(chunk_t *pc)
       /*
        * Now see if we need/must fold the next line with the current to enable full reflow
        */
-      if ((cpd.settings[UO_cmt_reflow_mode].n == 2) &&
+      if ((cpd->settings[UO_cmt_reflow_mode].n == 2) &&
           (ch == '\n') &&
           (remaining > 0))
       {
@@ -1292,9 +1767,9 @@ static void output_comment_multi(chunk_t *pc)
             if (line_len == 0)
             {
                /* Empty line - just a '\n' */
-               if (cpd.settings[UO_cmt_star_cont].b)
+               if (cpd->settings[UO_cmt_star_cont].b)
                {
-                  output_indent(cmt_col + xtra + cpd.settings[UO_cmt_sp_before_star_cont].n,
+                  output_indent(cmt_col + xtra + cpd->settings[UO_cmt_sp_before_star_cont].n,
                                 cmt_col);
                   add_char('*');
                }
@@ -1305,17 +1780,17 @@ static void output_comment_multi(chunk_t *pc)
                /* If this doesn't start with a '*' or '|'.
                 * '\name' is a common parameter documentation thing.
                 */
-               if (cpd.settings[UO_cmt_indent_multi].b &&
+               if (cpd->settings[UO_cmt_indent_multi].b &&
                    (line[0] != '*') && (line[0] != '|') && (line[0] != '#') &&
                    ((line[0] != '\\') || unc_isalpha(line[1])) && (line[0] != '+'))
                {
-                  int start_col = cmt_col + xtra + cpd.settings[UO_cmt_sp_before_star_cont].n;
+                  int start_col = cmt_col + xtra + cpd->settings[UO_cmt_sp_before_star_cont].n;
 
-                  if (cpd.settings[UO_cmt_star_cont].b)
+                  if (cpd->settings[UO_cmt_star_cont].b)
                   {
                      output_indent(start_col, cmt_col);
                      add_text("* ");
-                     output_to_column(ccol + cpd.settings[UO_cmt_sp_after_star_cont].n,
+                     output_to_column(ccol + cpd->settings[UO_cmt_sp_after_star_cont].n,
                                       false);
                   }
                   else
@@ -1325,7 +1800,7 @@ static void output_comment_multi(chunk_t *pc)
                }
                else
                {
-                  output_indent(cmt_col + xtra + cpd.settings[UO_cmt_sp_before_star_cont].n,
+                  output_indent(cmt_col + xtra + cpd->settings[UO_cmt_sp_before_star_cont].n,
                                 cmt_col);
 
                   int idx  = 0;
@@ -1339,7 +1814,7 @@ static void output_comment_multi(chunk_t *pc)
                   {
                      lead[idx++] = line[sidx++];
                   }
-                  for (sidx = 0; sidx < cpd.settings[UO_cmt_sp_after_star_cont].n; sidx++)
+                  for (sidx = 0; sidx < cpd->settings[UO_cmt_sp_after_star_cont].n; sidx++)
                   {
                      lead[idx++] = ' ';
                   }
@@ -1428,7 +1903,7 @@ static void output_comment_multi_simple(chunk_t *pc)
          }
          else if (ch == '\t')
          {
-            ccol = calc_next_tab_column(ccol, cpd.settings[UO_input_tab_size].n);
+            ccol = calc_next_tab_column(ccol, cpd->settings[UO_input_tab_size].n);
             continue;
          }
          else
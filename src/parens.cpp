@@ -24,7 +24,7 @@ void do_parens(void)
    chunk_t *pc;
    chunk_t *pclose;
 
-   if (cpd.settings[UO_mod_full_paren_if_bool].b)
+   if (cpd->settings[UO_mod_full_paren_if_bool].b)
    {
       pc = chunk_get_head();
       while ((pc = chunk_get_next_ncnl(pc)) != NULL)
@@ -38,12 +38,12 @@ static void pf_log_frms(int logsev, const char *txt, struct parse_frame *pf)
 {
    int idx;
 
-   LOG_FMT(logsev, "%s Parse Frames(%d):", txt, cpd.frame_count);
-   for (idx = 0; idx < cpd.frame_count; idx++)
+   LOG_FMT(logsev, "%s Parse Frames(%d):", txt, (int)cpd->frames.size());
+   for (idx = 0; idx < (int)cpd->frames.size(); idx++)
    {
       LOG_FMT(logsev, " [%s-%d]",
-              get_token_name(cpd.frames[idx].in_ifdef),
-              cpd.frames[idx].ref_no);
+              get_token_name(cpd->frames[idx].in_ifdef),
+              cpd->frames[idx].ref_no);
    }
    LOG_FMT(logsev, "-[%s-%d]\n", get_token_name(pf->in_ifdef), pf->ref_no);
 }
@@ -56,13 +56,13 @@ void pf_log_all(int logsev)
 {
    int idx;
 
-   LOG_FMT(logsev, "##=- Parse Frame : %d entries\n", cpd.frame_count);
+   LOG_FMT(logsev, "##=- Parse Frame : %d entries\n", (int)cpd->frames.size());
 
-   for (idx = 0; idx < cpd.frame_count; idx++)
+   for (idx = 0; idx < (int)cpd->frames.size(); idx++)
    {
       LOG_FMT(logsev, "##  <%d> ", idx);
 
-      pf_log(logsev, &cpd.frames[idx]);
+      pf_log(logsev, &cpd->frames[idx]);
    }
    LOG_FMT(logsev, "##=-\n");
 }
@@ -70,10 +70,11 @@ void pf_log_all(int logsev)
 
 /**
  * Copies src to dst.
+ * The paren stack isn't copied, the two share it until one changes it.
  */
 void pf_copy(struct parse_frame *dst, const struct parse_frame *src)
 {
-   memcpy(dst, src, sizeof(struct parse_frame));
+   *dst = *src;
 }
 
 
@@ -83,15 +84,9 @@ void pf_copy(struct parse_frame *dst, const struct parse_frame *src)
  */
 void pf_push(struct parse_frame *pf)
 {
-   static int ref_no = 1;
-
-   if (cpd.frame_count < (int)ARRAY_SIZE(cpd.frames))
-   {
-      pf_copy(&cpd.frames[cpd.frame_count], pf);
-      cpd.frame_count++;
-      pf->ref_no = ref_no++;
-   }
-   LOG_FMT(LPF, "%s: count = %d\n", __func__, cpd.frame_count);
+   cpd->frames.push_back(*pf);
+   pf->ref_no = ++cpd->pf_ref_no;
+   LOG_FMT(LPF, "%s: count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -102,22 +97,14 @@ void pf_push(struct parse_frame *pf)
  */
 void pf_push_under(struct parse_frame *pf)
 {
-   struct parse_frame *npf1;
-   struct parse_frame *npf2;
-
-   LOG_FMT(LPF, "%s: before count = %d\n", __func__, cpd.frame_count);
+   LOG_FMT(LPF, "%s: before count = %d\n", __func__, (int)cpd->frames.size());
 
-   if ((cpd.frame_count < (int)ARRAY_SIZE(cpd.frames)) &&
-       (cpd.frame_count >= 1))
+   if (!cpd->frames.empty())
    {
-      npf1 = &cpd.frames[cpd.frame_count - 1];
-      npf2 = &cpd.frames[cpd.frame_count];
-      pf_copy(npf2, npf1);
-      pf_copy(npf1, pf);
-      cpd.frame_count++;
+      cpd->frames.insert(cpd->frames.end() - 1, *pf);
    }
 
-   LOG_FMT(LPF, "%s: after count = %d\n", __func__, cpd.frame_count);
+   LOG_FMT(LPF, "%s: after count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -127,11 +114,11 @@ void pf_push_under(struct parse_frame *pf)
  */
 void pf_copy_tos(struct parse_frame *pf)
 {
-   if (cpd.frame_count > 0)
+   if (!cpd->frames.empty())
    {
-      pf_copy(pf, &cpd.frames[cpd.frame_count - 1]);
+      pf_copy(pf, &cpd->frames.back());
    }
-   LOG_FMT(LPF, "%s: count = %d\n", __func__, cpd.frame_count);
+   LOG_FMT(LPF, "%s: count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -143,11 +130,11 @@ void pf_copy_tos(struct parse_frame *pf)
  */
 static void pf_copy_2nd_tos(struct parse_frame *pf)
 {
-   if (cpd.frame_count > 1)
+   if (cpd->frames.size() > 1)
    {
-      pf_copy(pf, &cpd.frames[cpd.frame_count - 2]);
+      pf_copy(pf, &cpd->frames[cpd->frames.size() - 2]);
    }
-   LOG_FMT(LPF, "%s: count = %d\n", __func__, cpd.frame_count);
+   LOG_FMT(LPF, "%s: count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -156,11 +143,11 @@ static void pf_copy_2nd_tos(struct parse_frame *pf)
  */
 void pf_trash_tos(void)
 {
-   if (cpd.frame_count > 0)
+   if (!cpd->frames.empty())
    {
-      cpd.frame_count--;
+      cpd->frames.pop_back();
    }
-   LOG_FMT(LPF, "%s: count = %d\n", __func__, cpd.frame_count);
+   LOG_FMT(LPF, "%s: count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -170,12 +157,12 @@ void pf_trash_tos(void)
  */
 void pf_pop(struct parse_frame *pf)
 {
-   if (cpd.frame_count > 0)
+   if (!cpd->frames.empty())
    {
       pf_copy_tos(pf);
       pf_trash_tos();
    }
-   //fprintf(stderr, "%s: count = %d\n", __func__, cpd.frame_count);
+   //fprintf(stderr, "%s: count = %d\n", __func__, (int)cpd->frames.size());
 }
 
 
@@ -185,8 +172,8 @@ void pf_pop(struct parse_frame *pf)
 int pf_check(struct parse_frame *frm, chunk_t *pc)
 {
    int        in_ifdef = frm->in_ifdef;
-   int        b4_cnt   = cpd.frame_count;
-   int        pp_level = cpd.pp_level;
+   int        b4_cnt   = cpd->frames.size();
+   int        pp_level = cpd->pp_level;
    const char *txt     = NULL;
 
    if (pc->type != CT_PREPROC)
@@ -206,7 +193,7 @@ int pf_check(struct parse_frame *frm, chunk_t *pc)
       if (pc->parent_type == CT_PP_IF)
       {
          /* An #if pushes a copy of the current frame on the stack */
-         cpd.pp_level++;
+         cpd->pp_level++;
          pf_push(frm);
          frm->in_ifdef = CT_PP_IF;
          txt           = "if-push";
@@ -239,7 +226,7 @@ int pf_check(struct parse_frame *frm, chunk_t *pc)
           * we may have [...] [base] [if]-[else] or [...] [base]-[if].
           * Throw out the [else].
           */
-         cpd.pp_level--;
+         cpd->pp_level--;
          pp_level--;
 
          if (frm->in_ifdef == CT_PP_ELSE)
@@ -249,7 +236,8 @@ int pf_check(struct parse_frame *frm, chunk_t *pc)
              * We want: [...]-[if]
              */
             pf_copy_tos(frm);     /* [...] [base] [if]-[if] */
-            frm->in_ifdef = cpd.frames[cpd.frame_count - 2].in_ifdef;
+            frm->in_ifdef = (cpd->frames.size() > 1) ?
+                            cpd->frames[cpd->frames.size() - 2].in_ifdef : CT_NONE;
             pf_trash_tos();       /* [...] [base]-[if] */
             pf_trash_tos();       /* [...]-[if] */
 
@@ -275,7 +263,7 @@ int pf_check(struct parse_frame *frm, chunk_t *pc)
    {
       LOG_FMT(LPF, "%s: %d> %s: %s in_ifdef=%d/%d counts=%d/%d\n", __func__,
               pc->orig_line, get_token_name(pc->parent_type), txt,
-              in_ifdef, frm->in_ifdef, b4_cnt, cpd.frame_count);
+              in_ifdef, frm->in_ifdef, b4_cnt, (int)cpd->frames.size());
       pf_log_all(LPF);
       LOG_FMT(LPF, " <Out>");
       pf_log(LPF, frm);
@@ -12,8 +12,10 @@
 
 #include <string>
 
+class ChunkStack;
+
 /*
- *  uncrustify.cpp
+ *  format.cpp
  */
 
 const char *get_token_name(c_token_t token);
@@ -22,6 +24,22 @@ void log_pcf_flags(log_sev_t sev, UINT32 flags);
 const char *path_basename(const char *path);
 int path_dirname_len(const char *filename);
 const char *get_file_extension(int& idx);
+int language_from_tag(const char *tag);
+int language_from_filename(const char *filename);
+const char *language_to_string(int lang);
+bool map_mem_file(int fd, file_mem& fm);
+int load_mem_file(const char *filename, file_mem& fm);
+void free_file_mem(file_mem& fm);
+int load_header_files();
+void uncrustify_start(const char *data, int data_len);
+void uncrustify_file(const char *data, int data_len, FILE *pfout,
+                     const char *parsed_file);
+const char *uncrustify_file_mem(const char *data, int data_len, int& out_len,
+                                const char *parsed_file = NULL);
+void uncrustify_end();
+struct cp_data *context_select(struct cp_data *ctx);
+struct cp_data *context_create(void);
+void context_destroy(struct cp_data *ctx);
 
 
 /*
@@ -35,7 +53,10 @@ void detect_options(const char *data, int data_len);
  *  output.cpp
  */
 
-void output_text(FILE *pfile);
+void output_text(void);
+void output_lines(const char *data, int data_len);
+void output_lines_tie(chunk_t *open, chunk_t *close);
+void output_lines_free(void);
 void output_parsed(FILE *pfile);
 void output_options(FILE *pfile);
 void dump_parsed();
@@ -104,6 +125,8 @@ bool oc_msg_line_has_colon(chunk_t *pc, bool *prev_result, int level);
 bool oc_msg_whole_line_is_string_literal(chunk_t *pc, int level = -1, bool skip = true);
 bool next_line_has_oc_msg_colon(chunk_t *pc, int level = -1);
 bool prev_line_has_oc_msg_colon(chunk_t *pc, int level = -1);
+void oc_msg_lines_reset(void);
+bool oc_msg_line_near_colon(chunk_t *pc, int level);
 
 /*
  *  braces.cpp
@@ -135,6 +158,9 @@ void do_parens(void);
 void space_text(void);
 void space_text_balance_nested_parens(void);
 int space_col_align(chunk_t *first, chunk_t *second);
+void space_table_check(void);
+void space_table_free(void);
+void space_table_verify(bool verify);
 
 void space_add_after(chunk_t *pc, int count);
 
@@ -162,11 +188,11 @@ void remove_extra_returns();
  */
 
 void newlines_cleanup_braces(void);
-void newlines_insert_blank_lines(void);
-void newlines_squeeze_ifdef(void);
+void newlines_insert_blank_lines(ChunkStack& later);
+void newlines_squeeze_ifdef(const ChunkStack& later);
 void newlines_eat_start_end(void);
-void newlines_chunk_pos(c_token_t chunk_type, tokenpos_e mode);
-void newlines_class_colon_pos(void);
+void newlines_chunk_pos(const ChunkStack& later, c_token_t chunk_type, tokenpos_e mode);
+void newlines_class_colon_pos(const ChunkStack& later);
 void newlines_cleanup_dup(void);
 void newline_after_multiline_comment(void);
 void do_blank_lines(void);
@@ -315,7 +341,7 @@ int calc_next_tab_column(int col, int tabsize)
 static_inline
 int next_tab_column(int col)
 {
-   return(calc_next_tab_column(col, cpd.settings[UO_output_tab_size].n));
+   return(calc_next_tab_column(col, cpd->settings[UO_output_tab_size].n));
 }
 
 
@@ -328,9 +354,9 @@ int next_tab_column(int col)
 static_inline
 int align_tab_column(int col)
 {
-   if ((col % cpd.settings[UO_output_tab_size].n) != 1)
+   if ((col % cpd->settings[UO_output_tab_size].n) != 1)
    {
-      calc_next_tab_column(col, cpd.settings[UO_output_tab_size].n);
+      calc_next_tab_column(col, cpd->settings[UO_output_tab_size].n);
    }
    return(col);
 }
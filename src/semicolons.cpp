@@ -77,7 +77,7 @@ void remove_extra_semicolons(void)
          {
             remove_semicolon(pc);
          }
-         else if ((cpd.lang_flags & LANG_D) &&
+         else if ((cpd->lang_flags & LANG_D) &&
                   ((prev->parent_type == CT_ENUM) ||
                    (prev->parent_type == CT_UNION) ||
                    (prev->parent_type == CT_STRUCT)))
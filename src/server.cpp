@@ -0,0 +1,717 @@
+/**
+ * @file server.cpp
+ * The formatting server and client. See server.h.
+ *
+ * Each message is a list of fields. A field is a 4 byte length in network
+ * byte order followed by that many bytes.
+ *
+ * A request has these fields:
+ *  - SERVER_MAGIC
+ *  - the config file
+ *  - the extras, see client_setup
+ *  - the log mask
+ *  - the LANG_xxx flags, as a decimal number
+ *  - the file name
+ *  - the text to format
+ *
+ * The reply has these fields:
+ *  - the status, as a decimal number: the number of errors logged or -1 if
+ *    the config couldn't be loaded
+ *  - the log text
+ *  - the formatted text
+ *
+ * A client may send any number of requests on one connection.
+ * A field may not be longer than SERVER_FIELD_MAX.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "server.h"
+#include "uncrustify_types.h"
+#include "prototypes.h"
+#include "logger.h"
+#include "log_levels.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <map>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#define SERVER_MAGIC        "uncrustify-1"
+
+/* The number of fields in a request */
+#define SERVER_FIELDS       7
+
+/* So that a bad length can't make either side allocate all the memory */
+#define SERVER_FIELD_MAX    (64 * 1024 * 1024)
+
+
+bool write_all(int fd, const void *data, int len)
+{
+   const char *ptr = (const char *)data;
+
+   while (len > 0)
+   {
+      int cnt = write(fd, ptr, len);
+      if (cnt < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         return(false);
+      }
+      ptr += cnt;
+      len -= cnt;
+   }
+   return(true);
+}
+
+
+bool read_all(int fd, void *data, int len)
+{
+   char *ptr = (char *)data;
+
+   while (len > 0)
+   {
+      int cnt = read(fd, ptr, len);
+      if (cnt < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         return(false);
+      }
+      if (cnt == 0)
+      {
+         return(false);
+      }
+      ptr += cnt;
+      len -= cnt;
+   }
+   return(true);
+}
+
+
+static bool send_field(int fd, const char *data, int len)
+{
+   UINT32 hdr = htonl(len);
+
+   return(write_all(fd, &hdr, sizeof(hdr)) && write_all(fd, data, len));
+}
+
+
+static bool send_field(int fd, const std::string& str)
+{
+   return(send_field(fd, str.data(), str.size()));
+}
+
+
+static bool recv_field(int fd, std::string& str)
+{
+   UINT32 hdr;
+
+   if (!read_all(fd, &hdr, sizeof(hdr)) || (ntohl(hdr) > SERVER_FIELD_MAX))
+   {
+      return(false);
+   }
+   str.resize(ntohl(hdr));
+   return(str.empty() || read_all(fd, &str[0], str.size()));
+}
+
+
+static void sockaddr_set(struct sockaddr_un& addr, const char *sock_path)
+{
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, sock_path, sizeof(addr.sun_path) - 1);
+}
+
+
+static int sock_connect(const char *sock_path)
+{
+   struct sockaddr_un addr;
+   int                fd;
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0)
+   {
+      return(-1);
+   }
+   sockaddr_set(addr, sock_path);
+   if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+   {
+      int err = errno;
+      close(fd);
+      errno = err;
+      return(-1);
+   }
+   return(fd);
+}
+
+
+/*
+ *  The server
+ */
+
+/**
+ * A loaded config and the files it came from
+ */
+struct server_config
+{
+   struct cp_data           *ctx;
+   std::vector<std::string> files;
+   std::vector<time_t>      mtimes;
+};
+
+typedef std::map<std::string, server_config>   config_map;
+
+
+static time_t file_mtime(const char *filename)
+{
+   struct stat my_stat;
+
+   return((stat(filename, &my_stat) == 0) ? my_stat.st_mtime : 0);
+}
+
+
+static bool config_is_current(const server_config& sc)
+{
+   for (int idx = 0; idx < (int)sc.files.size(); idx++)
+   {
+      if (file_mtime(sc.files[idx].c_str()) != sc.mtimes[idx])
+      {
+         return(false);
+      }
+   }
+   return(true);
+}
+
+
+static void config_add_file(server_config& sc, const char *filename)
+{
+   sc.files.push_back(filename);
+   sc.mtimes.push_back(file_mtime(filename));
+}
+
+
+/**
+ * Loads a config in the same order as main() does: type files, types,
+ * define files, defines and then the config file.
+ */
+static bool config_load(server_config& sc, const std::string& cfg_file,
+                        const std::string& extras)
+{
+   struct cp_data *prev;
+   int            retval;
+   size_t         pos = 0;
+
+   sc.ctx = context_create();
+   prev   = context_select(sc.ctx);
+
+   while (pos < extras.size())
+   {
+      size_t      end  = extras.find('\n', pos);
+      std::string line = extras.substr(pos, end - pos);
+      size_t      sp   = line.find(' ');
+      std::string kind = line.substr(0, sp);
+      std::string arg  = (sp != std::string::npos) ? line.substr(sp + 1) : "";
+
+      pos = (end != std::string::npos) ? end + 1 : extras.size();
+
+      if (kind == "t")
+      {
+         load_keyword_file(arg.c_str());
+         config_add_file(sc, arg.c_str());
+      }
+      else if (kind == "type")
+      {
+         add_keyword(arg.c_str(), CT_TYPE, LANG_ALL);
+      }
+      else if (kind == "d")
+      {
+         load_define_file(arg.c_str());
+         config_add_file(sc, arg.c_str());
+      }
+      else if (kind == "define")
+      {
+         add_define(arg.c_str(), NULL);
+      }
+   }
+
+   cpd->filename = cfg_file.c_str();
+   retval        = load_option_file(cfg_file.c_str());
+   config_add_file(sc, cfg_file.c_str());
+   if (retval == 0)
+   {
+      /* This relies on cpd->filename being the config file name */
+      load_header_files();
+   }
+
+   context_select(prev);
+   return(retval == 0);
+}
+
+
+/**
+ * Finds the config for a request, loading it if it isn't loaded yet or if
+ * any of its files changed.
+ *
+ * @return the config or NULL if it couldn't be loaded
+ */
+static server_config *config_get(config_map& configs, const std::string& cfg_file,
+                                 const std::string& extras)
+{
+   std::string          key = cfg_file + '\n' + extras;
+   config_map::iterator it  = configs.find(key);
+
+   if (it != configs.end())
+   {
+      if (config_is_current(it->second))
+      {
+         return(&it->second);
+      }
+      LOG_FMT(LNOTE, "Reloading %s\n", cfg_file.c_str());
+      context_destroy(it->second.ctx);
+      configs.erase(it);
+   }
+
+   server_config sc;
+   if (!config_load(sc, cfg_file, extras))
+   {
+      context_destroy(sc.ctx);
+      return(NULL);
+   }
+   return(&(configs[key] = sc));
+}
+
+
+/**
+ * Sends everything written to stderr to a temp file, so that the logs for a
+ * request can be sent back with the reply.
+ */
+struct log_capture
+{
+   FILE *p_log;
+   int  saved_fd;
+};
+
+
+static void capture_start(log_capture& lc)
+{
+   fflush(stderr);
+   if (lc.p_log != NULL)
+   {
+      rewind(lc.p_log);
+      (void)ftruncate(fileno(lc.p_log), 0);
+      dup2(fileno(lc.p_log), STDERR_FILENO);
+   }
+}
+
+
+static void capture_end(log_capture& lc, std::string& text)
+{
+   fflush(stderr);
+   text.clear();
+   if (lc.p_log != NULL)
+   {
+      int len = (int)lseek(fileno(lc.p_log), 0, SEEK_END);
+
+      dup2(lc.saved_fd, STDERR_FILENO);
+      if (len > 0)
+      {
+         text.resize(len);
+         if (pread(fileno(lc.p_log), &text[0], len, 0) != len)
+         {
+            text.clear();
+         }
+      }
+   }
+}
+
+
+/**
+ * A client connection. The requests are read into 'in' bit by bit as they
+ * arrive, and the replies wait in 'out' until the client takes them. So a
+ * client that stops half way through a request or doesn't read its reply
+ * doesn't hold up the others.
+ */
+struct server_conn
+{
+   std::string in;
+   std::string out;
+   size_t      out_pos;   /* how much of 'out' was sent */
+};
+
+
+static void field_add(std::string& buf, const char *data, int len)
+{
+   UINT32 hdr = htonl(len);
+
+   buf.append((const char *)&hdr, sizeof(hdr));
+   buf.append(data, len);
+}
+
+
+static void field_add(std::string& buf, const std::string& str)
+{
+   field_add(buf, str.data(), str.size());
+}
+
+
+static void field_add(std::string& buf, int value)
+{
+   char tmp[32];
+
+   snprintf(tmp, sizeof(tmp), "%d", value);
+   field_add(buf, tmp, strlen(tmp));
+}
+
+
+/**
+ * Takes the next request off the front of 'in'.
+ *
+ * @return 1 if it was there and was put in 'fields', 0 if more is needed or
+ *         -1 if it isn't a request
+ */
+static int request_take(std::string& in, std::string fields[SERVER_FIELDS])
+{
+   size_t start[SERVER_FIELDS];
+   size_t pos = 0;
+   UINT32 len;
+
+   for (int idx = 0; idx < SERVER_FIELDS; idx++)
+   {
+      if ((in.size() - pos) < sizeof(len))
+      {
+         return(0);
+      }
+      memcpy(&len, &in[pos], sizeof(len));
+      len = ntohl(len);
+      if (len > SERVER_FIELD_MAX)
+      {
+         return(-1);
+      }
+      start[idx] = pos + sizeof(len);
+      pos        = start[idx] + len;
+
+      /* Give up on a wrong magic without waiting for the rest */
+      if ((idx == 0) &&
+          ((len != strlen(SERVER_MAGIC)) ||
+           ((in.size() >= pos) && (in.compare(start[0], len, SERVER_MAGIC) != 0))))
+      {
+         return(-1);
+      }
+      if (in.size() < pos)
+      {
+         return(0);
+      }
+   }
+
+   for (int idx = 0; idx < SERVER_FIELDS; idx++)
+   {
+      size_t end = (idx + 1 < SERVER_FIELDS) ? start[idx + 1] - sizeof(len) : pos;
+      fields[idx].assign(in, start[idx], end - start[idx]);
+   }
+   in.erase(0, pos);
+   return(1);
+}
+
+
+/**
+ * Formats one request and adds the reply to 'out'.
+ */
+static void server_handle(const std::string fields[SERVER_FIELDS], std::string& out,
+                          config_map& configs, log_capture& lc)
+{
+   const std::string& cfg_file = fields[1];
+   const std::string& extras   = fields[2];
+   const std::string& mask     = fields[3];
+   const std::string& lang     = fields[4];
+   const std::string& filename = fields[5];
+   const std::string& text     = fields[6];
+   std::string        log_text;
+   log_mask_t         saved_mask;
+   log_mask_t         req_mask;
+   const char         *out_buf = NULL;
+   int                out_len  = 0;
+   int                status   = -1;
+
+   log_get_mask(&saved_mask);
+   logmask_from_string(mask.c_str(), &req_mask);
+   log_set_mask(&req_mask);
+   capture_start(lc);
+
+   server_config *sc = config_get(configs, cfg_file, extras);
+   if (sc != NULL)
+   {
+      struct cp_data *prev = context_select(sc->ctx);
+      UINT32         old_errors;
+
+      cpd->lang_flags = strtol(lang.c_str(), NULL, 10);
+      cpd->filename   = filename.c_str();
+      old_errors      = cpd->error_count;
+
+      /* out_buf stays valid until the context formats again */
+      out_buf = uncrustify_file_mem(text.c_str(), text.size(), out_len);
+      status  = cpd->error_count - old_errors;
+      context_select(prev);
+   }
+
+   capture_end(lc, log_text);
+   log_set_mask(&saved_mask);
+
+   field_add(out, status);
+   field_add(out, log_text);
+   field_add(out, out_buf, (status >= 0) ? out_len : 0);
+}
+
+
+/**
+ * Reads what the client sent so far and serves the requests that are all
+ * there.
+ *
+ * @return false if the connection should be closed
+ */
+static bool conn_read(int fd, server_conn& conn, config_map& configs, log_capture& lc)
+{
+   std::string fields[SERVER_FIELDS];
+   char        buf[64 * 1024];
+   int         cnt;
+   int         ret;
+
+   cnt = read(fd, buf, sizeof(buf));
+   if (cnt <= 0)
+   {
+      return((cnt < 0) && ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)));
+   }
+   conn.in.append(buf, cnt);
+
+   while ((ret = request_take(conn.in, fields)) > 0)
+   {
+      server_handle(fields, conn.out, configs, lc);
+   }
+   return(ret == 0);
+}
+
+
+/**
+ * Sends as much of the replies as the client takes without waiting.
+ *
+ * @return false if the connection should be closed
+ */
+static bool conn_write(int fd, server_conn& conn)
+{
+   while (conn.out_pos < conn.out.size())
+   {
+      int cnt = write(fd, &conn.out[conn.out_pos], conn.out.size() - conn.out_pos);
+      if (cnt < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         return((errno == EAGAIN) || (errno == EWOULDBLOCK));
+      }
+      conn.out_pos += cnt;
+   }
+   conn.out.clear();
+   conn.out_pos = 0;
+   return(true);
+}
+
+
+static void set_nonblock(int fd)
+{
+   int flags = fcntl(fd, F_GETFL, 0);
+
+   if (flags >= 0)
+   {
+      (void)fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+   }
+}
+
+
+int server_run(const char *sock_path)
+{
+   std::vector<struct pollfd> fds;
+   std::vector<server_conn>   conns;
+   struct sockaddr_un         addr;
+   struct pollfd              pfd;
+   config_map                 configs;
+   log_capture                lc;
+   int                        fd;
+
+   if (strlen(sock_path) >= sizeof(addr.sun_path))
+   {
+      LOG_FMT(LERR, "%s: Socket path is too long: %s\n", __func__, sock_path);
+      return(EXIT_FAILURE);
+   }
+
+   /* A client going away must not kill the server */
+   signal(SIGPIPE, SIG_IGN);
+
+   /* Only remove the socket if nothing is answering on it */
+   fd = sock_connect(sock_path);
+   if (fd >= 0)
+   {
+      close(fd);
+      LOG_FMT(LERR, "%s: A server is already running on %s\n", __func__, sock_path);
+      return(EXIT_FAILURE);
+   }
+   (void)unlink(sock_path);
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   sockaddr_set(addr, sock_path);
+   if ((fd < 0) ||
+       (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+       (listen(fd, 16) != 0))
+   {
+      LOG_FMT(LERR, "%s: Unable to listen on %s: %s (%d)\n",
+              __func__, sock_path, strerror(errno), errno);
+      return(EXIT_FAILURE);
+   }
+   set_nonblock(fd);
+   LOG_FMT(LSYS, "Listening on %s\n", sock_path);
+
+   lc.p_log    = tmpfile();
+   lc.saved_fd = dup(STDERR_FILENO);
+
+   /* Entry 0 is the listening socket, conns[0] isn't used */
+   pfd.fd     = fd;
+   pfd.events = POLLIN;
+   fds.push_back(pfd);
+   conns.resize(1);
+
+   while (true)
+   {
+      if (poll(&fds[0], fds.size(), -1) < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+         LOG_FMT(LERR, "%s: poll failed: %s (%d)\n", __func__, strerror(errno), errno);
+         return(EXIT_FAILURE);
+      }
+
+      /* Handle the clients from the end so that erasing is safe */
+      for (int idx = fds.size() - 1; idx > 0; idx--)
+      {
+         short revents = fds[idx].revents;
+         bool  ok      = true;
+
+         if (revents == 0)
+         {
+            continue;
+         }
+         if ((fds[idx].events & POLLOUT) != 0)
+         {
+            ok = conn_write(fds[idx].fd, conns[idx]);
+         }
+         else
+         {
+            ok = conn_read(fds[idx].fd, conns[idx], configs, lc) &&
+                 conn_write(fds[idx].fd, conns[idx]);
+         }
+
+         if (!ok)
+         {
+            close(fds[idx].fd);
+            fds.erase(fds.begin() + idx);
+            conns.erase(conns.begin() + idx);
+         }
+         else
+         {
+            /* Don't take more requests until the client took the replies */
+            fds[idx].events = conns[idx].out.empty() ? POLLIN : POLLOUT;
+         }
+      }
+
+      if ((fds[0].revents & POLLIN) != 0)
+      {
+         pfd.fd = accept(fd, NULL, NULL);
+         if (pfd.fd >= 0)
+         {
+            set_nonblock(pfd.fd);
+            fds.push_back(pfd);
+            conns.push_back(server_conn());
+         }
+      }
+   }
+}
+
+
+/*
+ *  The client
+ */
+
+static int client_fd = -1;
+
+
+bool client_format(const char *sock_path, const client_setup& setup,
+                   const char *filename, int lang_flags,
+                   const char *data, int data_len, std::string& out)
+{
+   std::string status, log_text, text;
+   char        lang[32];
+
+   if (client_fd < 0)
+   {
+      /* Don't die if the server goes away */
+      signal(SIGPIPE, SIG_IGN);
+
+      client_fd = sock_connect(sock_path);
+      if (client_fd < 0)
+      {
+         LOG_FMT(LERR, "%s: Unable to connect to %s: %s (%d)\n",
+                 __func__, sock_path, strerror(errno), errno);
+         cpd->error_count++;
+         return(false);
+      }
+   }
+
+   snprintf(lang, sizeof(lang), "%d", lang_flags);
+
+   if (!send_field(client_fd, SERVER_MAGIC, strlen(SERVER_MAGIC)) ||
+       !send_field(client_fd, setup.cfg_file) ||
+       !send_field(client_fd, setup.extras) ||
+       !send_field(client_fd, setup.log_mask) ||
+       !send_field(client_fd, lang, strlen(lang)) ||
+       !send_field(client_fd, filename, strlen(filename)) ||
+       !send_field(client_fd, data, data_len) ||
+       !recv_field(client_fd, status) ||
+       !recv_field(client_fd, log_text) ||
+       !recv_field(client_fd, text))
+   {
+      LOG_FMT(LERR, "%s: Lost the connection to %s\n", __func__, sock_path);
+      close(client_fd);
+      client_fd = -1;
+      cpd->error_count++;
+      return(false);
+   }
+
+   fwrite(log_text.data(), log_text.size(), 1, stderr);
+
+   int errors = strtol(status.c_str(), NULL, 10);
+   if (errors < 0)
+   {
+      cpd->error_count++;
+      return(false);
+   }
+   cpd->error_count += errors;
+   out.swap(text);
+   return(true);
+}
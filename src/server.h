@@ -0,0 +1,84 @@
+/**
+ * @file server.h
+ * A formatting server that keeps configs loaded, and the client for it.
+ *
+ * It works like this:
+ *
+ * 1. 'uncrustify --server SOCK' listens on the Unix socket SOCK
+ *
+ * 2. 'uncrustify --client SOCK ...' takes the usual options, but instead of
+ *    loading the config and formatting, it sends each file to the server
+ *
+ * 3. The server loads the config, type and define files on first use and
+ *    keeps them until one of the files changes
+ *
+ * The client sends the config by absolute path, so the server must be able
+ * to read the same files.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED
+
+#include <cstdio>
+#include <string>
+
+
+/**
+ * What the server needs to load the config a client uses
+ */
+struct client_setup
+{
+   std::string cfg_file;    /* absolute path of the config file */
+   std::string extras;      /* "t FILE", "type WORD", "d FILE" or "define WORD" lines */
+   std::string log_mask;    /* log severities, as used with -L */
+};
+
+
+/**
+ * Writes all of data to fd, retrying on short writes.
+ *
+ * @return true on success
+ */
+bool write_all(int fd, const void *data, int len);
+
+
+/**
+ * Reads exactly len bytes from fd.
+ *
+ * @return true on success, false on error or end of file
+ */
+bool read_all(int fd, void *data, int len);
+
+
+/**
+ * Runs the server until it is killed.
+ *
+ * @param sock_path  The path of the Unix socket to listen on
+ * @return           The exit code if the server couldn't be started
+ */
+int server_run(const char *sock_path);
+
+
+/**
+ * Has the server format one file.
+ * Anything the server logged is written to stderr.
+ * The connection is made on the first call and kept open.
+ *
+ * @param sock_path  The server socket
+ * @param setup      The config to use
+ * @param filename   The name of the file, used in the logs
+ * @param lang_flags The LANG_xxx flags to format with
+ * @param data       The file contents
+ * @param data_len   The length of data
+ * @param out        Gets the output
+ * @return           false if there is no output, ie the config couldn't be
+ *                   loaded or the server couldn't be reached
+ */
+bool client_format(const char *sock_path, const client_setup& setup,
+                   const char *filename, int lang_flags,
+                   const char *data, int data_len, std::string& out);
+
+
+#endif /* SERVER_H_INCLUDED */
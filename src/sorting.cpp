@@ -107,6 +107,14 @@ void sort_imports(void)
    chunk_t *p_last = NULL;
    chunk_t *p_imp  = NULL;
 
+   /* Don't bother if there is nothing to sort */
+   if (!((cpd->settings[UO_mod_sort_import].b && (chunk_first_of_type(CT_IMPORT) != NULL)) ||
+         (cpd->settings[UO_mod_sort_using].b && (chunk_first_of_type(CT_USING) != NULL)) ||
+         (cpd->settings[UO_mod_sort_include].b && (chunk_first_of_type(CT_PP_INCLUDE) != NULL))))
+   {
+      return;
+   }
+
    pc = chunk_get_head();
    while (pc != NULL)
    {
@@ -140,21 +148,21 @@ void sort_imports(void)
       }
       else if (pc->type == CT_IMPORT)
       {
-         if (cpd.settings[UO_mod_sort_import].b)
+         if (cpd->settings[UO_mod_sort_import].b)
          {
             p_imp = chunk_get_next(pc);
          }
       }
       else if (pc->type == CT_USING)
       {
-         if (cpd.settings[UO_mod_sort_using].b)
+         if (cpd->settings[UO_mod_sort_using].b)
          {
             p_imp = chunk_get_next(pc);
          }
       }
       else if (pc->type == CT_PP_INCLUDE)
       {
-         if (cpd.settings[UO_mod_sort_include].b)
+         if (cpd->settings[UO_mod_sort_include].b)
          {
             p_imp  = chunk_get_next(pc);
             p_last = pc;
@@ -66,6 +66,35 @@ struct no_space_table_s no_space_table[] =
    { CT_OC_SEL_NAME,    CT_OC_SEL_NAME   },
 };
 
+/**
+ * The answers of do_space() for the pairs of chunk types that don't need to
+ * look at anything else. It is filled in as pairs come up: the rules run the
+ * first time and the answer is kept unless they used CTX().
+ * The "((" rule is the only one that all pairs can get to, so the table
+ * checks for it itself instead of giving up on the pair.
+ * It goes with the settings it was filled with, see space_table_check().
+ */
+#define SPT_TYPES        256  /* more than the number of c_token_t values */
+#define SPT_UNKNOWN      0x00 /* the pair hasn't come up yet */
+#define SPT_CTX          0x01 /* the pair needs the rules every time */
+#define SPT_KNOWN        0x10 /* SPT_KNOWN | the argval_t */
+#define SPT_PAREN        0x20 /* "((" and "))" get sp_paren_paren first */
+#define SPT_AV_MASK      0x03
+
+/* What do_space_rules() looked at, besides the types */
+#define SPU_CHUNK        0x01 /* anything, through CTX() */
+#define SPU_PAREN        0x02 /* got to the "((" rule */
+#define SPU_PAREN_HIT    0x04 /* and it was "((" or "))" */
+
+struct space_table_t
+{
+   op_val_t settings[UO_option_count];
+   UINT8    av[SPT_TYPES][SPT_TYPES];
+};
+
+/* Check each answer from the table against the rules */
+static bool sp_verify = false;
+
 #define log_rule(rule)                                        \
    do { if (log_sev_on(LSPACE)) {                             \
       log_rule2(__LINE__, (rule), first, second, complete); } \
@@ -84,15 +113,41 @@ static void log_rule2(int line, const char *rule, chunk_t *first, chunk_t *secon
 }
 
 
+/**
+ * Marks the use of something besides the types of the two chunks, which keeps
+ * the answer out of the space table.
+ * Everything in do_space_rules() that looks at 'first' or 'second' must go
+ * through this, except for the 'type' members and sp_paren_paren().
+ */
+#define CTX(pc)    sp_ctx_use(sp_used, (pc))
+
+static_inline chunk_t *sp_ctx_use(int& sp_used, chunk_t *pc)
+{
+   sp_used |= SPU_CHUNK;
+   return(pc);
+}
+
+
+/**
+ * "((" vs "( (" and "))" vs ") )"
+ */
+static_inline bool sp_paren_paren(chunk_t *first, chunk_t *second)
+{
+   return((chunk_is_str(first, "(", 1) && chunk_is_str(second, "(", 1)) ||
+          (chunk_is_str(first, ")", 1) && chunk_is_str(second, ")", 1)));
+}
+
+
 /**
  * Decides how to change inter-chunk spacing.
  * Note that the order of the if statements is VERY important.
  *
  * @param first   The first chunk
  * @param second  The second chunk
+ * @param sp_used Gets the SPU_xxx bits for what else the answer depends on
  * @return        AV_IGNORE, AV_ADD, AV_REMOVE or AV_FORCE
  */
-argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
+static argval_t do_space_rules(chunk_t *first, chunk_t *second, int& sp_used, bool complete)
 {
    int      idx;
    argval_t arg;
@@ -106,12 +161,12 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_PP) || (second->type == CT_PP))
    {
       log_rule("sp_pp_concat");
-      return(cpd.settings[UO_sp_pp_concat].a);
+      return(cpd->settings[UO_sp_pp_concat].a);
    }
    if (first->type == CT_POUND)
    {
       log_rule("sp_pp_stringify");
-      return(cpd.settings[UO_sp_pp_stringify].a);
+      return(cpd->settings[UO_sp_pp_stringify].a);
    }
 
    if ((first->type == CT_SPACE) || (second->type == CT_SPACE))
@@ -149,42 +204,42 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (second->type == CT_NL_CONT)
    {
       log_rule("sp_before_nl_cont");
-      return(cpd.settings[UO_sp_before_nl_cont].a);
+      return(cpd->settings[UO_sp_before_nl_cont].a);
    }
 
    if ((first->type == CT_D_ARRAY_COLON) ||
        (second->type == CT_D_ARRAY_COLON))
    {
       log_rule("sp_d_array_colon");
-      return(cpd.settings[UO_sp_d_array_colon].a);
+      return(cpd->settings[UO_sp_d_array_colon].a);
    }
 
-   if ((first->type == CT_CASE) && CharTable::IsKw1(second->str[0]))
+   if ((first->type == CT_CASE) && CharTable::IsKw1(CTX(second)->str[0]))
    {
       log_rule("sp_case_label");
-      return(argval_t(cpd.settings[UO_sp_case_label].a | AV_ADD));
+      return(argval_t(cpd->settings[UO_sp_case_label].a | AV_ADD));
    }
 
    if ((first->type == CT_QUESTION) || (second->type == CT_QUESTION))
    {
-      if (cpd.settings[UO_sp_cond_question].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_cond_question].a != AV_IGNORE)
       {
-         return(cpd.settings[UO_sp_cond_question].a);
+         return(cpd->settings[UO_sp_cond_question].a);
       }
    }
    if ((first->type == CT_COND_COLON) || (second->type == CT_COND_COLON))
    {
-      if (cpd.settings[UO_sp_cond_colon].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_cond_colon].a != AV_IGNORE)
       {
-         return(cpd.settings[UO_sp_cond_colon].a);
+         return(cpd->settings[UO_sp_cond_colon].a);
       }
    }
    if ((first->type == CT_RANGE) || (second->type == CT_RANGE))
    {
-      return(cpd.settings[UO_sp_range].a);
+      return(cpd->settings[UO_sp_range].a);
    }
 
-   if ((first->type == CT_COLON) && (first->parent_type == CT_SQL_EXEC))
+   if ((first->type == CT_COLON) && (CTX(first)->parent_type == CT_SQL_EXEC))
    {
       log_rule("REMOVE");
       return(AV_REMOVE);
@@ -194,21 +249,21 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_MACRO)
    {
       log_rule("sp_macro");
-      arg = cpd.settings[UO_sp_macro].a;
+      arg = cpd->settings[UO_sp_macro].a;
       return((argval_t)(arg | ((arg != AV_IGNORE) ? AV_ADD : AV_IGNORE)));
    }
 
-   if ((first->type == CT_FPAREN_CLOSE) && (first->parent_type == CT_MACRO_FUNC))
+   if ((first->type == CT_FPAREN_CLOSE) && (CTX(first)->parent_type == CT_MACRO_FUNC))
    {
       log_rule("sp_macro_func");
-      arg = cpd.settings[UO_sp_macro_func].a;
+      arg = cpd->settings[UO_sp_macro_func].a;
       return((argval_t)(arg | ((arg != AV_IGNORE) ? AV_ADD : AV_IGNORE)));
    }
 
    if (first->type == CT_PREPROC)
    {
       /* Remove spaces, unless we are ignoring. See indent_preproc() */
-      if (cpd.settings[UO_pp_space].a == AV_IGNORE)
+      if (cpd->settings[UO_pp_space].a == AV_IGNORE)
       {
          log_rule("IGNORE");
          return(AV_IGNORE);
@@ -219,28 +274,28 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
 
    if (second->type == CT_SEMICOLON)
    {
-      if (second->parent_type == CT_FOR)
+      if (CTX(second)->parent_type == CT_FOR)
       {
-         if ((cpd.settings[UO_sp_before_semi_for_empty].a != AV_IGNORE) &&
+         if ((cpd->settings[UO_sp_before_semi_for_empty].a != AV_IGNORE) &&
              ((first->type == CT_SPAREN_OPEN) || (first->type == CT_SEMICOLON)))
          {
             log_rule("sp_before_semi_for_empty");
-            return(cpd.settings[UO_sp_before_semi_for_empty].a);
+            return(cpd->settings[UO_sp_before_semi_for_empty].a);
          }
-         if (cpd.settings[UO_sp_before_semi_for].a != AV_IGNORE)
+         if (cpd->settings[UO_sp_before_semi_for].a != AV_IGNORE)
          {
             log_rule("sp_before_semi_for");
-            return(cpd.settings[UO_sp_before_semi_for].a);
+            return(cpd->settings[UO_sp_before_semi_for].a);
          }
       }
 
-      arg = cpd.settings[UO_sp_before_semi].a;
+      arg = cpd->settings[UO_sp_before_semi].a;
       log_rule("sp_before_semi");
       if ((first->type == CT_SPAREN_CLOSE) &&
-          (first->parent_type != CT_WHILE_OF_DO))
+          (CTX(first)->parent_type != CT_WHILE_OF_DO))
       {
          log_rule("sp_special_semi");
-         arg = (argval_t)(arg | cpd.settings[UO_sp_special_semi].a);
+         arg = (argval_t)(arg | cpd->settings[UO_sp_special_semi].a);
       }
       return(arg);
    }
@@ -248,24 +303,24 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    /* "for (;;)" vs "for (;; )" and "for (a;b;c)" vs "for (a; b; c)" */
    if (first->type == CT_SEMICOLON)
    {
-      if (first->parent_type == CT_FOR)
+      if (CTX(first)->parent_type == CT_FOR)
       {
-         if ((cpd.settings[UO_sp_after_semi_for_empty].a != AV_IGNORE) &&
+         if ((cpd->settings[UO_sp_after_semi_for_empty].a != AV_IGNORE) &&
              (second->type == CT_SPAREN_CLOSE))
          {
             log_rule("sp_after_semi_for_empty");
-            return(cpd.settings[UO_sp_after_semi_for_empty].a);
+            return(cpd->settings[UO_sp_after_semi_for_empty].a);
          }
-         if (cpd.settings[UO_sp_after_semi_for].a != AV_IGNORE)
+         if (cpd->settings[UO_sp_after_semi_for].a != AV_IGNORE)
          {
             log_rule("sp_after_semi_for");
-            return(cpd.settings[UO_sp_after_semi_for].a);
+            return(cpd->settings[UO_sp_after_semi_for].a);
          }
       }
       else if (!chunk_is_comment(second))
       {
          log_rule("sp_after_semi");
-         return(cpd.settings[UO_sp_after_semi].a);
+         return(cpd->settings[UO_sp_after_semi].a);
       }
       /* Let the comment spacing rules handle this */
    }
@@ -281,10 +336,10 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_RETURN)
    {
       if ((second->type == CT_PAREN_OPEN) &&
-          (second->parent_type == CT_RETURN))
+          (CTX(second)->parent_type == CT_RETURN))
       {
          log_rule("sp_return_paren");
-         return(cpd.settings[UO_sp_return_paren].a);
+         return(cpd->settings[UO_sp_return_paren].a);
       }
       /* everything else requires a space */
       log_rule("FORCE");
@@ -297,7 +352,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
       if (second->type == CT_PAREN_OPEN)
       {
          log_rule("sp_sizeof_paren");
-         return(cpd.settings[UO_sp_sizeof_paren].a);
+         return(cpd->settings[UO_sp_sizeof_paren].a);
       }
       log_rule("FORCE");
       return(AV_FORCE);
@@ -307,35 +362,35 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_DC_MEMBER)
    {
       log_rule("sp_after_dc");
-      return(cpd.settings[UO_sp_after_dc].a);
+      return(cpd->settings[UO_sp_after_dc].a);
    }
    if ((second->type == CT_DC_MEMBER) &&
        ((first->type == CT_WORD) || (first->type == CT_TYPE)))
    {
       log_rule("sp_before_dc");
-      return(cpd.settings[UO_sp_before_dc].a);
+      return(cpd->settings[UO_sp_before_dc].a);
    }
 
    /* "a,b" vs "a, b" */
    if (first->type == CT_COMMA)
    {
       log_rule("sp_after_comma");
-      return(cpd.settings[UO_sp_after_comma].a);
+      return(cpd->settings[UO_sp_after_comma].a);
    }
    if (second->type == CT_COMMA)
    {
       log_rule("sp_before_comma");
-      return(cpd.settings[UO_sp_before_comma].a);
+      return(cpd->settings[UO_sp_before_comma].a);
    }
 
    if (second->type == CT_ELLIPSIS)
    {
       /* non-punc followed by a ellipsis */
-      if (((first->flags & PCF_PUNCTUATOR) == 0) &&
-          (cpd.settings[UO_sp_before_ellipsis].a != AV_IGNORE))
+      if (((CTX(first)->flags & PCF_PUNCTUATOR) == 0) &&
+          (cpd->settings[UO_sp_before_ellipsis].a != AV_IGNORE))
       {
          log_rule("sp_before_ellipsis");
-         return(cpd.settings[UO_sp_before_ellipsis].a);
+         return(cpd->settings[UO_sp_before_ellipsis].a);
       }
 
       if (first->type == CT_TAG_COLON)
@@ -344,7 +399,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
          return(AV_FORCE);
       }
    }
-   if ((first->type == CT_ELLIPSIS) && CharTable::IsKw1(second->str[0]))
+   if ((first->type == CT_ELLIPSIS) && CharTable::IsKw1(CTX(second)->str[0]))
    {
       log_rule("FORCE");
       return(AV_FORCE);
@@ -352,7 +407,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_TAG_COLON)
    {
       log_rule("sp_after_tag");
-      return(cpd.settings[UO_sp_after_tag].a);
+      return(cpd->settings[UO_sp_after_tag].a);
    }
    if (second->type == CT_TAG_COLON)
    {
@@ -368,92 +423,93 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    }
 
    /* "((" vs "( (" */
-   if ((chunk_is_str(first, "(", 1) && chunk_is_str(second, "(", 1)) ||
-       (chunk_is_str(first, ")", 1) && chunk_is_str(second, ")", 1)))
+   sp_used |= SPU_PAREN;
+   if (sp_paren_paren(first, second))
    {
+      sp_used |= SPU_PAREN_HIT;
       log_rule("sp_paren_paren");
-      return(cpd.settings[UO_sp_paren_paren].a);
+      return(cpd->settings[UO_sp_paren_paren].a);
    }
 
    /* "if (" vs "if(" */
    if (second->type == CT_SPAREN_OPEN)
    {
       log_rule("sp_before_sparen");
-      return(cpd.settings[UO_sp_before_sparen].a);
+      return(cpd->settings[UO_sp_before_sparen].a);
    }
 
    if ((first->type == CT_LAMBDA) ||
        (second->type == CT_LAMBDA))
    {
       log_rule("sp_assign (lambda)");
-      return(cpd.settings[UO_sp_assign].a);
+      return(cpd->settings[UO_sp_assign].a);
    }
 
    if (second->type == CT_OC_BLOCK_CARET)
    {
       log_rule("sp_before_oc_block_caret");
-      return(cpd.settings[UO_sp_before_oc_block_caret].a);
+      return(cpd->settings[UO_sp_before_oc_block_caret].a);
    }
    if (first->type == CT_OC_BLOCK_CARET)
    {
       log_rule("sp_after_oc_block_caret");
-      return(cpd.settings[UO_sp_after_oc_block_caret].a);
+      return(cpd->settings[UO_sp_after_oc_block_caret].a);
    }
 
    if (second->type == CT_ASSIGN)
    {
-      if (second->flags & PCF_IN_ENUM)
+      if (CTX(second)->flags & PCF_IN_ENUM)
       {
-         if (cpd.settings[UO_sp_enum_before_assign].a != AV_IGNORE)
+         if (cpd->settings[UO_sp_enum_before_assign].a != AV_IGNORE)
          {
             log_rule("sp_enum_before_assign");
-            return(cpd.settings[UO_sp_enum_before_assign].a);
+            return(cpd->settings[UO_sp_enum_before_assign].a);
          }
          log_rule("sp_enum_assign");
-         return(cpd.settings[UO_sp_enum_assign].a);
+         return(cpd->settings[UO_sp_enum_assign].a);
       }
-      if (cpd.settings[UO_sp_before_assign].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_assign].a != AV_IGNORE)
       {
          log_rule("sp_before_assign");
-         return(cpd.settings[UO_sp_before_assign].a);
+         return(cpd->settings[UO_sp_before_assign].a);
       }
       log_rule("sp_assign");
-      return(cpd.settings[UO_sp_assign].a);
+      return(cpd->settings[UO_sp_assign].a);
    }
 
    if (first->type == CT_ASSIGN)
    {
-      if (first->flags & PCF_IN_ENUM)
+      if (CTX(first)->flags & PCF_IN_ENUM)
       {
-         if (cpd.settings[UO_sp_enum_after_assign].a != AV_IGNORE)
+         if (cpd->settings[UO_sp_enum_after_assign].a != AV_IGNORE)
          {
             log_rule("sp_enum_after_assign");
-            return(cpd.settings[UO_sp_enum_after_assign].a);
+            return(cpd->settings[UO_sp_enum_after_assign].a);
          }
          log_rule("sp_enum_assign");
-         return(cpd.settings[UO_sp_enum_assign].a);
+         return(cpd->settings[UO_sp_enum_assign].a);
       }
-      if (cpd.settings[UO_sp_after_assign].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_after_assign].a != AV_IGNORE)
       {
          log_rule("sp_after_assign");
-         return(cpd.settings[UO_sp_after_assign].a);
+         return(cpd->settings[UO_sp_after_assign].a);
       }
       log_rule("sp_assign");
-      return(cpd.settings[UO_sp_assign].a);
+      return(cpd->settings[UO_sp_assign].a);
    }
 
    /* "a [x]" vs "a[x]" */
-   if ((second->type == CT_SQUARE_OPEN) && (second->parent_type != CT_OC_MSG))
+   if ((second->type == CT_SQUARE_OPEN) && (CTX(second)->parent_type != CT_OC_MSG))
    {
       log_rule("sp_before_square");
-      return(cpd.settings[UO_sp_before_square].a);
+      return(cpd->settings[UO_sp_before_square].a);
    }
 
    /* "byte[]" vs "byte []" */
    if (second->type == CT_TSQUARE)
    {
       log_rule("sp_before_squares");
-      return(cpd.settings[UO_sp_before_squares].a);
+      return(cpd->settings[UO_sp_before_squares].a);
    }
 
    /* spacing around template < > stuff */
@@ -461,111 +517,111 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
        (second->type == CT_ANGLE_CLOSE))
    {
       log_rule("sp_inside_angle");
-      return(cpd.settings[UO_sp_inside_angle].a);
+      return(cpd->settings[UO_sp_inside_angle].a);
    }
    if (second->type == CT_ANGLE_OPEN)
    {
       if ((first->type == CT_TEMPLATE) &&
-          (cpd.settings[UO_sp_template_angle].a != AV_IGNORE))
+          (cpd->settings[UO_sp_template_angle].a != AV_IGNORE))
       {
          log_rule("sp_template_angle");
-         return(cpd.settings[UO_sp_template_angle].a);
+         return(cpd->settings[UO_sp_template_angle].a);
       }
       log_rule("sp_before_angle");
-      return(cpd.settings[UO_sp_before_angle].a);
+      return(cpd->settings[UO_sp_before_angle].a);
    }
    if (first->type == CT_ANGLE_CLOSE)
    {
-      if ((second->type == CT_WORD) || CharTable::IsKw1(second->str[0]))
+      if ((second->type == CT_WORD) || CharTable::IsKw1(CTX(second)->str[0]))
       {
-         if (cpd.settings[UO_sp_angle_word].a != AV_IGNORE)
+         if (cpd->settings[UO_sp_angle_word].a != AV_IGNORE)
          {
             log_rule("sp_angle_word");
-            return(cpd.settings[UO_sp_angle_word].a);
+            return(cpd->settings[UO_sp_angle_word].a);
          }
       }
       if ((second->type == CT_FPAREN_OPEN) ||
           (second->type == CT_PAREN_OPEN))
       {
          log_rule("sp_angle_paren");
-         return(cpd.settings[UO_sp_angle_paren].a);
+         return(cpd->settings[UO_sp_angle_paren].a);
       }
       if (second->type == CT_DC_MEMBER)
       {
          log_rule("sp_before_dc");
-         return(cpd.settings[UO_sp_before_dc].a);
+         return(cpd->settings[UO_sp_before_dc].a);
       }
       if ((second->type != CT_BYREF) &&
           (second->type != CT_PTR_TYPE))
       {
          log_rule("sp_after_angle");
-         return(cpd.settings[UO_sp_after_angle].a);
+         return(cpd->settings[UO_sp_after_angle].a);
       }
    }
 
    if ((first->type == CT_BYREF) &&
-       (cpd.settings[UO_sp_after_byref_func].a != AV_IGNORE) &&
-       ((first->parent_type == CT_FUNC_DEF) ||
-        (first->parent_type == CT_FUNC_PROTO)))
+       (cpd->settings[UO_sp_after_byref_func].a != AV_IGNORE) &&
+       ((CTX(first)->parent_type == CT_FUNC_DEF) ||
+        (CTX(first)->parent_type == CT_FUNC_PROTO)))
    {
       log_rule("sp_after_byref_func");
-      return(cpd.settings[UO_sp_after_byref_func].a);
+      return(cpd->settings[UO_sp_after_byref_func].a);
    }
 
-   if ((first->type == CT_BYREF) && CharTable::IsKw1(second->str[0]))
+   if ((first->type == CT_BYREF) && CharTable::IsKw1(CTX(second)->str[0]))
    {
       log_rule("sp_after_byref");
-      return(cpd.settings[UO_sp_after_byref].a);
+      return(cpd->settings[UO_sp_after_byref].a);
    }
 
    if (second->type == CT_BYREF)
    {
-      if (cpd.settings[UO_sp_before_byref_func].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_byref_func].a != AV_IGNORE)
       {
-         next = chunk_get_next(second);
+         next = chunk_get_next(CTX(second));
          if ((next != NULL) &&
              ((next->type == CT_FUNC_DEF) ||
               (next->type == CT_FUNC_PROTO)))
          {
-            return(cpd.settings[UO_sp_before_byref_func].a);
+            return(cpd->settings[UO_sp_before_byref_func].a);
          }
       }
 
-      if (cpd.settings[UO_sp_before_unnamed_byref].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_unnamed_byref].a != AV_IGNORE)
       {
-         next = chunk_get_next_nc(second);
+         next = chunk_get_next_nc(CTX(second));
          if ((next != NULL) && (next->type != CT_WORD))
          {
             log_rule("sp_before_unnamed_byref");
-            return(cpd.settings[UO_sp_before_unnamed_byref].a);
+            return(cpd->settings[UO_sp_before_unnamed_byref].a);
          }
       }
       log_rule("sp_before_byref");
-      return(cpd.settings[UO_sp_before_byref].a);
+      return(cpd->settings[UO_sp_before_byref].a);
    }
 
    if (first->type == CT_SPAREN_CLOSE)
    {
       if ((second->type == CT_BRACE_OPEN) &&
-          (cpd.settings[UO_sp_sparen_brace].a != AV_IGNORE))
+          (cpd->settings[UO_sp_sparen_brace].a != AV_IGNORE))
       {
          log_rule("sp_sparen_brace");
-         return(cpd.settings[UO_sp_sparen_brace].a);
+         return(cpd->settings[UO_sp_sparen_brace].a);
       }
       if (!chunk_is_comment(second) &&
-          (cpd.settings[UO_sp_after_sparen].a != AV_IGNORE))
+          (cpd->settings[UO_sp_after_sparen].a != AV_IGNORE))
       {
          log_rule("sp_after_sparen");
-         return(cpd.settings[UO_sp_after_sparen].a);
+         return(cpd->settings[UO_sp_after_sparen].a);
       }
    }
 
    if ((second->type == CT_FPAREN_OPEN) &&
-       (first->parent_type == CT_OPERATOR) &&
-       (cpd.settings[UO_sp_after_operator_sym].a != AV_IGNORE))
+       (CTX(first)->parent_type == CT_OPERATOR) &&
+       (cpd->settings[UO_sp_after_operator_sym].a != AV_IGNORE))
    {
       log_rule("sp_after_operator_sym");
-      return(cpd.settings[UO_sp_after_operator_sym].a);
+      return(cpd->settings[UO_sp_after_operator_sym].a);
    }
 
    /* spaces between function and open paren */
@@ -573,27 +629,27 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
        (first->type == CT_FUNC_CTOR_VAR))
    {
       log_rule("sp_func_call_paren");
-      return(cpd.settings[UO_sp_func_call_paren].a);
+      return(cpd->settings[UO_sp_func_call_paren].a);
    }
    if (first->type == CT_FUNC_CALL_USER)
    {
       log_rule("sp_func_call_user_paren");
-      return(cpd.settings[UO_sp_func_call_user_paren].a);
+      return(cpd->settings[UO_sp_func_call_user_paren].a);
    }
    if (first->type == CT_ATTRIBUTE)
    {
       log_rule("sp_attribute_paren");
-      return(cpd.settings[UO_sp_attribute_paren].a);
+      return(cpd->settings[UO_sp_attribute_paren].a);
    }
    if (first->type == CT_FUNC_DEF)
    {
       log_rule("sp_func_def_paren");
-      return(cpd.settings[UO_sp_func_def_paren].a);
+      return(cpd->settings[UO_sp_func_def_paren].a);
    }
    if (first->type == CT_CPP_CAST)
    {
       log_rule("sp_cpp_cast_paren");
-      return(cpd.settings[UO_sp_cpp_cast_paren].a);
+      return(cpd->settings[UO_sp_cpp_cast_paren].a);
    }
 
    if ((first->type == CT_PAREN_CLOSE) &&
@@ -601,11 +657,11 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
         (second->type == CT_FPAREN_OPEN)))
    {
       /* "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a" */
-      if ((first->parent_type == CT_C_CAST) ||
-          (first->parent_type == CT_D_CAST))
+      if ((CTX(first)->parent_type == CT_C_CAST) ||
+          (CTX(first)->parent_type == CT_D_CAST))
       {
          log_rule("sp_after_cast");
-         return(cpd.settings[UO_sp_after_cast].a);
+         return(cpd->settings[UO_sp_after_cast].a);
       }
 
       /* Must be an indirect/chained function call? */
@@ -615,17 +671,17 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
 
    if ((first->type == CT_FUNC_PROTO) ||
        ((second->type == CT_FPAREN_OPEN) &&
-        (second->parent_type == CT_FUNC_PROTO)))
+        (CTX(second)->parent_type == CT_FUNC_PROTO)))
    {
       log_rule("sp_func_proto_paren");
-      return(cpd.settings[UO_sp_func_proto_paren].a);
+      return(cpd->settings[UO_sp_func_proto_paren].a);
    }
    if (first->type == CT_FUNC_CLASS)
    {
       log_rule("sp_func_class_paren");
-      return(cpd.settings[UO_sp_func_class_paren].a);
+      return(cpd->settings[UO_sp_func_class_paren].a);
    }
-   if ((first->type == CT_CLASS) && (first->parent_type != CT_OC_MSG))
+   if ((first->type == CT_CLASS) && (CTX(first)->parent_type != CT_OC_MSG))
    {
       log_rule("FORCE");
       return(AV_FORCE);
@@ -634,24 +690,24 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_BRACE_OPEN) && (second->type == CT_BRACE_CLOSE))
    {
       log_rule("sp_inside_braces_empty");
-      return(cpd.settings[UO_sp_inside_braces_empty].a);
+      return(cpd->settings[UO_sp_inside_braces_empty].a);
    }
 
    if (second->type == CT_BRACE_CLOSE)
    {
-      if (second->parent_type == CT_ENUM)
+      if (CTX(second)->parent_type == CT_ENUM)
       {
          log_rule("sp_inside_braces_enum");
-         return(cpd.settings[UO_sp_inside_braces_enum].a);
+         return(cpd->settings[UO_sp_inside_braces_enum].a);
       }
-      if ((second->parent_type == CT_STRUCT) ||
-          (second->parent_type == CT_UNION))
+      if ((CTX(second)->parent_type == CT_STRUCT) ||
+          (CTX(second)->parent_type == CT_UNION))
       {
          log_rule("sp_inside_braces_struct");
-         return(cpd.settings[UO_sp_inside_braces_struct].a);
+         return(cpd->settings[UO_sp_inside_braces_struct].a);
       }
       log_rule("sp_inside_braces");
-      return(cpd.settings[UO_sp_inside_braces].a);
+      return(cpd->settings[UO_sp_inside_braces].a);
    }
 
    if (first->type == CT_D_CAST)
@@ -663,13 +719,13 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_PP_DEFINED) && (second->type == CT_PAREN_OPEN))
    {
       log_rule("sp_defined_paren");
-      return(cpd.settings[UO_sp_defined_paren].a);
+      return(cpd->settings[UO_sp_defined_paren].a);
    }
 
    if ((first->type == CT_THROW) && (second->type == CT_PAREN_OPEN))
    {
       log_rule("sp_throw_paren");
-      return(cpd.settings[UO_sp_throw_paren].a);
+      return(cpd->settings[UO_sp_throw_paren].a);
    }
 
    if ((first->type == CT_THIS) && (second->type == CT_PAREN_OPEN))
@@ -693,7 +749,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_MEMBER) || (second->type == CT_MEMBER))
    {
       log_rule("sp_member");
-      return(cpd.settings[UO_sp_member].a);
+      return(cpd->settings[UO_sp_member].a);
    }
 
    if (first->type == CT_C99_MEMBER)
@@ -711,7 +767,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_FPAREN_CLOSE) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_fparen_brace");
-      return(cpd.settings[UO_sp_fparen_brace].a);
+      return(cpd->settings[UO_sp_fparen_brace].a);
    }
 
    if ((first->type == CT_D_TEMPLATE) || (second->type == CT_D_TEMPLATE))
@@ -723,7 +779,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_ELSE) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_else_brace");
-      return(cpd.settings[UO_sp_else_brace].a);
+      return(cpd->settings[UO_sp_else_brace].a);
    }
 
    if ((first->type == CT_ELSE) && (second->type == CT_ELSEIF))
@@ -735,79 +791,79 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_CATCH) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_catch_brace");
-      return(cpd.settings[UO_sp_catch_brace].a);
+      return(cpd->settings[UO_sp_catch_brace].a);
    }
 
    if ((first->type == CT_FINALLY) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_finally_brace");
-      return(cpd.settings[UO_sp_finally_brace].a);
+      return(cpd->settings[UO_sp_finally_brace].a);
    }
 
    if ((first->type == CT_TRY) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_try_brace");
-      return(cpd.settings[UO_sp_try_brace].a);
+      return(cpd->settings[UO_sp_try_brace].a);
    }
 
    if ((first->type == CT_GETSET) && (second->type == CT_BRACE_OPEN))
    {
       log_rule("sp_getset_brace");
-      return(cpd.settings[UO_sp_getset_brace].a);
+      return(cpd->settings[UO_sp_getset_brace].a);
    }
 
    if ((second->type == CT_PAREN_OPEN) &&
-       (second->parent_type == CT_INVARIANT))
+       (CTX(second)->parent_type == CT_INVARIANT))
    {
       log_rule("sp_invariant_paren");
-      return(cpd.settings[UO_sp_invariant_paren].a);
+      return(cpd->settings[UO_sp_invariant_paren].a);
    }
 
    if (first->type == CT_PAREN_CLOSE)
    {
-      if (first->parent_type == CT_D_TEMPLATE)
+      if (CTX(first)->parent_type == CT_D_TEMPLATE)
       {
          log_rule("FORCE");
          return(AV_FORCE);
       }
 
-      if (first->parent_type == CT_INVARIANT)
+      if (CTX(first)->parent_type == CT_INVARIANT)
       {
          log_rule("sp_after_invariant_paren");
-         return(cpd.settings[UO_sp_after_invariant_paren].a);
+         return(cpd->settings[UO_sp_after_invariant_paren].a);
       }
 
       /* Arith after a cast comes first */
       if (second->type == CT_ARITH)
       {
          log_rule("sp_arith");
-         return(cpd.settings[UO_sp_arith].a);
+         return(cpd->settings[UO_sp_arith].a);
       }
 
       /* "(int)a" vs "(int) a" or "cast(int)a" vs "cast(int) a" */
-      if ((first->parent_type == CT_C_CAST) ||
-          (first->parent_type == CT_D_CAST))
+      if ((CTX(first)->parent_type == CT_C_CAST) ||
+          (CTX(first)->parent_type == CT_D_CAST))
       {
          log_rule("sp_after_cast");
-         return(cpd.settings[UO_sp_after_cast].a);
+         return(cpd->settings[UO_sp_after_cast].a);
       }
 
       /* "(struct foo) {...}" vs "(struct foo){...}" */
       if (second->type == CT_BRACE_OPEN)
       {
          log_rule("sp_paren_brace");
-         return(cpd.settings[UO_sp_paren_brace].a);
+         return(cpd->settings[UO_sp_paren_brace].a);
       }
 
       /* D-specific: "delegate(some thing) dg */
-      if (first->parent_type == CT_DELEGATE)
+      if (CTX(first)->parent_type == CT_DELEGATE)
       {
          log_rule("ADD");
          return(AV_ADD);
       }
 
       /* PAWN-specific: "state (condition) next" */
-      if (first->parent_type == CT_STATE)
+      if (CTX(first)->parent_type == CT_STATE)
       {
          log_rule("ADD");
          return(AV_ADD);
@@ -820,31 +876,31 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
       if ((first->type == CT_FPAREN_OPEN) && (second->type == CT_FPAREN_CLOSE))
       {
          log_rule("sp_inside_fparens");
-         return(cpd.settings[UO_sp_inside_fparens].a);
+         return(cpd->settings[UO_sp_inside_fparens].a);
       }
       log_rule("sp_inside_fparen");
-      return(cpd.settings[UO_sp_inside_fparen].a);
+      return(cpd->settings[UO_sp_inside_fparen].a);
    }
 
    if (first->type == CT_PAREN_CLOSE)
    {
-      if (first->parent_type == CT_OC_RTYPE)
+      if (CTX(first)->parent_type == CT_OC_RTYPE)
       {
          log_rule("sp_after_oc_return_type");
-         return(cpd.settings[UO_sp_after_oc_return_type].a);
+         return(cpd->settings[UO_sp_after_oc_return_type].a);
       }
-      else if ((first->parent_type == CT_OC_MSG_SPEC) ||
-               (first->parent_type == CT_OC_MSG_DECL))
+      else if ((CTX(first)->parent_type == CT_OC_MSG_SPEC) ||
+               (CTX(first)->parent_type == CT_OC_MSG_DECL))
       {
          log_rule("sp_after_oc_type");
-         return(cpd.settings[UO_sp_after_oc_type].a);
+         return(cpd->settings[UO_sp_after_oc_type].a);
       }
    }
 
    if ((first->type == CT_OC_SEL) && (second->type == CT_PAREN_OPEN))
    {
       log_rule("sp_after_oc_at_sel");
-      return(cpd.settings[UO_sp_after_oc_at_sel].a);
+      return(cpd->settings[UO_sp_after_oc_at_sel].a);
    }
 
    /* C cast:   "(int)"      vs "( int )"
@@ -853,72 +909,72 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
     */
    if (first->type == CT_PAREN_OPEN)
    {
-      if ((first->parent_type == CT_C_CAST) ||
-          (first->parent_type == CT_CPP_CAST) ||
-          (first->parent_type == CT_D_CAST))
+      if ((CTX(first)->parent_type == CT_C_CAST) ||
+          (CTX(first)->parent_type == CT_CPP_CAST) ||
+          (CTX(first)->parent_type == CT_D_CAST))
       {
          log_rule("sp_inside_paren_cast");
-         return(cpd.settings[UO_sp_inside_paren_cast].a);
+         return(cpd->settings[UO_sp_inside_paren_cast].a);
       }
       log_rule("sp_inside_paren");
-      return(cpd.settings[UO_sp_inside_paren].a);
+      return(cpd->settings[UO_sp_inside_paren].a);
    }
 
    if (second->type == CT_PAREN_CLOSE)
    {
-      if ((second->parent_type == CT_C_CAST) ||
-          (second->parent_type == CT_CPP_CAST) ||
-          (second->parent_type == CT_D_CAST))
+      if ((CTX(second)->parent_type == CT_C_CAST) ||
+          (CTX(second)->parent_type == CT_CPP_CAST) ||
+          (CTX(second)->parent_type == CT_D_CAST))
       {
          log_rule("sp_inside_paren_cast");
-         return(cpd.settings[UO_sp_inside_paren_cast].a);
+         return(cpd->settings[UO_sp_inside_paren_cast].a);
       }
       log_rule("sp_inside_paren");
-      return(cpd.settings[UO_sp_inside_paren].a);
+      return(cpd->settings[UO_sp_inside_paren].a);
    }
 
    /* "[3]" vs "[ 3 ]" */
    if ((first->type == CT_SQUARE_OPEN) || (second->type == CT_SQUARE_CLOSE))
    {
       log_rule("sp_inside_square");
-      return(cpd.settings[UO_sp_inside_square].a);
+      return(cpd->settings[UO_sp_inside_square].a);
    }
    if ((first->type == CT_SQUARE_CLOSE) && (second->type == CT_FPAREN_OPEN))
    {
       log_rule("sp_square_fparen");
-      return(cpd.settings[UO_sp_square_fparen].a);
+      return(cpd->settings[UO_sp_square_fparen].a);
    }
 
    /* "if(...)" vs "if( ... )" */
    if ((second->type == CT_SPAREN_CLOSE) &&
-       (cpd.settings[UO_sp_inside_sparen_close].a != AV_IGNORE))
+       (cpd->settings[UO_sp_inside_sparen_close].a != AV_IGNORE))
    {
       log_rule("sp_inside_sparen_close");
-      return(cpd.settings[UO_sp_inside_sparen_close].a);
+      return(cpd->settings[UO_sp_inside_sparen_close].a);
    }
    if ((first->type == CT_SPAREN_OPEN) || (second->type == CT_SPAREN_CLOSE))
    {
       log_rule("sp_inside_sparen");
-      return(cpd.settings[UO_sp_inside_sparen].a);
+      return(cpd->settings[UO_sp_inside_sparen].a);
    }
 
-   if ((cpd.settings[UO_sp_after_class_colon].a != AV_IGNORE) &&
+   if ((cpd->settings[UO_sp_after_class_colon].a != AV_IGNORE) &&
        (first->type == CT_CLASS_COLON))
    {
       log_rule("sp_after_class_colon");
-      return(cpd.settings[UO_sp_after_class_colon].a);
+      return(cpd->settings[UO_sp_after_class_colon].a);
    }
-   if ((cpd.settings[UO_sp_before_class_colon].a != AV_IGNORE) &&
+   if ((cpd->settings[UO_sp_before_class_colon].a != AV_IGNORE) &&
        (second->type == CT_CLASS_COLON))
    {
       log_rule("sp_before_class_colon");
-      return(cpd.settings[UO_sp_before_class_colon].a);
+      return(cpd->settings[UO_sp_before_class_colon].a);
    }
-   if ((cpd.settings[UO_sp_before_case_colon].a != AV_IGNORE) &&
+   if ((cpd->settings[UO_sp_before_case_colon].a != AV_IGNORE) &&
        (second->type == CT_CASE_COLON))
    {
       log_rule("sp_before_case_colon");
-      return(cpd.settings[UO_sp_before_case_colon].a);
+      return(cpd->settings[UO_sp_before_case_colon].a);
    }
 
    if (first->type == CT_DOT)
@@ -935,13 +991,13 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_ARITH) || (second->type == CT_ARITH))
    {
       log_rule("sp_arith");
-      return(cpd.settings[UO_sp_arith].a);
+      return(cpd->settings[UO_sp_arith].a);
    }
    if ((first->type == CT_BOOL) || (second->type == CT_BOOL))
    {
-      arg = cpd.settings[UO_sp_bool].a;
-      if ((cpd.settings[UO_pos_bool].tp != TP_IGNORE) &&
-          (first->orig_line != second->orig_line) &&
+      arg = cpd->settings[UO_sp_bool].a;
+      if ((cpd->settings[UO_pos_bool].tp != TP_IGNORE) &&
+          (CTX(first)->orig_line != CTX(second)->orig_line) &&
           (arg != AV_REMOVE))
       {
          arg = (argval_t)(arg | AV_ADD);
@@ -952,7 +1008,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((first->type == CT_COMPARE) || (second->type == CT_COMPARE))
    {
       log_rule("sp_compare");
-      return(cpd.settings[UO_sp_compare].a);
+      return(cpd->settings[UO_sp_compare].a);
    }
 
    if ((first->type == CT_PAREN_OPEN) && (second->type == CT_PTR_TYPE))
@@ -963,35 +1019,35 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
 
    if ((first->type == CT_PTR_TYPE) &&
        (second->type == CT_PTR_TYPE) &&
-       (cpd.settings[UO_sp_between_ptr_star].a != AV_IGNORE))
+       (cpd->settings[UO_sp_between_ptr_star].a != AV_IGNORE))
    {
       log_rule("sp_between_ptr_star");
-      return(cpd.settings[UO_sp_between_ptr_star].a);
+      return(cpd->settings[UO_sp_between_ptr_star].a);
    }
 
    if ((first->type == CT_PTR_TYPE) &&
-       (cpd.settings[UO_sp_after_ptr_star_func].a != AV_IGNORE) &&
-       ((first->parent_type == CT_FUNC_DEF) ||
-        (first->parent_type == CT_FUNC_PROTO)))
+       (cpd->settings[UO_sp_after_ptr_star_func].a != AV_IGNORE) &&
+       ((CTX(first)->parent_type == CT_FUNC_DEF) ||
+        (CTX(first)->parent_type == CT_FUNC_PROTO)))
    {
       log_rule("sp_after_ptr_star_func");
-      return(cpd.settings[UO_sp_after_ptr_star_func].a);
+      return(cpd->settings[UO_sp_after_ptr_star_func].a);
    }
 
    if ((first->type == CT_PTR_TYPE) &&
-       (cpd.settings[UO_sp_after_ptr_star].a != AV_IGNORE) &&
-       CharTable::IsKw1(second->str[0]))
+       (cpd->settings[UO_sp_after_ptr_star].a != AV_IGNORE) &&
+       CharTable::IsKw1(CTX(second)->str[0]))
    {
       log_rule("sp_after_ptr_star");
-      return(cpd.settings[UO_sp_after_ptr_star].a);
+      return(cpd->settings[UO_sp_after_ptr_star].a);
    }
 
    if (second->type == CT_PTR_TYPE)
    {
-      if (cpd.settings[UO_sp_before_ptr_star_func].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_ptr_star_func].a != AV_IGNORE)
       {
          /* Find the next non-'*' chunk */
-         next = second;
+         next = CTX(second);
          do
          {
             next = chunk_get_next(next);
@@ -1001,13 +1057,13 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
              ((next->type == CT_FUNC_DEF) ||
               (next->type == CT_FUNC_PROTO)))
          {
-            return(cpd.settings[UO_sp_before_ptr_star_func].a);
+            return(cpd->settings[UO_sp_before_ptr_star_func].a);
          }
       }
 
-      if (cpd.settings[UO_sp_before_unnamed_ptr_star].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_unnamed_ptr_star].a != AV_IGNORE)
       {
-         next = chunk_get_next_nc(second);
+         next = chunk_get_next_nc(CTX(second));
          while ((next != NULL) && (next->type == CT_PTR_TYPE))
          {
             next = chunk_get_next_nc(next);
@@ -1015,20 +1071,20 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
          if ((next != NULL) && (next->type != CT_WORD))
          {
             log_rule("sp_before_unnamed_ptr_star");
-            return(cpd.settings[UO_sp_before_unnamed_ptr_star].a);
+            return(cpd->settings[UO_sp_before_unnamed_ptr_star].a);
          }
       }
-      if (cpd.settings[UO_sp_before_ptr_star].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_before_ptr_star].a != AV_IGNORE)
       {
          log_rule("sp_before_ptr_star");
-         return(cpd.settings[UO_sp_before_ptr_star].a);
+         return(cpd->settings[UO_sp_before_ptr_star].a);
       }
    }
 
    if (first->type == CT_OPERATOR)
    {
       log_rule("sp_after_operator");
-      return(cpd.settings[UO_sp_after_operator].a);
+      return(cpd->settings[UO_sp_after_operator].a);
    }
 
    if ((second->type == CT_FUNC_PROTO) || (second->type == CT_FUNC_DEF))
@@ -1036,10 +1092,10 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
       if (first->type != CT_PTR_TYPE)
       {
          log_rule("sp_type_func|ADD");
-         return((argval_t)(cpd.settings[UO_sp_type_func].a | AV_ADD));
+         return((argval_t)(cpd->settings[UO_sp_type_func].a | AV_ADD));
       }
       log_rule("sp_type_func");
-      return(cpd.settings[UO_sp_type_func].a);
+      return(cpd->settings[UO_sp_type_func].a);
    }
 
    if (first->type == CT_BRACE_CLOSE)
@@ -1047,77 +1103,77 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
       if (second->type == CT_ELSE)
       {
          log_rule("sp_brace_else");
-         return(cpd.settings[UO_sp_brace_else].a);
+         return(cpd->settings[UO_sp_brace_else].a);
       }
       else if (second->type == CT_CATCH)
       {
          log_rule("sp_brace_catch");
-         return(cpd.settings[UO_sp_brace_catch].a);
+         return(cpd->settings[UO_sp_brace_catch].a);
       }
       else if (second->type == CT_FINALLY)
       {
          log_rule("sp_brace_finally");
-         return(cpd.settings[UO_sp_brace_finally].a);
+         return(cpd->settings[UO_sp_brace_finally].a);
       }
    }
 
    if (first->type == CT_BRACE_OPEN)
    {
-      if (first->parent_type == CT_ENUM)
+      if (CTX(first)->parent_type == CT_ENUM)
       {
          log_rule("sp_inside_braces_enum");
-         return(cpd.settings[UO_sp_inside_braces_enum].a);
+         return(cpd->settings[UO_sp_inside_braces_enum].a);
       }
-      else if ((first->parent_type == CT_UNION) ||
-               (first->parent_type == CT_STRUCT))
+      else if ((CTX(first)->parent_type == CT_UNION) ||
+               (CTX(first)->parent_type == CT_STRUCT))
       {
          log_rule("sp_inside_braces_struct");
-         return(cpd.settings[UO_sp_inside_braces_struct].a);
+         return(cpd->settings[UO_sp_inside_braces_struct].a);
       }
       else if (!chunk_is_comment(second))
       {
          log_rule("sp_inside_braces");
-         return(cpd.settings[UO_sp_inside_braces].a);
+         return(cpd->settings[UO_sp_inside_braces].a);
       }
    }
 
    if (second->type == CT_BRACE_CLOSE)
    {
-      if (second->parent_type == CT_ENUM)
+      if (CTX(second)->parent_type == CT_ENUM)
       {
          log_rule("sp_inside_braces_enum");
-         return(cpd.settings[UO_sp_inside_braces_enum].a);
+         return(cpd->settings[UO_sp_inside_braces_enum].a);
       }
-      else if ((second->parent_type == CT_UNION) ||
-               (second->parent_type == CT_STRUCT))
+      else if ((CTX(second)->parent_type == CT_UNION) ||
+               (CTX(second)->parent_type == CT_STRUCT))
       {
          log_rule("sp_inside_braces_struct");
-         return(cpd.settings[UO_sp_inside_braces_struct].a);
+         return(cpd->settings[UO_sp_inside_braces_struct].a);
       }
       log_rule("sp_inside_braces");
-      return(cpd.settings[UO_sp_inside_braces].a);
+      return(cpd->settings[UO_sp_inside_braces].a);
    }
 
    if ((first->type == CT_BRACE_CLOSE) &&
-       (first->flags & PCF_IN_TYPEDEF) &&
-       ((first->parent_type == CT_ENUM) ||
-        (first->parent_type == CT_STRUCT) ||
-        (first->parent_type == CT_UNION)))
+       (CTX(first)->flags & PCF_IN_TYPEDEF) &&
+       ((CTX(first)->parent_type == CT_ENUM) ||
+        (CTX(first)->parent_type == CT_STRUCT) ||
+        (CTX(first)->parent_type == CT_UNION)))
    {
       log_rule("sp_brace_typedef");
-      return(cpd.settings[UO_sp_brace_typedef].a);
+      return(cpd->settings[UO_sp_brace_typedef].a);
    }
 
    if (second->type == CT_SPAREN_OPEN)
    {
       log_rule("sp_before_sparen");
-      return(cpd.settings[UO_sp_before_sparen].a);
+      return(cpd->settings[UO_sp_before_sparen].a);
    }
 
    if ((second->type != CT_PTR_TYPE) &&
        ((first->type == CT_QUALIFIER) || (first->type == CT_TYPE)))
    {
-      arg = cpd.settings[UO_sp_after_type].a;
+      arg = cpd->settings[UO_sp_after_type].a;
       log_rule("sp_after_type");
       return((arg != AV_REMOVE) ? arg : AV_FORCE);
    }
@@ -1129,7 +1185,7 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
       if (second->type == CT_PAREN_OPEN)
       {
          log_rule("sp_func_call_paren");
-         return(cpd.settings[UO_sp_func_call_paren].a);
+         return(cpd->settings[UO_sp_func_call_paren].a);
       }
       log_rule("IGNORE");
       return(AV_IGNORE);
@@ -1145,32 +1201,32 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_NOT)
    {
       log_rule("sp_not");
-      return(cpd.settings[UO_sp_not].a);
+      return(cpd->settings[UO_sp_not].a);
    }
    if (first->type == CT_INV)
    {
       log_rule("sp_inv");
-      return(cpd.settings[UO_sp_inv].a);
+      return(cpd->settings[UO_sp_inv].a);
    }
    if (first->type == CT_ADDR)
    {
       log_rule("sp_addr");
-      return(cpd.settings[UO_sp_addr].a);
+      return(cpd->settings[UO_sp_addr].a);
    }
    if (first->type == CT_DEREF)
    {
       log_rule("sp_deref");
-      return(cpd.settings[UO_sp_deref].a);
+      return(cpd->settings[UO_sp_deref].a);
    }
    if ((first->type == CT_POS) || (first->type == CT_NEG))
    {
       log_rule("sp_sign");
-      return(cpd.settings[UO_sp_sign].a);
+      return(cpd->settings[UO_sp_sign].a);
    }
    if ((first->type == CT_INCDEC_BEFORE) || (second->type == CT_INCDEC_AFTER))
    {
       log_rule("sp_incdec");
-      return(cpd.settings[UO_sp_incdec].a);
+      return(cpd->settings[UO_sp_incdec].a);
    }
    if (second->type == CT_CS_SQ_COLON)
    {
@@ -1185,36 +1241,36 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if (first->type == CT_OC_SCOPE)
    {
       log_rule("sp_after_oc_scope");
-      return(cpd.settings[UO_sp_after_oc_scope].a);
+      return(cpd->settings[UO_sp_after_oc_scope].a);
    }
    if (first->type == CT_OC_COLON)
    {
-      if (first->parent_type == CT_OC_MSG)
+      if (CTX(first)->parent_type == CT_OC_MSG)
       {
          log_rule("sp_after_send_oc_colon");
-         return(cpd.settings[UO_sp_after_send_oc_colon].a);
+         return(cpd->settings[UO_sp_after_send_oc_colon].a);
       }
       else
       {
          log_rule("sp_after_oc_colon");
-         return(cpd.settings[UO_sp_after_oc_colon].a);
+         return(cpd->settings[UO_sp_after_oc_colon].a);
       }
    }
    if (second->type == CT_OC_COLON)
    {
-      if (first->parent_type == CT_OC_MSG)
+      if (CTX(first)->parent_type == CT_OC_MSG)
       {
          log_rule("sp_before_send_oc_colon");
-         return(cpd.settings[UO_sp_before_send_oc_colon].a);
+         return(cpd->settings[UO_sp_before_send_oc_colon].a);
       }
       else
       {
          log_rule("sp_before_oc_colon");
-         return(cpd.settings[UO_sp_before_oc_colon].a);
+         return(cpd->settings[UO_sp_before_oc_colon].a);
       }
    }
 
-   if ((second->type == CT_COMMENT) && (second->parent_type == CT_COMMENT_EMBED))
+   if ((second->type == CT_COMMENT) && (CTX(second)->parent_type == CT_COMMENT_EMBED))
    {
       log_rule("FORCE");
       return(AV_FORCE);
@@ -1223,11 +1279,11 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
    if ((second->type == CT_COMMENT) &&
        ((first->type == CT_PP_ELSE) || (first->type == CT_PP_ENDIF)))
    {
-      if (cpd.settings[UO_sp_endif_cmt].a != AV_IGNORE)
+      if (cpd->settings[UO_sp_endif_cmt].a != AV_IGNORE)
       {
-         second->type = CT_COMMENT_ENDIF;
+         chunk_set_type(CTX(second), CT_COMMENT_ENDIF);
          log_rule("sp_endif_cmt");
-         return(cpd.settings[UO_sp_endif_cmt].a);
+         return(cpd->settings[UO_sp_endif_cmt].a);
       }
    }
 
@@ -1260,6 +1316,109 @@ argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
 }
 
 
+/**
+ * Decides how to change inter-chunk spacing.
+ * Pairs that only depend on the two types are looked up in the space table.
+ *
+ * @param first   The first chunk
+ * @param second  The second chunk
+ * @return        AV_IGNORE, AV_ADD, AV_REMOVE or AV_FORCE
+ */
+argval_t do_space(chunk_t *first, chunk_t *second, bool complete = true)
+{
+   space_table_t *st = cpd->sp_table;
+   int           sp_used;
+   argval_t      av;
+
+   /* The log needs the rule names, so skip the table when logging */
+   if ((st == NULL) || log_sev_on(LSPACE) ||
+       ((unsigned)first->type >= SPT_TYPES) || ((unsigned)second->type >= SPT_TYPES))
+   {
+      return(do_space_rules(first, second, sp_used, complete));
+   }
+
+   UINT8& ent = st->av[first->type][second->type];
+   if ((ent & SPT_PAREN) && sp_paren_paren(first, second))
+   {
+      av = cpd->settings[UO_sp_paren_paren].a;
+   }
+   else if (ent & SPT_KNOWN)
+   {
+      av = (argval_t)(ent & SPT_AV_MASK);
+   }
+   else if (ent == SPT_CTX)
+   {
+      return(do_space_rules(first, second, sp_used, complete));
+   }
+   else
+   {
+      sp_used = 0;
+      av      = do_space_rules(first, second, sp_used, complete);
+      if (sp_used & SPU_CHUNK)
+      {
+         ent = SPT_CTX;
+      }
+      else if (sp_used & SPU_PAREN_HIT)
+      {
+         /* the answer for the other chunks with these types is still unknown */
+         ent = SPT_PAREN;
+      }
+      else
+      {
+         ent = SPT_KNOWN | av | ((sp_used & SPU_PAREN) ? SPT_PAREN : 0);
+      }
+      return(av);
+   }
+
+   if (sp_verify)
+   {
+      sp_used = 0;
+      argval_t rule_av = do_space_rules(first, second, sp_used, complete);
+      if ((sp_used & SPU_CHUNK) || (rule_av != av))
+      {
+         LOG_FMT(LERR, "%s:%d space table has %d for [%s] [%s], the rules say %d%s\n",
+                 cpd->filename, first->orig_line, av,
+                 get_token_name(first->type), get_token_name(second->type),
+                 rule_av, (sp_used & SPU_CHUNK) ? " and depend on more than the types" : "");
+         cpd->error_count++;
+         return(rule_av);
+      }
+   }
+   return(av);
+}
+
+
+void space_table_check(void)
+{
+   space_table_t *st = cpd->sp_table;
+
+   if ((st != NULL) && (memcmp(st->settings, cpd->settings, sizeof(st->settings)) == 0))
+   {
+      return;
+   }
+   if (st == NULL)
+   {
+      st            = new space_table_t;
+      cpd->sp_table = st;
+   }
+   memcpy(st->settings, cpd->settings, sizeof(st->settings));
+   memset(st->av, SPT_UNKNOWN, sizeof(st->av));
+}
+
+
+void space_table_free(void)
+{
+   delete cpd->sp_table;
+   cpd->sp_table = NULL;
+}
+
+
+void space_table_verify(bool verify)
+{
+   sp_verify = verify;
+}
+
+
 /**
  * Marches through the whole file and checks to see how many spaces should be
  * between two chunks
@@ -1343,7 +1502,7 @@ void space_text(void)
                   buf[pc->len + next->len] = 0;
 
                   const chunk_tag_t *ct;
-                  ct = find_punctuator(buf, cpd.lang_flags);
+                  ct = find_punctuator(buf, cpd->lang_flags);
                   if ((ct != NULL) && ((int)strlen(ct->tag) != pc->len))
                   {
                      /* punctuator parsed to a different size.. */
@@ -1396,10 +1555,10 @@ void space_text(void)
              chunk_is_newline(chunk_get_next(next)) &&
              (column < (int)next->orig_col))
          {
-            if ((cpd.settings[UO_sp_endif_cmt].a == AV_IGNORE) ||
+            if ((cpd->settings[UO_sp_endif_cmt].a == AV_IGNORE) ||
                 ((pc->type != CT_PP_ELSE) && (pc->type != CT_PP_ENDIF)))
             {
-               if (cpd.settings[UO_indent_relative_single_line_comments].b)
+               if (cpd->settings[UO_indent_relative_single_line_comments].b)
                {
                   column = pc->column + (next->orig_col - pc->orig_col_end);
                }
@@ -0,0 +1,401 @@
+/**
+ * @file stats.cpp
+ * Per-pass timing and counters for --stats. See stats.h.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "stats.h"
+#include "uncrustify_types.h"
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+/* Indexed by unc_pass_t */
+static const char *pass_names[PASS_COUNT] =
+{
+   "tokenize",
+   "add_file_header",
+   "add_file_footer",
+   "tokenize_cleanup",
+   "brace_cleanup",
+   "chunk_link_matches",
+   "pawn_prescan",
+   "fix_symbols",
+   "mark_comments",
+   "combine_labels",
+   "add_func_header",
+   "do_braces",
+   "remove_extra_semicolons",
+   "remove_extra_returns",
+   "do_parens",
+   "do_blank_lines",
+   "newlines_cleanup_braces",
+   "newline_after_multiline_comment",
+   "newlines_insert_blank_lines",
+   "newlines_chunk_pos",
+   "newlines_class_colon_pos",
+   "newlines_squeeze_ifdef",
+   "newlines_eat_start_end",
+   "newlines_cleanup_dup",
+   "space_text_balance_nested_parens",
+   "pawn_scrub_vsemi",
+   "sort_imports",
+   "space_text",
+   "align_preprocessor",
+   "indent_preproc",
+   "indent_text",
+   "add_long_closebrace_comment",
+   "add_long_preprocessor_conditional_block_comment",
+   "align_all",
+   "do_code_width",
+   "align_right_comments",
+   "align_backslash_newline",
+   "output_text",
+};
+
+struct stats_entry
+{
+   std::string  filename;
+   file_stats_t fs;
+};
+
+/* The files in the report, in the order they were added */
+static std::vector<stats_entry> stats_files;
+
+
+static UINT64 stats_now_ns(void)
+{
+#ifdef WIN32
+   LARGE_INTEGER freq;
+   LARGE_INTEGER now;
+
+   QueryPerformanceFrequency(&freq);
+   QueryPerformanceCounter(&now);
+   return((UINT64)((double)now.QuadPart * 1e9 / (double)freq.QuadPart));
+
+#else
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((UINT64)ts.tv_sec * 1000000000u + ts.tv_nsec);
+#endif
+}
+
+
+static int stats_chunk_count(void)
+{
+   return((int)(cpd->chunks_added - cpd->chunks_deleted));
+}
+
+
+/**
+ * Gets the peak resident size of this process in KB, or 0 if unknown.
+ * With -j, the workers are not included.
+ */
+static int stats_max_rss_kb(void)
+{
+#if defined(__linux__)
+   /* ru_maxrss would include what the parent used before the exec */
+   FILE *pfile = fopen("/proc/self/status", "r");
+   char buf[128];
+   int  kb = 0;
+
+   if (pfile != NULL)
+   {
+      while (fgets(buf, sizeof(buf), pfile) != NULL)
+      {
+         if (sscanf(buf, "VmHWM: %d", &kb) == 1)
+         {
+            break;
+         }
+      }
+      fclose(pfile);
+   }
+   return(kb);
+
+#elif !defined(WIN32)
+   struct rusage usage;
+
+   if (getrusage(RUSAGE_SELF, &usage) != 0)
+   {
+      return(0);
+   }
+#ifdef __APPLE__
+   return((int)(usage.ru_maxrss / 1024));
+
+#else
+   return((int)usage.ru_maxrss);
+#endif
+
+#else
+   return(0);
+#endif
+}
+
+
+void stats_enable(void)
+{
+   if (cpd->stats == NULL)
+   {
+      cpd->stats = new file_stats_t();
+   }
+}
+
+
+void stats_file_begin(int data_len)
+{
+   file_stats_t *fs = cpd->stats;
+
+   if (fs != NULL)
+   {
+      memset(fs, 0, sizeof(*fs));
+      fs->bytes_in = data_len;
+      /* holds the start time until stats_file_end() */
+      fs->time_ns = stats_now_ns();
+   }
+}
+
+
+void stats_file_end(int out_len)
+{
+   file_stats_t *fs = cpd->stats;
+
+   if (fs != NULL)
+   {
+      fs->bytes_out = out_len;
+      fs->time_ns   = stats_now_ns() - fs->time_ns;
+      fs->chunks    = stats_chunk_count();
+   }
+}
+
+
+void stats_pass_begin(pass_mark_t& mark)
+{
+   if (cpd->stats != NULL)
+   {
+      mark.added    = cpd->chunks_added;
+      mark.deleted  = cpd->chunks_deleted;
+      mark.changes  = cpd->changes;
+      mark.start_ns = stats_now_ns();
+   }
+}
+
+
+void stats_pass_end(unc_pass_t pass, const pass_mark_t& mark)
+{
+   if (cpd->stats == NULL)
+   {
+      return;
+   }
+
+   UINT64       now = stats_now_ns();
+   pass_stats_t *ps = &cpd->stats->pass[pass];
+
+   if (ps->calls == 0)
+   {
+      ps->chunks_before = (int)(mark.added - mark.deleted);
+   }
+   ps->calls++;
+   ps->time_ns     += now - mark.start_ns;
+   ps->chunks_after = stats_chunk_count();
+   ps->added       += (int)(cpd->chunks_added - mark.added);
+   ps->deleted     += (int)(cpd->chunks_deleted - mark.deleted);
+   ps->changes     += cpd->changes - mark.changes;
+}
+
+
+void stats_record(const char *filename, const file_stats_t& fs)
+{
+   stats_entry ent;
+
+   ent.filename = (filename != NULL) ? filename : "";
+   ent.fs       = fs;
+   stats_files.push_back(ent);
+}
+
+
+int stats_count(void)
+{
+   return((int)stats_files.size());
+}
+
+
+const file_stats_t *stats_get(int idx)
+{
+   if ((idx < 0) || (idx >= (int)stats_files.size()))
+   {
+      return(NULL);
+   }
+   return(&stats_files[idx].fs);
+}
+
+
+/**
+ * Adds up the files in the report.
+ */
+static void stats_total(file_stats_t& total)
+{
+   memset(&total, 0, sizeof(total));
+   for (int idx = 0; idx < (int)stats_files.size(); idx++)
+   {
+      const file_stats_t& fs = stats_files[idx].fs;
+
+      total.bytes_in  += fs.bytes_in;
+      total.bytes_out += fs.bytes_out;
+      total.time_ns   += fs.time_ns;
+      total.chunks    += fs.chunks;
+      for (int pass = 0; pass < PASS_COUNT; pass++)
+      {
+         pass_stats_t       *tp = &total.pass[pass];
+         const pass_stats_t *ps = &fs.pass[pass];
+
+         tp->calls         += ps->calls;
+         tp->time_ns       += ps->time_ns;
+         tp->chunks_before += ps->chunks_before;
+         tp->chunks_after  += ps->chunks_after;
+         tp->added         += ps->added;
+         tp->deleted       += ps->deleted;
+         tp->changes       += ps->changes;
+      }
+   }
+}
+
+
+static void stats_text(FILE *pfile, const char *name, const file_stats_t& fs)
+{
+   int name_width = 4;
+
+   for (int pass = 0; pass < PASS_COUNT; pass++)
+   {
+      int len = (int)strlen(pass_names[pass]);
+      if ((fs.pass[pass].calls > 0) && (len > name_width))
+      {
+         name_width = len;
+      }
+   }
+
+   fprintf(pfile, "%s: %d bytes in, %d bytes out, %d chunks, %.3f ms\n",
+           name, fs.bytes_in, fs.bytes_out, fs.chunks, fs.time_ns / 1e6);
+   fprintf(pfile, "  %-*s %6s %10s %6s %8s %8s %8s %8s %8s\n",
+           name_width, "pass", "calls", "ms", "%", "before", "after",
+           "added", "deleted", "changes");
+   for (int pass = 0; pass < PASS_COUNT; pass++)
+   {
+      const pass_stats_t *ps = &fs.pass[pass];
+
+      if (ps->calls == 0)
+      {
+         continue;
+      }
+      fprintf(pfile, "  %-*s %6d %10.3f %6.1f %8d %8d %8d %8d %8d\n",
+              name_width, pass_names[pass], ps->calls, ps->time_ns / 1e6,
+              (fs.time_ns != 0) ? (ps->time_ns * 100.0 / fs.time_ns) : 0.0,
+              ps->chunks_before, ps->chunks_after,
+              ps->added, ps->deleted, ps->changes);
+   }
+}
+
+
+static void json_string(FILE *pfile, const char *str)
+{
+   fputc('"', pfile);
+   for ( ; *str != 0; str++)
+   {
+      unsigned char ch = (unsigned char)*str;
+
+      if ((ch == '"') || (ch == '\\'))
+      {
+         fprintf(pfile, "\\%c", ch);
+      }
+      else if (ch < 0x20)
+      {
+         fprintf(pfile, "\\u%04x", ch);
+      }
+      else
+      {
+         fputc(ch, pfile);
+      }
+   }
+   fputc('"', pfile);
+}
+
+
+/**
+ * Prints the members of a file or of the total, without the braces.
+ */
+static void stats_json(FILE *pfile, const file_stats_t& fs)
+{
+   bool first = true;
+
+   fprintf(pfile, "\"bytes_in\": %d, \"bytes_out\": %d, \"chunks\": %d, \"time_ns\": %llu,\n"
+                  "      \"passes\": [",
+           fs.bytes_in, fs.bytes_out, fs.chunks, (unsigned long long)fs.time_ns);
+   for (int pass = 0; pass < PASS_COUNT; pass++)
+   {
+      const pass_stats_t *ps = &fs.pass[pass];
+
+      if (ps->calls == 0)
+      {
+         continue;
+      }
+      fprintf(pfile, "%s\n        { \"pass\": \"%s\", \"calls\": %d, \"time_ns\": %llu, "
+                     "\"chunks_before\": %d, \"chunks_after\": %d, "
+                     "\"added\": %d, \"deleted\": %d, \"changes\": %d }",
+              first ? "" : ",", pass_names[pass], ps->calls,
+              (unsigned long long)ps->time_ns, ps->chunks_before, ps->chunks_after,
+              ps->added, ps->deleted, ps->changes);
+      first = false;
+   }
+   fprintf(pfile, "\n      ]");
+}
+
+
+void stats_report(FILE *pfile, bool json)
+{
+   file_stats_t total;
+   int          idx;
+
+   stats_total(total);
+
+   if (!json)
+   {
+      for (idx = 0; idx < (int)stats_files.size(); idx++)
+      {
+         stats_text(pfile, stats_files[idx].filename.c_str(), stats_files[idx].fs);
+         fputc('\n', pfile);
+      }
+      if (stats_files.size() > 1)
+      {
+         char name[64];
+
+         snprintf(name, sizeof(name), "total (%d files)", (int)stats_files.size());
+         stats_text(pfile, name, total);
+         fputc('\n', pfile);
+      }
+      fprintf(pfile, "peak RSS: %d KB\n", stats_max_rss_kb());
+      fflush(pfile);
+      return;
+   }
+
+   fprintf(pfile, "{\n  \"files\": [");
+   for (idx = 0; idx < (int)stats_files.size(); idx++)
+   {
+      fprintf(pfile, "%s\n    { \"file\": ", (idx == 0) ? "" : ",");
+      json_string(pfile, stats_files[idx].filename.c_str());
+      fprintf(pfile, ",\n      ");
+      stats_json(pfile, stats_files[idx].fs);
+      fprintf(pfile, " }");
+   }
+   fprintf(pfile, "\n  ],\n  \"total\":\n    { \"files\": %d, \"max_rss_kb\": %d,\n      ",
+           (int)stats_files.size(), stats_max_rss_kb());
+   stats_json(pfile, total);
+   fprintf(pfile, " }\n}\n");
+   fflush(pfile);
+}
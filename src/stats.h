@@ -0,0 +1,171 @@
+/**
+ * @file stats.h
+ * Per-pass timing and counters for --stats.
+ *
+ * It works like this:
+ *
+ * 1. Call stats_enable() on the context that formats
+ *
+ * 2. uncrustify_run() wraps each pass with RUN_PASS(), which fills in
+ *    cpd->stats for the file
+ *
+ * 3. Call stats_record() with the file name once the file is done
+ *
+ * 4. Call stats_report() at the end to print each file and the totals
+ *
+ * When the context doesn't have stats, the pass calls do nothing.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#include "base_types.h"
+#include <cstdio>
+
+/**
+ * The passes that are timed, in the order they run
+ */
+enum unc_pass_t
+{
+   PASS_TOKENIZE,
+   PASS_ADD_FILE_HEADER,
+   PASS_ADD_FILE_FOOTER,
+   PASS_TOKENIZE_CLEANUP,
+   PASS_BRACE_CLEANUP,
+   PASS_CHUNK_LINK_MATCHES,
+   PASS_PAWN_PRESCAN,
+   PASS_FIX_SYMBOLS,
+   PASS_MARK_COMMENTS,
+   PASS_COMBINE_LABELS,
+   PASS_ADD_FUNC_HEADER,
+   PASS_DO_BRACES,
+   PASS_REMOVE_EXTRA_SEMICOLONS,
+   PASS_REMOVE_EXTRA_RETURNS,
+   PASS_DO_PARENS,
+   PASS_DO_BLANK_LINES,
+   PASS_NEWLINES_CLEANUP_BRACES,
+   PASS_NEWLINE_AFTER_MULTILINE_COMMENT,
+   PASS_NEWLINES_INSERT_BLANK_LINES,
+   PASS_NEWLINES_CHUNK_POS,
+   PASS_NEWLINES_CLASS_COLON_POS,
+   PASS_NEWLINES_SQUEEZE_IFDEF,
+   PASS_NEWLINES_EAT_START_END,
+   PASS_NEWLINES_CLEANUP_DUP,
+   PASS_SPACE_TEXT_BALANCE_NESTED_PARENS,
+   PASS_PAWN_SCRUB_VSEMI,
+   PASS_SORT_IMPORTS,
+   PASS_SPACE_TEXT,
+   PASS_ALIGN_PREPROCESSOR,
+   PASS_INDENT_PREPROC,
+   PASS_INDENT_TEXT,
+   PASS_ADD_LONG_CLOSEBRACE_COMMENT,
+   PASS_ADD_LONG_PREPROC_COMMENT,
+   PASS_ALIGN_ALL,
+   PASS_DO_CODE_WIDTH,
+   PASS_ALIGN_RIGHT_COMMENTS,
+   PASS_ALIGN_BACKSLASH_NEWLINE,
+   PASS_OUTPUT_TEXT,
+
+   PASS_COUNT
+};
+
+/**
+ * The numbers for one pass. A pass that runs more than once adds up.
+ */
+struct pass_stats_t
+{
+   int    calls;
+   UINT64 time_ns;
+   int    chunks_before;  /* chunk count when first called */
+   int    chunks_after;   /* chunk count after the last call */
+   int    added;          /* chunks inserted */
+   int    deleted;        /* chunks deleted */
+   int    changes;        /* how much cpd->changes went up */
+};
+
+/**
+ * The numbers for one file.
+ * This is plain data, so that a worker can send it through a pipe.
+ */
+struct file_stats_t
+{
+   int          bytes_in;
+   int          bytes_out;
+   UINT64       time_ns;   /* the whole run, including what isn't a pass */
+   int          chunks;    /* chunk count at the end */
+   pass_stats_t pass[PASS_COUNT];
+};
+
+/**
+ * What stats_pass_begin() saves for stats_pass_end()
+ */
+struct pass_mark_t
+{
+   UINT64 start_ns;
+   UINT32 added;
+   UINT32 deleted;
+   int    changes;
+};
+
+
+/**
+ * Gives the current context a file_stats_t, which turns on the counting.
+ */
+void stats_enable(void);
+
+
+/**
+ * Clears cpd->stats for a new file.
+ */
+void stats_file_begin(int data_len);
+
+
+/**
+ * Finishes cpd->stats for the file.
+ */
+void stats_file_end(int out_len);
+
+
+void stats_pass_begin(pass_mark_t& mark);
+
+
+void stats_pass_end(unc_pass_t pass, const pass_mark_t& mark);
+
+/**
+ * Runs one pass of the formatter, adding it to cpd->stats
+ */
+#define RUN_PASS(pass, call)                                                          \
+   do { pass_mark_t mark; stats_pass_begin(mark); call; stats_pass_end(pass, mark); } \
+   while (0)
+
+
+/**
+ * Adds a file to the report.
+ */
+void stats_record(const char *filename, const file_stats_t& fs);
+
+
+/**
+ * Gets the number of files added to the report.
+ */
+int stats_count(void);
+
+
+/**
+ * Gets a file from the report, by index.
+ */
+const file_stats_t *stats_get(int idx);
+
+
+/**
+ * Prints each file in the report and the totals.
+ *
+ * @param pfile  Where to print
+ * @param json   true for JSON, false for text tables
+ */
+void stats_report(FILE *pfile, bool json);
+
+
+#endif /* STATS_H_INCLUDED */
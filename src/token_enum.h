@@ -282,6 +282,8 @@ typedef enum
    /* Vala stuff */
    CT_CONSTRUCT,        /* braced "construct { }" or qualifier "(construct int x)" */
    CT_LAMBDA,
+
+   CT_TOKEN_COUNT       /* the number of token types - must be last */
 } c_token_t;
 
 #endif   /* TOKEN_ENUM_H_INCLUDED */
@@ -11,6 +11,7 @@
 #include "char_table.h"
 #include "prototypes.h"
 #include "chunk_list.h"
+#include "unc_scan.h"
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -55,9 +56,11 @@ static const char *str_search(const char *needle, const char *haystack, int hays
 static bool parse_comment(chunk_t *pc)
 {
    int  len     = 2;
-   bool is_d    = (cpd.lang_flags & LANG_D) != 0;
+   bool is_d    = (cpd->lang_flags & LANG_D) != 0;
    int  d_level = 0;
    int  bs_cnt;
+   int  start;
+   int  end;
 
    if ((pc->str[0] != '/') ||
        ((pc->str[1] != '*') && (pc->str[1] != '/') &&
@@ -67,27 +70,21 @@ static bool parse_comment(chunk_t *pc)
    }
 
    /* account for opening two chars */
-   cpd.column += 2;
+   cpd->column += 2;
 
    if (pc->str[1] == '/')
    {
       pc->type = CT_COMMENT_CPP;
       while (true)
       {
+         start = len;
+         len   = unc_scan_find(&pc->str[len], '\n', '\r') - pc->str;
+
+         /* count the backslashes right before the newline */
          bs_cnt = 0;
-         while ((pc->str[len] != '\n') &&
-                (pc->str[len] != '\r') &&
-                (pc->str[len] != 0))
+         while ((len - bs_cnt > start) && (pc->str[len - bs_cnt - 1] == '\\'))
          {
-            if (pc->str[len] == '\\')
-            {
-               bs_cnt++;
-            }
-            else
-            {
-               bs_cnt = 0;
-            }
-            len++;
+            bs_cnt++;
          }
 
          /* If we hit an odd number of backslashes right before the newline,
@@ -120,16 +117,16 @@ static bool parse_comment(chunk_t *pc)
       {
          if ((pc->str[len] == '+') && (pc->str[len + 1] == '/'))
          {
-            len        += 2;
-            cpd.column += 2;
+            len         += 2;
+            cpd->column += 2;
             d_level--;
             continue;
          }
 
          if ((pc->str[len] == '/') && (pc->str[len + 1] == '+'))
          {
-            len        += 2;
-            cpd.column += 2;
+            len         += 2;
+            cpd->column += 2;
             d_level++;
             continue;
          }
@@ -138,28 +135,28 @@ static bool parse_comment(chunk_t *pc)
          {
             pc->type = CT_COMMENT_MULTI;
             pc->nl_count++;
-            cpd.column = 0;
-            cpd.line_number++;
+            cpd->column = 0;
+            cpd->line_number++;
 
             if (pc->str[len] == '\r')
             {
                if (pc->str[len + 1] == '\n')
                {
-                  cpd.le_counts[LE_CRLF]++;
+                  cpd->le_counts[LE_CRLF]++;
                   len++;
                }
                else
                {
-                  cpd.le_counts[LE_CR]++;
+                  cpd->le_counts[LE_CR]++;
                }
             }
             else
             {
-               cpd.le_counts[LE_LF]++;
+               cpd->le_counts[LE_LF]++;
             }
          }
          len++;
-         cpd.column++;
+         cpd->column++;
       }
    }
    else
@@ -167,10 +164,24 @@ static bool parse_comment(chunk_t *pc)
       pc->type = CT_COMMENT;
       while (pc->str[len + 1] != 0)
       {
+         /* Skip to the next byte that needs a look. The last byte before
+          * the NUL is never looked at. */
+         end = unc_scan_find(&pc->str[len], '*', '\n', '\r') - pc->str;
+         if ((pc->str[end] == 0) && (end > len))
+         {
+            end--;
+         }
+         cpd->column += end - len;
+         len          = end;
+         if (pc->str[len + 1] == 0)
+         {
+            break;
+         }
+
          if ((pc->str[len] == '*') && (pc->str[len + 1] == '/'))
          {
-            len        += 2;
-            cpd.column += 2;
+            len         += 2;
+            cpd->column += 2;
 
             /* If there is another C comment right after this one, combine them */
             int tmp_len = len;
@@ -190,37 +201,37 @@ static bool parse_comment(chunk_t *pc)
          {
             pc->type = CT_COMMENT_MULTI;
             pc->nl_count++;
-            cpd.column = 0;
-            cpd.line_number++;
+            cpd->column = 0;
+            cpd->line_number++;
 
             if (pc->str[len] == '\r')
             {
                if (pc->str[len + 1] == '\n')
                {
-                  cpd.le_counts[LE_CRLF]++;
+                  cpd->le_counts[LE_CRLF]++;
                   len++;
                }
                else
                {
-                  cpd.le_counts[LE_CR]++;
+                  cpd->le_counts[LE_CR]++;
                }
             }
             else
             {
-               cpd.le_counts[LE_LF]++;
+               cpd->le_counts[LE_LF]++;
             }
          }
          len++;
-         cpd.column++;
+         cpd->column++;
       }
    }
    pc->len = len;
-   if (cpd.unc_off)
+   if (cpd->unc_off)
    {
       if (str_search(UNCRUSTIFY_ON_TEXT, pc->str, pc->len) != NULL)
       {
          LOG_FMT(LBCTRL, "Found '%s' on line %d\n", UNCRUSTIFY_ON_TEXT, pc->orig_line);
-         cpd.unc_off = false;
+         cpd->unc_off = false;
       }
    }
    else
@@ -228,7 +239,7 @@ static bool parse_comment(chunk_t *pc)
       if (str_search(UNCRUSTIFY_OFF_TEXT, pc->str, pc->len) != NULL)
       {
          LOG_FMT(LBCTRL, "Found '%s' on line %d\n", UNCRUSTIFY_OFF_TEXT, pc->orig_line);
-         cpd.unc_off = true;
+         cpd->unc_off = true;
       }
    }
    return(true);
@@ -403,9 +414,9 @@ static bool parse_number(chunk_t *pc)
       len++;
    }
 
-   pc->len     = len;
-   pc->type    = is_float ? CT_NUMBER_FP : CT_NUMBER;
-   cpd.column += len;
+   pc->len      = len;
+   pc->type     = is_float ? CT_NUMBER_FP : CT_NUMBER;
+   cpd->column += len;
    return(true);
 }
 
@@ -422,25 +433,37 @@ static bool parse_string(chunk_t *pc, int quote_idx, bool allow_escape)
 {
    bool escaped = 0;
    int  end_ch;
+   int  end;
    int  len          = quote_idx;
-   char escape_char  = cpd.settings[UO_string_escape_char].n;
-   char escape_char2 = cpd.settings[UO_string_escape_char2].n;
+   char escape_char  = cpd->settings[UO_string_escape_char].n;
+   char escape_char2 = cpd->settings[UO_string_escape_char2].n;
 
    pc->type = CT_STRING;
 
    end_ch = CharTable::Get(pc->str[len]) & 0xff;
    len++;
 
-   cpd.column += len;
+   cpd->column += len;
    for (/* nada */; pc->str[len] != 0; len++)
    {
-      cpd.column++;
+      if (!escaped)
+      {
+         /* Skip to the next byte that needs a look */
+         end          = unc_scan_find(&pc->str[len], end_ch, escape_char, escape_char2, '\n', '\r') - pc->str;
+         cpd->column += end - len;
+         len          = end;
+         if (pc->str[len] == 0)
+         {
+            break;
+         }
+      }
+      cpd->column++;
 
       if ((pc->str[len] == '\n') ||
           ((pc->str[len] == '\r') && (pc->str[len + 1] != '\n')))
       {
-         cpd.line_number++;
-         cpd.column = 1;
+         cpd->line_number++;
+         cpd->column = 1;
          pc->nl_count++;
          pc->type = CT_STRING_MULTI;
       }
@@ -468,13 +491,13 @@ static bool parse_string(chunk_t *pc, int quote_idx, bool allow_escape)
    }
 
    /* D can have suffixes */
-   if (((cpd.lang_flags & LANG_D) != 0) &&
+   if (((cpd->lang_flags & LANG_D) != 0) &&
        ((pc->str[len] == 'c') ||
         (pc->str[len] == 'w') ||
         (pc->str[len] == 'd')))
    {
       len++;
-      cpd.column++;
+      cpd->column++;
    }
    pc->len = len;
    return(true);
@@ -509,9 +532,9 @@ static bool parse_cs_string(chunk_t *pc)
       }
    }
 
-   pc->len     = len;
-   pc->type    = CT_STRING;
-   cpd.column += len;
+   pc->len      = len;
+   pc->type     = CT_STRING;
+   cpd->column += len;
    return(true);
 }
 
@@ -532,9 +555,9 @@ bool parse_word(chunk_t *pc, bool skipcheck)
    {
       len++;
    }
-   cpd.column += len;
-   pc->len     = len;
-   pc->type    = CT_WORD;
+   cpd->column += len;
+   pc->len      = len;
+   pc->type     = CT_WORD;
 
    if (skipcheck)
    {
@@ -542,8 +565,8 @@ bool parse_word(chunk_t *pc, bool skipcheck)
    }
 
    /* Detect pre-processor functions now */
-   if ((cpd.in_preproc == CT_PP_DEFINE) &&
-       (cpd.preproc_ncnl_count == 1))
+   if ((cpd->in_preproc == CT_PP_DEFINE) &&
+       (cpd->preproc_ncnl_count == 1))
    {
       if (pc->str[len] == '(')
       {
@@ -576,6 +599,7 @@ static bool parse_whitespace(chunk_t *pc)
    int  len          = 0;
    int  nl_count     = 0;
    bool last_was_tab = false;
+   int  end;
 
    while ((pc->str[len] != 0) &&
           ((pc->str[len] <= ' ') || (pc->str[len] >= 127)))
@@ -588,34 +612,36 @@ static bool parse_whitespace(chunk_t *pc)
          {
             /* CRLF ending */
             len++;
-            cpd.le_counts[LE_CRLF]++;
+            cpd->le_counts[LE_CRLF]++;
          }
          else
          {
             /* CR ending */
-            cpd.le_counts[LE_CR]++;
+            cpd->le_counts[LE_CR]++;
          }
          nl_count++;
-         cpd.column = 1;
-         cpd.line_number++;
+         cpd->column = 1;
+         cpd->line_number++;
          break;
 
       case '\n':
          /* LF ending */
-         cpd.le_counts[LE_LF]++;
+         cpd->le_counts[LE_LF]++;
          nl_count++;
-         cpd.column = 1;
-         cpd.line_number++;
+         cpd->column = 1;
+         cpd->line_number++;
          break;
 
       case '\t':
-         cpd.column = calc_next_tab_column(cpd.column,
-                                           cpd.settings[UO_input_tab_size].n);
+         cpd->column = calc_next_tab_column(cpd->column,
+                                            cpd->settings[UO_input_tab_size].n);
          last_was_tab = true;
          break;
 
       case ' ':
-         cpd.column++;
+         end          = unc_scan_skip(&pc->str[len], ' ') - pc->str;
+         cpd->column += end - len;
+         len          = end - 1;
          break;
 
       default:
@@ -741,15 +767,15 @@ static bool parse_ignored(chunk_t *pc)
    }
    if (nl_count > 0)
    {
-      cpd.column       = 1;
-      cpd.line_number += nl_count;
-      pc->nl_count     = nl_count;
-      pc->type         = CT_NEWLINE;
+      cpd->column       = 1;
+      cpd->line_number += nl_count;
+      pc->nl_count      = nl_count;
+      pc->type          = CT_NEWLINE;
       return(true);
    }
 
    /* Look for the ending comment and let it pass */
-   if (parse_comment(pc) && !cpd.unc_off)
+   if (parse_comment(pc) && !cpd->unc_off)
    {
       return(true);
    }
@@ -793,16 +819,16 @@ static bool parse_next(chunk_t *pc)
    }
 
    /* Save off the current column */
-   pc->orig_line = cpd.line_number;
-   pc->column    = cpd.column;
-   pc->orig_col  = cpd.column;
+   pc->orig_line = cpd->line_number;
+   pc->column    = cpd->column;
+   pc->orig_col  = cpd->column;
    pc->len       = 0;
    pc->type      = CT_NONE;
    pc->nl_count  = 0;
    pc->flags     = 0;
 
    /* If it is turned off, we put everything except newlines into CT_UNKNOWN */
-   if (cpd.unc_off)
+   if (cpd->unc_off)
    {
       if (parse_ignored(pc))
       {
@@ -829,20 +855,25 @@ static bool parse_next(chunk_t *pc)
    /**
     *  Handle unknown/unhandled preprocessors
     */
-   if ((cpd.in_preproc > CT_PP_BODYCHUNK) &&
-       (cpd.in_preproc <= CT_PP_OTHER))
+   if ((cpd->in_preproc > CT_PP_BODYCHUNK) &&
+       (cpd->in_preproc <= CT_PP_OTHER))
    {
       /* Chunk to a newline or comment */
       pc->type = CT_PREPROC_BODY;
-      char last = 0;
-      while (pc->str[pc->len] != 0)
+      while (true)
       {
+         pc->len = unc_scan_find(&pc->str[pc->len], '\n', '\r', '/') - pc->str;
          char ch = pc->str[pc->len];
 
+         if (ch == 0)
+         {
+            break;
+         }
+
          if ((ch == '\n') || (ch == '\r'))
          {
             /* Back off if this is an escaped newline */
-            if (last == '\\')
+            if ((pc->len > 0) && (pc->str[pc->len - 1] == '\\'))
             {
                pc->len--;
             }
@@ -850,11 +881,10 @@ static bool parse_next(chunk_t *pc)
          }
 
          /* Quit on a C++ comment start */
-         if ((ch == '/') && (pc->str[pc->len + 1] == '/'))
+         if (pc->str[pc->len + 1] == '/')
          {
             break;
          }
-         last = ch;
          pc->len++;
       }
       if (pc->len > 0)
@@ -870,8 +900,8 @@ static bool parse_next(chunk_t *pc)
     */
    if ((pc->str[0] == '\\') && parse_bs_newline(pc))
    {
-      cpd.column = 1;
-      cpd.line_number++;
+      cpd->column = 1;
+      cpd->line_number++;
       return(true);
    }
 
@@ -884,7 +914,7 @@ static bool parse_next(chunk_t *pc)
    }
 
    /* Check for C# literal strings, ie @"hello" */
-   if (((cpd.lang_flags & LANG_CS) != 0) && (*pc->str == '@'))
+   if (((cpd->lang_flags & LANG_CS) != 0) && (*pc->str == '@'))
    {
       if (pc->str[1] == '"')
       {
@@ -898,7 +928,7 @@ static bool parse_next(chunk_t *pc)
    }
 
    /* Check for Obj-C NSString constants, ie @"hello" */
-   if (((cpd.lang_flags & LANG_OC) != 0) && (*pc->str == '@'))
+   if (((cpd->lang_flags & LANG_OC) != 0) && (*pc->str == '@'))
    {
       if (pc->str[1] == '"')
       {
@@ -908,7 +938,7 @@ static bool parse_next(chunk_t *pc)
    }
 
    /* PAWN specific stuff */
-   if ((cpd.lang_flags & LANG_PAWN) != 0)
+   if ((cpd->lang_flags & LANG_PAWN) != 0)
    {
       /* Check for PAWN strings: \"hi" or !"hi" or !\"hi" or \!"hi" */
       if ((pc->str[0] == '\\') || (pc->str[0] == '!'))
@@ -936,7 +966,7 @@ static bool parse_next(chunk_t *pc)
       return(true);
    }
 
-   if ((cpd.lang_flags & LANG_D) != 0)
+   if ((cpd->lang_flags & LANG_D) != 0)
    {
       /* D specific stuff */
       if (d_parse_string(pc))
@@ -953,13 +983,13 @@ static bool parse_next(chunk_t *pc)
            ((pc->str[1] == '"') || (pc->str[1] == '\''))) ||
           (*pc->str == '"') ||
           (*pc->str == '\'') ||
-          ((*pc->str == '<') && (cpd.in_preproc == CT_PP_INCLUDE)))
+          ((*pc->str == '<') && (cpd->in_preproc == CT_PP_INCLUDE)))
       {
          parse_string(pc, unc_isalpha(*pc->str) ? 1 : 0, true);
          return(true);
       }
 
-      if ((*pc->str == '<') && (cpd.in_preproc == CT_PP_DEFINE))
+      if ((*pc->str == '<') && (cpd->in_preproc == CT_PP_DEFINE))
       {
          if (chunk_get_tail()->type == CT_MACRO)
          {
@@ -983,12 +1013,12 @@ static bool parse_next(chunk_t *pc)
       return(true);
    }
 
-   if ((punc = find_punctuator(pc->str, cpd.lang_flags)) != NULL)
+   if ((punc = find_punctuator(pc->str, cpd->lang_flags)) != NULL)
    {
-      pc->type    = punc->type;
-      pc->len     = strlen(punc->tag);
-      cpd.column += pc->len;
-      pc->flags  |= PCF_PUNCTUATOR;
+      pc->type     = punc->type;
+      pc->len      = strlen(punc->tag);
+      cpd->column += pc->len;
+      pc->flags   |= PCF_PUNCTUATOR;
       return(true);
    }
 
@@ -998,8 +1028,8 @@ static bool parse_next(chunk_t *pc)
    pc->len  = 1;
 
    LOG_FMT(LWARN, "%s:%d Garbage in col %d: %x\n",
-           cpd.filename, pc->orig_line, cpd.column, *pc->str);
-   cpd.error_count++;
+           cpd->filename, pc->orig_line, cpd->column, *pc->str);
+   cpd->error_count++;
    return(true);
 }
 
@@ -1017,19 +1047,17 @@ static bool parse_next(chunk_t *pc)
  */
 void tokenize(const char *data, int data_len, chunk_t *ref)
 {
-   int                idx = 0;
-   chunk_t            chunk;
-   chunk_t            *pc    = NULL;
-   chunk_t            *rprev = NULL;
-   chunk_t            *prev  = NULL;
-   struct parse_frame frm;
-   bool               last_was_tab = false;
-
-   memset(&frm, 0, sizeof(frm));
+   int     idx = 0;
+   chunk_t chunk;
+   chunk_t *pc          = NULL;
+   chunk_t *rprev       = NULL;
+   chunk_t *prev        = NULL;
+   bool    last_was_tab = false;
+
    memset(&chunk, 0, sizeof(chunk));
 
-   cpd.line_number = 1;
-   cpd.column      = 1;
+   cpd->line_number = 1;
+   cpd->column      = 1;
 
    while (idx < data_len)
    {
@@ -1037,8 +1065,8 @@ void tokenize(const char *data, int data_len, chunk_t *ref)
       if (!parse_next(&chunk))
       {
          LOG_FMT(LERR, "%s:%d Bailed before the end?\n",
-                 cpd.filename, cpd.line_number);
-         cpd.error_count++;
+                 cpd->filename, cpd->line_number);
+         cpd->error_count++;
          break;
       }
 
@@ -1054,7 +1082,7 @@ void tokenize(const char *data, int data_len, chunk_t *ref)
 
       if (chunk.type == CT_SOF)
       {
-         cpd.bom = chunk_dup(&chunk);
+         cpd->bom = chunk_dup(&chunk);
          continue;
       }
 
@@ -1086,7 +1114,7 @@ void tokenize(const char *data, int data_len, chunk_t *ref)
       }
 
       /* Store off the end column */
-      chunk.orig_col_end = cpd.column;
+      chunk.orig_col_end = cpd->column;
 
       /* Add the chunk to the list */
       rprev = pc;
@@ -1117,29 +1145,29 @@ void tokenize(const char *data, int data_len, chunk_t *ref)
       /* A newline marks the end of a preprocessor */
       if (pc->type == CT_NEWLINE) // || (pc->type == CT_COMMENT_MULTI))
       {
-         cpd.in_preproc         = CT_NONE;
-         cpd.preproc_ncnl_count = 0;
+         cpd->in_preproc         = CT_NONE;
+         cpd->preproc_ncnl_count = 0;
       }
 
       /* Special handling for preprocessor stuff */
-      if (cpd.in_preproc != CT_NONE)
+      if (cpd->in_preproc != CT_NONE)
       {
          pc->flags |= PCF_IN_PREPROC;
 
          /* Count words after the preprocessor */
          if (!chunk_is_comment(pc) && !chunk_is_newline(pc))
          {
-            cpd.preproc_ncnl_count++;
+            cpd->preproc_ncnl_count++;
          }
 
          /* Figure out the type of preprocessor for #include parsing */
-         if (cpd.in_preproc == CT_PREPROC)
+         if (cpd->in_preproc == CT_PREPROC)
          {
             if ((pc->type < CT_PP_DEFINE) || (pc->type > CT_PP_OTHER))
             {
-               pc->type = CT_PP_OTHER;
+               chunk_set_type(pc, CT_PP_OTHER);
             }
-            cpd.in_preproc = pc->type;
+            cpd->in_preproc = pc->type;
          }
       }
       else
@@ -1148,36 +1176,36 @@ void tokenize(const char *data, int data_len, chunk_t *ref)
          if ((pc->type == CT_POUND) &&
              ((rprev == NULL) || (rprev->type == CT_NEWLINE)))
          {
-            pc->type       = CT_PREPROC;
-            pc->flags     |= PCF_IN_PREPROC;
-            cpd.in_preproc = CT_PREPROC;
+            chunk_set_type(pc, CT_PREPROC);
+            pc->flags      |= PCF_IN_PREPROC;
+            cpd->in_preproc = CT_PREPROC;
          }
       }
    }
 
-   /* Set the cpd.newline string for this file */
-   if ((cpd.settings[UO_newlines].le == LE_LF) ||
-       ((cpd.settings[UO_newlines].le == LE_AUTO) &&
-        (cpd.le_counts[LE_LF] >= cpd.le_counts[LE_CRLF]) &&
-        (cpd.le_counts[LE_LF] >= cpd.le_counts[LE_CR])))
+   /* Set the cpd->newline string for this file */
+   if ((cpd->settings[UO_newlines].le == LE_LF) ||
+       ((cpd->settings[UO_newlines].le == LE_AUTO) &&
+        (cpd->le_counts[LE_LF] >= cpd->le_counts[LE_CRLF]) &&
+        (cpd->le_counts[LE_LF] >= cpd->le_counts[LE_CR])))
    {
       /* LF line ends */
-      strcpy(cpd.newline, "\n");
+      strcpy(cpd->newline, "\n");
       LOG_FMT(LLINEENDS, "Using LF line endings\n");
    }
-   else if ((cpd.settings[UO_newlines].le == LE_CRLF) ||
-            ((cpd.settings[UO_newlines].le == LE_AUTO) &&
-             (cpd.le_counts[LE_CRLF] >= cpd.le_counts[LE_LF]) &&
-             (cpd.le_counts[LE_CRLF] >= cpd.le_counts[LE_CR])))
+   else if ((cpd->settings[UO_newlines].le == LE_CRLF) ||
+            ((cpd->settings[UO_newlines].le == LE_AUTO) &&
+             (cpd->le_counts[LE_CRLF] >= cpd->le_counts[LE_LF]) &&
+             (cpd->le_counts[LE_CRLF] >= cpd->le_counts[LE_CR])))
    {
       /* CRLF line ends */
-      strcpy(cpd.newline, "\r\n");
+      strcpy(cpd->newline, "\r\n");
       LOG_FMT(LLINEENDS, "Using CRLF line endings\n");
    }
    else
    {
       /* CR line ends */
-      strcpy(cpd.newline, "\r");
+      strcpy(cpd->newline, "\r");
       LOG_FMT(LLINEENDS, "Using CR line endings\n");
    }
 }
@@ -34,17 +34,17 @@ void tokenize_cleanup(void)
       /* Change '[' + ']' into '[]' */
       if ((pc->type == CT_SQUARE_OPEN) && (next->type == CT_SQUARE_CLOSE))
       {
-         pc->type = CT_TSQUARE;
-         pc->str  = "[]";
-         pc->len  = 2;
+         chunk_set_type(pc, CT_TSQUARE);
+         pc->str = "[]";
+         pc->len = 2;
          chunk_del(next);
          pc->orig_col_end += 1;
          next              = chunk_get_next_ncnl(pc);
       }
 
-      if ((pc->type == CT_DOT) && ((cpd.lang_flags & LANG_ALLC) != 0))
+      if ((pc->type == CT_DOT) && ((cpd->lang_flags & LANG_ALLC) != 0))
       {
-         pc->type = CT_MEMBER;
+         chunk_set_type(pc, CT_MEMBER);
       }
 
       /* Determine the version stuff (D only) */
@@ -52,17 +52,17 @@ void tokenize_cleanup(void)
       {
          if (next->type == CT_PAREN_OPEN)
          {
-            pc->type = CT_IF;
+            chunk_set_type(pc, CT_IF);
          }
          else
          {
             if (next->type != CT_ASSIGN)
             {
                LOG_FMT(LERR, "%s:%d %s: version: Unexpected token %s\n",
-                       cpd.filename, pc->orig_line, __func__, get_token_name(next->type));
-               cpd.error_count++;
+                       cpd->filename, pc->orig_line, __func__, get_token_name(next->type));
+               cpd->error_count++;
             }
-            pc->type = CT_WORD;
+            chunk_set_type(pc, CT_WORD);
          }
       }
 
@@ -73,7 +73,7 @@ void tokenize_cleanup(void)
        */
       if ((pc->type == CT_BASE) && (next->type == CT_PAREN_OPEN))
       {
-         pc->type = CT_WORD;
+         chunk_set_type(pc, CT_WORD);
       }
 
       /**
@@ -86,11 +86,11 @@ void tokenize_cleanup(void)
              (pc->type == CT_UNION) ||
              (pc->type == CT_STRUCT))
          {
-            next->type = CT_TYPE;
+            chunk_set_type(next, CT_TYPE);
          }
          if (pc->type == CT_WORD)
          {
-            pc->type = CT_TYPE;
+            chunk_set_type(pc, CT_TYPE);
          }
       }
 
@@ -113,7 +113,7 @@ void tokenize_cleanup(void)
             tmp = chunk_get_next_ncnl(next);
             if ((tmp != NULL) || (tmp->type != CT_BRACE_OPEN))
             {
-               pc->type = CT_QUALIFIER;
+               chunk_set_type(pc, CT_QUALIFIER);
             }
          }
       }
@@ -127,7 +127,7 @@ void tokenize_cleanup(void)
            (pc->type == CT_QUALIFIER) ||
            (pc->type == CT_PTR_TYPE)))
       {
-         next->type = CT_PTR_TYPE;
+         chunk_set_type(next, CT_PTR_TYPE);
       }
 
       if ((pc->type == CT_TYPE_CAST) &&
@@ -144,7 +144,7 @@ void tokenize_cleanup(void)
       {
          if (pc->flags & PCF_IN_PREPROC)
          {
-            pc->type = CT_COMPARE;
+            chunk_set_type(pc, CT_COMPARE);
          }
          else
          {
@@ -160,11 +160,11 @@ void tokenize_cleanup(void)
          }
          else
          {
-            pc->type = CT_COMPARE;
+            chunk_set_type(pc, CT_COMPARE);
          }
       }
 
-      if ((cpd.lang_flags & LANG_D) != 0)
+      if ((cpd->lang_flags & LANG_D) != 0)
       {
          /* Check for the D string concat symbol '~' */
          if ((pc->type == CT_INV) &&
@@ -172,7 +172,7 @@ void tokenize_cleanup(void)
               (prev->type == CT_WORD) ||
               (next->type == CT_STRING)))
          {
-            pc->type = CT_CONCAT;
+            chunk_set_type(pc, CT_CONCAT);
          }
 
          /* Check for the D template symbol '!' */
@@ -180,16 +180,16 @@ void tokenize_cleanup(void)
              (prev->type == CT_WORD) &&
              (next->type == CT_PAREN_OPEN))
          {
-            pc->type = CT_D_TEMPLATE;
+            chunk_set_type(pc, CT_D_TEMPLATE);
          }
       }
 
-      if ((cpd.lang_flags & LANG_CPP) != 0)
+      if ((cpd->lang_flags & LANG_CPP) != 0)
       {
          /* Change Word before '::' into a type */
          if ((pc->type == CT_WORD) && (next->type == CT_DC_MEMBER))
          {
-            pc->type = CT_TYPE;
+            chunk_set_type(pc, CT_TYPE);
          }
       }
 
@@ -201,12 +201,12 @@ void tokenize_cleanup(void)
               (prev->type == CT_BRACE_OPEN) ||
               (prev->type == CT_SEMICOLON)))
          {
-            pc->type          = CT_GETSET_EMPTY;
+            chunk_set_type(pc, CT_GETSET_EMPTY);
             next->parent_type = CT_GETSET;
          }
          else
          {
-            pc->type = CT_WORD;
+            chunk_set_type(pc, CT_WORD);
          }
       }
 
@@ -221,9 +221,9 @@ void tokenize_cleanup(void)
             tmp = chunk_get_next(next);
             if ((tmp != NULL) && (tmp->type == CT_PAREN_CLOSE))
             {
-               next->str         = "()";
-               next->len         = 2;
-               next->type        = CT_FUNCTION;
+               next->str = "()";
+               next->len = 2;
+               chunk_set_type(next, CT_FUNCTION);
                next->parent_type = CT_OPERATOR;
                chunk_del(tmp);
                next->orig_col_end += 1;
@@ -271,14 +271,14 @@ void tokenize_cleanup(void)
 
                LOG_FMT(LOPERATOR, " [%.*s]", tmp2->len, tmp2->str);
 
-               tmp2->type        = CT_FUNCTION;
+               chunk_set_type(tmp2, CT_FUNCTION);
                tmp2->parent_type = CT_OPERATOR;
             }
             LOG_FMT(LOPERATOR, "\n");
          }
          if (chunk_is_addr(prev))
          {
-            prev->type = CT_BYREF;
+            chunk_set_type(prev, CT_BYREF);
          }
       }
 
@@ -296,7 +296,7 @@ void tokenize_cleanup(void)
          }
          if (next->type == CT_COLON)
          {
-            next->type = CT_PRIVATE_COLON;
+            chunk_set_type(next, CT_PRIVATE_COLON);
             if ((tmp = chunk_get_next_ncnl(next)) != NULL)
             {
                tmp->flags |= PCF_STMT_START | PCF_EXPR_START;
@@ -304,7 +304,7 @@ void tokenize_cleanup(void)
          }
          else
          {
-            pc->type = chunk_is_str(pc, "signals", 7) ? CT_WORD : CT_QUALIFIER;
+            chunk_set_type(pc, chunk_is_str(pc, "signals", 7) ? CT_WORD : CT_QUALIFIER);
          }
       }
 
@@ -317,15 +317,15 @@ void tokenize_cleanup(void)
             tmp = chunk_get_next(next);
             if (chunk_is_str_case(tmp, "BEGIN", 5))
             {
-               pc->type = CT_SQL_BEGIN;
+               chunk_set_type(pc, CT_SQL_BEGIN);
             }
             else if (chunk_is_str_case(tmp, "END", 3))
             {
-               pc->type = CT_SQL_END;
+               chunk_set_type(pc, CT_SQL_END);
             }
             else
             {
-               pc->type = CT_SQL_EXEC;
+               chunk_set_type(pc, CT_SQL_EXEC);
             }
 
             /* Change words into CT_SQL_WORD until CT_SEMICOLON */
@@ -337,7 +337,7 @@ void tokenize_cleanup(void)
                }
                if ((tmp->len > 0) && isalpha(*tmp->str))
                {
-                  tmp->type = CT_SQL_WORD;
+                  chunk_set_type(tmp, CT_SQL_WORD);
                }
                tmp = chunk_get_next_ncnl(tmp);
             }
@@ -347,7 +347,7 @@ void tokenize_cleanup(void)
       /* Detect Objective C class name */
       if ((pc->type == CT_OC_IMPL) || (pc->type == CT_OC_INTF))
       {
-         next->type        = CT_OC_CLASS;
+         chunk_set_type(next, CT_OC_CLASS);
          next->parent_type = pc->type;
 
          tmp = chunk_get_next_ncnl(next);
@@ -385,7 +385,7 @@ void tokenize_cleanup(void)
             }
             else
             {
-               tmp->type        = CT_OC_CATEGORY;
+               chunk_set_type(tmp, CT_OC_CATEGORY);
                tmp->parent_type = pc->parent_type;
             }
          }
@@ -457,7 +457,7 @@ void tokenize_cleanup(void)
          tmp = chunk_get_next(next);
          if (tmp != NULL)
          {
-            tmp->type        = CT_OC_SEL_NAME;
+            chunk_set_type(tmp, CT_OC_SEL_NAME);
             tmp->parent_type = pc->type;
 
             while ((tmp = chunk_get_next_ncnl(tmp)) != NULL)
@@ -467,7 +467,7 @@ void tokenize_cleanup(void)
                   tmp->parent_type = CT_OC_SEL;
                   break;
                }
-               tmp->type        = CT_OC_SEL_NAME;
+               chunk_set_type(tmp, CT_OC_SEL_NAME);
                tmp->parent_type = pc->type;
             }
          }
@@ -483,14 +483,14 @@ void tokenize_cleanup(void)
        *
        *  See http://developer.apple.com/mac/library/documentation/Cocoa/Conceptual/Blocks for more info...
        */
-      if ((cpd.lang_flags & LANG_OC) &&
+      if ((cpd->lang_flags & LANG_OC) &&
           (pc->type == CT_ARITH) &&
           (chunk_is_str(pc, "^", 1)) &&
           (prev->type != CT_NUMBER) &&
           (prev->type != CT_NUMBER_FP))
       {
          /* mark objc blocks caret so that we can process it later*/
-         pc->type = CT_OC_BLOCK_CARET;
+         chunk_set_type(pc, CT_OC_BLOCK_CARET);
 
          if (prev->type == CT_PAREN_OPEN)
          {
@@ -546,14 +546,14 @@ void tokenize_cleanup(void)
          if ((memcmp(next->str, "region", 6) == 0) ||
              (memcmp(next->str, "endregion", 9) == 0))
          {
-            pc->type = (*next->str == 'r') ? CT_PP_REGION : CT_PP_ENDREGION;
+            chunk_set_type(pc, (*next->str == 'r') ? CT_PP_REGION : CT_PP_ENDREGION);
 
             prev->parent_type = pc->type;
          }
       }
 
       /* Check for C# nullable types '?' is in next */
-      if ((cpd.lang_flags & LANG_CS) &&
+      if ((cpd->lang_flags & LANG_CS) &&
           (next->type == CT_QUESTION) &&
           (next->orig_col == (pc->orig_col + pc->len)))
       {
@@ -585,7 +585,7 @@ void tokenize_cleanup(void)
       }
 
       /* Convert '>' + '>' into '>>' */
-      if ((cpd.lang_flags & LANG_CS) &&
+      if ((cpd->lang_flags & LANG_CS) &&
           (pc->type == CT_ANGLE_CLOSE) &&
           (next->type == CT_ANGLE_CLOSE) &&
           (pc->parent_type == CT_NONE) &&
@@ -593,23 +593,23 @@ void tokenize_cleanup(void)
           (next->parent_type == CT_NONE))
       {
          pc->len++;
-         pc->type = CT_ARITH;
-         tmp      = chunk_get_next_ncnl(next);
+         chunk_set_type(pc, CT_ARITH);
+         tmp = chunk_get_next_ncnl(next);
          chunk_del(next);
          next = tmp;
       }
 
       /* Change 'default(' into a sizeof-like statement */
-      if ((cpd.lang_flags & LANG_CS) &&
+      if ((cpd->lang_flags & LANG_CS) &&
           (pc->type == CT_DEFAULT) &&
           (next->type == CT_PAREN_OPEN))
       {
-         pc->type = CT_SIZEOF;
+         chunk_set_type(pc, CT_SIZEOF);
       }
 
       if ((pc->type == CT_UNSAFE) && (next->type != CT_BRACE_OPEN))
       {
-         pc->type = CT_QUALIFIER;
+         chunk_set_type(pc, CT_QUALIFIER);
       }
 
       /* TODO: determine other stuff here */
@@ -679,7 +679,7 @@ static void check_template(chunk_t *start)
       if ((prev->type != CT_WORD) && (prev->type != CT_TYPE) && (prev->parent_type != CT_OPERATOR))
       {
          LOG_FMT(LTEMPL, " - after %s + ( - Not a template\n", get_token_name(prev->type));
-         start->type = CT_COMPARE;
+         chunk_set_type(start, CT_COMPARE);
          return;
       }
 
@@ -705,7 +705,7 @@ static void check_template(chunk_t *start)
          if (pc->type == CT_SQUARE_OPEN)
          {
             LOG_FMT(LTEMPL, " - Not a template: after a square open\n");
-            start->type = CT_COMPARE;
+            chunk_set_type(start, CT_COMPARE);
             return;
          }
       }
@@ -799,5 +799,5 @@ static void check_template(chunk_t *start)
 
    LOG_FMT(LTEMPL, " - Not a template: end = %s\n",
            (end != NULL) ? get_token_name(end->type) : "<null>");
-   start->type = CT_COMPARE;
+   chunk_set_type(start, CT_COMPARE);
 }
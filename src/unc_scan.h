@@ -0,0 +1,161 @@
+/**
+ * @file unc_scan.h
+ * Scanning kernels for the tokenizer, which look at 16 (SSE2) or 32 (AVX2)
+ * bytes at a time. Other CPUs use plain loops.
+ *
+ * The text must be NUL terminated, and every scan stops at the NUL.
+ * The vector loops only use aligned loads, so they may look at a few bytes
+ * before the start or after the NUL, but never past the page that holds
+ * them.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#ifndef UNC_SCAN_H_INCLUDED
+#define UNC_SCAN_H_INCLUDED
+
+#include "base_types.h"
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UNC_SCAN_VECTOR
+#define SCAN_WIDTH    32
+#define SCAN_ALL      0xffffffffu
+typedef __m256i   scan_vec_t;
+#define scan_load(ptr)        _mm256_load_si256((const __m256i *)(ptr))
+#define scan_set1(ch)         _mm256_set1_epi8(ch)
+#define scan_cmpeq(v1, v2)    _mm256_cmpeq_epi8(v1, v2)
+#define scan_or(v1, v2)       _mm256_or_si256(v1, v2)
+#define scan_movemask(vec)    ((UINT32)_mm256_movemask_epi8(vec))
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define UNC_SCAN_VECTOR
+#define SCAN_WIDTH    16
+#define SCAN_ALL      0xffffu
+typedef __m128i   scan_vec_t;
+#define scan_load(ptr)        _mm_load_si128((const __m128i *)(ptr))
+#define scan_set1(ch)         _mm_set1_epi8(ch)
+#define scan_cmpeq(v1, v2)    _mm_cmpeq_epi8(v1, v2)
+#define scan_or(v1, v2)       _mm_or_si128(v1, v2)
+#define scan_movemask(vec)    ((UINT32)_mm_movemask_epi8(vec))
+#endif
+
+#if defined(UNC_SCAN_VECTOR) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+#ifdef UNC_SCAN_VECTOR
+
+/**
+ * Returns the index of the lowest set bit. mask must not be 0.
+ */
+static_inline int scan_first_bit(UINT32 mask)
+{
+#ifdef _MSC_VER
+   unsigned long idx;
+
+   _BitScanForward(&idx, mask);
+   return((int)idx);
+
+#else
+   return(__builtin_ctz(mask));
+#endif
+}
+
+
+/**
+ * Returns the aligned block that holds str.
+ */
+static_inline const char *scan_block(const char *str)
+{
+   return((const char *)((size_t)str & ~(size_t)(SCAN_WIDTH - 1)));
+}
+
+
+#endif /* UNC_SCAN_VECTOR */
+
+
+/**
+ * Finds the first byte that is NUL or one of the chars.
+ * Unused chars should be left as 0.
+ *
+ * @param str  The text to scan
+ * @return     Points to the byte found
+ */
+static_inline const char *unc_scan_find(const char *str, char c1, char c2 = 0,
+                                        char c3 = 0, char c4 = 0, char c5 = 0)
+{
+#ifdef UNC_SCAN_VECTOR
+   const scan_vec_t v0   = scan_set1(0);
+   const scan_vec_t v1   = scan_set1(c1);
+   const scan_vec_t v2   = scan_set1(c2);
+   const scan_vec_t v3   = scan_set1(c3);
+   const scan_vec_t v4   = scan_set1(c4);
+   const scan_vec_t v5   = scan_set1(c5);
+   const char       *blk = scan_block(str);
+   scan_vec_t       data;
+   UINT32           mask;
+
+   data = scan_load(blk);
+   mask = scan_movemask(scan_or(scan_or(scan_or(scan_cmpeq(data, v0), scan_cmpeq(data, v1)),
+                                        scan_or(scan_cmpeq(data, v2), scan_cmpeq(data, v3))),
+                                scan_or(scan_cmpeq(data, v4), scan_cmpeq(data, v5))));
+   /* ignore the bytes before str */
+   mask &= SCAN_ALL << (str - blk);
+   while (mask == 0)
+   {
+      blk += SCAN_WIDTH;
+      data = scan_load(blk);
+      mask = scan_movemask(scan_or(scan_or(scan_or(scan_cmpeq(data, v0), scan_cmpeq(data, v1)),
+                                           scan_or(scan_cmpeq(data, v2), scan_cmpeq(data, v3))),
+                                   scan_or(scan_cmpeq(data, v4), scan_cmpeq(data, v5))));
+   }
+   return(blk + scan_first_bit(mask));
+
+#else
+   while ((*str != 0) && (*str != c1) && (*str != c2) &&
+          (*str != c3) && (*str != c4) && (*str != c5))
+   {
+      str++;
+   }
+   return(str);
+#endif
+}
+
+
+/**
+ * Finds the first byte that isn't ch, which may be the NUL.
+ *
+ * @param str  The text to scan
+ * @param ch   The char to skip, not 0
+ * @return     Points to the byte found
+ */
+static_inline const char *unc_scan_skip(const char *str, char ch)
+{
+#ifdef UNC_SCAN_VECTOR
+   const scan_vec_t vch  = scan_set1(ch);
+   const char       *blk = scan_block(str);
+   UINT32           mask;
+
+   mask  = ~scan_movemask(scan_cmpeq(scan_load(blk), vch)) & SCAN_ALL;
+   mask &= SCAN_ALL << (str - blk);
+   while (mask == 0)
+   {
+      blk += SCAN_WIDTH;
+      mask = ~scan_movemask(scan_cmpeq(scan_load(blk), vch)) & SCAN_ALL;
+   }
+   return(blk + scan_first_bit(mask));
+
+#else
+   while (*str == ch)
+   {
+      str++;
+   }
+   return(str);
+#endif
+}
+
+
+#endif /* UNC_SCAN_H_INCLUDED */
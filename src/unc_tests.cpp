@@ -0,0 +1,575 @@
+/**
+ * @file unc_tests.cpp
+ * Runs the cases in the .test files in one process, with the library.
+ *
+ * Each worker thread keeps the configs it has loaded, so a config is loaded
+ * once per thread instead of once per case. Because a config is reused,
+ * anything that one file leaves behind in the context shows up in the next
+ * file formatted with it. A case that doesn't match is run again with a
+ * freshly loaded config. If that matches, the case is reported as a leak
+ * along with the case that ran before it.
+ *
+ * --orders N runs the whole list N times: in file order, reversed and then
+ * shuffled. A case that doesn't give the same output each time depends on
+ * what ran before it.
+ *
+ * Run it from the tests folder, just like run_tests.py.
+ * Mismatched output is written to results/, for difftest.sh and fixtest.sh.
+ *
+ * @author  Ben Gardner
+ * @license GPL v2+
+ */
+#include "libuncrustify.h"
+#include "uncrustify_types.h"
+#include "prototypes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <map>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+/**
+ * One line from a .test file
+ */
+struct test_case
+{
+   std::string name;
+   std::string config;
+   std::string input;
+   std::string lang;
+   std::string expected;   /* path of the expected output */
+
+   /* filled in by the runs */
+   std::string text;       /* the expected output */
+   std::string in_text;    /* the input */
+   bool        loaded;     /* input and expected text were read */
+   bool        failed;     /* mismatch, error or leak */
+   bool        leaked;     /* passes with a fresh config, but not in the run */
+   std::string leak_after; /* the case that ran before it with the same config */
+   std::string first_out;  /* the output of the first order */
+   bool        order_dep;  /* the output changed with the order */
+};
+
+/**
+ * What a worker thread works on
+ */
+struct worker
+{
+   std::map<std::string, uncrustify_config *> configs;
+   std::map<std::string, int>                 last_case; /* by config */
+};
+
+static std::vector<test_case> cases;
+static std::vector<int>       run_order;
+static int          run_pass;
+static volatile int next_idx;
+static int          log_level;
+
+#ifndef WIN32
+static pthread_mutex_t print_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+static void print_lock_take(void)
+{
+#ifndef WIN32
+   pthread_mutex_lock(&print_lock);
+#endif
+}
+
+
+static void print_lock_give(void)
+{
+#ifndef WIN32
+   pthread_mutex_unlock(&print_lock);
+#endif
+}
+
+
+static int take_next_idx(void)
+{
+#if defined(WIN32) || !defined(__GNUC__)
+   return(next_idx++);
+
+#else
+   return(__sync_fetch_and_add(&next_idx, 1));
+#endif
+}
+
+
+static bool read_file(const char *filename, std::string& text)
+{
+   FILE *pfile = fopen(filename, "rb");
+   char buf[16 * 1024];
+   int  len;
+
+   text.clear();
+   if (pfile == NULL)
+   {
+      return(false);
+   }
+   while ((len = (int)fread(buf, 1, sizeof(buf), pfile)) > 0)
+   {
+      text.append(buf, len);
+   }
+   fclose(pfile);
+   return(true);
+}
+
+
+static void make_folders(const std::string& filename)
+{
+   for (size_t idx = 1; idx < filename.size(); idx++)
+   {
+      if (filename[idx] == '/')
+      {
+#ifdef WIN32
+         mkdir(filename.substr(0, idx).c_str());
+#else
+         mkdir(filename.substr(0, idx).c_str(), 0750);
+#endif
+      }
+   }
+}
+
+
+/**
+ * Saves the output in results/, named the same as in output/
+ */
+static void write_result(const test_case& tc, const std::string& text)
+{
+   std::string filename = "results" + tc.expected.substr(strlen("output"));
+   FILE        *pfile;
+
+   make_folders(filename);
+   pfile = fopen(filename.c_str(), "wb");
+   if (pfile != NULL)
+   {
+      fwrite(text.data(), 1, text.size(), pfile);
+      fclose(pfile);
+   }
+}
+
+
+/**
+ * Reads a .test file and adds its cases.
+ * The format is "name config input [lang]", '#' starts a comment line.
+ */
+static bool load_test_file(const char *filename)
+{
+   FILE *pfile = fopen(filename, "r");
+   char line[1024];
+
+   if (pfile == NULL)
+   {
+      fprintf(stderr, "Unable to open %s: %s\n", filename, strerror(errno));
+      return(false);
+   }
+
+   while (fgets(line, sizeof(line), pfile) != NULL)
+   {
+      char      parts[4][256];
+      int       count;
+      test_case tc;
+
+      count = sscanf(line, "%255s %255s %255s %255s", parts[0], parts[1], parts[2], parts[3]);
+      if ((count < 3) || (parts[0][0] == '#'))
+      {
+         continue;
+      }
+      tc.name   = parts[0];
+      tc.config = parts[1];
+      if (tc.config[0] != '/')
+      {
+         tc.config = "config/" + tc.config;
+      }
+      tc.input = parts[2];
+      if (count > 3)
+      {
+         tc.lang = parts[3];
+      }
+
+      size_t slash = tc.input.rfind('/');
+      slash       = (slash == std::string::npos) ? 0 : slash + 1;
+      tc.expected = "output/" + tc.input.substr(0, slash) + tc.name + "-" + tc.input.substr(slash);
+
+      tc.loaded    = false;
+      tc.failed    = false;
+      tc.leaked    = false;
+      tc.order_dep = false;
+      cases.push_back(tc);
+   }
+   fclose(pfile);
+   return(true);
+}
+
+
+/**
+ * Formats the input of a case.
+ *
+ * @return UNCRUSTIFY_OK or one of the UNCRUSTIFY_ERR_xxx codes
+ */
+static int format_case(uncrustify_config *cfg, const test_case& tc, std::string& out)
+{
+   size_t out_len = 0;
+   int    retval;
+
+   /* Try with the size of the expected output first, that is usually it */
+   out.resize(tc.text.size() + 256);
+   retval = uncrustify_format(cfg, tc.lang.empty() ? NULL : tc.lang.c_str(),
+                              tc.input.c_str(), tc.in_text.data(), tc.in_text.size(),
+                              &out[0], out.size(), &out_len);
+   if (retval == UNCRUSTIFY_ERR_BUFFER)
+   {
+      out.resize(out_len);
+      retval = uncrustify_format(cfg, tc.lang.empty() ? NULL : tc.lang.c_str(),
+                                 tc.input.c_str(), tc.in_text.data(), tc.in_text.size(),
+                                 &out[0], out.size(), &out_len);
+   }
+   out.resize(out_len);
+   return(retval);
+}
+
+
+static void report(const char *what, const test_case& tc, const char *extra = NULL)
+{
+   print_lock_take();
+   printf("%s: %s %s%s\n", what, tc.name.c_str(), tc.expected.c_str(),
+          (extra != NULL) ? extra : "");
+   print_lock_give();
+}
+
+
+static void run_case(worker& wk, int idx)
+{
+   test_case&        tc = cases[idx];
+   uncrustify_config *cfg;
+   std::string       out;
+   int               retval;
+
+   if (!tc.loaded)
+   {
+      if (!read_file(("input/" + tc.input).c_str(), tc.in_text))
+      {
+         tc.failed = true;
+         report("MISSING", tc, " (no input)");
+         return;
+      }
+      if (!read_file(tc.expected.c_str(), tc.text))
+      {
+         tc.failed = true;
+         report("MISSING", tc);
+         return;
+      }
+      tc.loaded = true;
+   }
+
+   cfg = wk.configs[tc.config];
+   if (cfg == NULL)
+   {
+      cfg = uncrustify_config_load(tc.config.c_str());
+      if (cfg == NULL)
+      {
+         tc.failed = true;
+         report("FAILED", tc, " (config)");
+         return;
+      }
+      wk.configs[tc.config] = cfg;
+   }
+
+   retval = format_case(cfg, tc, out);
+
+   std::map<std::string, int>::iterator last = wk.last_case.find(tc.config);
+   std::string after;
+   if (last != wk.last_case.end())
+   {
+      after = cases[last->second].name + " " + cases[last->second].input;
+   }
+   wk.last_case[tc.config] = idx;
+
+   if (run_pass == 0)
+   {
+      tc.first_out = out;
+   }
+   else if (!tc.order_dep && (out != tc.first_out))
+   {
+      tc.order_dep = true;
+      tc.failed    = true;
+      report("ORDER", tc, (" (output changed, ran after " + after + ")").c_str());
+   }
+
+   if ((retval == UNCRUSTIFY_OK) && (out == tc.text))
+   {
+      if (log_level > 0)
+      {
+         report("PASSED", tc);
+      }
+      return;
+   }
+   if (tc.failed)
+   {
+      /* only report a case once */
+      return;
+   }
+   tc.failed = true;
+   write_result(tc, out);
+
+   if ((retval != UNCRUSTIFY_OK) && (retval != UNCRUSTIFY_ERR_FORMAT))
+   {
+      report("FAILED", tc);
+      return;
+   }
+
+   /* Is it the case or what ran before it? */
+   uncrustify_config *fresh = uncrustify_config_load(tc.config.c_str());
+   std::string       fresh_out;
+   if ((fresh != NULL) &&
+       (format_case(fresh, tc, fresh_out) == UNCRUSTIFY_OK) &&
+       (fresh_out == tc.text))
+   {
+      tc.leaked     = true;
+      tc.leak_after = after;
+      report("LEAK", tc, (" (passes alone, failed after " + after + ")").c_str());
+   }
+   else if (retval == UNCRUSTIFY_ERR_FORMAT)
+   {
+      report("FAILED", tc, " (errors)");
+   }
+   else
+   {
+      report("MISMATCH", tc);
+   }
+   uncrustify_config_free(fresh);
+}
+
+
+static void *worker_main(void *arg)
+{
+   worker *wk = (worker *)arg;
+   int    idx;
+
+   while ((idx = take_next_idx()) < (int)run_order.size())
+   {
+      run_case(*wk, run_order[idx]);
+   }
+   return(NULL);
+}
+
+
+/**
+ * Runs all the cases in run_order with the workers
+ */
+static void run_all(std::vector<worker>& workers)
+{
+   next_idx = 0;
+#ifndef WIN32
+   if (workers.size() > 1)
+   {
+      std::vector<pthread_t> threads(workers.size());
+      int started = 0;
+
+      for (int idx = 0; idx < (int)workers.size(); idx++)
+      {
+         if (pthread_create(&threads[started], NULL, worker_main, &workers[idx]) == 0)
+         {
+            started++;
+         }
+      }
+      if (started == 0)
+      {
+         worker_main(&workers[0]);
+      }
+      for (int idx = 0; idx < started; idx++)
+      {
+         pthread_join(threads[idx], NULL);
+      }
+      return;
+   }
+#endif
+   worker_main(&workers[0]);
+}
+
+
+/**
+ * Fills in run_order for a pass: in order, reversed, then shuffled.
+ */
+static void make_order(int pass, UINT32& seed)
+{
+   int count = (int)cases.size();
+
+   run_order.resize(count);
+   for (int idx = 0; idx < count; idx++)
+   {
+      run_order[idx] = (pass == 1) ? (count - 1 - idx) : idx;
+   }
+   if (pass >= 2)
+   {
+      for (int idx = count - 1; idx > 0; idx--)
+      {
+         seed = seed * 1103515245 + 12345;
+         int pick = (int)((seed >> 8) % (UINT32)(idx + 1));
+         int tmp  = run_order[idx];
+         run_order[idx]  = run_order[pick];
+         run_order[pick] = tmp;
+      }
+   }
+}
+
+
+static void usage_exit(const char *argv0)
+{
+   printf("Usage: %s [options] [test ...]\n"
+          "\n"
+          "Runs the cases in 'test.test' for each test, from the tests folder.\n"
+          "The default is all of them.\n"
+          "\n"
+          " -j N        : use N threads (0 = one per CPU, the default)\n"
+          " --orders N  : run the cases N times, in file order, reversed and then shuffled\n"
+          " --seed N    : the seed for the shuffled orders\n"
+          " --verify-space : check the cached spacing answers against the rules\n"
+          " -v          : show the cases that pass\n",
+          argv0);
+   exit(1);
+}
+
+
+int main(int argc, char *argv[])
+{
+   const char *default_tests[] =
+   {
+      "c-sharp", "c", "cpp", "d", "java", "pawn", "objective-c", "vala", "ecma",
+   };
+
+   std::vector<std::string> tests;
+   int    threads = 0;
+   int    orders  = 1;
+   UINT32 seed    = (UINT32)time(NULL);
+
+   for (int idx = 1; idx < argc; idx++)
+   {
+      const char *arg = argv[idx];
+
+      if ((strcmp(arg, "-j") == 0) && (idx + 1 < argc))
+      {
+         threads = atoi(argv[++idx]);
+      }
+      else if ((strcmp(arg, "--orders") == 0) && (idx + 1 < argc))
+      {
+         orders = atoi(argv[++idx]);
+      }
+      else if ((strcmp(arg, "--seed") == 0) && (idx + 1 < argc))
+      {
+         seed = (UINT32)strtoul(argv[++idx], NULL, 0);
+      }
+      else if (strcmp(arg, "--verify-space") == 0)
+      {
+         space_table_verify(true);
+      }
+      else if ((arg[0] == '-') && (arg[1] == 'v'))
+      {
+         log_level += (int)strlen(arg) - 1;
+      }
+      else if (arg[0] == '-')
+      {
+         usage_exit(argv[0]);
+      }
+      else
+      {
+         tests.push_back(arg);
+      }
+   }
+   if (tests.empty())
+   {
+      tests.assign(default_tests, default_tests + ARRAY_SIZE(default_tests));
+   }
+
+#ifdef WIN32
+   threads = 1;
+#else
+   if (threads <= 0)
+   {
+      threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   }
+#endif
+   if (threads <= 0)
+   {
+      threads = 1;
+   }
+   if (orders < 1)
+   {
+      orders = 1;
+   }
+
+   for (int idx = 0; idx < (int)tests.size(); idx++)
+   {
+      if (!load_test_file((tests[idx] + ".test").c_str()))
+      {
+         return(1);
+      }
+   }
+
+   printf("Running %d cases with %d threads, %d order%s",
+          (int)cases.size(), threads, orders, (orders > 1) ? "s" : "");
+   if (orders > 2)
+   {
+      printf(", seed %u", seed);
+   }
+   printf("\n");
+   fflush(stdout);
+
+   std::vector<worker> workers(threads);
+   for (run_pass = 0; run_pass < orders; run_pass++)
+   {
+      make_order(run_pass, seed);
+      run_all(workers);
+   }
+
+   for (int idx = 0; idx < (int)workers.size(); idx++)
+   {
+      std::map<std::string, uncrustify_config *>::iterator it;
+      for (it = workers[idx].configs.begin(); it != workers[idx].configs.end(); ++it)
+      {
+         uncrustify_config_free(it->second);
+      }
+   }
+
+   int fail_count = 0;
+   int leak_count = 0;
+   for (int idx = 0; idx < (int)cases.size(); idx++)
+   {
+      if (cases[idx].failed)
+      {
+         fail_count++;
+      }
+      if (cases[idx].leaked || cases[idx].order_dep)
+      {
+         leak_count++;
+      }
+   }
+
+   printf("Passed %d / %d tests\n", (int)cases.size() - fail_count, (int)cases.size());
+   if (leak_count > 0)
+   {
+      printf("%d test(s) depend on what ran before them\n", leak_count);
+   }
+   if (fail_count > 0)
+   {
+      printf("Failed %d test(s)\n", fail_count);
+      return(1);
+   }
+   printf("All tests passed\n");
+   return(0);
+}
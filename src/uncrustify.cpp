@@ -5,110 +5,82 @@
  * @author  Ben Gardner
  * @license GPL v2+
  */
-#define DEFINE_PCF_NAMES
-#define DEFINE_CHAR_TABLE
-
 #include "uncrustify_version.h"
 #include "uncrustify_types.h"
-#include "char_table.h"
 #include "chunk_list.h"
 #include "prototypes.h"
-#include "token_names.h"
 #include "args.h"
 #include "logger.h"
 #include "log_levels.h"
 #include "md5.h"
 #include "backup.h"
+#include "server.h"
+#include "cache.h"
+#include "stats.h"
+#include "diff.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <ctime>
 #include <fcntl.h>
 #include "unc_ctype.h"
 #ifdef HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifndef WIN32
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+#include <string>
+#include <vector>
 #ifdef HAVE_STRINGS_H
 #include <strings.h>  /* strcasecmp() */
 #endif
 
-/* Global data */
-struct cp_data cpd;
+/**
+ * One file to be formatted in multi-file mode
+ */
+struct file_job
+{
+   std::string filename_in;
+   std::string filename_out;
+};
+
+/* Set by --client: the files are formatted by the server on this socket */
+static const char   *client_sock = NULL;
+static client_setup client_cfg;
+
+/* Set by --diff: print the changes instead of the formatted text */
+static diff_format_t diff_mode = DIFF_NONE;
 
 
-static int language_from_tag(const char *tag);
-static int language_from_filename(const char *filename);
-static const char *language_to_string(int lang);
-static char *read_stdin(int& out_len);
-static void uncrustify_start(const char *data, int data_len);
-static void uncrustify_end();
-static void uncrustify_file(const char *data, int data_len, FILE *pfout,
-                            const char *parsed_file);
+static int read_stdin(file_mem& fm);
+static std::string abs_path(const char *filename);
+static bool client_add_extra(const char *kind, const char *arg, bool is_file);
+static bool format_data(const char *data, int data_len,
+                        const char *parsed_file, std::string& text);
 static void do_source_file(const char *filename_in,
                            const char *filename_out,
                            const char *parsed_file,
                            bool no_backup, bool keep_mtime);
 static void process_source_list(const char *source_list, const char *prefix,
-                                const char *suffix, bool no_backup, bool keep_mtime);
-static int load_header_files();
+                                const char *suffix, std::vector<file_job>& jobs);
+static void add_file_job(std::vector<file_job>& jobs, const char *filename,
+                         const char *prefix, const char *suffix);
+static void run_file_jobs(const std::vector<file_job>& jobs, int workers,
+                          bool no_backup, bool keep_mtime);
 
 static const char *make_output_filename(char *buf, int buf_size,
                                         const char *filename,
                                         const char *prefix,
                                         const char *suffix);
 
-static int load_mem_file(const char *filename, file_mem& fm);
-
-
-/**
- * Replace the brain-dead and non-portable basename().
- * Returns a pointer to the character after the last '/'.
- * The returned value always points into path, unless path is NULL.
- *
- * Input            Returns
- * NULL          => ""
- * "/some/path/" => ""
- * "/some/path"  => "path"
- * "afile"       => "afile"
- *
- * @param path The path to look at
- * @return     Pointer to the character after the last path seperator
- */
-const char *path_basename(const char *path)
-{
-   if (path == NULL)
-   {
-      return("");
-   }
-
-   const char *last_path = path;
-   char       ch;
-
-   while ((ch = *path) != 0)
-   {
-      path++;
-      if (ch == PATH_SEP)
-      {
-         last_path = path;
-      }
-   }
-   return(last_path);
-}
-
-
-/**
- * Returns the length of the directory part of the filename.
- */
-int path_dirname_len(const char *filename)
-{
-   if (filename == NULL)
-   {
-      return(0);
-   }
-   return((int)(path_basename(filename) - filename));
-}
-
 
 static void usage_exit(const char *msg, const char *argv0, int code)
 {
@@ -151,6 +123,16 @@ static void usage_exit(const char *msg, const char *argv0, int code)
            " --no-backup  : replace files, no backup. Useful if files are under source control\n"
 #ifdef HAVE_UTIME_H
            " --mtime      : preserve mtime on replaced files\n"
+#endif
+           " --cache DIR  : with --replace or --no-backup, skip files that DIR says are formatted\n"
+           " --stats[=json] : print the time and chunk counts of each pass to stderr\n"
+           " --lines A:B  : only format lines A to B, with -f or stdin\n"
+           " --lines-patch: with --lines, output 'first:last' and the new text of those lines\n"
+           " --diff[=json]: print a unified diff (or the edits as JSON) instead of the text\n"
+#ifndef WIN32
+           " -j N         : format up to N files in parallel (0 = one per CPU)\n"
+           " --server SOCK: keep configs loaded and format files for clients on socket SOCK\n"
+           " --client SOCK: use the server on socket SOCK to format the files\n"
 #endif
            " -l           : language override: C, CPP, D, CS, JAVA, PAWN, OC, OC+\n"
            " -t           : load a file with types (usually not needed)\n"
@@ -171,6 +153,7 @@ static void usage_exit(const char *msg, const char *argv0, int code)
            " -L SEV       : Set the log severity (see log_levels.h)\n"
            " -s           : Show the log severity in the logs\n"
            " --decode FLAG: Print FLAG (chunk flags) as text and exit\n"
+           " --verify-space : check each spacing answer from the cache against the rules\n"
            "\n"
            "Usage Examples\n"
            "cat foo.d | uncrustify -q -c my.cfg -l d\n"
@@ -222,8 +205,7 @@ static void redir_stdout(const char *output_file)
 
 int main(int argc, char *argv[])
 {
-   char       *data        = NULL;
-   int        data_len     = 0;
+   file_mem   fm_in;
    const char *cfg_file    = "uncrustify.cfg";
    const char *parsed_file = NULL;
    const char *source_file = NULL;
@@ -286,6 +268,21 @@ int main(int argc, char *argv[])
       exit(EXIT_SUCCESS);
    }
 
+#ifndef WIN32
+   if ((p_arg = arg.Param("--server")) != NULL)
+   {
+      return(server_run(p_arg));
+   }
+
+   if ((client_sock = arg.Param("--client")) != NULL)
+   {
+      char buf[256];
+
+      log_get_mask(&mask);
+      client_cfg.log_mask = logmask_to_str(&mask, buf, sizeof(buf));
+   }
+#endif
+
    /* Get the config file name */
    if (((cfg_file = arg.Param("--config")) == NULL) &&
        ((cfg_file = arg.Param("-c")) == NULL))
@@ -337,38 +334,51 @@ int main(int argc, char *argv[])
    idx = 0;
    while ((p_arg = arg.Params("-t", idx)) != NULL)
    {
-      load_keyword_file(p_arg);
+      if (!client_add_extra("t", p_arg, true))
+      {
+         load_keyword_file(p_arg);
+      }
    }
 
    /* add types */
    idx = 0;
    while ((p_arg = arg.Params("--type", idx)) != NULL)
    {
-      add_keyword(p_arg, CT_TYPE, LANG_ALL);
+      if (!client_add_extra("type", p_arg, false))
+      {
+         add_keyword(p_arg, CT_TYPE, LANG_ALL);
+      }
    }
 
    /* Load define files */
    idx = 0;
    while ((p_arg = arg.Params("-d", idx)) != NULL)
    {
-      load_define_file(p_arg);
+      if (!client_add_extra("d", p_arg, true))
+      {
+         load_define_file(p_arg);
+      }
    }
 
    /* add defines */
    idx = 0;
    while ((p_arg = arg.Params("--define", idx)) != NULL)
    {
-      add_define(p_arg, NULL);
+      if (!client_add_extra("define", p_arg, false))
+      {
+         add_define(p_arg, NULL);
+      }
    }
 
    /* Check for a language override */
    if ((p_arg = arg.Param("-l")) != NULL)
    {
-      cpd.lang_flags = language_from_tag(p_arg);
-      if (cpd.lang_flags == 0)
+      cpd->lang_flags = language_from_tag(p_arg);
+      if (cpd->lang_flags == 0)
       {
          LOG_FMT(LWARN, "Ignoring unknown language: %s\n", p_arg);
       }
+      cpd->lang_forced = (cpd->lang_flags != 0);
    }
 
    /* Get the source file name */
@@ -384,8 +394,9 @@ int main(int argc, char *argv[])
       // not using a file list, source_list is NULL
    }
 
-   const char *prefix = arg.Param("--prefix");
-   const char *suffix = arg.Param("--suffix");
+   const char *prefix    = arg.Param("--prefix");
+   const char *suffix    = arg.Param("--suffix");
+   const char *cache_dir = arg.Param("--cache");
 
    bool no_backup        = arg.Present("--no-backup");
    bool replace          = arg.Present("--replace");
@@ -393,6 +404,83 @@ int main(int argc, char *argv[])
    bool update_config    = arg.Present("--update-config");
    bool update_config_wd = arg.Present("--update-config-with-doc");
    bool detect           = arg.Present("--detect");
+   int  workers          = 1;
+   bool stats            = false;
+   bool stats_json       = false;
+
+   if ((p_arg = arg.Param("-j")) != NULL)
+   {
+      workers = strtol(p_arg, NULL, 10);
+#ifdef WIN32
+      if (workers != 1)
+      {
+         LOG_FMT(LWARN, "Parallel formatting is not supported, ignoring -j %s\n", p_arg);
+         workers = 1;
+      }
+#else
+      if (workers <= 0)
+      {
+         workers = sysconf(_SC_NPROCESSORS_ONLN);
+      }
+#endif
+      if (workers <= 0)
+      {
+         workers = 1;
+      }
+   }
+
+   if (arg.Present("--stats"))
+   {
+      stats = true;
+   }
+   else if ((p_arg = arg.Param("--stats=")) != NULL)
+   {
+      if (strcasecmp(p_arg, "json") != 0)
+      {
+         usage_exit("The --stats format must be 'json'", argv[0], 66);
+      }
+      stats      = true;
+      stats_json = true;
+   }
+
+   if (arg.Present("--diff"))
+   {
+      diff_mode = DIFF_UNIFIED;
+   }
+   else if ((p_arg = arg.Param("--diff=")) != NULL)
+   {
+      if (strcasecmp(p_arg, "json") != 0)
+      {
+         usage_exit("The --diff format must be 'json'", argv[0], 66);
+      }
+      diff_mode = DIFF_JSON;
+   }
+
+   if (arg.Present("--verify-space"))
+   {
+      space_table_verify(true);
+   }
+
+   /* Params() goes by prefix, so "--lines" also finds "--lines-patch" */
+   cpd->line_patch = arg.Present("--lines-patch");
+   idx             = 0;
+   while (((p_arg = arg.Params("--lines", idx)) != NULL) &&
+          (strcmp(argv[idx - 1], "--lines-patch") == 0))
+   {
+      /* not this one, keep looking */
+   }
+   if (p_arg != NULL)
+   {
+      if ((sscanf(p_arg, "%d:%d", &cpd->line_first, &cpd->line_last) != 2) ||
+          (cpd->line_first < 1) || (cpd->line_last < cpd->line_first))
+      {
+         usage_exit("The --lines range must be 'first:last', ie '10:20'", argv[0], 66);
+      }
+   }
+   else if (cpd->line_patch)
+   {
+      usage_exit("Cannot use --lines-patch without --lines", argv[0], 66);
+   }
 
    /* Grab the output override */
    output_file = arg.Param("-o");
@@ -425,14 +513,37 @@ int main(int argc, char *argv[])
       }
    }
 
+   if ((client_sock != NULL) &&
+       (detect || update_config || update_config_wd || arg.Present("--universalindent")))
+   {
+      usage_exit("Cannot use --client with --detect, --update-config or --universalindent",
+                 argv[0], 66);
+   }
+
+   if ((cpd->line_last > 0) &&
+       ((client_sock != NULL) || replace || no_backup))
+   {
+      usage_exit("Cannot use --lines with --client, --replace or --no-backup", argv[0], 66);
+   }
+
+   if ((diff_mode != DIFF_NONE) && (replace || no_backup || cpd->line_patch))
+   {
+      usage_exit("Cannot use --diff with --replace, --no-backup or --lines-patch", argv[0], 66);
+   }
+
    /* Try to load the config file, if available.
     * It is optional for "--universalindent" and "--detect", but required for
     * everything else.
     */
    if (cfg_file != NULL)
    {
-      cpd.filename = cfg_file;
-      if (load_option_file(cfg_file) < 0)
+      cpd->filename = cfg_file;
+      if (client_sock != NULL)
+      {
+         /* The server loads it */
+         client_cfg.cfg_file = abs_path(cfg_file);
+      }
+      else if (load_option_file(cfg_file) < 0)
       {
          usage_exit("Unable to load the config file", argv[0], 56);
       }
@@ -469,23 +580,23 @@ int main(int argc, char *argv[])
       }
 
       /* Do some simple language detection based on the filename extension */
-      if (cpd.lang_flags == 0)
+      if (cpd->lang_flags == 0)
       {
-         cpd.lang_flags = language_from_filename(source_file);
+         cpd->lang_flags = language_from_filename(source_file);
       }
 
       /* Try to read in the source file */
       if (load_mem_file(source_file, fm) < 0)
       {
          LOG_FMT(LERR, "Failed to load (%s)\n", source_file);
-         cpd.error_count++;
+         cpd->error_count++;
          return(EXIT_FAILURE);
       }
 
       uncrustify_start(fm.data, fm.length);
       detect_options(fm.data, fm.length);
       uncrustify_end();
-      free(fm.data);
+      free_file_mem(fm);
 
       redir_stdout(output_file);
       save_option_file(stdout, update_config_wd);
@@ -534,38 +645,82 @@ int main(int argc, char *argv[])
          usage_exit("Cannot specify -o with a mulit-file option.",
                     argv[0], 68);
       }
+
+      if (cpd->line_last > 0)
+      {
+         usage_exit("Cannot use --lines with a mulit-file option.",
+                    argv[0], 68);
+      }
+   }
+
+   /* This relies on cpd->filename being the config file name */
+   if (client_sock == NULL)
+   {
+      load_header_files();
+   }
+
+   if (cache_dir != NULL)
+   {
+      if (client_sock != NULL)
+      {
+         LOG_FMT(LWARN, "Ignoring --cache, the config isn't loaded with --client\n");
+      }
+      else
+      {
+         cache_init(cache_dir);
+      }
    }
 
-   /* This relies on cpd.filename being the config file name */
-   load_header_files();
+   if (stats)
+   {
+      if (client_sock != NULL)
+      {
+         LOG_FMT(LWARN, "Ignoring --stats, the files are formatted by the server with --client\n");
+         stats = false;
+      }
+      else
+      {
+         stats_enable();
+      }
+   }
 
    if ((source_file == NULL) && (source_list == NULL) && (p_arg == NULL))
    {
       /* no input specified, so use stdin */
-      if (cpd.lang_flags == 0)
+      if (cpd->lang_flags == 0)
       {
-         cpd.lang_flags = LANG_C;
+         cpd->lang_flags = LANG_C;
       }
 
       redir_stdout(output_file);
 
-      data = read_stdin(data_len);
-      if (data == NULL)
+      if (read_stdin(fm_in) != SUCCESS)
       {
          LOG_FMT(LERR, "Out of memory\n");
          return(100);
       }
 
-      cpd.filename = "stdin";
+      cpd->filename = "stdin";
 
       /* Done reading from stdin */
       LOG_FMT(LSYS, "Parsing: %d bytes from stdin as language %s\n",
-              data_len, language_to_string(cpd.lang_flags));
+              fm_in.length, language_to_string(cpd->lang_flags));
 
-      uncrustify_file(data, data_len, stdout, parsed_file);
-      free(data);
-      data_len = 0;
-      data     = NULL;
+      std::string text;
+      if (!format_data(fm_in.data, fm_in.length, parsed_file, text))
+      {
+         /* No output */
+      }
+      else if (diff_mode != DIFF_NONE)
+      {
+         diff_report(stdout, diff_mode, cpd->filename, fm_in.data, fm_in.length,
+                     text.data(), text.size());
+      }
+      else
+      {
+         fwrite(text.data(), text.size(), 1, stdout);
+      }
+      free_file_mem(fm_in);
    }
    else if (source_file != NULL)
    {
@@ -584,32 +739,38 @@ int main(int argc, char *argv[])
          LOG_FMT(LSYS, "Output suffix: %s\n", suffix);
       }
 
+      std::vector<file_job> jobs;
+
       /* Do the files on the command line first */
       idx = 1;
       while ((p_arg = arg.Unused(idx)) != NULL)
       {
-         char outbuf[1024];
-         do_source_file(p_arg,
-                        make_output_filename(outbuf, sizeof(outbuf), p_arg, prefix, suffix),
-                        NULL, no_backup, keep_mtime);
+         add_file_job(jobs, p_arg, prefix, suffix);
       }
 
       if (source_list != NULL)
       {
-         process_source_list(source_list, prefix, suffix, no_backup, keep_mtime);
+         process_source_list(source_list, prefix, suffix, jobs);
       }
+
+      run_file_jobs(jobs, workers, no_backup, keep_mtime);
+   }
+
+   if (stats)
+   {
+      stats_report(stderr, stats_json);
    }
 
    clear_keyword_file();
    clear_defines();
 
-   return((cpd.error_count != 0) ? 1 : 0);
+   return((cpd->error_count != 0) ? 1 : 0);
 }
 
 
 static void process_source_list(const char *source_list,
                                 const char *prefix, const char *suffix,
-                                bool no_backup, bool keep_mtime)
+                                std::vector<file_job>& jobs)
 {
    FILE *p_file = fopen(source_list, "r");
 
@@ -617,7 +778,7 @@ static void process_source_list(const char *source_list,
    {
       LOG_FMT(LERR, "%s: fopen(%s) failed: %s (%d)\n",
               __func__, source_list, strerror(errno), errno);
-      cpd.error_count++;
+      cpd->error_count++;
       return;
    }
 
@@ -641,1048 +802,760 @@ static void process_source_list(const char *source_list,
 
       if ((argc == 1) && (*args[0] != '#'))
       {
-         char outbuf[1024];
-         do_source_file(args[0],
-                        make_output_filename(outbuf, sizeof(outbuf), args[0], prefix, suffix),
-                        NULL, no_backup, keep_mtime);
+         add_file_job(jobs, args[0], prefix, suffix);
       }
    }
    fclose(p_file);
 }
 
 
-static char *read_stdin(int& out_len)
+static void add_file_job(std::vector<file_job>& jobs, const char *filename,
+                         const char *prefix, const char *suffix)
 {
-   char *data;
-   char *new_data;
-   int  data_size;
-   int  data_len;
-   int  len;
-
-   /* Start with 64k */
-   data_size = 64 * 1024;
-   data      = (char *)malloc(data_size);
-   data_len  = 0;
-
-   if (data == NULL)
-   {
-      return(NULL);
-   }
+   char     outbuf[1024];
+   file_job job;
 
-   while ((len = fread(&data[data_len], 1, data_size - data_len, stdin)) > 0)
-   {
-      data_len += len;
-      if (data_len == data_size)
-      {
-         /* Double the buffer size */
-         data_size *= 2;
-         if ((new_data = (char *)realloc(data, data_size)) == NULL)
-         {
-            free(data);
-            return(NULL);
-         }
-         data = new_data;
-      }
-   }
+   job.filename_in  = filename;
+   job.filename_out = make_output_filename(outbuf, sizeof(outbuf), filename,
+                                           prefix, suffix);
+   jobs.push_back(job);
+}
 
-   assert(data_len < data_size);
-   /* Make sure the buffer is terminated */
-   data[data_len] = 0;
 
-   out_len = data_len;
+#ifndef WIN32
 
-   return(data);
-}
+/**
+ * What a worker sends back to the parent for each file, followed by
+ * log_len bytes of captured stderr, out_len bytes of captured stdout and
+ * then by a file_stats_t if has_stats.
+ */
+struct job_result
+{
+   int idx;
+   int error_count;
+   int log_len;
+   int out_len;
+   int has_stats;
+};
 
 
-static void make_folders(const char *filename)
+/**
+ * Sends everything written to 'fd' to a temp file instead.
+ *
+ * @return the temp file or NULL if it couldn't be made
+ */
+static FILE *capture_open(FILE *pstream, int fd)
 {
-   int  idx;
-   int  last_idx = 0;
-   char outname[1024];
-
-   snprintf(outname, sizeof(outname), "%s", filename);
+   FILE *pfile = tmpfile();
 
-   for (idx = 0; outname[idx] != 0; idx++)
+   if (pfile != NULL)
    {
-      if ((outname[idx] == '/') || (outname[idx] == '\\'))
-      {
-         outname[idx] = PATH_SEP;
-      }
-
-      if ((idx > last_idx) && (outname[idx] == PATH_SEP))
-      {
-         outname[idx] = 0;
-
-         if ((strcmp(&outname[last_idx], ".") != 0) &&
-             (strcmp(&outname[last_idx], "..") != 0))
-         {
-            //fprintf(stderr, "%s: %s\n", __func__, outname);
-            mkdir(outname, 0750);
-         }
-         outname[idx] = PATH_SEP;
-      }
-
-      if (outname[idx] == PATH_SEP)
-      {
-         last_idx = idx + 1;
-      }
+      fflush(pstream);
+      dup2(fileno(pfile), fd);
    }
+   return(pfile);
 }
 
 
 /**
- * Loads a file into memory
+ * Takes what was captured since the last call and empties the temp file.
+ *
+ * @param len  Gets the length of the text
+ * @return the text (free it) or NULL if there is none
  */
-static int load_mem_file(const char *filename, file_mem& fm)
+static char *capture_take(FILE *pfile, FILE *pstream, int& len)
 {
-   int         retval = -1;
-   struct stat my_stat;
-   FILE        *p_file;
-
-   fm.data   = NULL;
-   fm.length = 0;
-
-   /* Grab the stat info for the file */
-   if (stat(filename, &my_stat) < 0)
-   {
-      return(-1);
-   }
-
-#ifdef HAVE_UTIME_H
-   /* Save off mtime */
-   fm.utb.modtime = my_stat.st_mtime;
-#endif
+   char *text = NULL;
 
-   /* Try to read in the file */
-   p_file = fopen(filename, "rb");
-   if (p_file == NULL)
+   len = 0;
+   fflush(pstream);
+   if (pfile == NULL)
    {
-      return(-1);
+      return(NULL);
    }
 
-   fm.length = my_stat.st_size;
-   fm.data   = (char *)malloc(fm.length + 1);
-   if (fm.data == NULL)
-   {
-      LOG_FMT(LERR, "%s: fopen(%s) failed: out of memory\n", __func__, filename);
-      cpd.error_count++;
-   }
-   else if (fread(fm.data, fm.length, 1, p_file) != 1)
+   len = (int)lseek(fileno(pfile), 0, SEEK_END);
+   if ((len > 0) &&
+       ((text = (char *)malloc(len)) != NULL) &&
+       (pread(fileno(pfile), text, len, 0) != len))
    {
-      LOG_FMT(LERR, "%s: fread(%s) failed: %s (%d)\n",
-              __func__, filename, strerror(errno), errno);
-      cpd.error_count++;
+      free(text);
+      text = NULL;
    }
-   else
-   {
-      fm.data[fm.length] = 0;
-      retval             = 0;
-   }
-   fclose(p_file);
-
-   if ((retval != 0) && (fm.data != NULL))
+   if (text == NULL)
    {
-      free(fm.data);
-      fm.data   = NULL;
-      fm.length = 0;
+      len = 0;
    }
-   return(retval);
+   rewind(pfile);
+   (void)ftruncate(fileno(pfile), 0);
+   return(text);
 }
 
 
 /**
- * Try to load the file from the config folder first and then by name
+ * The body of a worker process.
+ * Grabs the next unclaimed job from the shared counter until there are none
+ * left. Anything logged or printed (--diff) while doing a file is captured
+ * and sent back to the parent with the result, so that the parent can
+ * replay it in job order.
  */
-static int load_mem_file_config(const char *filename, file_mem& fm)
+static void worker_loop(const std::vector<file_job>& jobs, volatile int *next_job,
+                        int fd_out, bool no_backup, bool keep_mtime)
 {
-   int  retval;
-   char buf[1024];
-
-   snprintf(buf, sizeof(buf), "%.*s%s",
-            path_dirname_len(cpd.filename), cpd.filename, filename);
+   FILE *p_log = capture_open(stderr, STDERR_FILENO);
+   FILE *p_out = capture_open(stdout, STDOUT_FILENO);
+   int  idx;
 
-   retval = load_mem_file(buf, fm);
-   if (retval < 0)
+   while ((idx = __sync_fetch_and_add(next_job, 1)) < (int)jobs.size())
    {
-      retval = load_mem_file(filename, fm);
-      if (retval < 0)
+      job_result res;
+      UINT32     old_errors = cpd->error_count;
+      int        old_stats  = stats_count();
+      char       *log_text;
+      char       *out_text;
+
+      do_source_file(jobs[idx].filename_in.c_str(), jobs[idx].filename_out.c_str(),
+                     NULL, no_backup, keep_mtime);
+
+      res.idx         = idx;
+      res.error_count = cpd->error_count - old_errors;
+      res.has_stats   = (stats_count() > old_stats);
+      log_text        = capture_take(p_log, stderr, res.log_len);
+      out_text        = capture_take(p_out, stdout, res.out_len);
+
+      bool ok = write_all(fd_out, &res, sizeof(res)) &&
+                write_all(fd_out, log_text, res.log_len) &&
+                write_all(fd_out, out_text, res.out_len) &&
+                (!res.has_stats ||
+                 write_all(fd_out, stats_get(stats_count() - 1), sizeof(file_stats_t)));
+      free(log_text);
+      free(out_text);
+      if (!ok)
       {
-         LOG_FMT(LERR, "Failed to load (%s) or (%s)\n", buf, filename);
-         cpd.error_count++;
+         break;
       }
    }
-   return(retval);
 }
 
 
-static int load_header_files()
+/**
+ * Formats the jobs with a pool of worker processes.
+ * Each worker is a fork of this process, so it gets its own copy of the
+ * parse state and settings. Results are collected per file and the logs
+ * are replayed in the original job order, so the output doesn't depend
+ * on the scheduling.
+ */
+static void run_file_jobs_parallel(const std::vector<file_job>& jobs, int workers,
+                                   bool no_backup, bool keep_mtime)
 {
-   int retval = 0;
+   volatile int *next_job;
+   int          idx;
 
-   if ((cpd.settings[UO_cmt_insert_file_header].str != NULL) &&
-       (cpd.settings[UO_cmt_insert_file_header].str[0] != 0))
-   {
-      retval |= load_mem_file_config(cpd.settings[UO_cmt_insert_file_header].str,
-                                     cpd.file_hdr);
-   }
-   if ((cpd.settings[UO_cmt_insert_file_footer].str != NULL) &&
-       (cpd.settings[UO_cmt_insert_file_footer].str[0] != 0))
-   {
-      retval |= load_mem_file_config(cpd.settings[UO_cmt_insert_file_footer].str,
-                                     cpd.file_ftr);
-   }
-   if ((cpd.settings[UO_cmt_insert_func_header].str != NULL) &&
-       (cpd.settings[UO_cmt_insert_func_header].str[0] != 0))
-   {
-      retval |= load_mem_file_config(cpd.settings[UO_cmt_insert_func_header].str,
-                                     cpd.func_hdr);
-   }
-   if ((cpd.settings[UO_cmt_insert_class_header].str != NULL) &&
-       (cpd.settings[UO_cmt_insert_class_header].str[0] != 0))
+   next_job = (volatile int *)mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if (next_job == MAP_FAILED)
    {
-      retval |= load_mem_file_config(cpd.settings[UO_cmt_insert_class_header].str,
-                                     cpd.class_hdr);
+      LOG_FMT(LWARN, "%s: mmap failed, formatting serially: %s (%d)\n",
+              __func__, strerror(errno), errno);
+      for (idx = 0; idx < (int)jobs.size(); idx++)
+      {
+         do_source_file(jobs[idx].filename_in.c_str(), jobs[idx].filename_out.c_str(),
+                        NULL, no_backup, keep_mtime);
+      }
+      return;
    }
-   return(retval);
-}
+   *next_job = 0;
 
+   std::vector<pid_t>         pids;
+   std::vector<struct pollfd> fds;
 
-static const char *make_output_filename(char *buf, int buf_size,
-                                        const char *filename,
-                                        const char *prefix,
-                                        const char *suffix)
-{
-   int len = 0;
+   fflush(stdout);
+   fflush(stderr);
 
-   if (prefix != NULL)
+   for (idx = 0; idx < workers; idx++)
    {
-      len = snprintf(buf, buf_size, "%s/", prefix);
-   }
-
-   snprintf(&buf[len], buf_size - len, "%s%s", filename,
-            (suffix != NULL) ? suffix : "");
+      int   pipe_fds[2];
+      pid_t pid;
 
-   return(buf);
-}
-
-
-/**
- * Reinvent the wheel with a file comparision function...
- */
-static bool file_content_matches(const char *filename1, const char *filename2)
-{
-   struct stat st1, st2;
-   int         fd1, fd2;
-   UINT8       buf1[1024], buf2[1024];
-   int         len1 = 0, len2 = 0;
-   int         minlen;
-
-   /* Check the sizes first */
-   if ((stat(filename1, &st1) != 0) ||
-       (stat(filename2, &st2) != 0) ||
-       (st1.st_size != st2.st_size))
-   {
-      return(false);
-   }
-
-   if ((fd1 = open(filename1, O_RDONLY)) < 0)
-   {
-      return(false);
-   }
-   if ((fd2 = open(filename2, O_RDONLY)) < 0)
-   {
-      close(fd1);
-      return(false);
-   }
-
-   while ((len1 >= 0) && (len2 >= 0))
-   {
-      if (len1 == 0)
+      if (pipe(pipe_fds) < 0)
       {
-         len1 = read(fd1, buf1, sizeof(buf1));
-      }
-      if (len2 == 0)
-      {
-         len2 = read(fd2, buf2, sizeof(buf2));
+         LOG_FMT(LERR, "%s: pipe failed: %s (%d)\n", __func__, strerror(errno), errno);
+         break;
       }
-      if ((len1 <= 0) || (len2 <= 0))
+      pid = fork();
+      if (pid < 0)
       {
+         LOG_FMT(LERR, "%s: fork failed: %s (%d)\n", __func__, strerror(errno), errno);
+         close(pipe_fds[0]);
+         close(pipe_fds[1]);
          break;
       }
-      minlen = (len1 < len2) ? len1 : len2;
-      if (memcmp(buf1, buf2, minlen) != 0)
+      if (pid == 0)
       {
-         break;
+         /* the worker doesn't need the read ends of the other pipes */
+         for (int fd_idx = 0; fd_idx < (int)fds.size(); fd_idx++)
+         {
+            close(fds[fd_idx].fd);
+         }
+         close(pipe_fds[0]);
+         worker_loop(jobs, next_job, pipe_fds[1], no_backup, keep_mtime);
+         close(pipe_fds[1]);
+         _exit(0);
       }
-      len1 -= minlen;
-      len2 -= minlen;
-   }
-
-   close(fd1);
-   close(fd2);
-
-   return((len1 == 0) && (len2 == 0));
-}
-
-
-const char *fix_filename(const char *filename)
-{
-   char *tmp_file;
-
-   /* Create 'outfile.uncrustify' */
-   tmp_file = new char[strlen(filename) + 16];
-   if (tmp_file != NULL)
-   {
-      sprintf(tmp_file, "%s.uncrustify", filename);
-   }
-   return(tmp_file);
-}
-
-
-/**
- * Does a source file.
- *
- * @param filename_in  the file to read
- * @param filename_out NULL (stdout) or the file to write
- * @param parsed_file  NULL or the filename for the parsed debug info
- * @param no_backup    don't create a backup, if filename_out == filename_in
- * @param keep_mtime   don't change the mtime (dangerous)
- */
-static void do_source_file(const char *filename_in,
-                           const char *filename_out,
-                           const char *parsed_file,
-                           bool       no_backup,
-                           bool       keep_mtime)
-{
-   FILE       *pfout;
-   bool       did_open    = false;
-   bool       need_backup = false;
-   file_mem   fm;
-   const char *filename_tmp = NULL;
 
-   /* Do some simple language detection based on the filename extension */
-   if (cpd.lang_flags == 0)
-   {
-      cpd.lang_flags = language_from_filename(filename_in);
+      close(pipe_fds[1]);
+      struct pollfd pfd;
+      pfd.fd      = pipe_fds[0];
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+      fds.push_back(pfd);
+      pids.push_back(pid);
    }
 
-   /* Try to read in the source file */
-   if (load_mem_file(filename_in, fm) < 0)
+   if (pids.empty())
    {
-      LOG_FMT(LERR, "Failed to load (%s)\n", filename_in);
-      cpd.error_count++;
+      /* Couldn't start any workers, so do it ourselves */
+      munmap((void *)next_job, sizeof(int));
+      for (idx = 0; idx < (int)jobs.size(); idx++)
+      {
+         do_source_file(jobs[idx].filename_in.c_str(), jobs[idx].filename_out.c_str(),
+                        NULL, no_backup, keep_mtime);
+      }
       return;
    }
 
-   LOG_FMT(LSYS, "Parsing: %s as language %s\n",
-           filename_in, language_to_string(cpd.lang_flags));
+   /* Collect the results and replay the logs in job order */
+   std::vector<bool>         done(jobs.size(), false);
+   std::vector<std::string>  logs(jobs.size());
+   std::vector<std::string>  outs(jobs.size());
+   std::vector<file_stats_t> stats(jobs.size());
+   std::vector<bool>         has_stats(jobs.size(), false);
+   int next_print = 0;
+   int open_fds   = (int)fds.size();
 
-   if (filename_out == NULL)
+   while (open_fds > 0)
    {
-      pfout = stdout;
-   }
-   else
-   {
-      /* If the out file is the same as the in file, then use a temp file */
-      filename_tmp = filename_out;
-      if (strcmp(filename_in, filename_out) == 0)
+      if (poll(&fds[0], fds.size(), -1) < 0)
       {
-         /* Create 'outfile.uncrustify' */
-         filename_tmp = fix_filename(filename_out);
-         if (filename_tmp == NULL)
-         {
-            LOG_FMT(LERR, "%s: Out of memory\n", __func__);
-            cpd.error_count++;
-            free(fm.data);
-            return;
-         }
-
-         if (!no_backup)
+         if (errno == EINTR)
          {
-            if (backup_copy_file(filename_in, fm.data, fm.length) != SUCCESS)
-            {
-               LOG_FMT(LERR, "%s: Failed to create backup file for %s\n",
-                       __func__, filename_in);
-               free(fm.data);
-               cpd.error_count++;
-               return;
-            }
-            need_backup = true;
+            continue;
          }
+         LOG_FMT(LERR, "%s: poll failed: %s (%d)\n", __func__, strerror(errno), errno);
+         break;
       }
-      make_folders(filename_tmp);
 
-      pfout = fopen(filename_tmp, "wb");
-      if (pfout == NULL)
+      for (int fd_idx = 0; fd_idx < (int)fds.size(); fd_idx++)
       {
-         LOG_FMT(LERR, "%s: Unable to create %s: %s (%d)\n",
-                 __func__, filename_tmp, strerror(errno), errno);
-         cpd.error_count++;
-         free(fm.data);
-         if ((filename_tmp != NULL) && (filename_tmp != filename_out))
+         if ((fds[fd_idx].fd < 0) || (fds[fd_idx].revents == 0))
          {
-            delete [] (char *)filename_tmp;
-            filename_tmp = NULL;
+            continue;
          }
-         return;
-      }
-      did_open = true;
-      //LOG_FMT(LSYS, "Output file %s\n", filename_out);
-   }
-
-   cpd.filename = filename_in;
-   uncrustify_file(fm.data, fm.length, pfout, parsed_file);
-
-   free(fm.data);
 
-   if (did_open)
-   {
-      fclose(pfout);
-
-      if (need_backup)
-      {
-         backup_create_md5_file(filename_in);
-      }
-
-      if ((filename_tmp != NULL) && (filename_tmp != filename_out))
-      {
-         /* We need to compare and then do a rename */
-         if (file_content_matches(filename_tmp, filename_out))
+         job_result res;
+         bool       ok = read_all(fds[fd_idx].fd, &res, sizeof(res)) &&
+                         (res.idx >= 0) && (res.idx < (int)jobs.size()) &&
+                         (res.log_len >= 0) && (res.out_len >= 0);
+         if (ok && (res.log_len > 0))
          {
-            /* No change - remove tmp file */
-            (void)unlink(filename_tmp);
+            logs[res.idx].resize(res.log_len);
+            ok = read_all(fds[fd_idx].fd, &logs[res.idx][0], res.log_len);
          }
-         else
+         if (ok && (res.out_len > 0))
          {
-#ifdef WIN32
-            /* windows can't rename a file if the target exists, so delete it
-             * first. This may cause data loss if the tmp file gets deleted
-             * or can't be renamed.
-             */
-            (void)unlink(filename_out);
-#endif
-            /* Change - rename filename_tmp to filename_out */
-            if (rename(filename_tmp, filename_out) != 0)
-            {
-               LOG_FMT(LERR, "%s: Unable to rename '%s' to '%s'\n",
-                       __func__, filename_tmp, filename_out);
-               cpd.error_count++;
-            }
+            outs[res.idx].resize(res.out_len);
+            ok = read_all(fds[fd_idx].fd, &outs[res.idx][0], res.out_len);
          }
-         delete [] (char *)filename_tmp;
-         filename_tmp = NULL;
-      }
-
-#ifdef HAVE_UTIME_H
-      if (keep_mtime)
-      {
-         /* update mtime -- don't care if it fails */
-         fm.utb.actime = time(NULL);
-         (void)utime(filename_in, &fm.utb);
-      }
-#endif
-   }
-}
-
-
-static void add_file_header()
-{
-   if (!chunk_is_comment(chunk_get_head()))
-   {
-      /*TODO: detect the typical #ifndef FOO / #define FOO sequence */
-      tokenize(cpd.file_hdr.data, cpd.file_hdr.length, chunk_get_head());
-   }
-}
-
-
-static void add_file_footer()
-{
-   chunk_t *pc = chunk_get_tail();
-
-   /* Back up if the file ends with a newline */
-   if ((pc != NULL) && chunk_is_newline(pc))
-   {
-      pc = chunk_get_prev(pc);
-   }
-   if ((pc != NULL) &&
-       (!chunk_is_comment(pc) || !chunk_is_newline(chunk_get_prev(pc))))
-   {
-      pc = chunk_get_tail();
-      if (!chunk_is_newline(pc))
-      {
-         LOG_FMT(LSYS, "Adding a newline at the end of the file\n");
-         newline_add_after(pc);
-      }
-      tokenize(cpd.file_ftr.data, cpd.file_ftr.length, NULL);
-   }
-}
-
-
-static void add_func_header(c_token_t type, file_mem& fm)
-{
-   chunk_t *pc;
-   chunk_t *ref;
-   chunk_t *tmp;
-   bool    do_insert;
-
-   for (pc = chunk_get_head(); pc != NULL; pc = chunk_get_next_ncnlnp(pc))
-   {
-      if (pc->type != type)
-      {
-         continue;
-      }
-
-      do_insert = false;
-
-      /* On a function proto or def. Back up to a close brace or semicolon on
-       * the same level
-       */
-      ref = pc;
-      while ((ref = chunk_get_prev(ref)) != NULL)
-      {
-         /* Bail if we change level */
-         if (ref->level != pc->level)
+         if (ok && res.has_stats)
          {
-            do_insert = true;
-            break;
+            has_stats[res.idx] = true;
+            ok = read_all(fds[fd_idx].fd, &stats[res.idx], sizeof(file_stats_t));
          }
-
-         /* If we hit an angle close, back up to the angle open */
-         if (ref->type == CT_ANGLE_CLOSE)
+         if (!ok)
          {
-            ref = chunk_get_prev_type(ref, CT_ANGLE_OPEN, ref->level, CNAV_PREPROC);
+            /* EOF or a broken worker */
+            close(fds[fd_idx].fd);
+            fds[fd_idx].fd = -1;
+            open_fds--;
             continue;
          }
+         done[res.idx]     = true;
+         cpd->error_count += res.error_count;
 
-         /* Bail if we hit a preprocessor and cmt_insert_before_preproc is false */
-         if (ref->flags & PCF_IN_PREPROC)
+         while ((next_print < (int)jobs.size()) && done[next_print])
          {
-            tmp = chunk_get_prev_type(ref, CT_PREPROC, ref->level);
-            if ((tmp != NULL) && (tmp->parent_type == CT_PP_IF))
+            fwrite(logs[next_print].data(), 1, logs[next_print].size(), stderr);
+            logs[next_print].clear();
+            fwrite(outs[next_print].data(), 1, outs[next_print].size(), stdout);
+            outs[next_print].clear();
+            if (has_stats[next_print])
             {
-               tmp = chunk_get_prev_nnl(tmp);
-               if (chunk_is_comment(tmp) &&
-                   !cpd.settings[UO_cmt_insert_before_preproc].b)
-               {
-                  break;
-               }
+               stats_record(jobs[next_print].filename_in.c_str(), stats[next_print]);
             }
+            next_print++;
          }
+      }
+   }
+   fflush(stderr);
+   fflush(stdout);
 
-         /* Ignore 'right' comments */
-         if (chunk_is_comment(ref) && chunk_is_newline(chunk_get_prev(ref)))
-         {
-            break;
-         }
-
-         if ((ref->level == pc->level) &&
-             ((ref->flags & PCF_IN_PREPROC) ||
-              (ref->type == CT_SEMICOLON) ||
-              (ref->type == CT_BRACE_CLOSE)))
-         {
-            do_insert = true;
-            break;
-         }
+   for (idx = 0; idx < (int)pids.size(); idx++)
+   {
+      int status;
+      while ((waitpid(pids[idx], &status, 0) < 0) && (errno == EINTR))
+      {
       }
-      if (do_insert)
+   }
+
+   /* Anything not reported was lost with a worker */
+   for (idx = 0; idx < (int)jobs.size(); idx++)
+   {
+      if (!done[idx])
       {
-         /* Insert between after and ref */
-         chunk_t *after = chunk_get_next_ncnl(ref);
-         tokenize(fm.data, fm.length, after);
-         for (tmp = chunk_get_next(ref); tmp != after; tmp = chunk_get_next(tmp))
-         {
-            tmp->level = after->level;
-         }
+         LOG_FMT(LERR, "%s: no result for %s\n", __func__, jobs[idx].filename_in.c_str());
+         cpd->error_count++;
       }
    }
+
+   munmap((void *)next_job, sizeof(int));
 }
 
 
-static void uncrustify_start(const char *data, int data_len)
-{
-   /**
-    * Parse the text into chunks
-    */
-   tokenize(data, data_len, NULL);
+#endif
+
 
-   /* Add the file header */
-   if (cpd.file_hdr.data != NULL)
+/**
+ * Formats all the files in the job list, using up to 'workers' processes.
+ */
+static void run_file_jobs(const std::vector<file_job>& jobs, int workers,
+                          bool no_backup, bool keep_mtime)
+{
+   if (workers > (int)jobs.size())
    {
-      add_file_header();
+      workers = jobs.size();
    }
 
-   /* Add the file footer */
-   if (cpd.file_ftr.data != NULL)
+#ifndef WIN32
+   if (workers > 1)
    {
-      add_file_footer();
+      run_file_jobs_parallel(jobs, workers, no_backup, keep_mtime);
+      return;
    }
+#endif
 
-   /**
-    * Change certain token types based on simple sequence.
-    * Example: change '[' + ']' to '[]'
-    * Note that level info is not yet available, so it is OK to do all
-    * processing that doesn't need to know level info. (that's very little!)
-    */
-   tokenize_cleanup();
-
-   /**
-    * Detect the brace and paren levels and insert virtual braces.
-    * This handles all that nasty preprocessor stuff
-    */
-   brace_cleanup();
-
-   /**
-    * At this point, the level information is available and accurate.
-    */
-
-   if ((cpd.lang_flags & LANG_PAWN) != 0)
+   for (int idx = 0; idx < (int)jobs.size(); idx++)
    {
-      pawn_prescan();
+      do_source_file(jobs[idx].filename_in.c_str(), jobs[idx].filename_out.c_str(),
+                     NULL, no_backup, keep_mtime);
    }
-
-   /**
-    * Re-type chunks, combine chunks
-    */
-   fix_symbols();
-
-   mark_comments();
-
-   /**
-    * Look at all colons ':' and mark labels, :? sequences, etc.
-    */
-   combine_labels();
 }
 
 
-static void uncrustify_file(const char *data, int data_len, FILE *pfout,
-                            const char *parsed_file)
+/**
+ * Loads all of stdin. A big file redirected to stdin is mapped instead.
+ *
+ * @return SUCCESS or FAILURE (out of memory)
+ */
+static int read_stdin(file_mem& fm)
 {
-   uncrustify_start(data, data_len);
-
-   /**
-    * Done with detection. Do the rest only if the file will go somewhere.
-    * The detection code needs as few changes as possible.
-    */
-   if (pfout != NULL)
-   {
-      /**
-       * Add comments before function defs and classes
-       */
-      if (cpd.func_hdr.data != NULL)
-      {
-         add_func_header(CT_FUNC_DEF, cpd.func_hdr);
-      }
-      if (cpd.class_hdr.data != NULL)
-      {
-         add_func_header(CT_CLASS, cpd.class_hdr);
-      }
-
-      /**
-       * Change virtual braces into real braces...
-       */
-      do_braces();
-
-      /* Scrub extra semicolons */
-      if (cpd.settings[UO_mod_remove_extra_semicolon].b)
-      {
-         remove_extra_semicolons();
-      }
+   char *data;
+   char *new_data;
+   int  data_size;
+   int  data_len;
+   int  len;
 
-      /* Remove unnecessary returns */
-      if (cpd.settings[UO_mod_remove_empty_return].b)
-      {
-         remove_extra_returns();
-      }
+   fm.data     = NULL;
+   fm.length   = 0;
+   fm.map_size = 0;
 
-      /**
-       * Add parens
-       */
-      do_parens();
+   if (map_mem_file(fileno(stdin), fm))
+   {
+      return(SUCCESS);
+   }
 
-      /**
-       * Insert line breaks as needed
-       */
-      do_blank_lines();
-      newlines_cleanup_braces();
-      if (cpd.settings[UO_nl_after_multiline_comment].b)
-      {
-         newline_after_multiline_comment();
-      }
-      newlines_insert_blank_lines();
-      if (cpd.settings[UO_pos_bool].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_BOOL, cpd.settings[UO_pos_bool].tp);
-      }
-      if (cpd.settings[UO_pos_compare].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_COMPARE, cpd.settings[UO_pos_compare].tp);
-      }
-      if (cpd.settings[UO_pos_conditional].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_COND_COLON, cpd.settings[UO_pos_conditional].tp);
-         newlines_chunk_pos(CT_QUESTION, cpd.settings[UO_pos_conditional].tp);
-      }
-      if (cpd.settings[UO_pos_comma].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_COMMA, cpd.settings[UO_pos_comma].tp);
-      }
-      if (cpd.settings[UO_pos_assign].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_ASSIGN, cpd.settings[UO_pos_assign].tp);
-      }
-      if (cpd.settings[UO_pos_arith].tp != TP_IGNORE)
-      {
-         newlines_chunk_pos(CT_ARITH, cpd.settings[UO_pos_arith].tp);
-      }
-      newlines_class_colon_pos();
-      if (cpd.settings[UO_nl_squeeze_ifdef].b)
-      {
-         newlines_squeeze_ifdef();
-      }
-      newlines_eat_start_end();
-      newlines_cleanup_dup();
+   /* Start with 64k */
+   data_size = 64 * 1024;
+   data      = (char *)malloc(data_size);
+   data_len  = 0;
 
-      mark_comments();
+   if (data == NULL)
+   {
+      return(FAILURE);
+   }
 
-      /**
-       * Add balanced spaces around nested params
-       */
-      if (cpd.settings[UO_sp_balance_nested_parens].b)
+   while ((len = fread(&data[data_len], 1, data_size - data_len, stdin)) > 0)
+   {
+      data_len += len;
+      if (data_len == data_size)
       {
-         space_text_balance_nested_parens();
+         /* Double the buffer size */
+         data_size *= 2;
+         if ((new_data = (char *)realloc(data, data_size)) == NULL)
+         {
+            free(data);
+            return(FAILURE);
+         }
+         data = new_data;
       }
+   }
 
-      /* Scrub certain added semicolons */
-      if (((cpd.lang_flags & LANG_PAWN) != 0) &&
-          cpd.settings[UO_mod_pawn_semicolon].b)
-      {
-         pawn_scrub_vsemi();
-      }
+   assert(data_len < data_size);
+   /* Make sure the buffer is terminated */
+   data[data_len] = 0;
 
-      /* Sort imports/using/include */
-      if (cpd.settings[UO_mod_sort_import].b ||
-          cpd.settings[UO_mod_sort_include].b ||
-          cpd.settings[UO_mod_sort_using].b)
-      {
-         sort_imports();
-      }
+   fm.data   = data;
+   fm.length = data_len;
+   return(SUCCESS);
+}
 
-      /**
-       * Fix same-line inter-chunk spacing
-       */
-      space_text();
 
-      /**
-       * Do any aligning of preprocessors
-       */
-      if (cpd.settings[UO_align_pp_define_span].n > 0)
-      {
-         align_preprocessor();
-      }
+static void make_folders(const char *filename)
+{
+   int  idx;
+   int  last_idx = 0;
+   char outname[1024];
 
-      /**
-       * Indent the text
-       */
-      indent_preproc();
-      indent_text();
+   snprintf(outname, sizeof(outname), "%s", filename);
 
-      /* Insert trailing comments after certain close braces */
-      if ((cpd.settings[UO_mod_add_long_switch_closebrace_comment].n > 0) ||
-          (cpd.settings[UO_mod_add_long_function_closebrace_comment].n > 0))
+   for (idx = 0; outname[idx] != 0; idx++)
+   {
+      if ((outname[idx] == '/') || (outname[idx] == '\\'))
       {
-         add_long_closebrace_comment();
+         outname[idx] = PATH_SEP;
       }
 
-      /* Insert trailing comments after certain preprocessor conditional blocks */
-      if ((cpd.settings[UO_mod_add_long_ifdef_else_comment].n > 0) ||
-          (cpd.settings[UO_mod_add_long_ifdef_endif_comment].n > 0))
+      if ((idx > last_idx) && (outname[idx] == PATH_SEP))
       {
-         add_long_preprocessor_conditional_block_comment();
-      }
-
-      /**
-       * Aligning everything else and reindent
-       */
-      align_all();
-      indent_text();
+         outname[idx] = 0;
 
-      if (cpd.settings[UO_code_width].n > 0)
-      {
-         int max_passes = 3;
-         int prev_changes;
-         do
+         if ((strcmp(&outname[last_idx], ".") != 0) &&
+             (strcmp(&outname[last_idx], "..") != 0))
          {
-            prev_changes = cpd.changes;
-            do_code_width();
-            if (prev_changes != cpd.changes)
-            {
-               align_all();
-               indent_text();
-            }
-         } while ((prev_changes != cpd.changes) && (--max_passes > 0));
-      }
-
-      /**
-       * And finally, align the backslash newline stuff
-       */
-      align_right_comments();
-      if (cpd.settings[UO_align_nl_cont].b)
-      {
-         align_backslash_newline();
+            //fprintf(stderr, "%s: %s\n", __func__, outname);
+            mkdir(outname, 0750);
+         }
+         outname[idx] = PATH_SEP;
       }
 
-      /**
-       * Now render it all to the output file
-       */
-      output_text(pfout);
-   }
-
-   /* Special hook for dumping parsed data for debugging */
-   if (parsed_file != NULL)
-   {
-      FILE *p_file = fopen(parsed_file, "w");
-      if (p_file != NULL)
-      {
-         output_parsed(p_file);
-         fclose(p_file);
-      }
-      else
+      if (outname[idx] == PATH_SEP)
       {
-         LOG_FMT(LERR, "%s: Failed to open '%s' for write: %s (%d)\n",
-                 __func__, parsed_file, strerror(errno), errno);
+         last_idx = idx + 1;
       }
    }
-
-   uncrustify_end();
 }
 
 
-static void uncrustify_end()
+static const char *make_output_filename(char *buf, int buf_size,
+                                        const char *filename,
+                                        const char *prefix,
+                                        const char *suffix)
 {
-   /* Free all the memory */
-   chunk_t *pc;
+   int len = 0;
 
-   while ((pc = chunk_get_head()) != NULL)
+   if (prefix != NULL)
    {
-      chunk_del(pc);
+      len = snprintf(buf, buf_size, "%s/", prefix);
    }
 
-   if (cpd.bom != NULL)
-   {
-      chunk_del(cpd.bom);
-      cpd.bom = NULL;
-   }
+   snprintf(&buf[len], buf_size - len, "%s%s", filename,
+            (suffix != NULL) ? suffix : "");
 
-   /* Clean up some state variables */
-   cpd.unc_off     = false;
-   cpd.al_cnt      = 0;
-   cpd.did_newline = true;
-   cpd.frame_count = 0;
-   cpd.pp_level    = 0;
-   cpd.changes     = 0;
-   cpd.in_preproc  = CT_NONE;
-   cpd.consumed    = false;
-   memset(cpd.le_counts, 0, sizeof(cpd.le_counts));
-   cpd.preproc_ncnl_count = 0;
+   return(buf);
 }
 
 
-const char *get_token_name(c_token_t token)
+const char *fix_filename(const char *filename)
 {
-   if ((token >= 0) && (token < (int)ARRAY_SIZE(token_names)) &&
-       (token_names[token] != NULL))
+   char *tmp_file;
+
+   /* Create 'outfile.uncrustify' */
+   tmp_file = new char[strlen(filename) + 16];
+   if (tmp_file != NULL)
    {
-      return(token_names[token]);
+      sprintf(tmp_file, "%s.uncrustify", filename);
    }
-   return("???");
+   return(tmp_file);
 }
 
 
 /**
- * Grab the token id for the text.
- * returns CT_NONE on failure t match
+ * Gets the absolute path of a file, so that the server can find it.
  */
-c_token_t find_token_name(const char *text)
+static std::string abs_path(const char *filename)
 {
-   int idx;
+#ifndef WIN32
+   char *path = realpath(filename, NULL);
 
-   if ((text != NULL) && (*text != 0))
+   if (path != NULL)
    {
-      for (idx = 1; idx < (int)ARRAY_SIZE(token_names); idx++)
-      {
-         if (strcasecmp(text, token_names[idx]) == 0)
-         {
-            return((c_token_t)idx);
-         }
-      }
+      std::string ret = path;
+      free(path);
+      return(ret);
    }
-   return(CT_NONE);
+#endif
+   return(filename);
 }
 
 
-static bool ends_with(const char *filename, const char *tag)
+/**
+ * With --client, the server loads the type and define files, so they are
+ * passed along instead of being loaded here.
+ *
+ * @param kind     "t", "type", "d" or "define"
+ * @param arg      The file or word
+ * @param is_file  Whether arg is a file
+ * @return         true if arg was passed to the server
+ */
+static bool client_add_extra(const char *kind, const char *arg, bool is_file)
 {
-   int len1 = strlen(filename);
-   int len2 = strlen(tag);
-
-   if ((len2 <= len1) && (strcmp(&filename[len1 - len2], tag) == 0))
+   if (client_sock == NULL)
    {
-      return(true);
+      return(false);
    }
-   return(false);
+   client_cfg.extras += kind;
+   client_cfg.extras += ' ';
+   client_cfg.extras += is_file ? abs_path(arg) : arg;
+   client_cfg.extras += '\n';
+   return(true);
 }
 
 
-struct file_lang
-{
-   const char *ext;
-   const char *tag;
-   int        lang;
-};
-
-struct file_lang languages[] =
-{
-   { ".c",    "C",    LANG_C             },
-   { ".cpp",  "CPP",  LANG_CPP           },
-   { ".d",    "D",    LANG_D             },
-   { ".cs",   "CS",   LANG_CS            },
-   { ".vala", "VALA", LANG_VALA          },
-   { ".java", "JAVA", LANG_JAVA          },
-   { ".pawn", "PAWN", LANG_PAWN          },
-   { ".p",    "",     LANG_PAWN          },
-   { ".sma",  "",     LANG_PAWN          },
-   { ".inl",  "",     LANG_PAWN          },
-   { ".h",    "",     LANG_CPP           },
-   { ".cxx",  "",     LANG_CPP           },
-   { ".hpp",  "",     LANG_CPP           },
-   { ".hxx",  "",     LANG_CPP           },
-   { ".cc",   "",     LANG_CPP           },
-   { ".di",   "",     LANG_D             },
-   { ".m",    "OC",   LANG_OC            },
-   { ".mm",   "OC+",  LANG_OC | LANG_CPP },
-   { ".sqc",  "",     LANG_C             }, // embedded SQL
-   { ".es",   "ECMA", LANG_ECMA          },
-};
-
 /**
- * Set idx = 0 before the first call.
- * Done when returns NULL
+ * Formats the data here or, with --client, on the server.
+ *
+ * @param text  Gets the output
+ * @return false if there is no output
  */
-const char *get_file_extension(int& idx)
+static bool format_data(const char *data, int data_len,
+                        const char *parsed_file, std::string& text)
 {
-   const char *val = NULL;
+   const char *out;
+   int        out_len;
 
-   if (idx < (int)ARRAY_SIZE(languages))
+#ifndef WIN32
+   if (client_sock != NULL)
+   {
+      return(client_format(client_sock, client_cfg, cpd->filename,
+                           cpd->lang_flags, data, data_len, text));
+   }
+#endif
+   out = uncrustify_file_mem(data, data_len, out_len, parsed_file);
+   text.assign(out, out_len);
+   if (cpd->stats != NULL)
    {
-      val = languages[idx].ext;
+      stats_record(cpd->filename, *cpd->stats);
    }
-   idx++;
-   return(val);
+   return(true);
 }
 
 
 /**
- * Find the language for the file extension
- * Default to C
+ * Writes the text to filename.
+ * With use_tmp, the text is written to 'filename.uncrustify', which is then
+ * renamed to filename, so that filename is never left half written.
+ * Otherwise the file is written in place, like any other output, so that
+ * symlinks, devices, owner and permissions are kept.
  *
- * @param filename   The name of the file
- * @return           LANG_xxx
+ * @return SUCCESS or FAILURE
  */
-static int language_from_filename(const char *filename)
+static int write_file(const char *filename, const std::string& text, bool use_tmp)
 {
-   int i;
+   const char *filename_tmp = filename;
+   FILE       *pfout;
+   bool       ok;
+   int        my_errno;
+   int        retval = FAILURE;
 
-   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   if (use_tmp)
    {
-      if (ends_with(filename, languages[i].ext))
+      filename_tmp = fix_filename(filename);
+      if (filename_tmp == NULL)
       {
-         return(languages[i].lang);
+         LOG_FMT(LERR, "%s: Out of memory\n", __func__);
+         cpd->error_count++;
+         return(FAILURE);
       }
    }
-   return(LANG_C);
-}
-
+   make_folders(filename_tmp);
 
-/**
- * Find the language for the file extension
- *
- * @param filename   The name of the file
- * @return           LANG_xxx or 0 (no match)
- */
-static int language_from_tag(const char *tag)
-{
-   int i;
-
-   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   pfout = fopen(filename_tmp, "wb");
+   if (pfout == NULL)
    {
-      if (strcasecmp(tag, languages[i].tag) == 0)
+      LOG_FMT(LERR, "%s: Unable to create %s: %s (%d)\n",
+              __func__, filename_tmp, strerror(errno), errno);
+   }
+   else
+   {
+      ok       = text.empty() || (fwrite(text.data(), text.size(), 1, pfout) == 1);
+      my_errno = errno;
+      ok       = (fclose(pfout) == 0) && ok;
+      if (!ok)
+      {
+         LOG_FMT(LERR, "%s: Unable to write %s: %s (%d)\n",
+                 __func__, filename_tmp, strerror(my_errno), my_errno);
+         if (use_tmp)
+         {
+            (void)unlink(filename_tmp);
+         }
+      }
+      else if (!use_tmp)
+      {
+         retval = SUCCESS;
+      }
+      else
       {
-         return(languages[i].lang);
+#ifdef WIN32
+         /* windows can't rename a file if the target exists, so delete it
+          * first. This may cause data loss if the tmp file gets deleted
+          * or can't be renamed.
+          */
+         (void)unlink(filename);
+#endif
+         if (rename(filename_tmp, filename) != 0)
+         {
+            LOG_FMT(LERR, "%s: Unable to rename '%s' to '%s'\n",
+                    __func__, filename_tmp, filename);
+            (void)unlink(filename_tmp);
+         }
+         else
+         {
+            retval = SUCCESS;
+         }
       }
    }
-   return(0);
+   if (retval != SUCCESS)
+   {
+      cpd->error_count++;
+   }
+   if (use_tmp)
+   {
+      delete [] (char *)filename_tmp;
+   }
+   return(retval);
 }
 
 
 /**
- * Gets the tag text for a language
+ * Does a source file.
+ * The output is made in memory. A file is only written if the text differs
+ * from what is there. With --diff, no file is written and only the changes
+ * are printed.
  *
- * @param lang    The LANG_xxx enum
- * @return        A string
+ * @param filename_in  the file to read
+ * @param filename_out NULL (stdout) or the file to write
+ * @param parsed_file  NULL or the filename for the parsed debug info
+ * @param no_backup    don't create a backup, if filename_out == filename_in
+ * @param keep_mtime   don't change the mtime (dangerous)
  */
-static const char *language_to_string(int lang)
+static void do_source_file(const char *filename_in,
+                           const char *filename_out,
+                           const char *parsed_file,
+                           bool       no_backup,
+                           bool       keep_mtime)
 {
-   int i;
+   file_mem    fm;
+   std::string text;
+   bool        replace;
+   bool        backup;
+   char        cache_key[CACHE_KEY_SIZE];
+   UINT32      old_errors;
+
+   /* Do some simple language detection based on the filename extension.
+    * This is done for each file, so that the result doesn't depend on which
+    * files were done before (or by which worker).
+    */
+   if (!cpd->lang_forced)
+   {
+      cpd->lang_flags = language_from_filename(filename_in);
+   }
 
-   /* Check for an exact match first */
-   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   /* Try to read in the source file */
+   if (load_mem_file(filename_in, fm) < 0)
    {
-      if (languages[i].lang == lang)
-      {
-         return(languages[i].tag);
-      }
+      LOG_FMT(LERR, "Failed to load (%s)\n", filename_in);
+      cpd->error_count++;
+      return;
    }
 
-   /* Check for the first set language bit */
-   for (i = 0; i < (int)ARRAY_SIZE(languages); i++)
+   replace = (filename_out != NULL) && (strcmp(filename_in, filename_out) == 0);
+   backup  = replace && !no_backup;
+
+   /* When replacing, skip the files that are known to be formatted */
+   cache_key[0] = 0;
+   if (replace && (parsed_file == NULL) &&
+       cache_lookup(fm.data, fm.length, cpd->lang_flags, cache_key))
    {
-      if ((languages[i].lang & lang) != 0)
-      {
-         return(languages[i].tag);
-      }
+      LOG_FMT(LNOTE, "Unchanged: %s (cached)\n", filename_in);
+      free_file_mem(fm);
+      return;
    }
-   return("???");
-}
 
+   LOG_FMT(LSYS, "Parsing: %s as language %s\n",
+           filename_in, language_to_string(cpd->lang_flags));
 
-void log_pcf_flags(log_sev_t sev, UINT32 flags)
-{
-   if (!log_sev_on(sev))
+   cpd->filename = filename_in;
+   old_errors    = cpd->error_count;
+   if (!format_data(fm.data, fm.length, parsed_file, text))
    {
+      /* No output - leave the files alone */
+      free_file_mem(fm);
       return;
    }
 
-   log_fmt(sev, "[0x%X:", flags);
+   if (diff_mode != DIFF_NONE)
+   {
+      /* Only show what would change */
+      diff_report(stdout, diff_mode, filename_in, fm.data, fm.length,
+                  text.data(), text.size());
+      free_file_mem(fm);
+      return;
+   }
 
-   const char *tolog = NULL;
-   for (int i = 0; i < (int)ARRAY_SIZE(pcf_names); i++)
+   if (filename_out == NULL)
    {
-      if ((flags & (1 << i)) != 0)
+      fwrite(text.data(), text.size(), 1, stdout);
+      free_file_mem(fm);
+      return;
+   }
+
+   if (replace && (text.size() == (size_t)fm.length) &&
+       (memcmp(text.data(), fm.data, fm.length) == 0))
+   {
+      /* No change - don't touch the file.
+       * A file that logged errors is not cached, so that they show up again.
+       */
+      if (cpd->error_count == old_errors)
       {
-         if (tolog != NULL)
-         {
-            log_str(sev, tolog, strlen(tolog));
-            log_str(sev, ",", 1);
-         }
-         tolog = pcf_names[i];
+         cache_store(cache_key);
       }
+      free_file_mem(fm);
+      return;
    }
 
-   if (tolog != NULL)
+   if (backup && (backup_copy_file(filename_in, fm.data, fm.length) != SUCCESS))
    {
-      log_str(sev, tolog, strlen(tolog));
+      LOG_FMT(LERR, "%s: Failed to create backup file for %s\n",
+              __func__, filename_in);
+      free_file_mem(fm);
+      cpd->error_count++;
+      return;
    }
 
-   log_str(sev, "]\n", 2);
+   if (write_file(filename_out, text, replace) == SUCCESS)
+   {
+      if (backup)
+      {
+         backup_create_md5_file(filename_in, text.data(), text.size());
+      }
+
+#ifdef HAVE_UTIME_H
+      if (keep_mtime)
+      {
+         /* update mtime -- don't care if it fails */
+         fm.utb.actime = time(NULL);
+         (void)utime(filename_in, &fm.utb);
+      }
+#endif
+   }
+   free_file_mem(fm);
 }
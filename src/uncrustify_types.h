@@ -15,7 +15,10 @@
 #include "token_enum.h"    /* c_token_t */
 #include "log_levels.h"
 #include "logger.h"
+#include "ListManager.h"
+#include "SharedArray.h"
 #include <cstdio>
+#include <vector>
 #include <assert.h>
 #ifdef HAVE_UTIME_H
 #include <utime.h>
@@ -43,6 +46,8 @@ enum brstage_e
 };
 
 struct chunk_t;
+struct space_table_t;   /* see space.cpp */
+struct line_map_t;      /* see output.cpp */
 
 /**
  * Structure for counting nested level
@@ -64,26 +69,30 @@ struct paren_stack_entry
    bool      non_vardef;   /**< Hit a non-vardef line */
 };
 
-/* TODO: put this on a linked list */
+/**
+ * A parse frame is copied on each #if, #else and #define, see pf_push().
+ * The copies share the paren stack entries until they are changed.
+ * Clear it with 'frm = parse_frame()', not with memset().
+ */
 struct parse_frame
 {
-   int                      ref_no;
-   int                      level;           // level of parens/square/angle/brace
-   int                      brace_level;     // level of brace/vbrace
-   int                      pp_level;        // level of preproc #if stuff
+   int                            ref_no;
+   int                            level;       // level of parens/square/angle/brace
+   int                            brace_level; // level of brace/vbrace
+   int                            pp_level;    // level of preproc #if stuff
 
-   int                      sparen_count;
+   int                            sparen_count;
 
-   struct paren_stack_entry pse[128];
-   int                      pse_tos;
-   int                      paren_count;
+   SharedArray<paren_stack_entry> pse;       // grows as needed
+   int                            pse_tos;
+   int                            paren_count;
 
-   c_token_t                in_ifdef;
-   int                      stmt_count;
-   int                      expr_count;
+   c_token_t                      in_ifdef;
+   int                            stmt_count;
+   int                            expr_count;
 
-   bool                     maybe_decl;
-   bool                     maybe_cast;
+   bool                           maybe_decl;
+   bool                           maybe_cast;
 };
 
 #define PCF_FORCE_SPACE        (1 << 0)  /* must have a space after this token */
@@ -191,14 +200,29 @@ struct align_ptr_t
    chunk_t *start;
 };
 
+/**
+ * A line of the file, see chunk_line_index().
+ * The newline at the end of a line is part of it.
+ */
+struct line_t
+{
+   chunk_t *first;     /* the first chunk on the line */
+   chunk_t *nl;        /* the newline that ends it, NULL on the last line */
+   int     oc_colons;  /* ObjC msg colons on the line, -1 if not counted yet */
+   int     oc_seq;     /* cpd->oc_seq when oc_near was set */
+   bool    oc_near;    /* see oc_msg_line_near_colon() */
+};
+
 /** This is the main type of this program */
 struct chunk_t
 {
    chunk_t     *next;
    chunk_t     *prev;
-   align_ptr_t align;
+   align_ptr_t *align;           /* NULL until the chunk is aligned, see chunk_align() */
+   chunk_t     *match;           /* the other half of a paren/brace/etc pair */
+   line_t      *line;            /* NULL unless there is a line index */
    c_token_t   type;
-   c_token_t   parent_type;     /* usually CT_NONE */
+   c_token_t   parent_type;      /* usually CT_NONE */
    UINT32      orig_line;
    UINT32      orig_col;
    UINT32      orig_col_end;
@@ -211,6 +235,7 @@ struct chunk_t
    int         brace_level;      /* nest level in braces only */
    int         pp_level;         /* nest level in #if stuff */
    bool        after_tab;        /* whether this token was after a tab */
+   UINT16      match_gen;        /* 'match' is only valid if equal to cpd->match_gen */
    int         len;              /* # of bytes at str that make up the token */
    const char  *str;             /* pointer to the token text */
 };
@@ -269,6 +294,47 @@ typedef struct
    const char *value;
 } define_tag_t;
 
+typedef struct
+{
+   chunk_tag_t *p_tags;
+   int         total;            /* number of items at p_tags */
+   int         active;           /* number of valid entries */
+   int         *hash;            /* index in p_tags for each slot, or -1 */
+   int         hash_size;        /* number of slots, a power of 2 */
+   bool        sorted;           /* whether p_tags is sorted by tag */
+} dynamic_word_list_t;
+
+typedef struct
+{
+   define_tag_t *p_tags;
+   int          total;            /* number of items at p_tags */
+   int          active;           /* number of valid entries */
+} define_list_t;
+
+typedef ListManager<chunk_t>   ChunkList;
+
+/**
+ * Where the chunks of a file are allocated.
+ * Chunks are handed out from slabs of CHUNK_SLAB_SIZE, deleted chunks go on
+ * a free list for reuse, and all the chunks are released at once at the end
+ * of the file. The alignment data of the chunks that get aligned comes from
+ * slabs of its own, and so do the lines of the line index. See chunk_list.cpp.
+ */
+struct chunk_slab;
+struct align_slab;
+struct line_slab;
+
+typedef struct
+{
+   struct chunk_slab *slabs;       /* newest first, chunks come from the first */
+   int               slab_used;    /* number of chunks used in the first slab */
+   chunk_t           *free_list;   /* deleted chunks, linked by 'next' */
+   struct align_slab *align_slabs; /* same as 'slabs', for chunk_t::align */
+   int               align_used;   /* number of entries used in the first align slab */
+   struct line_slab  *line_slabs;  /* same as 'slabs', for the line index */
+   int               line_used;    /* number of lines used in the first line slab */
+} chunk_arena_t;
+
 
 struct align_t
 {
@@ -290,61 +356,116 @@ typedef struct chunk_stack
    int                 size;
 } chunk_stack_t;
 
+/**
+ * The rendered text of a file.
+ * The buffer is kept for the next file.
+ */
+struct output_buf_t
+{
+   char *data;
+   int  len;                     /* number of bytes used */
+   int  size;                    /* number of bytes allocated */
+};
+
 struct file_mem
 {
    char           *data;
    int            length;
+   size_t         map_size;     /* size of the mapping if data is mapped */
 #ifdef HAVE_UTIME_H
    struct utimbuf utb;
 #endif
 };
 
+/**
+ * The formatting context.
+ * This holds everything needed to format one file: the settings, the
+ * keywords and defines that go with them, the chunk list and the parse
+ * state. Nothing that changes while formatting lives outside of it, so
+ * several contexts can be used in one process, one per thread at a time.
+ */
 struct cp_data
 {
-   FILE               *fout;
+   output_buf_t             out;    /* what output_text() renders */
 
-   UINT32             error_count;
-   const char         *filename;
+   UINT32                   error_count;
+   const char               *filename;
 
-   file_mem           file_hdr;   /* for cmt_insert_file_header */
-   file_mem           file_ftr;   /* for cmt_insert_file_footer */
-   file_mem           func_hdr;   /* for cmt_insert_func_header */
-   file_mem           class_hdr;  /* for cmt_insert_class_header */
+   file_mem                 file_hdr;    /* for cmt_insert_file_header */
+   file_mem                 file_ftr;    /* for cmt_insert_file_footer */
+   file_mem                 func_hdr;    /* for cmt_insert_func_header */
+   file_mem                 class_hdr;   /* for cmt_insert_class_header */
 
-   int                lang_flags; // LANG_xxx
+   int                      lang_flags;  // LANG_xxx
+   bool                     lang_forced; // lang_flags came from '-l'
 
-   bool               unc_off;
-   UINT32             line_number;
-   UINT16             column;  /* column for parsing */
+   bool                     unc_off;
+   UINT32                   line_number;
+   UINT16                   column; /* column for parsing */
 
    /* stuff to auto-detect line endings */
-   UINT32             le_counts[LE_AUTO];
-   char               newline[5];
+   UINT32                   le_counts[LE_AUTO];
+   char                     newline[5];
 
-   bool               consumed;
+   bool                     consumed;
 
-   int                did_newline;
-   c_token_t          in_preproc;
-   int                preproc_ncnl_count;
+   int                      did_newline;
+   c_token_t                in_preproc;
+   int                      preproc_ncnl_count;
 
-   chunk_t            *bom;
+   chunk_t                  *bom;
 
    /* bumped up when a line is split or indented */
-   int                changes;
+   int                      changes;
 
-   struct align_t     al[80];
-   int                al_cnt;
-   bool               al_c99_array;
+   struct align_t           al[80];
+   int                      al_cnt;
+   bool                     al_c99_array;
 
    /* Here are all the settings */
-   op_val_t           settings[UO_option_count];
-   int                max_option_name_len;
-
-   struct parse_frame frames[16];
-   int                frame_count;
-   int                pp_level;
+   op_val_t                 settings[UO_option_count];
+
+   /* types from '-t' files and 'type' lines, defines from '-d' files */
+   dynamic_word_list_t      keywords;
+   define_list_t            defines;
+
+   /* the chunks of the file being formatted */
+   ChunkList                chunks;
+   chunk_arena_t            arena;
+   UINT32                   chunks_added;   /* chunks put in the list since the last file */
+   UINT32                   chunks_deleted; /* chunks taken out of the list since the last file */
+   UINT16                   match_gen;      /* bumped when chunk_t::match links may be wrong */
+   bool                     match_used;     /* a link was made with the current match_gen */
+
+   /* the chunks of each type, see chunk_first_of_type() */
+   std::vector<chunk_t *>   type_list[CT_TOKEN_COUNT];
+   bool                     type_known[CT_TOKEN_COUNT]; /* type_list[] is up to date */
+   int                      type_pos[CT_TOKEN_COUNT];   /* where chunk_next_of_type() left off */
+   bool                     line_index;                 /* see chunk_line_index() */
+   int                      oc_seq;                     /* see oc_msg_lines_reset() */
+
+   std::vector<parse_frame> frames;                     /* the #if and #define stack, see pf_push() */
+   int                      pp_level;
+   int                      pf_ref_no;                  /* last parse_frame::ref_no handed out */
+   int                      indent_ref;                 /* last paren_stack_entry::ref handed out by indent */
+
+   char                     last_char;                  /* last character sent to the output */
+
+   struct file_stats_t      *stats;                     /* NULL unless --stats */
+
+   space_table_t            *sp_table;                  /* do_space() answers for the settings */
+
+   /* --lines: only these lines of the input are formatted */
+   int                      line_first;
+   int                      line_last;  /* 0 to format the whole file */
+   bool                     line_patch; /* output just the new text of the lines */
+   line_map_t               *line_map;  /* where output_text() put the chunks */
 };
 
-extern struct cp_data cpd;
+/**
+ * The context that the current thread is formatting with.
+ * Each thread that formats must point this at its own context.
+ */
+extern THREAD_LOCAL struct cp_data *cpd;
 
 #endif   /* UNCRUSTIFY_TYPES_H_INCLUDED */
@@ -145,7 +145,7 @@ void print_universal_indent_cfg(FILE *pfile)
             fprintf(pfile, "EditorType=multiple\n");
             fprintf(pfile, "Choices=\"%s=0|%s=1|%s=2\"\n", option->name, option->name, option->name);
             fprintf(pfile, "ChoicesReadable=\"Spaces only|Indent with tabs, align with spaces|Indent and align with tabs\"\n");
-            fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+            fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
             break;
 
          // All not specially handled options are created only dependent by their type.
@@ -163,7 +163,7 @@ void print_universal_indent_cfg(FILE *pfile)
                // TrueFalse="align_keep_tabs=true|align_keep_tabs=false"
                fprintf(pfile, "EditorType=boolean\n");
                fprintf(pfile, "TrueFalse=%s=true|%s=false\n", option->name, option->name);
-               fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+               fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
                break;
 
             case AT_IARF:
@@ -172,7 +172,7 @@ void print_universal_indent_cfg(FILE *pfile)
                        option->name, option->name, option->name, option->name);
                fprintf(pfile, "ChoicesReadable=\"Ignore %s|Add %s|Remove %s|Force %s\"\n",
                        optionNameReadable, optionNameReadable, optionNameReadable, optionNameReadable);
-               fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+               fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
                // [nl_after_switch]
                // Category=4
                // Description=<html>Add or remove newline after 'switch'</html>
@@ -198,7 +198,7 @@ void print_universal_indent_cfg(FILE *pfile)
                fprintf(pfile, "CallName=\"%s=\"\n", option->name);
                fprintf(pfile, "MinVal=%d\n", option->min_val);
                fprintf(pfile, "MaxVal=%d\n", option->max_val);
-               fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+               fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
                break;
 
             case AT_LINE:
@@ -214,7 +214,7 @@ void print_universal_indent_cfg(FILE *pfile)
                fprintf(pfile, "Choices=\"%s=lf|%s=crlf|%s=cr|%s=auto\"\n",
                        option->name, option->name, option->name, option->name);
                fprintf(pfile, "ChoicesReadable=\"Newlines Mac|Newlines Win|Newlines Unix|Newlines Auto\"\n");
-               fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+               fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
                break;
 
             case AT_POS:
@@ -231,7 +231,7 @@ void print_universal_indent_cfg(FILE *pfile)
                        option->name, option->name, option->name);
                fprintf(pfile, "ChoicesReadable=\"Ignore %s|Lead %s|Trail %s\"\n",
                        optionNameReadable, optionNameReadable, optionNameReadable);
-               fprintf(pfile, "ValueDefault=%d\n", cpd.settings[option->id].n);
+               fprintf(pfile, "ValueDefault=%d\n", cpd->settings[option->id].n);
                break;
 
             case AT_STRING:
@@ -240,7 +240,7 @@ void print_universal_indent_cfg(FILE *pfile)
                   fprintf(pfile, "EditorType=string\n");
                   std::string val_string;
                   const char  *val_str;
-                  val_string = op_val_to_string(option->type, cpd.settings[option->id]);
+                  val_string = op_val_to_string(option->type, cpd->settings[option->id]);
                   val_str    = val_string.c_str();
                   fprintf(pfile, "ValueDefault=%s\n", val_str);
                }
@@ -17,7 +17,7 @@ static void split_for_stmt(chunk_t *start);
 
 static_inline bool is_past_width(chunk_t *pc)
 {
-   return((pc->column + pc->len) > cpd.settings[UO_code_width].n);
+   return((pc->column + pc->len) > cpd->settings[UO_code_width].n);
 }
 
 
@@ -32,8 +32,8 @@ static void split_before_chunk(chunk_t *pc)
        !chunk_is_newline(chunk_get_prev(pc)))
    {
       newline_add_before(pc);
-      reindent_line(pc, pc->brace_level * cpd.settings[UO_indent_columns].n);
-      cpd.changes++;
+      reindent_line(pc, pc->brace_level * cpd->settings[UO_indent_columns].n);
+      cpd->changes++;
    }
 }
 
@@ -211,7 +211,7 @@ static void split_line(chunk_t *start)
    {
       LOG_FMT(LSPLIT, " ** FUNC SPLIT **\n");
 
-      if (cpd.settings[UO_ls_func_split_full].b)
+      if (cpd->settings[UO_ls_func_split_full].b)
       {
          split_fcn_params_full(start);
          if (!is_past_width(start))
@@ -257,16 +257,16 @@ static void split_line(chunk_t *start)
 
    /* Break before the token instead of after it according to the pos_xxx rules */
    if ((chunk_is_token(ent.pc, CT_ARITH) &&
-        (cpd.settings[UO_pos_arith].tp == TP_LEAD)) ||
+        (cpd->settings[UO_pos_arith].tp == TP_LEAD)) ||
        (chunk_is_token(ent.pc, CT_ASSIGN) &&
-        (cpd.settings[UO_pos_assign].tp == TP_LEAD)) ||
+        (cpd->settings[UO_pos_assign].tp == TP_LEAD)) ||
        (chunk_is_token(ent.pc, CT_COMPARE) &&
-        (cpd.settings[UO_pos_compare].tp == TP_LEAD)) ||
+        (cpd->settings[UO_pos_compare].tp == TP_LEAD)) ||
        ((chunk_is_token(ent.pc, CT_COND_COLON) ||
          chunk_is_token(ent.pc, CT_QUESTION)) &&
-        (cpd.settings[UO_pos_compare].tp == TP_LEAD)) ||
+        (cpd->settings[UO_pos_compare].tp == TP_LEAD)) ||
        (chunk_is_token(ent.pc, CT_BOOL) &&
-        (cpd.settings[UO_pos_bool].tp == TP_LEAD)))
+        (cpd->settings[UO_pos_bool].tp == TP_LEAD)))
    {
       pc = ent.pc;
    }
@@ -305,7 +305,7 @@ static void split_line(chunk_t *start)
 static void split_for_stmt(chunk_t *start)
 {
    int     count   = 0;
-   int     max_cnt = cpd.settings[UO_ls_for_split_full].b ? 2 : 1;
+   int     max_cnt = cpd->settings[UO_ls_for_split_full].b ? 2 : 1;
    chunk_t *st[2];
    chunk_t *pc;
    chunk_t *open_paren = NULL;
@@ -482,7 +482,7 @@ static void split_fcn_params(chunk_t *start)
 
       LOG_FMT(LSPLIT, " mincol=%d, max_width=%d ",
               min_col,
-              cpd.settings[UO_code_width].n - min_col);
+              cpd->settings[UO_code_width].n - min_col);
 
       while (pc != NULL)
       {
@@ -507,7 +507,7 @@ static void split_fcn_params(chunk_t *start)
                if (cur_width > max_width)
                {
                   max_width = cur_width;
-                  if ((max_width + min_col) > cpd.settings[UO_code_width].n)
+                  if ((max_width + min_col) > cpd->settings[UO_code_width].n)
                   {
                      break;
                   }
@@ -523,7 +523,7 @@ static void split_fcn_params(chunk_t *start)
          pc = chunk_get_next(pc);
       }
 
-      if ((max_width + min_col) > cpd.settings[UO_code_width].n)
+      if ((max_width + min_col) > cpd->settings[UO_code_width].n)
       {
          LOG_FMT(LSPLIT, " - A param won't fit, nl after open paren.");
          split_before_chunk(chunk_get_next(fpo));
@@ -0,0 +1,48 @@
+#! /bin/sh
+#
+# Runs the cases in cmdline.test, which need command line options that the
+# .test files can't give. Each line is "name config input options...".
+# The output is compared the same way as for the .test files.
+#
+
+exe=${1:-../src/uncrustify}
+pass=0
+fail=0
+
+while read name config input opts
+do
+	case "$name" in
+		''|'#'*) continue ;;
+	esac
+
+	expected="output/$(dirname $input)/$name-$(basename $input)"
+	result="results/$(dirname $input)/$name-$(basename $input)"
+	mkdir -p $(dirname $result)
+
+	if $exe -q -c config/$config -f input/$input $opts > $result &&
+	   cmp -s $result $expected
+	then
+		pass=$((pass + 1))
+	else
+		echo "MISMATCH: $name"
+		fail=$((fail + 1))
+	fi
+done < cmdline.test
+
+# A file that logs an error must fail each time, even when it is cached
+mkdir -p results/cache
+cp input/c/cache_error.c results/cache/
+for run in 1 2
+do
+	if $exe -q -c config/ben.cfg --replace --cache results/cache \
+	   results/cache/cache_error.c 2> /dev/null
+	then
+		echo "MISMATCH: cache_error.c run $run"
+		fail=$((fail + 1))
+	else
+		pass=$((pass + 1))
+	fi
+done
+
+echo "Passed $pass / $((pass + fail)) command line tests"
+[ $fail -eq 0 ]
@@ -0,0 +1,6 @@
+/* Only lines 4 and 5 are formatted */
+int   a;
+int  b  =  1;
+int  main( ){
+return   a+b;}
+int   c;
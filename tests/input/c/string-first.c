@@ -0,0 +1,3 @@
+"usage: foo [options] file...\n"
+   "  -h   show this help\n"
+"  -v   be verbose\n"
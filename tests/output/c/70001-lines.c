@@ -0,0 +1,5 @@
+4:5
+int  main( )
+{
+   return(a + b);
+}
@@ -0,0 +1,9 @@
+/* --lines must keep or drop both braces of a pair */
+void f(void)
+{
+	if (x) {
+		g(); }
+  if (x)  g();
+	if (x)
+		g();
+}
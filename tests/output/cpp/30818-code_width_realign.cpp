@@ -0,0 +1,25 @@
+static void align_typedefs(int span)
+{
+    as.m_star_style =
+        (AlignStack::StarStyle)cpd->settings[UO_align_typedef_star_style].n;
+    as.m_amp_style  =
+        (AlignStack::StarStyle)cpd->settings[UO_align_typedef_amp_style].n;
+}
+
+bool whole_line_is_string_literal(chunk_t *pc, int level, bool skip)
+{
+    bool result = false;
+
+    if ((pc != NULL) &&
+        (pc->type == CT_STRING) &&
+        (pc->parent_type == CT_OC_MSG) &&
+        ((pc->next != NULL) &&
+         ((pc->next->type == CT_COMMA) ||
+          (pc->next->type == CT_NEWLINE) ||
+          ((pc->next->type == CT_SQUARE_CLOSE) &&
+          ((pc->next->level <= level) ||
+           (level == -1)))))) {
+        result = true;
+    }
+    return result;
+}
@@ -111,6 +111,10 @@ SOURCE=..\src\braces.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\cache.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\chunk_list.cpp
 # End Source File
 # Begin Source File
@@ -131,6 +135,14 @@ SOURCE=..\src\detect.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\diff.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\format.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\indent.cpp
 # End Source File
 # Begin Source File
@@ -143,6 +155,10 @@ SOURCE=..\src\lang_pawn.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\libuncrustify.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\logger.cpp
 # End Source File
 # Begin Source File
@@ -191,6 +207,10 @@ SOURCE=..\src\space.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\stats.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\tokenize.cpp
 # End Source File
 # Begin Source File
@@ -231,6 +251,10 @@ SOURCE=..\src\base_types.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\cache.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\char_table.h
 # End Source File
 # Begin Source File
@@ -247,6 +271,18 @@ SOURCE=..\src\config.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\diff.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\keyword_hash.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\libuncrustify.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\ListManager.h
 # End Source File
 # Begin Source File
@@ -279,6 +315,14 @@ SOURCE=..\src\punctuators.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\SharedArray.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\src\stats.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\token_enum.h
 # End Source File
 # Begin Source File
@@ -287,6 +331,10 @@ SOURCE=..\src\token_names.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\src\unc_scan.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\src\uncrustify_types.h
 # End Source File
 # Begin Source File
@@ -18,10 +18,12 @@ typedef char               CHAR;
 typedef signed char        INT8;
 typedef short              INT16;
 typedef int                INT32;
+typedef __int64            INT64;
 
 typedef unsigned char      UINT8;
 typedef unsigned short     UINT16;
 typedef unsigned int       UINT32;
+typedef unsigned __int64   UINT64;
 
 /* eliminate GNU's attribute */
 #define __attribute__(x)